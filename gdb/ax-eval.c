@@ -0,0 +1,195 @@
+/* Evaluate agent expressions in GDB.
+
+   Copyright (C) 2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* The interpreter itself is shared with gdbserver (see
+   common/ax-interp.c); this file supplies the register and memory
+   accessors.  Tracing and trace state variable operations are not
+   available here.  */
+
+#include "defs.h"
+#include "ax.h"
+#include "gdbarch.h"
+#include "regcache.h"
+#include "target.h"
+#include "gdbcore.h"
+#include "target-dcache.h"
+#include "memattr.h"
+#include "tracepoint.h"
+#include "common/ax-interp.h"
+
+/* Map the remote register number REG, as found in a `reg' bytecode,
+   back to a GDB raw register number of GDBARCH.  */
+
+static int
+ax_eval_regnum (struct gdbarch *gdbarch, int reg)
+{
+  int num_regs = gdbarch_num_regs (gdbarch);
+  int regnum;
+
+  /* The mapping is the identity on most architectures.  */
+  if (reg < num_regs && gdbarch_remote_register_number (gdbarch, reg) == reg)
+    return reg;
+
+  for (regnum = 0; regnum < num_regs; regnum++)
+    if (gdbarch_remote_register_number (gdbarch, regnum) == reg)
+      return regnum;
+
+  error (_("Agent expression refers to unknown register %d"), reg);
+}
+
+/* Return the value of register REG (a remote register number) in
+   REGCACHE, zero-extended.  */
+
+static ULONGEST
+ax_eval_reg (struct regcache *regcache, int reg)
+{
+  struct gdbarch *gdbarch = regcache->arch ();
+  int regnum = ax_eval_regnum (gdbarch, reg);
+  int size = register_size (gdbarch, regnum);
+  gdb_byte buf[sizeof (ULONGEST)];
+
+  if (size > sizeof (buf))
+    error (_("Register %d is too large for an agent expression"), reg);
+
+  if (regcache->raw_read (regnum, buf) != REG_VALID)
+    throw_error (NOT_AVAILABLE_ERROR,
+		 _("Register %d is not available"), regnum);
+
+  return extract_unsigned_integer (buf, size, gdbarch_byte_order (gdbarch));
+}
+
+/* Read LEN bytes at ADDR from the current inferior into BUF through
+   GDB's data cache, as the stack cache does for stack memory.  If
+   neither the stack cache nor the code cache is enabled, the data cache
+   is not kept up to date and is not used; reads from memory regions
+   that can't be read also fall back to read_memory, so that they fail
+   the same way.  */
+
+static void
+ax_eval_read_cached (CORE_ADDR addr, gdb_byte *buf, int len)
+{
+  struct mem_region *region = lookup_mem_region (addr);
+
+  if (!(stack_cache_enabled_p () || code_cache_enabled_p ())
+      || region->attrib.mode == MEM_WO || region->attrib.mode == MEM_NONE
+      || get_traceframe_number () != -1
+      || (region->hi != 0 && addr + len > region->hi))
+    {
+      read_memory (addr, buf, len);
+      return;
+    }
+
+  DCACHE *dcache = target_dcache_get_or_init ();
+
+  while (len > 0)
+    {
+      ULONGEST xfered_len;
+      enum target_xfer_status status
+	= dcache_read_memory_partial (current_top_target (), dcache, addr,
+				      buf, len, &xfered_len);
+
+      if (status != TARGET_XFER_OK)
+	memory_error (status == TARGET_XFER_EOF ? TARGET_XFER_E_IO : status,
+		      addr);
+
+      addr += xfered_len;
+      buf += xfered_len;
+      len -= xfered_len;
+    }
+}
+
+/* Read SIZE bytes at ADDR from the current inferior, zero-extended.
+   If CACHED, read through GDB's data cache.  */
+
+static ULONGEST
+ax_eval_ref (struct gdbarch *gdbarch, CORE_ADDR addr, int size, bool cached)
+{
+  gdb_byte buf[sizeof (ULONGEST)];
+
+  if (cached)
+    ax_eval_read_cached (addr, buf, size);
+  else
+    read_memory (addr, buf, size);
+  return extract_unsigned_integer (buf, size, gdbarch_byte_order (gdbarch));
+}
+
+/* The state the ax_interp_eval callbacks need.  */
+
+struct ax_eval_baton
+{
+  struct regcache *regcache;
+  bool cached;
+};
+
+static ULONGEST
+ax_eval_read_reg (void *baton, int reg)
+{
+  struct ax_eval_baton *data = (struct ax_eval_baton *) baton;
+
+  return ax_eval_reg (data->regcache, reg);
+}
+
+static ULONGEST
+ax_eval_read_memory (void *baton, CORE_ADDR addr, int size)
+{
+  struct ax_eval_baton *data = (struct ax_eval_baton *) baton;
+
+  return ax_eval_ref (data->regcache->arch (), addr, size, data->cached);
+}
+
+static const struct ax_interp_ops ax_eval_ops =
+  {
+    ax_eval_read_reg,
+    ax_eval_read_memory
+  };
+
+/* See ax.h.  */
+
+ULONGEST
+ax_eval (struct agent_expr *expr, struct regcache *regcache, bool cached)
+{
+  struct ax_eval_baton baton = { regcache, cached };
+  ULONGEST result;
+  int pc = 0;
+
+  switch (ax_interp_eval (&ax_eval_ops, &baton, expr->buf, expr->len,
+			  &result, &pc))
+    {
+    case expr_eval_no_error:
+      return result;
+    case expr_eval_empty_expression:
+      error (_("Empty agent expression"));
+    case expr_eval_empty_stack:
+      error (_("Agent expression left an empty stack"));
+    case expr_eval_stack_overflow:
+      error (_("Agent expression stack overflow"));
+    case expr_eval_stack_underflow:
+      error (_("Agent expression stack underflow"));
+    case expr_eval_divide_by_zero:
+      error (_("Division by zero"));
+    case expr_eval_invalid_goto:
+      error (_("Invalid jump in agent expression at offset %d"), pc);
+    case expr_eval_unhandled_opcode:
+      throw_error (NOT_SUPPORTED_ERROR,
+		   _("Agent expression operation `%s' is not "
+		     "supported here"), aop_map[expr->buf[pc]].name);
+    default:
+      error (_("Malformed agent expression at offset %d"), pc);
+    }
+}
@@ -267,4 +267,15 @@ extern struct aop_map aop_map[];
 
 extern void ax_reqs (struct agent_expr *ax);
 
+/* Evaluate the agent expression EXPR in GDB, taking register values
+   from REGCACHE and reading memory from the current inferior, and
+   return the value it leaves on top of the stack.  If CACHED, memory
+   is read through GDB's data cache, which is only safe while the
+   inferior can't run.  Throws an error if EXPR is malformed, and a
+   NOT_SUPPORTED_ERROR if it uses operations that only the agent can
+   perform (tracing, trace state variables, printf, floating point).  */
+
+extern ULONGEST ax_eval (struct agent_expr *expr, struct regcache *regcache,
+			 bool cached);
+
 #endif /* AGENTEXPR_H */
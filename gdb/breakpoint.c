@@ -83,6 +83,10 @@
 #include "common/array-view.h"
 #include "common/gdb_optional.h"
 
+#ifdef ENABLE_PIP
+#include <pip_gdbif_enums.h>
+#endif
+
 /* Enums for exception-handling support.  */
 enum exception_event_kind
 {
@@ -386,6 +390,23 @@ show_always_inserted_mode (struct ui_file *file, int from_tty,
 		    value);
 }
 
+/* If on (default), GDB evaluates the conditions of breakpoint
+   locations by compiling them to agent expression bytecode once and
+   interpreting that, rather than by walking the expression tree on
+   every hit.  Conditions that can't be compiled are still evaluated
+   by the expression evaluator.  */
+static int condition_bytecode = 1;
+
+static void
+show_condition_bytecode (struct ui_file *file, int from_tty,
+			 struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file,
+		    _("Evaluation of breakpoint conditions as bytecode "
+		      "is %s.\n"),
+		    value);
+}
+
 /* See breakpoint.h.  */
 
 int
@@ -541,21 +562,19 @@ static struct bp_location **bp_locations;
 
 static unsigned bp_locations_count;
 
-/* Maximum alignment offset between bp_target_info.PLACED_ADDRESS and
-   ADDRESS for the current elements of BP_LOCATIONS which get a valid
-   result from bp_location_has_shadow.  You can use it for roughly
-   limiting the subrange of BP_LOCATIONS to scan for shadow bytes for
-   an address you need to read.  */
+/* An implicit binary tree over BP_LOCATIONS, used to find the
+   locations whose address range overlaps a given range without
+   scanning the whole array.  Leaf BP_LOCATIONS_END_TREE_LEAVES + I
+   holds bp_location_end of BP_LOCATIONS[I], unused leaves hold zero,
+   and every inner node I holds the highest end of its children 2I and
+   2I + 1.  Rebuilt along with BP_LOCATIONS by
+   update_global_location_list.  */
 
-static CORE_ADDR bp_locations_placed_address_before_address_max;
+static std::vector<CORE_ADDR> bp_locations_end_tree;
 
-/* Maximum offset plus alignment between bp_target_info.PLACED_ADDRESS
-   + bp_target_info.SHADOW_LEN and ADDRESS for the current elements of
-   BP_LOCATIONS which get a valid result from bp_location_has_shadow.
-   You can use it for roughly limiting the subrange of BP_LOCATIONS to
-   scan for shadow bytes for an address you need to read.  */
+/* Number of leaves of BP_LOCATIONS_END_TREE, a power of two.  */
 
-static CORE_ADDR bp_locations_shadow_len_after_address_max;
+static unsigned bp_locations_end_tree_leaves;
 
 /* The locations that no longer correspond to any breakpoint, unlinked
    from the bp_locations array, but for which a hit may still be
@@ -618,20 +637,39 @@ set_breakpoint_count (int num)
    breakpoint count before "rbreak" creates any breakpoint.  */
 static int rbreak_start_breakpoint_count;
 
+/* Nonzero while an "rbreak" command is creating breakpoints.  Their
+   locations are then only added to the global location list once the
+   command is done, rather than re-sorting every location for each new
+   breakpoint.  */
+static int rbreak_defer_location_list_update;
+
+/* Set if update_global_location_list was asked to add locations
+   while RBREAK_DEFER_LOCATION_LIST_UPDATE was nonzero.  */
+static bool rbreak_location_list_update_pending;
+
 /* Called at the start an "rbreak" command to record the first
    breakpoint made.  */
 
 scoped_rbreak_breakpoints::scoped_rbreak_breakpoints ()
 {
   rbreak_start_breakpoint_count = breakpoint_count;
+  rbreak_defer_location_list_update++;
 }
 
 /* Called at the end of an "rbreak" command to record the last
-   breakpoint made.  */
+   breakpoint made, and to take in the locations of the breakpoints
+   it made.  */
 
 scoped_rbreak_breakpoints::~scoped_rbreak_breakpoints ()
 {
   prev_breakpoint_count = rbreak_start_breakpoint_count;
+
+  if (--rbreak_defer_location_list_update == 0
+      && rbreak_location_list_update_pending)
+    {
+      rbreak_location_list_update_pending = false;
+      update_global_location_list_nothrow (UGLL_MAY_INSERT);
+    }
 }
 
 /* Used in run_command to zero the hit count when a new run starts.  */
@@ -835,6 +873,103 @@ get_first_locp_gte_addr (CORE_ADDR address)
   return locp_found;
 }
 
+/* Return the end of the range of LEN bytes at ADDR, saturating
+   instead of wrapping around.  */
+
+static CORE_ADDR
+bp_range_end (CORE_ADDR addr, ULONGEST len)
+{
+  if (addr + len < addr)
+    return (CORE_ADDR) -1;
+  return addr + len;
+}
+
+/* Return the end of the address range of BL: LENGTH bytes for ranged
+   breakpoints and watchpoints, one byte otherwise.  */
+
+static CORE_ADDR
+bp_location_end (const struct bp_location *bl)
+{
+  return bp_range_end (bl->address, bl->length != 0 ? bl->length : 1);
+}
+
+/* Rebuild BP_LOCATIONS_END_TREE from the current contents of
+   BP_LOCATIONS.  */
+
+static void
+bp_locations_end_tree_update (void)
+{
+  unsigned leaves = 1;
+  unsigned i;
+
+  while (leaves < bp_locations_count)
+    leaves *= 2;
+
+  bp_locations_end_tree_leaves = leaves;
+  bp_locations_end_tree.assign (2 * leaves, 0);
+  for (i = 0; i < bp_locations_count; i++)
+    bp_locations_end_tree[leaves + i] = bp_location_end (bp_locations[i]);
+  for (i = leaves - 1; i > 0; i--)
+    bp_locations_end_tree[i] = std::max (bp_locations_end_tree[2 * i],
+					 bp_locations_end_tree[2 * i + 1]);
+}
+
+/* Helper for iterate_over_bp_locations_in_range.  Visit the
+   locations below tree node NODE, which covers BP_LOCATIONS indexes
+   [NODE_LO, NODE_HI), whose index is below LIMIT and whose range ends
+   after LO.  */
+
+static bool
+iterate_over_bp_locations_in_range_1
+  (unsigned node, unsigned node_lo, unsigned node_hi, unsigned limit,
+   CORE_ADDR lo, gdb::function_view<bool (struct bp_location *)> callback)
+{
+  unsigned mid;
+
+  if (node_lo >= limit || bp_locations_end_tree[node] <= lo)
+    return false;
+
+  if (node_hi - node_lo == 1)
+    return callback (bp_locations[node_lo]);
+
+  mid = node_lo + (node_hi - node_lo) / 2;
+  return (iterate_over_bp_locations_in_range_1 (2 * node, node_lo, mid,
+						limit, lo, callback)
+	  || iterate_over_bp_locations_in_range_1 (2 * node + 1, mid, node_hi,
+						   limit, lo, callback));
+}
+
+/* Call CALLBACK on each location of BP_LOCATIONS whose address range
+   (see bp_location_end) overlaps [LO, HI), in BP_LOCATIONS order,
+   until it returns true.  Return true if it did.  This costs
+   logarithmic time per location visited, instead of a scan of every
+   location.  Address spaces are not considered.  */
+
+static bool
+iterate_over_bp_locations_in_range
+  (CORE_ADDR lo, CORE_ADDR hi,
+   gdb::function_view<bool (struct bp_location *)> callback)
+{
+  struct bp_location **first_beyond;
+
+  if (bp_locations_count == 0 || lo >= hi)
+    return false;
+
+  /* BP_LOCATIONS is sorted by address, so only the locations before
+     the first one at or after HI can overlap.  */
+  first_beyond = std::lower_bound (bp_locations,
+				   bp_locations + bp_locations_count, hi,
+				   [] (const bp_location *bl, CORE_ADDR addr)
+				   {
+				     return bl->address < addr;
+				   });
+
+  return iterate_over_bp_locations_in_range_1 (1, 0,
+					       bp_locations_end_tree_leaves,
+					       first_beyond - bp_locations,
+					       lo, callback);
+}
+
 void
 set_breakpoint_condition (struct breakpoint *b, const char *exp,
 			  int from_tty)
@@ -855,6 +990,8 @@ set_breakpoint_condition (struct breakpoint *b, const char *exp,
       for (loc = b->loc; loc; loc = loc->next)
 	{
 	  loc->cond.reset ();
+	  loc->cond_host_bytecode.reset ();
+	  loc->cond_host_bytecode_valid = false;
 
 	  /* No need to free the condition agent expression
 	     bytecode (if we have one).  We will handle this
@@ -1411,102 +1548,36 @@ one_breakpoint_xfer_memory (gdb_byte *readbuf, gdb_byte *writebuf,
    the breakpoint location's shadow_contents buffers.  Otherwise,
    a failed assertion internal error will be raised.
 
-   The range of shadowed area by each bp_location is:
-     bl->address - bp_locations_placed_address_before_address_max
-     up to bl->address + bp_locations_shadow_len_after_address_max
-   The range we were requested to resolve shadows for is:
-     memaddr ... memaddr + len
-   Thus the safe cutoff boundaries for performance optimization are
-     memaddr + len <= (bl->address
-		       - bp_locations_placed_address_before_address_max)
-   and:
-     bl->address + bp_locations_shadow_len_after_address_max <= memaddr  */
+   A location's shadow covers at most BREAKPOINT_MAX bytes and always
+   includes its ADDRESS, so only the locations whose address is within
+   BREAKPOINT_MAX bytes of MEMADDR ... MEMADDR + LEN can be
+   concerned.  */
 
 void
 breakpoint_xfer_memory (gdb_byte *readbuf, gdb_byte *writebuf,
 			const gdb_byte *writebuf_org,
 			ULONGEST memaddr, LONGEST len)
 {
-  /* Left boundary, right boundary and median element of our binary
-     search.  */
-  unsigned bc_l, bc_r, bc;
-
-  /* Find BC_L which is a leftmost element which may affect BUF
-     content.  It is safe to report lower value but a failure to
-     report higher one.  */
-
-  bc_l = 0;
-  bc_r = bp_locations_count;
-  while (bc_l + 1 < bc_r)
-    {
-      struct bp_location *bl;
-
-      bc = (bc_l + bc_r) / 2;
-      bl = bp_locations[bc];
-
-      /* Check first BL->ADDRESS will not overflow due to the added
-	 constant.  Then advance the left boundary only if we are sure
-	 the BC element can in no way affect the BUF content (MEMADDR
-	 to MEMADDR + LEN range).
-
-	 Use the BP_LOCATIONS_SHADOW_LEN_AFTER_ADDRESS_MAX safety
-	 offset so that we cannot miss a breakpoint with its shadow
-	 range tail still reaching MEMADDR.  */
-
-      if ((bl->address + bp_locations_shadow_len_after_address_max
-	   >= bl->address)
-	  && (bl->address + bp_locations_shadow_len_after_address_max
-	      <= memaddr))
-	bc_l = bc;
-      else
-	bc_r = bc;
-    }
-
-  /* Due to the binary search above, we need to make sure we pick the
-     first location that's at BC_L's address.  E.g., if there are
-     multiple locations at the same address, BC_L may end up pointing
-     at a duplicate location, and miss the "master"/"inserted"
-     location.  Say, given locations L1, L2 and L3 at addresses A and
-     B:
-
-      L1@A, L2@A, L3@B, ...
-
-     BC_L could end up pointing at location L2, while the "master"
-     location could be L1.  Since the `loc->inserted' flag is only set
-     on "master" locations, we'd forget to restore the shadow of L1
-     and L2.  */
-  while (bc_l > 0
-	 && bp_locations[bc_l]->address == bp_locations[bc_l - 1]->address)
-    bc_l--;
-
-  /* Now do full processing of the found relevant range of elements.  */
-
-  for (bc = bc_l; bc < bp_locations_count; bc++)
-  {
-    struct bp_location *bl = bp_locations[bc];
-
-    /* bp_location array has BL->OWNER always non-NULL.  */
-    if (bl->owner->type == bp_none)
-      warning (_("reading through apparently deleted breakpoint #%d?"),
-	       bl->owner->number);
-
-    /* Performance optimization: any further element can no longer affect BUF
-       content.  */
-
-    if (bl->address >= bp_locations_placed_address_before_address_max
-	&& memaddr + len <= (bl->address
-			     - bp_locations_placed_address_before_address_max))
-      break;
-
-    if (!bp_location_has_shadow (bl))
-      continue;
+  CORE_ADDR lo = memaddr >= BREAKPOINT_MAX ? memaddr - BREAKPOINT_MAX : 0;
+  CORE_ADDR hi = bp_range_end (memaddr, len + BREAKPOINT_MAX);
 
-    one_breakpoint_xfer_memory (readbuf, writebuf, writebuf_org,
-				memaddr, len, &bl->target_info, bl->gdbarch);
-  }
+  iterate_over_bp_locations_in_range
+    (lo, hi, [&] (struct bp_location *bl)
+     {
+       /* bp_location array has BL->OWNER always non-NULL.  */
+       if (bl->owner->type == bp_none)
+	 warning (_("reading through apparently deleted breakpoint #%d?"),
+		  bl->owner->number);
+
+       if (bp_location_has_shadow (bl))
+	 one_breakpoint_xfer_memory (readbuf, writebuf, writebuf_org,
+				     memaddr, len, &bl->target_info,
+				     bl->gdbarch);
+       return false;
+     });
 }
 
-
+
 
 /* Return true if BPT is either a software breakpoint or a hardware
    breakpoint.  */
@@ -1557,6 +1628,26 @@ watchpoint_in_thread_scope (struct watchpoint *b)
 		  && !inferior_thread ()->executing)));
 }
 
+#ifdef ENABLE_PIP
+/* Return true if the current thread, which runs in another PiP task
+   than the one watchpoint B was set in, may have triggered B.  Only
+   watchpoints on global expressions are shared that way.  */
+
+static int
+watchpoint_triggered_by_pip_task (struct watchpoint *b)
+{
+  struct inferior *inf;
+
+  if (b->pspace == current_program_space
+      || b->watchpoint_thread != null_ptid
+      || b->exp_valid_block != NULL)
+    return 0;
+
+  inf = find_inferior_for_program_space (b->pspace);
+  return inf != NULL && pip_watchpoints_shared_p (inf, current_inferior ());
+}
+#endif
+
 /* Set watchpoint B to disp_del_at_next_stop, even including its possible
    associated bp_watchpoint_scope breakpoint.  */
 
@@ -3203,8 +3294,13 @@ free_breakpoint_objfile_data (struct objfile *obj, void *data)
   delete bp_objfile_data;
 }
 
+/* Create the overlay event breakpoints.  In this and the other
+   create_*_master_breakpoint functions below, if FILTER_OBJFILE is
+   not NULL, only FILTER_OBJFILE and its separate debug objfiles are
+   looked at.  */
+
 static void
-create_overlay_event_breakpoint (void)
+create_overlay_event_breakpoint (struct objfile *filter_objfile)
 {
   struct objfile *objfile;
   const char *const func_name = "_ovly_debug_event";
@@ -3216,6 +3312,10 @@ create_overlay_event_breakpoint (void)
       CORE_ADDR addr;
       struct explicit_location explicit_loc;
 
+      if (filter_objfile != NULL
+	  && !objfile_is_or_separate_debug_of (objfile, filter_objfile))
+	continue;
+
       bp_objfile_data = get_breakpoint_objfile_data (objfile);
 
       if (msym_not_found_p (bp_objfile_data->overlay_msym.minsym))
@@ -3257,7 +3357,7 @@ create_overlay_event_breakpoint (void)
 }
 
 static void
-create_longjmp_master_breakpoint (void)
+create_longjmp_master_breakpoint (struct objfile *filter_objfile)
 {
   struct program_space *pspace;
 
@@ -3267,6 +3367,9 @@ create_longjmp_master_breakpoint (void)
   {
     struct objfile *objfile;
 
+    if (filter_objfile != NULL && filter_objfile->pspace != pspace)
+      continue;
+
     set_current_program_space (pspace);
 
     ALL_OBJFILES (objfile)
@@ -3275,6 +3378,10 @@ create_longjmp_master_breakpoint (void)
       struct gdbarch *gdbarch;
       struct breakpoint_objfile_data *bp_objfile_data;
 
+      if (filter_objfile != NULL
+	  && !objfile_is_or_separate_debug_of (objfile, filter_objfile))
+	continue;
+
       gdbarch = get_objfile_arch (objfile);
 
       bp_objfile_data = get_breakpoint_objfile_data (objfile);
@@ -3361,7 +3468,7 @@ create_longjmp_master_breakpoint (void)
 
 /* Create a master std::terminate breakpoint.  */
 static void
-create_std_terminate_master_breakpoint (void)
+create_std_terminate_master_breakpoint (struct objfile *filter_objfile)
 {
   struct program_space *pspace;
   const char *const func_name = "std::terminate()";
@@ -3373,6 +3480,9 @@ create_std_terminate_master_breakpoint (void)
     struct objfile *objfile;
     CORE_ADDR addr;
 
+    if (filter_objfile != NULL && filter_objfile->pspace != pspace)
+      continue;
+
     set_current_program_space (pspace);
 
     ALL_OBJFILES (objfile)
@@ -3381,6 +3491,10 @@ create_std_terminate_master_breakpoint (void)
       struct breakpoint_objfile_data *bp_objfile_data;
       struct explicit_location explicit_loc;
 
+      if (filter_objfile != NULL
+	  && !objfile_is_or_separate_debug_of (objfile, filter_objfile))
+	continue;
+
       bp_objfile_data = get_breakpoint_objfile_data (objfile);
 
       if (msym_not_found_p (bp_objfile_data->terminate_msym.minsym))
@@ -3416,7 +3530,7 @@ create_std_terminate_master_breakpoint (void)
 /* Install a master breakpoint on the unwinder's debug hook.  */
 
 static void
-create_exception_master_breakpoint (void)
+create_exception_master_breakpoint (struct objfile *filter_objfile)
 {
   struct objfile *objfile;
   const char *const func_name = "_Unwind_DebugHook";
@@ -3429,6 +3543,10 @@ create_exception_master_breakpoint (void)
       CORE_ADDR addr;
       struct explicit_location explicit_loc;
 
+      if (filter_objfile != NULL
+	  && !objfile_is_or_separate_debug_of (objfile, filter_objfile))
+	continue;
+
       bp_objfile_data = get_breakpoint_objfile_data (objfile);
 
       /* We prefer the SystemTap probe point if it exists.  */
@@ -3980,31 +4098,35 @@ breakpoint_init_inferior (enum inf_context context)
 enum breakpoint_here
 breakpoint_here_p (const address_space *aspace, CORE_ADDR pc)
 {
-  struct bp_location *bl, **blp_tmp;
   int any_breakpoint_here = 0;
+  bool permanent_here;
 
-  ALL_BP_LOCATIONS (bl, blp_tmp)
-    {
-      if (bl->loc_type != bp_loc_software_breakpoint
-	  && bl->loc_type != bp_loc_hardware_breakpoint)
-	continue;
-
-      /* ALL_BP_LOCATIONS bp_location has BL->OWNER always non-NULL.  */
-      if ((breakpoint_enabled (bl->owner)
-	   || bl->permanent)
-	  && breakpoint_location_address_match (bl, aspace, pc))
-	{
-	  if (overlay_debugging 
-	      && section_is_overlay (bl->section)
-	      && !section_is_mapped (bl->section))
-	    continue;		/* unmapped overlay -- can't be a match */
-	  else if (bl->permanent)
-	    return permanent_breakpoint_here;
-	  else
-	    any_breakpoint_here = 1;
-	}
-    }
+  permanent_here = iterate_over_bp_locations_in_range
+    (pc, bp_range_end (pc, 1), [&] (struct bp_location *bl)
+     {
+       if (bl->loc_type != bp_loc_software_breakpoint
+	   && bl->loc_type != bp_loc_hardware_breakpoint)
+	 return false;
+
+       /* bp_location array has BL->OWNER always non-NULL.  */
+       if ((breakpoint_enabled (bl->owner)
+	    || bl->permanent)
+	   && breakpoint_location_address_match (bl, aspace, pc))
+	 {
+	   if (overlay_debugging
+	       && section_is_overlay (bl->section)
+	       && !section_is_mapped (bl->section))
+	     return false;	/* unmapped overlay -- can't be a match */
+	   else if (bl->permanent)
+	     return true;
+	   else
+	     any_breakpoint_here = 1;
+	 }
+       return false;
+     });
 
+  if (permanent_here)
+    return permanent_breakpoint_here;
   return any_breakpoint_here ? ordinary_breakpoint_here : no_breakpoint_here;
 }
 
@@ -4014,32 +4136,30 @@ int
 breakpoint_in_range_p (const address_space *aspace,
 		       CORE_ADDR addr, ULONGEST len)
 {
-  struct bp_location *bl, **blp_tmp;
-
-  ALL_BP_LOCATIONS (bl, blp_tmp)
-    {
-      if (bl->loc_type != bp_loc_software_breakpoint
-	  && bl->loc_type != bp_loc_hardware_breakpoint)
-	continue;
-
-      if ((breakpoint_enabled (bl->owner)
-	   || bl->permanent)
-	  && breakpoint_location_address_range_overlap (bl, aspace,
-							addr, len))
-	{
-	  if (overlay_debugging
-	      && section_is_overlay (bl->section)
-	      && !section_is_mapped (bl->section))
-	    {
-	      /* Unmapped overlay -- can't be a match.  */
-	      continue;
-	    }
-
-	  return 1;
-	}
-    }
+  return iterate_over_bp_locations_in_range
+    (addr, bp_range_end (addr, len), [&] (struct bp_location *bl)
+     {
+       if (bl->loc_type != bp_loc_software_breakpoint
+	   && bl->loc_type != bp_loc_hardware_breakpoint)
+	 return false;
+
+       if ((breakpoint_enabled (bl->owner)
+	    || bl->permanent)
+	   && breakpoint_location_address_range_overlap (bl, aspace,
+							 addr, len))
+	 {
+	   if (overlay_debugging
+	       && section_is_overlay (bl->section)
+	       && !section_is_mapped (bl->section))
+	     {
+	       /* Unmapped overlay -- can't be a match.  */
+	       return false;
+	     }
 
-  return 0;
+	   return true;
+	 }
+       return false;
+     });
 }
 
 /* Return true if there's a moribund breakpoint at PC.  */
@@ -4148,32 +4268,27 @@ int
 hardware_watchpoint_inserted_in_range (const address_space *aspace,
 				       CORE_ADDR addr, ULONGEST len)
 {
-  struct breakpoint *bpt;
+  return iterate_over_bp_locations_in_range
+    (addr, bp_range_end (addr, len), [&] (struct bp_location *loc)
+     {
+       struct breakpoint *bpt = loc->owner;
+       CORE_ADDR l, h;
 
-  ALL_BREAKPOINTS (bpt)
-    {
-      struct bp_location *loc;
+       if (bpt->type != bp_hardware_watchpoint
+	   && bpt->type != bp_access_watchpoint)
+	 return false;
 
-      if (bpt->type != bp_hardware_watchpoint
-	  && bpt->type != bp_access_watchpoint)
-	continue;
+       if (!breakpoint_enabled (bpt))
+	 return false;
 
-      if (!breakpoint_enabled (bpt))
-	continue;
-
-      for (loc = bpt->loc; loc; loc = loc->next)
-	if (loc->pspace->aspace == aspace && loc->inserted)
-	  {
-	    CORE_ADDR l, h;
+       if (loc->pspace->aspace != aspace || !loc->inserted)
+	 return false;
 
-	    /* Check for intersection.  */
-	    l = std::max<CORE_ADDR> (loc->address, addr);
-	    h = std::min<CORE_ADDR> (loc->address + loc->length, addr + len);
-	    if (l < h)
-	      return 1;
-	  }
-    }
-  return 0;
+       /* Check for intersection.  */
+       l = std::max<CORE_ADDR> (loc->address, addr);
+       h = std::min<CORE_ADDR> (loc->address + loc->length, addr + len);
+       return l < h;
+     });
 }
 
 
@@ -4548,6 +4663,38 @@ maybe_print_thread_hit_breakpoint (struct ui_out *uiout)
     }
 }
 
+#ifdef ENABLE_PIP
+/* If watchpoint W was triggered by a PiP task other than the one it
+   was set in, say which task and thread it was.  */
+
+static void
+maybe_print_pip_task_hit_watchpoint (struct ui_out *uiout,
+				     struct watchpoint *w)
+{
+  struct inferior *inf = current_inferior ();
+
+  if (w->pspace == current_program_space
+      || inf->pipid == PIP_GDBIF_PIPID_ANY)
+    return;
+
+  uiout->text ("Triggered by PiP ");
+  if (inf->pipid == PIP_GDBIF_PIPID_ROOT)
+    uiout->text ("root task");
+  else
+    {
+      uiout->text ("task ");
+      uiout->field_int ("pip-task", inf->pipid);
+    }
+  uiout->text (" (");
+  uiout->field_string ("pip-target-id",
+		       target_pid_to_str (ptid_t (inf->pid)));
+  uiout->text ("), thread ");
+  uiout->field_string ("pip-thread-id",
+		       print_thread_id (inferior_thread ()));
+  uiout->text (".\n");
+}
+#endif
+
 /* Generic routine for printing messages indicating why we
    stopped.  The behavior of this function depends on the value
    'print_it' in the bpstat structure.  Under some circumstances we
@@ -4708,6 +4855,42 @@ breakpoint_cond_eval (expression *exp)
   return res;
 }
 
+/* Evaluate the condition of breakpoint location BL in the selected
+   frame, which must be the innermost one, and return the result.
+   The condition is compiled to bytecode on first use, and evaluated
+   with the expression evaluator if that is not possible.  */
+
+static bool
+breakpoint_location_cond_eval (struct bp_location *bl)
+{
+  if (condition_bytecode && !bl->cond_host_bytecode_valid)
+    {
+      bl->cond_host_bytecode = parse_cond_to_aexpr (bl->address,
+						    bl->cond.get ());
+      bl->cond_host_bytecode_valid = true;
+    }
+
+  if (condition_bytecode && bl->cond_host_bytecode != NULL)
+    {
+      /* The inferior is stopped, so memory can be read through the
+	 data cache.  An error is reported by the expression evaluator
+	 below, the same way as without bytecode.  */
+      TRY
+	{
+	  return ax_eval (bl->cond_host_bytecode.get (),
+			  get_current_regcache (), true) != 0;
+	}
+      CATCH (ex, RETURN_MASK_ERROR)
+	{
+	  if (ex.error == NOT_SUPPORTED_ERROR)
+	    bl->cond_host_bytecode.reset ();
+	}
+      END_CATCH
+    }
+
+  return breakpoint_cond_eval (bl->cond.get ());
+}
+
 /* Allocate a new bpstat.  Link it to the FIFO list by BS_LINK_POINTER.  */
 
 bpstats::bpstats (struct bp_location *bl, bpstat **bs_link_pointer)
@@ -4849,7 +5032,11 @@ watchpoint_check (bpstat bs)
   /* If this is a local watchpoint, we only want to check if the
      watchpoint frame is in scope if the current thread is the thread
      that was used to create the watchpoint.  */
-  if (!watchpoint_in_thread_scope (b))
+  if (!watchpoint_in_thread_scope (b)
+#ifdef ENABLE_PIP
+      && !watchpoint_triggered_by_pip_task (b)
+#endif
+      )
     return WP_IGNORE;
 
   if (b->exp_valid_block == NULL)
@@ -5273,7 +5460,11 @@ bpstat_check_breakpoint_conditions (bpstat bs, thread_info *thread)
 	{
 	  TRY
 	    {
-	      condition_result = breakpoint_cond_eval (cond);
+	      if (w == NULL)
+		condition_result
+		  = breakpoint_location_cond_eval (bs->bp_location_at);
+	      else
+		condition_result = breakpoint_cond_eval (cond);
 	    }
 	  CATCH (ex, RETURN_MASK_ALL)
 	    {
@@ -6369,6 +6560,22 @@ print_one_breakpoint_location (struct breakpoint *b,
 	}
     }
 
+  /* For "maint info breakpoints", say how GDB evaluated the condition
+     of the location the last time it did so on the host's side.  */
+  if (allflag && !uiout->is_mi_like_p () && is_breakpoint (b)
+      && !header_of_multiple)
+    {
+      struct bp_location *bl = loc != NULL ? loc : b->loc;
+
+      if (bl != NULL && bl->cond != NULL && bl->cond_host_bytecode_valid)
+	{
+	  if (condition_bytecode && bl->cond_host_bytecode != NULL)
+	    uiout->text ("\tcondition evaluated as bytecode\n");
+	  else
+	    uiout->text ("\tcondition evaluated as an expression\n");
+	}
+    }
+
   if (uiout->is_mi_like_p () && !part_of_multiple)
     {
       if (is_watchpoint (b))
@@ -10250,6 +10457,11 @@ print_it_watchpoint (bpstat bs)
       result = PRINT_UNKNOWN;
     }
 
+#ifdef ENABLE_PIP
+  tuple_emitter.reset ();
+  maybe_print_pip_task_hit_watchpoint (uiout, w);
+#endif
+
   return result;
 }
 
@@ -11604,42 +11816,6 @@ bp_locations_compare (const void *ap, const void *bp)
   return (a > b) - (a < b);
 }
 
-/* Set bp_locations_placed_address_before_address_max and
-   bp_locations_shadow_len_after_address_max according to the current
-   content of the bp_locations array.  */
-
-static void
-bp_locations_target_extensions_update (void)
-{
-  struct bp_location *bl, **blp_tmp;
-
-  bp_locations_placed_address_before_address_max = 0;
-  bp_locations_shadow_len_after_address_max = 0;
-
-  ALL_BP_LOCATIONS (bl, blp_tmp)
-    {
-      CORE_ADDR start, end, addr;
-
-      if (!bp_location_has_shadow (bl))
-	continue;
-
-      start = bl->target_info.placed_address;
-      end = start + bl->target_info.shadow_len;
-
-      gdb_assert (bl->address >= start);
-      addr = bl->address - start;
-      if (addr > bp_locations_placed_address_before_address_max)
-	bp_locations_placed_address_before_address_max = addr;
-
-      /* Zero SHADOW_LEN would not pass bp_location_has_shadow.  */
-
-      gdb_assert (bl->address < end);
-      addr = end - bl->address;
-      if (addr > bp_locations_shadow_len_after_address_max)
-	bp_locations_shadow_len_after_address_max = addr;
-    }
-}
-
 /* Download tracepoint locations if they haven't been.  */
 
 static void
@@ -11801,6 +11977,17 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
      built bp_locations from the current state of ALL_BREAKPOINTS.  */
   struct bp_location **old_locp;
   unsigned old_locations_count;
+
+  /* Leave the new locations of "rbreak" for scoped_rbreak_breakpoints
+     to take in all at once.  Other updates, such as those of deleting
+     a breakpoint, are done right away, as their callers may free what
+     the dropped locations refer to.  */
+  if (insert_mode == UGLL_MAY_INSERT && rbreak_defer_location_list_update > 0)
+    {
+      rbreak_location_list_update_pending = true;
+      return;
+    }
+
   gdb::unique_xmalloc_ptr<struct bp_location *> old_locations (bp_locations);
 
   old_locations_count = bp_locations_count;
@@ -11819,7 +12006,7 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
   qsort (bp_locations, bp_locations_count, sizeof (*bp_locations),
 	 bp_locations_compare);
 
-  bp_locations_target_extensions_update ();
+  bp_locations_end_tree_update ();
 
   /* Identify bp_location instances that are no longer present in the
      new list, and therefore should be freed.  Note that it's not
@@ -13915,10 +14102,127 @@ breakpoint_re_set (void)
     jit_breakpoint_re_set ();
   }
 
-  create_overlay_event_breakpoint ();
-  create_longjmp_master_breakpoint ();
-  create_std_terminate_master_breakpoint ();
-  create_exception_master_breakpoint ();
+  create_overlay_event_breakpoint (NULL);
+  create_longjmp_master_breakpoint (NULL);
+  create_std_terminate_master_breakpoint (NULL);
+  create_exception_master_breakpoint (NULL);
+
+  /* Now we can insert.  */
+  update_global_location_list (UGLL_MAY_INSERT);
+}
+
+/* Return true if B needs to be re-set now that OBJFILE has been
+   added, i.e. if it's not a kind of breakpoint we know how to check
+   cheaply, or if its location matches something in OBJFILE.  The
+   caller is responsible for restoring the current language and
+   input radix.  */
+
+static bool
+breakpoint_re_set_needed_for_objfile (struct breakpoint *b,
+				      struct objfile *objfile)
+{
+  struct bp_location *loc;
+
+  /* Only ordinary breakpoints on linespecs are checked.  Address
+     locations don't depend on symbols, and ranged breakpoints,
+     tracepoints, watchpoints, catchpoints, etc. are left to their
+     re_set method.  */
+  if (b->ops != &bkpt_breakpoint_ops
+      || b->location_range_end != NULL
+      || breakpoint_event_location_empty_p (b)
+      || (event_location_type (b->location.get ()) != LINESPEC_LOCATION
+	  && event_location_type (b->location.get ()) != EXPLICIT_LOCATION))
+    return true;
+
+  /* A full re-set would replace locations left pending by an
+     unloaded shared library, and retry conditions that failed to
+     parse.  */
+  for (loc = b->loc; loc != NULL; loc = loc->next)
+    if (loc->shlib_disabled
+	|| (b->cond_string != NULL && loc->cond == NULL))
+      return true;
+
+  /* Otherwise, re-setting B can only add locations in OBJFILE, so
+     look for some in OBJFILE alone.  Anything that is found is
+     handled by a full re-set of B, which also takes care of what
+     linespec does across objfiles (like preferring a function over a
+     PLT stub).  */
+  scoped_restore restore_search_objfile
+    = make_scoped_restore (&linespec_search_objfile, objfile);
+
+  input_radix = b->input_radix;
+  set_language (b->language);
+
+  TRY
+    {
+      std::vector<symtab_and_line> sals
+	= b->ops->decode_location (b, b->location.get (), objfile->pspace);
+
+      return !sals.empty ();
+    }
+  CATCH (e, RETURN_MASK_ERROR)
+    {
+      if (e.error == NOT_FOUND_ERROR)
+	return false;
+    }
+  END_CATCH
+
+  /* Let the full re-set report any other error.  */
+  return true;
+}
+
+/* See breakpoint.h.  */
+
+void
+breakpoint_re_set_objfiles (const std::vector<struct objfile *> &objfiles)
+{
+  struct breakpoint *b, *b_tmp;
+
+  {
+    scoped_restore_current_language save_language;
+    scoped_restore save_input_radix = make_scoped_restore (&input_radix);
+    scoped_restore_current_pspace_and_thread restore_pspace_thread;
+
+    /* See breakpoint_re_set.  */
+    scoped_restore save_language_mode = make_scoped_restore (&language_mode);
+    language_mode = language_mode_manual;
+
+    ALL_BREAKPOINTS_SAFE (b, b_tmp)
+      {
+	/* The master breakpoints of existing objfiles stay as they
+	   are; OBJFILE's are created below.  The other internal
+	   breakpoints don't depend on symbols.  */
+	if (b->ops == &internal_breakpoint_ops)
+	  continue;
+
+	TRY
+	  {
+	    for (struct objfile *objfile : objfiles)
+	      if (breakpoint_re_set_needed_for_objfile (b, objfile))
+		{
+		  breakpoint_re_set_one (b);
+		  break;
+		}
+	  }
+	CATCH (ex, RETURN_MASK_ALL)
+	  {
+	    exception_fprintf (gdb_stderr, ex,
+			       "Error in re-setting breakpoint %d: ",
+			       b->number);
+	  }
+	END_CATCH
+      }
+
+    jit_breakpoint_re_set ();
+  }
+
+  for (struct objfile *objfile : objfiles)
+    {
+      create_overlay_event_breakpoint (objfile);
+      create_longjmp_master_breakpoint (objfile);
+      create_std_terminate_master_breakpoint (objfile);
+      create_exception_master_breakpoint (objfile);
+    }
 
   /* Now we can insert.  */
   update_global_location_list (UGLL_MAY_INSERT);
@@ -16043,6 +16347,19 @@ when execution stops."),
 				&breakpoint_set_cmdlist,
 				&breakpoint_show_cmdlist);
 
+  add_setshow_boolean_cmd ("condition-bytecode", class_breakpoint,
+			   &condition_bytecode, _("\
+Set whether GDB evaluates breakpoint conditions as bytecode."), _("\
+Show whether GDB evaluates breakpoint conditions as bytecode."), _("\
+When on (default), the conditions of breakpoints that GDB evaluates are\n\
+compiled once to agent expression bytecode, which is much cheaper to\n\
+evaluate on each hit.  Conditions that can't be compiled, and all\n\
+watchpoint conditions, are evaluated by walking the expression."),
+			   NULL,
+			   show_condition_bytecode,
+			   &breakpoint_set_cmdlist,
+			   &breakpoint_show_cmdlist);
+
   add_setshow_enum_cmd ("condition-evaluation", class_breakpoint,
 			condition_evaluation_enums,
 			&condition_evaluation_mode_1, _("\
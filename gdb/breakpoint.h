@@ -354,6 +354,13 @@ public:
      condition evaluation.  */
   agent_expr_up cond_bytecode;
 
+  /* COND compiled to agent expression bytecode for evaluation by GDB
+     itself (see ax_eval), or NULL if it could not be compiled.  Only
+     meaningful if COND_HOST_BYTECODE_VALID; resetting that recompiles
+     COND the next time it is evaluated.  */
+  agent_expr_up cond_host_bytecode;
+  bool cond_host_bytecode_valid = false;
+
   /* Signals that the condition has changed since the last time
      we updated the global location list.  This means the condition
      needs to be sent to the target again.  This is used together
@@ -1251,6 +1258,13 @@ extern void update_breakpoint_locations
 
 extern void breakpoint_re_set (void);
 
+/* Like breakpoint_re_set, but for when OBJFILES, all in the current
+   program space, have just been added: only the breakpoints whose
+   locations may be found in OBJFILES are re-set.  */
+
+extern void breakpoint_re_set_objfiles
+  (const std::vector<struct objfile *> &objfiles);
+
 extern void breakpoint_re_set_thread (struct breakpoint *);
 
 extern void delete_breakpoint (struct breakpoint *);
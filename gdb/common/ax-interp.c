@@ -0,0 +1,487 @@
+/* Agent expression interpreter shared by GDB and GDBserver.
+
+   Copyright (C) 2009-2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "common-defs.h"
+#include "ax-interp.h"
+
+/* This enum must exactly match what is documented in
+   gdb/doc/agentexpr.texi, including all the numerical values.  */
+
+enum ax_interp_op
+  {
+#define DEFOP(NAME, SIZE, DATA_SIZE, CONSUMED, PRODUCED, VALUE)  \
+    ax_op_ ## NAME = VALUE,
+#include "ax.def"
+#undef DEFOP
+    ax_op_last
+  };
+
+/* The number of operand bytes, and the number of stack elements
+   consumed, of each operation.  */
+
+static const unsigned char ax_op_sizes[ax_op_last] =
+  {
+    0
+#define DEFOP(NAME, SIZE, DATA_SIZE, CONSUMED, PRODUCED, VALUE)  , SIZE
+#include "ax.def"
+#undef DEFOP
+  };
+
+static const unsigned char ax_op_consumed[ax_op_last] =
+  {
+    0
+#define DEFOP(NAME, SIZE, DATA_SIZE, CONSUMED, PRODUCED, VALUE)  , CONSUMED
+#include "ax.def"
+#undef DEFOP
+  };
+
+/* Maximum depth of the evaluation stack.  */
+#define STACK_MAX 100
+
+/* Read the big-endian SIZE-byte operand at BYTES.  */
+
+static ULONGEST
+ax_interp_operand (const gdb_byte *bytes, int size)
+{
+  ULONGEST val = 0;
+
+  while (size-- > 0)
+    val = (val << 8) + *bytes++;
+  return val;
+}
+
+/* See ax-interp.h.  */
+
+enum eval_result_type
+ax_interp_eval (const struct ax_interp_ops *ops, void *baton,
+		const gdb_byte *bytes, int len, ULONGEST *rslt,
+		int *error_pc)
+{
+  int pc = 0, op_pc = 0;
+  ULONGEST stack[STACK_MAX], top;
+  int sp = 0;
+  enum eval_result_type result;
+  unsigned char op;
+  int arg;
+
+  if (len == 0)
+    return expr_eval_empty_expression;
+
+  /* Cache the stack top in its own variable.  Much of the time we can
+     operate on this variable, rather than dinking with the stack.  It
+     needs to be copied to the stack when sp changes.  */
+  top = 0;
+
+  while (1)
+    {
+      op_pc = pc;
+      if (pc >= len)
+	{
+	  result = expr_eval_malformed_expression;
+	  goto fail;
+	}
+
+      op = bytes[pc++];
+      if (op == 0 || op >= ax_op_last)
+	{
+	  /* Don't struggle on, things will just get worse.  */
+	  result = expr_eval_unrecognized_opcode;
+	  goto fail;
+	}
+      if (pc + ax_op_sizes[op] > len)
+	{
+	  result = expr_eval_malformed_expression;
+	  goto fail;
+	}
+      if (sp < ax_op_consumed[op])
+	{
+	  result = expr_eval_stack_underflow;
+	  goto fail;
+	}
+
+      switch (op)
+	{
+	case ax_op_add:
+	  top += stack[--sp];
+	  break;
+
+	case ax_op_sub:
+	  top = stack[--sp] - top;
+	  break;
+
+	case ax_op_mul:
+	  top *= stack[--sp];
+	  break;
+
+	case ax_op_div_signed:
+	  if (top == 0)
+	    {
+	      result = expr_eval_divide_by_zero;
+	      goto fail;
+	    }
+	  top = ((LONGEST) stack[--sp]) / ((LONGEST) top);
+	  break;
+
+	case ax_op_div_unsigned:
+	  if (top == 0)
+	    {
+	      result = expr_eval_divide_by_zero;
+	      goto fail;
+	    }
+	  top = stack[--sp] / top;
+	  break;
+
+	case ax_op_rem_signed:
+	  if (top == 0)
+	    {
+	      result = expr_eval_divide_by_zero;
+	      goto fail;
+	    }
+	  top = ((LONGEST) stack[--sp]) % ((LONGEST) top);
+	  break;
+
+	case ax_op_rem_unsigned:
+	  if (top == 0)
+	    {
+	      result = expr_eval_divide_by_zero;
+	      goto fail;
+	    }
+	  top = stack[--sp] % top;
+	  break;
+
+	case ax_op_lsh:
+	  top = stack[--sp] << top;
+	  break;
+
+	case ax_op_rsh_signed:
+	  top = ((LONGEST) stack[--sp]) >> top;
+	  break;
+
+	case ax_op_rsh_unsigned:
+	  top = stack[--sp] >> top;
+	  break;
+
+	case ax_op_trace:
+	  if (ops->trace_memory == NULL)
+	    goto unhandled;
+	  ops->trace_memory (baton, (CORE_ADDR) stack[--sp], top);
+	  if (--sp >= 0)
+	    top = stack[sp];
+	  break;
+
+	case ax_op_trace_quick:
+	  if (ops->trace_memory == NULL)
+	    goto unhandled;
+	  arg = bytes[pc++];
+	  ops->trace_memory (baton, (CORE_ADDR) top, arg);
+	  break;
+
+	case ax_op_log_not:
+	  top = !top;
+	  break;
+
+	case ax_op_bit_and:
+	  top &= stack[--sp];
+	  break;
+
+	case ax_op_bit_or:
+	  top |= stack[--sp];
+	  break;
+
+	case ax_op_bit_xor:
+	  top ^= stack[--sp];
+	  break;
+
+	case ax_op_bit_not:
+	  top = ~top;
+	  break;
+
+	case ax_op_equal:
+	  top = (stack[--sp] == top);
+	  break;
+
+	case ax_op_less_signed:
+	  top = (((LONGEST) stack[--sp]) < ((LONGEST) top));
+	  break;
+
+	case ax_op_less_unsigned:
+	  top = (stack[--sp] < top);
+	  break;
+
+	case ax_op_ext:
+	  arg = bytes[pc++];
+	  if (arg == 0)
+	    {
+	      result = expr_eval_malformed_expression;
+	      goto fail;
+	    }
+	  if (arg < sizeof (LONGEST) * 8)
+	    {
+	      ULONGEST mask = (ULONGEST) 1 << (arg - 1);
+
+	      top &= ((ULONGEST) 1 << arg) - 1;
+	      top = (top ^ mask) - mask;
+	    }
+	  break;
+
+	case ax_op_zero_ext:
+	  arg = bytes[pc++];
+	  if (arg < sizeof (LONGEST) * 8)
+	    top &= ((ULONGEST) 1 << arg) - 1;
+	  break;
+
+	case ax_op_ref8:
+	  top = ops->read_memory (baton, (CORE_ADDR) top, 1);
+	  break;
+
+	case ax_op_ref16:
+	  top = ops->read_memory (baton, (CORE_ADDR) top, 2);
+	  break;
+
+	case ax_op_ref32:
+	  top = ops->read_memory (baton, (CORE_ADDR) top, 4);
+	  break;
+
+	case ax_op_ref64:
+	  top = ops->read_memory (baton, (CORE_ADDR) top, 8);
+	  break;
+
+	case ax_op_if_goto:
+	  arg = ax_interp_operand (&bytes[pc], 2);
+	  if (top)
+	    {
+	      if (arg >= len)
+		{
+		  result = expr_eval_invalid_goto;
+		  goto fail;
+		}
+	      pc = arg;
+	    }
+	  else
+	    pc += 2;
+	  if (--sp >= 0)
+	    top = stack[sp];
+	  break;
+
+	case ax_op_goto:
+	  arg = ax_interp_operand (&bytes[pc], 2);
+	  if (arg >= len)
+	    {
+	      result = expr_eval_invalid_goto;
+	      goto fail;
+	    }
+	  pc = arg;
+	  break;
+
+	case ax_op_const8:
+	case ax_op_const16:
+	case ax_op_const32:
+	case ax_op_const64:
+	  /* Flush the cached stack top.  */
+	  stack[sp++] = top;
+	  top = ax_interp_operand (&bytes[pc], ax_op_sizes[op]);
+	  pc += ax_op_sizes[op];
+	  break;
+
+	case ax_op_reg:
+	  /* Flush the cached stack top.  */
+	  stack[sp++] = top;
+	  arg = ax_interp_operand (&bytes[pc], 2);
+	  pc += 2;
+	  top = ops->read_reg (baton, arg);
+	  break;
+
+	case ax_op_end:
+	  if (rslt != NULL)
+	    {
+	      if (sp <= 0)
+		{
+		  result = expr_eval_empty_stack;
+		  goto fail;
+		}
+	      *rslt = top;
+	    }
+	  return expr_eval_no_error;
+
+	case ax_op_dup:
+	  stack[sp++] = top;
+	  break;
+
+	case ax_op_pop:
+	  if (--sp >= 0)
+	    top = stack[sp];
+	  break;
+
+	case ax_op_pick:
+	  arg = bytes[pc++];
+	  if (arg >= sp)
+	    {
+	      result = expr_eval_stack_underflow;
+	      goto fail;
+	    }
+	  stack[sp] = top;
+	  top = stack[sp - arg];
+	  ++sp;
+	  break;
+
+	case ax_op_rot:
+	  {
+	    ULONGEST tem = stack[sp - 1];
+
+	    stack[sp - 1] = stack[sp - 2];
+	    stack[sp - 2] = top;
+	    top = tem;
+	  }
+	  break;
+
+	case ax_op_swap:
+	  /* Interchange top two stack elements, making sure top gets
+	     copied back onto stack.  */
+	  stack[sp] = top;
+	  top = stack[sp - 1];
+	  stack[sp - 1] = stack[sp];
+	  break;
+
+	case ax_op_getv:
+	  if (ops->get_tsv == NULL)
+	    goto unhandled;
+	  /* Flush the cached stack top.  */
+	  stack[sp++] = top;
+	  arg = ax_interp_operand (&bytes[pc], 2);
+	  pc += 2;
+	  top = ops->get_tsv (baton, arg);
+	  break;
+
+	case ax_op_setv:
+	  if (ops->set_tsv == NULL)
+	    goto unhandled;
+	  arg = ax_interp_operand (&bytes[pc], 2);
+	  pc += 2;
+	  ops->set_tsv (baton, arg, top);
+	  /* Note that we leave the value on the stack, for the
+	     benefit of later/enclosing expressions.  */
+	  break;
+
+	case ax_op_tracev:
+	  if (ops->trace_tsv == NULL)
+	    goto unhandled;
+	  arg = ax_interp_operand (&bytes[pc], 2);
+	  pc += 2;
+	  ops->trace_tsv (baton, arg);
+	  break;
+
+	case ax_op_tracenz:
+	  if (ops->trace_string == NULL)
+	    goto unhandled;
+	  ops->trace_string (baton, (CORE_ADDR) stack[--sp], top);
+	  if (--sp >= 0)
+	    top = stack[sp];
+	  break;
+
+	case ax_op_printf:
+	  {
+	    int nargs, slen, i;
+	    CORE_ADDR fn = 0, chan = 0;
+	    /* Can't have more args than the entire size of the stack.  */
+	    ULONGEST args[STACK_MAX];
+	    const char *format;
+
+	    if (ops->print == NULL)
+	      goto unhandled;
+	    if (pc + 3 > len)
+	      {
+		result = expr_eval_malformed_expression;
+		goto fail;
+	      }
+	    nargs = bytes[pc++];
+	    slen = ax_interp_operand (&bytes[pc], 2);
+	    pc += 2;
+	    format = (const char *) &bytes[pc];
+	    pc += slen;
+
+	    /* A bad format string means something is very wrong; give
+	       up immediately.  */
+	    if (slen == 0 || pc > len || format[slen - 1] != '\0')
+	      {
+		result = expr_eval_malformed_expression;
+		goto fail;
+	      }
+	    if (sp < nargs + 2)
+	      {
+		result = expr_eval_stack_underflow;
+		goto fail;
+	      }
+
+	    /* Pop function and channel.  */
+	    fn = top;
+	    if (--sp >= 0)
+	      top = stack[sp];
+	    chan = top;
+	    if (--sp >= 0)
+	      top = stack[sp];
+	    /* Pop arguments into a dedicated array.  */
+	    for (i = 0; i < nargs; ++i)
+	      {
+		args[i] = top;
+		if (--sp >= 0)
+		  top = stack[sp];
+	      }
+
+	    ops->print (baton, fn, chan, format, nargs, args);
+	  }
+	  break;
+
+	  /* GDB never (currently) generates any of these ops.  */
+	case ax_op_float:
+	case ax_op_ref_float:
+	case ax_op_ref_double:
+	case ax_op_ref_long_double:
+	case ax_op_l_to_d:
+	case ax_op_d_to_l:
+	case ax_op_trace16:
+	unhandled:
+	  /* If ever GDB generates any of these, we don't have the
+	     option of ignoring.  */
+	  result = expr_eval_unhandled_opcode;
+	  goto fail;
+
+	default:
+	  result = expr_eval_unrecognized_opcode;
+	  goto fail;
+	}
+
+      /* Check for stack badness.  */
+      if (sp >= (STACK_MAX - 1))
+	{
+	  result = expr_eval_stack_overflow;
+	  goto fail;
+	}
+
+      if (sp < 0)
+	{
+	  result = expr_eval_stack_underflow;
+	  goto fail;
+	}
+    }
+
+ fail:
+  if (error_pc != NULL)
+    *error_pc = op_pc;
+  return result;
+}
@@ -0,0 +1,89 @@
+/* Agent expression interpreter shared by GDB and GDBserver.
+
+   Copyright (C) 2009-2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef COMMON_AX_INTERP_H
+#define COMMON_AX_INTERP_H
+
+/* Enumeration of the different kinds of things that can happen during
+   agent expression evaluation.  GDBserver reports these to GDB as
+   trace stop reasons, so new values go at the end.  */
+
+enum eval_result_type
+  {
+    expr_eval_no_error,
+    expr_eval_empty_expression,
+    expr_eval_empty_stack,
+    expr_eval_stack_overflow,
+    expr_eval_stack_underflow,
+    expr_eval_unhandled_opcode,
+    expr_eval_unrecognized_opcode,
+    expr_eval_divide_by_zero,
+    expr_eval_invalid_goto,
+    expr_eval_malformed_expression
+  };
+
+/* The ways in which the interpreter reaches out of the expression.
+   READ_REG and READ_MEMORY are mandatory; the others implement the
+   tracing operations and may be NULL, in which case the operations
+   that need them are reported as expr_eval_unhandled_opcode.  BATON
+   is the pointer passed to ax_interp_eval.  */
+
+struct ax_interp_ops
+{
+  /* Return the value of register REG, numbered as in a `reg'
+     bytecode, zero-extended.  */
+  ULONGEST (*read_reg) (void *baton, int reg);
+
+  /* Return the SIZE bytes at ADDR, in the target's byte order,
+     zero-extended.  SIZE is 1, 2, 4 or 8.  */
+  ULONGEST (*read_memory) (void *baton, CORE_ADDR addr, int size);
+
+  /* Collect LEN bytes at ADDR (`trace', `trace_quick').  */
+  void (*trace_memory) (void *baton, CORE_ADDR addr, ULONGEST len);
+
+  /* Collect a NUL-terminated string of at most LEN bytes at ADDR
+     (`tracenz').  */
+  void (*trace_string) (void *baton, CORE_ADDR addr, ULONGEST len);
+
+  /* Collect trace state variable NUM (`tracev').  */
+  void (*trace_tsv) (void *baton, int num);
+
+  /* Return, or set, the value of trace state variable NUM (`getv',
+     `setv').  */
+  LONGEST (*get_tsv) (void *baton, int num);
+  void (*set_tsv) (void *baton, int num, LONGEST value);
+
+  /* Print NARGS arguments ARGS using FORMAT, through function FN and
+     channel CHAN (`printf').  FORMAT is NUL-terminated.  */
+  void (*print) (void *baton, CORE_ADDR fn, CORE_ADDR chan,
+		const char *format, int nargs, ULONGEST *args);
+};
+
+/* Evaluate the LEN bytes of agent expression BYTES, accessing the
+   target through OPS and BATON.  If RSLT is not NULL, store the value
+   left on top of the stack there.  Return expr_eval_no_error if
+   everything went OK; otherwise, if ERROR_PC is not NULL, store the
+   offset of the offending operation there.  */
+
+extern enum eval_result_type ax_interp_eval (const struct ax_interp_ops *ops,
+					     void *baton,
+					     const gdb_byte *bytes, int len,
+					     ULONGEST *rslt, int *error_pc);
+
+#endif /* COMMON_AX_INTERP_H */
@@ -0,0 +1,296 @@
+/* Remote protocol packet compression for GDB, the GNU debugger.
+
+   Copyright (C) 2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "common-defs.h"
+#include "rsp-compress.h"
+#include "rsp-low.h"
+#include "byte-vector.h"
+
+/* The shortest and longest back-references, the longest literal run
+   and the farthest distance a back-reference can reach.  See
+   rsp-compress.h for the encoding.  */
+
+#define MIN_MATCH 4
+#define MAX_MATCH (MIN_MATCH + 0x7f)
+#define MAX_LITERALS 0x80
+#define MAX_DISTANCE 0xffff
+
+/* Matches are found through a table of the last position at which
+   each hash of four bytes was seen.  */
+
+#define HASH_BITS 12
+
+/* The largest original payload a compressed packet may claim, so that
+   a corrupt header cannot make the receiver allocate without bound.  */
+
+#define MAX_PACKET_LENGTH (64 * 1024 * 1024)
+
+/* Minimum payload sizes worth compressing, by packet prefix.  The
+   first matching entry wins.  */
+
+static const struct
+{
+  const char *prefix;
+  int threshold;
+} compress_thresholds[] =
+{
+  /* qXfer and vFile transfers.  */
+  { "l", 256 },
+  { "m", 256 },
+  { "F", 256 },
+  { "vFile:pwrite:", 256 },
+  /* Memory contents.  */
+  { "b", 512 },
+  { "V", 512 },
+  { "M", 512 },
+  { "X", 512 },
+};
+
+/* The threshold for hex replies, such as those to 'm' and 'g'.  */
+
+#define HEX_THRESHOLD 512
+
+/* The threshold for everything else.  */
+
+#define DEFAULT_THRESHOLD 1024
+
+/* See rsp-compress.h.  */
+
+int
+rsp_compress_threshold (const char *buf)
+{
+  for (const auto &entry : compress_thresholds)
+    if (startswith (buf, entry.prefix))
+      return entry.threshold;
+
+  if (isxdigit (buf[0]))
+    return HEX_THRESHOLD;
+
+  return DEFAULT_THRESHOLD;
+}
+
+/* Return the hash of the four bytes at P.  */
+
+static unsigned int
+hash4 (const gdb_byte *p)
+{
+  uint32_t v = (p[0] | (p[1] << 8) | (p[2] << 16)
+		| ((uint32_t) p[3] << 24));
+
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/* Append the LEN literal bytes at SRC to DST, which holds *OUT bytes
+   and has room for DST_LEN.  Return false if they do not fit.  */
+
+static bool
+put_literals (const gdb_byte *src, int len,
+	      gdb_byte *dst, int *out, int dst_len)
+{
+  while (len > 0)
+    {
+      int n = std::min (len, MAX_LITERALS);
+
+      if (*out + 1 + n > dst_len)
+	return false;
+      dst[(*out)++] = n - 1;
+      memcpy (dst + *out, src, n);
+      *out += n;
+      src += n;
+      len -= n;
+    }
+
+  return true;
+}
+
+/* Compress the LEN bytes at SRC into DST, which has room for DST_LEN
+   bytes.  Return the compressed size, or -1 if it would not fit.  */
+
+static int
+compress_block (const gdb_byte *src, int len, gdb_byte *dst, int dst_len)
+{
+  int table[1 << HASH_BITS];
+  int pos = 0, lit_start = 0, out = 0;
+
+  for (int &slot : table)
+    slot = -1;
+
+  while (pos + MIN_MATCH <= len)
+    {
+      unsigned int h = hash4 (src + pos);
+      int cand = table[h];
+
+      table[h] = pos;
+      if (cand < 0
+	  || pos - cand > MAX_DISTANCE
+	  || memcmp (src + cand, src + pos, MIN_MATCH) != 0)
+	{
+	  pos++;
+	  continue;
+	}
+
+      int match = MIN_MATCH;
+      while (match < MAX_MATCH && pos + match < len
+	     && src[cand + match] == src[pos + match])
+	match++;
+
+      if (!put_literals (src + lit_start, pos - lit_start, dst, &out, dst_len)
+	  || out + 3 > dst_len)
+	return -1;
+      dst[out++] = 0x80 | (match - MIN_MATCH);
+      dst[out++] = (pos - cand) & 0xff;
+      dst[out++] = (pos - cand) >> 8;
+
+      /* Remember the positions inside the match too, so that later
+	 repetitions of them are found.  */
+      for (int i = 1; i < match && pos + i + MIN_MATCH <= len; i++)
+	table[hash4 (src + pos + i)] = pos + i;
+
+      pos += match;
+      lit_start = pos;
+    }
+
+  if (!put_literals (src + lit_start, len - lit_start, dst, &out, dst_len))
+    return -1;
+
+  return out;
+}
+
+/* Expand the LEN compressed bytes at SRC into DST, which has room for
+   DST_LEN bytes.  Return the expanded size, or -1 if SRC is corrupt
+   or does not fit.  */
+
+static int
+decompress_block (const gdb_byte *src, int len, gdb_byte *dst, int dst_len)
+{
+  int in = 0, out = 0;
+
+  while (in < len)
+    {
+      gdb_byte ctrl = src[in++];
+
+      if (ctrl < 0x80)
+	{
+	  int n = ctrl + 1;
+
+	  if (in + n > len || out + n > dst_len)
+	    return -1;
+	  memcpy (dst + out, src + in, n);
+	  in += n;
+	  out += n;
+	}
+      else
+	{
+	  int n = (ctrl & 0x7f) + MIN_MATCH;
+
+	  if (in + 2 > len)
+	    return -1;
+
+	  int distance = src[in] | (src[in + 1] << 8);
+	  in += 2;
+	  if (distance == 0 || distance > out || out + n > dst_len)
+	    return -1;
+
+	  /* The source and destination may overlap; copy forward one
+	     byte at a time so that runs are reproduced.  */
+	  for (int i = 0; i < n; i++, out++)
+	    dst[out] = dst[out - distance];
+	}
+    }
+
+  return out;
+}
+
+/* See rsp-compress.h.  */
+
+int
+rsp_compress_packet (const char *buf, int cnt, char *out)
+{
+  if (cnt < rsp_compress_threshold (buf))
+    return -1;
+
+  gdb::byte_vector data (cnt);
+  int data_len = compress_block ((const gdb_byte *) buf, cnt,
+				 data.data (), cnt);
+  if (data_len < 0)
+    return -1;
+
+  char header[16];
+  int header_len = xsnprintf (header, sizeof (header), "%c%x:",
+			      RSP_COMPRESSED_PREFIX, cnt);
+  if (header_len >= cnt)
+    return -1;
+
+  int encoded, out_len;
+  memcpy (out, header, header_len);
+  out_len = remote_escape_output (data.data (), data_len, 1,
+				  (gdb_byte *) out + header_len, &encoded,
+				  cnt - header_len - 1);
+  if (encoded != data_len)
+    return -1;
+
+  return header_len + out_len;
+}
+
+/* See rsp-compress.h.  */
+
+int
+rsp_compressed_packet_length (const char *buf, int cnt)
+{
+  const char *end = buf + cnt;
+  const char *p = buf;
+  int len = 0;
+
+  if (p == end || *p++ != RSP_COMPRESSED_PREFIX)
+    return -1;
+
+  for (; p < end && isxdigit (*p); p++)
+    {
+      len = (len << 4) | fromhex (*p);
+      if (len > MAX_PACKET_LENGTH)
+	return -1;
+    }
+  if (p == end || *p != ':')
+    return -1;
+
+  return len;
+}
+
+/* See rsp-compress.h.  */
+
+int
+rsp_decompress_packet (const char *buf, int cnt, char *out, int out_size)
+{
+  int len = rsp_compressed_packet_length (buf, cnt);
+
+  if (len < 0 || len > out_size)
+    return -1;
+
+  const char *p = (const char *) memchr (buf, ':', cnt) + 1;
+  const char *end = buf + cnt;
+  gdb::byte_vector data (end - p);
+  int data_len = remote_unescape_input ((const gdb_byte *) p, end - p,
+					data.data (), data.size ());
+
+  if (decompress_block (data.data (), data_len,
+			(gdb_byte *) out, len) != len)
+    return -1;
+
+  return len;
+}
@@ -0,0 +1,68 @@
+/* Remote protocol packet compression for GDB, the GNU debugger.
+
+   Copyright (C) 2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef COMMON_RSP_COMPRESS_H
+#define COMMON_RSP_COMPRESS_H
+
+/* Once both sides have agreed on the "compression" qSupported
+   feature, a packet payload may be replaced by
+
+     @LENGTH:DATA
+
+   where LENGTH is the size of the original payload in hex and DATA is
+   the compressed payload, escaped like other binary data.  No packet
+   or reply otherwise starts with '@'.
+
+   The compressed stream is a sequence of tokens.  A control byte C
+   below 0x80 is followed by C + 1 literal bytes.  A control byte C of
+   0x80 or above is followed by a two-byte little-endian distance D,
+   and stands for (C & 0x7f) + 4 bytes copied from D bytes back in the
+   output.  The "Compressed packets" node of the manual is the full
+   specification.  */
+
+/* The character that starts a compressed packet payload.  */
+
+#define RSP_COMPRESSED_PREFIX '@'
+
+/* Return the smallest payload size worth compressing for the packet
+   whose payload is BUF.  Bulk data replies are compressed sooner than
+   other packets.  */
+
+extern int rsp_compress_threshold (const char *buf);
+
+/* Compress the CNT byte packet payload BUF into OUT, which must have
+   room for at least CNT bytes.  Return the length of the compressed
+   payload, or -1 if BUF is too small to be worth compressing or does
+   not get any smaller.  */
+
+extern int rsp_compress_packet (const char *buf, int cnt, char *out);
+
+/* Return the length of the original payload of the CNT byte
+   compressed packet payload BUF, or -1 if its header is malformed.  */
+
+extern int rsp_compressed_packet_length (const char *buf, int cnt);
+
+/* Expand the CNT byte compressed packet payload BUF into OUT, which
+   has room for OUT_SIZE bytes.  Return the length of the original
+   payload, or -1 if BUF is corrupt or does not fit.  */
+
+extern int rsp_decompress_packet (const char *buf, int cnt,
+				  char *out, int out_size);
+
+#endif /* COMMON_RSP_COMPRESS_H */
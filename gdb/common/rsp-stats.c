@@ -0,0 +1,168 @@
+/* Remote protocol packet statistics for GDB, the GNU debugger.
+
+   Copyright (C) 2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "common-defs.h"
+#include "rsp-stats.h"
+
+/* See rsp-stats.h.  */
+
+const char *const rsp_latency_bucket_names[RSP_LATENCY_BUCKETS] =
+{
+  "<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s"
+};
+
+/* See rsp-stats.h.  */
+
+void
+rsp_packet_stats::add_latency (rsp_clock::duration latency,
+			       rsp_clock::duration wait)
+{
+  auto us = std::chrono::duration_cast<std::chrono::microseconds> (latency);
+  long long limit = 10;
+  int bucket;
+
+  for (bucket = 0; bucket < RSP_LATENCY_BUCKETS - 1; bucket++, limit *= 10)
+    if (us.count () < limit)
+      break;
+
+  latency_histogram[bucket]++;
+  total_latency += latency;
+  max_latency = std::max (max_latency, latency);
+  wait_time += wait;
+}
+
+/* The longest packet type name kept, so that a stub sending garbage
+   cannot create arbitrarily long ones.  */
+
+#define MAX_TYPE_LENGTH 40
+
+/* See rsp-stats.h.  */
+
+std::string
+rsp_packet_type (const char *buf, int len)
+{
+  if (len == 0)
+    return "(empty)";
+
+  switch (buf[0])
+    {
+    case 'q':
+    case 'Q':
+    case 'v':
+      {
+	/* qXfer:OBJECT:read and vFile:OPERATION.  */
+	int fields = (startswith (buf, "qXfer:")
+		      || startswith (buf, "vFile:")) ? 2 : 1;
+	int i;
+
+	for (i = 0; i < len && i < MAX_TYPE_LENGTH; i++)
+	  if ((buf[i] == ':' && --fields == 0)
+	      || buf[i] == ',' || buf[i] == ';' || buf[i] == '?')
+	    break;
+	return std::string (buf, i);
+      }
+
+    case 'H':
+    case 'Z':
+    case 'z':
+      return std::string (buf, std::min (len, 2));
+
+    default:
+      return std::string (buf, 1);
+    }
+}
+
+/* Append S to JSON as a JSON string.  */
+
+static void
+json_append_string (std::string &json, const std::string &s)
+{
+  json += '"';
+  for (char c : s)
+    {
+      if (c == '"' || c == '\\')
+	{
+	  json += '\\';
+	  json += c;
+	}
+      else if ((unsigned char) c < 0x20 || (unsigned char) c >= 0x7f)
+	json += string_printf ("\\u%04x", (unsigned char) c);
+      else
+	json += c;
+    }
+  json += '"';
+}
+
+/* See rsp-stats.h.  */
+
+LONGEST
+rsp_duration_us (rsp_clock::duration d)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds> (d).count ();
+}
+
+/* See rsp-stats.h.  */
+
+std::string
+rsp_stats_to_json (const rsp_stats &stats)
+{
+  std::string json = "{\"latency_buckets\": [";
+
+  for (int i = 0; i < RSP_LATENCY_BUCKETS; i++)
+    {
+      if (i > 0)
+	json += ", ";
+      json_append_string (json, rsp_latency_bucket_names[i]);
+    }
+  json += "],\n \"packets\": [";
+
+  bool first = true;
+  for (const auto &entry : stats)
+    {
+      const rsp_packet_stats &ps = entry.second;
+
+      json += first ? "\n  {" : ",\n  {";
+      first = false;
+
+      json += "\"type\": ";
+      json_append_string (json, entry.first);
+      json += string_printf (", \"count\": %s, \"replies\": %s",
+			     pulongest (ps.count), pulongest (ps.replies));
+      json += string_printf (", \"bytes_out\": %s, \"bytes_in\": %s",
+			     pulongest (ps.bytes_out),
+			     pulongest (ps.bytes_in));
+      json += string_printf (", \"total_latency_us\": %s",
+			     plongest (rsp_duration_us (ps.total_latency)));
+      json += string_printf (", \"max_latency_us\": %s",
+			     plongest (rsp_duration_us (ps.max_latency)));
+      json += string_printf (", \"wait_us\": %s",
+			     plongest (rsp_duration_us (ps.wait_time)));
+      json += ", \"latency_histogram\": [";
+      for (int i = 0; i < RSP_LATENCY_BUCKETS; i++)
+	{
+	  if (i > 0)
+	    json += ", ";
+	  json += pulongest (ps.latency_histogram[i]);
+	}
+      json += "]}";
+    }
+  json += "]}\n";
+
+  return json;
+}
@@ -0,0 +1,90 @@
+/* Remote protocol packet statistics for GDB, the GNU debugger.
+
+   Copyright (C) 2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef COMMON_RSP_STATS_H
+#define COMMON_RSP_STATS_H
+
+#include <chrono>
+#include <map>
+
+/* The number of buckets in a latency histogram.  Bucket I counts the
+   latencies below 10^(I+1) microseconds; the last one counts all the
+   others.  */
+
+#define RSP_LATENCY_BUCKETS 7
+
+/* The names of the latency histogram buckets.  */
+
+extern const char *const rsp_latency_bucket_names[RSP_LATENCY_BUCKETS];
+
+/* The clock used to time packets.  */
+
+typedef std::chrono::steady_clock rsp_clock;
+
+/* Return D in microseconds.  */
+
+extern LONGEST rsp_duration_us (rsp_clock::duration d);
+
+/* Counters for one type of packet.  */
+
+struct rsp_packet_stats
+{
+  /* Record a round trip (or, in the stub, the handling of a request)
+     that took LATENCY, of which WAIT was spent waiting for the other
+     side.  */
+  void add_latency (rsp_clock::duration latency, rsp_clock::duration wait);
+
+  /* The number of packets of this type sent, and the number of
+     replies to them that arrived.  */
+  ULONGEST count = 0;
+  ULONGEST replies = 0;
+
+  /* The number of bytes sent and received on the wire for this type
+     of packet, including the framing.  */
+  ULONGEST bytes_out = 0;
+  ULONGEST bytes_in = 0;
+
+  /* The total and longest latencies.  */
+  rsp_clock::duration total_latency {};
+  rsp_clock::duration max_latency {};
+
+  /* The total time spent blocked waiting for input.  */
+  rsp_clock::duration wait_time {};
+
+  /* The latency histogram.  */
+  ULONGEST latency_histogram[RSP_LATENCY_BUCKETS] {};
+};
+
+/* Return the name under which statistics for the LEN byte packet BUF
+   are kept.  That is the packet's name for 'q', 'Q' and 'v' packets,
+   with the object of qXfer and the operation of vFile packets, the
+   first two characters of 'H', 'Z' and 'z' packets, and the first
+   character of the others.  */
+
+extern std::string rsp_packet_type (const char *buf, int len);
+
+/* The statistics of a remote protocol connection, by packet type.  */
+
+typedef std::map<std::string, rsp_packet_stats> rsp_stats;
+
+/* Return STATS in JSON form.  */
+
+extern std::string rsp_stats_to_json (const rsp_stats &stats);
+
+#endif /* COMMON_RSP_STATS_H */
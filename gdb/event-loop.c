@@ -31,6 +31,25 @@
 #endif
 #endif
 
+/* On hosts that have it, prefer epoll to poll: the set of watched
+   descriptors lives in the kernel, instead of being passed in and
+   scanned on every wait.  We fall back to poll if epoll can't watch
+   some descriptor, so HAVE_POLL is required too.  */
+#if defined (HAVE_POLL) && defined (HAVE_EPOLL_CREATE1) \
+  && defined (HAVE_SYS_EPOLL_H)
+#define USE_EPOLL 1
+#include <sys/epoll.h>
+
+/* Maximum number of events collected by a single epoll_wait call.  */
+#define EPOLL_MAX_EVENTS 16
+#else
+#define USE_EPOLL 0
+#endif
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
 #include <sys/types.h>
 #include "gdb_sys_time.h"
 #include "gdb_select.h"
@@ -157,6 +176,11 @@ async_event_handler;
 
 static unsigned char use_poll = USE_POLL;
 
+/* Do we use epoll?  When set, USE_POLL is set too, and file handlers
+   carry poll-style masks, which are converted for epoll_ctl.  Cleared
+   (in favor of plain poll) if epoll turns out not to be usable.  */
+static unsigned char use_epoll = USE_EPOLL;
+
 #ifdef USE_WIN32API
 #include <windows.h>
 #include <io.h>
@@ -185,10 +209,25 @@ static struct
        this is good enough.  */
     int next_poll_fds_index;
 
-    /* Timeout in milliseconds for calls to poll().  */
+    /* Timeout in milliseconds for calls to poll() and
+       epoll_wait().  */
     int poll_timeout;
 #endif
 
+#if USE_EPOLL
+    /* The epoll instance all file handlers are registered with, or 0
+       if it hasn't been created yet.  */
+    int epoll_fd;
+
+    /* Events returned by the last call to epoll_wait.  */
+    struct epoll_event epoll_events[EPOLL_MAX_EVENTS];
+
+    /* The file handlers registered with the epoll instance, indexed
+       by file descriptor, so that ready descriptors map to their
+       handler without walking the list.  */
+    std::vector<file_handler *> epoll_handlers;
+#endif
+
     /* Masks to be used in the next call to select.
        Bits are set in response to calls to create_file_handler.  */
     fd_set check_masks[3];
@@ -196,7 +235,7 @@ static struct
     /* What file descriptors were found ready by select.  */
     fd_set ready_masks[3];
 
-    /* Number of file descriptors to monitor (for poll).  */
+    /* Number of file descriptors to monitor (for poll and epoll).  */
     /* Number of valid bits (highest fd value + 1) (for select).  */
     int num_fds;
 
@@ -214,17 +253,32 @@ struct gdb_timer
   {
     std::chrono::steady_clock::time_point when;
     int timer_id;
-    struct gdb_timer *next;
     timer_handler_func *proc;	    /* Function to call to do the work.  */
     gdb_client_data client_data;    /* Argument to async_handler_func.  */
   };
 
-/* List of currently active timers.  It is sorted in order of
-   increasing timers.  */
+/* Ordering of the timer heap.  The heap functions put the greatest
+   element first, so this says A is "less" than B if it expires
+   later.  Timers with the same expiration time run in creation
+   order.  */
+
+static bool
+timer_expires_later (const gdb_timer *a, const gdb_timer *b)
+{
+  if (a->when != b->when)
+    return a->when > b->when;
+  return a->timer_id > b->timer_id;
+}
+
+/* The currently active timers.  */
 static struct
   {
-    /* Pointer to first in timer list.  */
-    struct gdb_timer *first_timer;
+    /* Binary heap of timers, ordered by timer_expires_later, so that
+       the timer that expires first is at the front.  */
+    std::vector<gdb_timer *> heap;
+
+    /* Map from timer id to timer, for delete_timer.  */
+    std::unordered_map<int, gdb_timer *> by_id;
 
     /* Id of the last timer created.  */
     int num_timers;
@@ -416,7 +470,7 @@ add_file_handler (int fd, handler_func * proc, gdb_client_data client_data)
   struct pollfd fds;
 #endif
 
-  if (use_poll)
+  if (use_poll && !use_epoll)
     {
 #ifdef HAVE_POLL
       /* Check to see if poll () is usable.  If not, we'll switch to
@@ -447,6 +501,169 @@ add_file_handler (int fd, handler_func * proc, gdb_client_data client_data)
 			 proc, client_data);
 }
 
+/* Add FILE_PTR's descriptor, with its event mask, to the array of
+   pollfd structures, or to the select masks.  */
+
+static void
+notifier_add_file (file_handler *file_ptr)
+{
+  int fd = file_ptr->fd;
+  int mask = file_ptr->mask;
+
+  if (use_poll)
+    {
+#ifdef HAVE_POLL
+      gdb_notifier.num_fds++;
+      if (gdb_notifier.poll_fds)
+	gdb_notifier.poll_fds =
+	  (struct pollfd *) xrealloc (gdb_notifier.poll_fds,
+				      (gdb_notifier.num_fds
+				       * sizeof (struct pollfd)));
+      else
+	gdb_notifier.poll_fds =
+	  XNEW (struct pollfd);
+      (gdb_notifier.poll_fds + gdb_notifier.num_fds - 1)->fd = fd;
+      (gdb_notifier.poll_fds + gdb_notifier.num_fds - 1)->events = mask;
+      (gdb_notifier.poll_fds + gdb_notifier.num_fds - 1)->revents = 0;
+#else
+      internal_error (__FILE__, __LINE__,
+		      _("use_poll without HAVE_POLL"));
+#endif /* HAVE_POLL */
+    }
+  else
+    {
+      if (mask & GDB_READABLE)
+	FD_SET (fd, &gdb_notifier.check_masks[0]);
+      else
+	FD_CLR (fd, &gdb_notifier.check_masks[0]);
+
+      if (mask & GDB_WRITABLE)
+	FD_SET (fd, &gdb_notifier.check_masks[1]);
+      else
+	FD_CLR (fd, &gdb_notifier.check_masks[1]);
+
+      if (mask & GDB_EXCEPTION)
+	FD_SET (fd, &gdb_notifier.check_masks[2]);
+      else
+	FD_CLR (fd, &gdb_notifier.check_masks[2]);
+
+      if (gdb_notifier.num_fds <= fd)
+	gdb_notifier.num_fds = fd + 1;
+    }
+}
+
+#if USE_EPOLL
+
+/* Convert the poll-style event mask MASK to epoll events.  */
+
+static uint32_t
+epoll_events_from_poll (int mask)
+{
+  uint32_t events = 0;
+
+  if (mask & POLLIN)
+    events |= EPOLLIN;
+  if (mask & POLLPRI)
+    events |= EPOLLPRI;
+  if (mask & POLLOUT)
+    events |= EPOLLOUT;
+  return events;
+}
+
+/* Convert the epoll events EVENTS to a poll-style mask, as expected
+   by handle_file_event.  */
+
+static int
+poll_mask_from_epoll (uint32_t events)
+{
+  int mask = 0;
+
+  if (events & EPOLLIN)
+    mask |= POLLIN;
+  if (events & EPOLLPRI)
+    mask |= POLLPRI;
+  if (events & EPOLLOUT)
+    mask |= POLLOUT;
+  if (events & EPOLLERR)
+    mask |= POLLERR;
+  if (events & EPOLLHUP)
+    mask |= POLLHUP;
+  return mask;
+}
+
+/* Tell the epoll instance to watch FILE_PTR's descriptor, creating
+   the instance on first use.  Return false if epoll can't be used
+   for it; e.g., epoll refuses regular files, which stdin may well
+   be.  */
+
+static bool
+epoll_add_file (file_handler *file_ptr)
+{
+  struct epoll_event ev;
+
+  if (gdb_notifier.epoll_fd == 0)
+    {
+      gdb_notifier.epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+      if (gdb_notifier.epoll_fd < 0)
+	{
+	  gdb_notifier.epoll_fd = 0;
+	  return false;
+	}
+    }
+
+  memset (&ev, 0, sizeof (ev));
+  ev.events = epoll_events_from_poll (file_ptr->mask);
+  ev.data.fd = file_ptr->fd;
+
+  if (epoll_ctl (gdb_notifier.epoll_fd, EPOLL_CTL_ADD,
+		 file_ptr->fd, &ev) != 0
+      /* The descriptor is already in the set when an existing file
+	 handler is being updated.  */
+      && (errno != EEXIST
+	  || epoll_ctl (gdb_notifier.epoll_fd, EPOLL_CTL_MOD,
+			file_ptr->fd, &ev) != 0))
+    return false;
+
+  if (gdb_notifier.epoll_handlers.size () <= file_ptr->fd)
+    gdb_notifier.epoll_handlers.resize (file_ptr->fd + 1);
+  gdb_notifier.epoll_handlers[file_ptr->fd] = file_ptr;
+  return true;
+}
+
+/* Return the file handler registered with the epoll instance for FD,
+   or NULL if there is none.  */
+
+static file_handler *
+epoll_file_handler (int fd)
+{
+  if (fd < 0 || fd >= gdb_notifier.epoll_handlers.size ())
+    return NULL;
+  return gdb_notifier.epoll_handlers[fd];
+}
+
+/* Stop using epoll, and move all the registered file handlers over
+   to poll.  */
+
+static void
+epoll_fall_back_to_poll (void)
+{
+  file_handler *file_ptr;
+
+  if (gdb_notifier.epoll_fd > 0)
+    close (gdb_notifier.epoll_fd);
+  gdb_notifier.epoll_fd = 0;
+  gdb_notifier.epoll_handlers.clear ();
+  use_epoll = 0;
+
+  gdb_notifier.num_fds = 0;
+  for (file_ptr = gdb_notifier.first_file_handler;
+       file_ptr != NULL;
+       file_ptr = file_ptr->next_file)
+    notifier_add_file (file_ptr);
+}
+
+#endif /* USE_EPOLL */
+
 /* Add a file handler/descriptor to the list of descriptors we are
    interested in.
 
@@ -482,51 +699,33 @@ create_file_handler (int fd, int mask, handler_func * proc,
     {
       file_ptr = XNEW (file_handler);
       file_ptr->fd = fd;
+      file_ptr->mask = mask;
       file_ptr->ready_mask = 0;
       file_ptr->next_file = gdb_notifier.first_file_handler;
       gdb_notifier.first_file_handler = file_ptr;
 
-      if (use_poll)
+#if USE_EPOLL
+      if (use_epoll)
 	{
-#ifdef HAVE_POLL
-	  gdb_notifier.num_fds++;
-	  if (gdb_notifier.poll_fds)
-	    gdb_notifier.poll_fds =
-	      (struct pollfd *) xrealloc (gdb_notifier.poll_fds,
-					  (gdb_notifier.num_fds
-					   * sizeof (struct pollfd)));
+	  if (epoll_add_file (file_ptr))
+	    gdb_notifier.num_fds++;
 	  else
-	    gdb_notifier.poll_fds =
-	      XNEW (struct pollfd);
-	  (gdb_notifier.poll_fds + gdb_notifier.num_fds - 1)->fd = fd;
-	  (gdb_notifier.poll_fds + gdb_notifier.num_fds - 1)->events = mask;
-	  (gdb_notifier.poll_fds + gdb_notifier.num_fds - 1)->revents = 0;
-#else
-	  internal_error (__FILE__, __LINE__,
-			  _("use_poll without HAVE_POLL"));
-#endif /* HAVE_POLL */
+	    epoll_fall_back_to_poll ();
 	}
       else
-	{
-	  if (mask & GDB_READABLE)
-	    FD_SET (fd, &gdb_notifier.check_masks[0]);
-	  else
-	    FD_CLR (fd, &gdb_notifier.check_masks[0]);
-
-	  if (mask & GDB_WRITABLE)
-	    FD_SET (fd, &gdb_notifier.check_masks[1]);
-	  else
-	    FD_CLR (fd, &gdb_notifier.check_masks[1]);
-
-	  if (mask & GDB_EXCEPTION)
-	    FD_SET (fd, &gdb_notifier.check_masks[2]);
-	  else
-	    FD_CLR (fd, &gdb_notifier.check_masks[2]);
-
-	  if (gdb_notifier.num_fds <= fd)
-	    gdb_notifier.num_fds = fd + 1;
-	}
+#endif
+	notifier_add_file (file_ptr);
     }
+#if USE_EPOLL
+  else if (use_epoll)
+    {
+      /* Re-register, in case the mask changed, or FD was closed and
+	 reused (closing it removed it from the epoll set).  */
+      file_ptr->mask = mask;
+      if (!epoll_add_file (file_ptr))
+	epoll_fall_back_to_poll ();
+    }
+#endif
 
   file_ptr->proc = proc;
   file_ptr->client_data = client_data;
@@ -582,6 +781,17 @@ delete_file_handler (int fd)
   if (file_ptr == NULL)
     return;
 
+#if USE_EPOLL
+  if (use_epoll)
+    {
+      /* This fails harmlessly if FD was already closed; closing it
+	 removed it from the epoll set.  */
+      epoll_ctl (gdb_notifier.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+      gdb_notifier.epoll_handlers[fd] = NULL;
+      gdb_notifier.num_fds--;
+    }
+  else
+#endif
   if (use_poll)
     {
 #ifdef HAVE_POLL
@@ -758,6 +968,27 @@ gdb_wait_for_event (int block)
   if (block)
     update_wait_timeout ();
 
+#if USE_EPOLL
+  if (use_epoll)
+    {
+      int timeout;
+
+      if (block)
+	timeout = gdb_notifier.timeout_valid ? gdb_notifier.poll_timeout : -1;
+      else
+	timeout = 0;
+
+      num_found = epoll_wait (gdb_notifier.epoll_fd,
+			      gdb_notifier.epoll_events,
+			      EPOLL_MAX_EVENTS, timeout);
+
+      /* Don't print anything if we get out of epoll_wait because of
+	 a signal.  */
+      if (num_found == -1 && errno != EINTR)
+	perror_with_name (("epoll_wait"));
+    }
+  else
+#endif
   if (use_poll)
     {
 #ifdef HAVE_POLL
@@ -829,6 +1060,30 @@ gdb_wait_for_event (int block)
   /* To level the fairness across event descriptors, we handle them in
      a round-robin-like fashion.  The number and order of descriptors
      may change between invocations, but this is good enough.  */
+#if USE_EPOLL
+  if (use_epoll)
+    {
+      /* epoll already serves ready descriptors round-robin: a
+	 level-triggered descriptor that is still ready goes to the
+	 back of the kernel's ready list once reported.  So just take
+	 the first one that still has a handler.  */
+      int i;
+
+      for (i = 0; i < num_found; i++)
+	{
+	  struct epoll_event *ev = &gdb_notifier.epoll_events[i];
+
+	  file_ptr = epoll_file_handler (ev->data.fd);
+	  if (file_ptr != NULL)
+	    {
+	      handle_file_event (file_ptr, poll_mask_from_epoll (ev->events));
+	      return 1;
+	    }
+	}
+      return 0;
+    }
+  else
+#endif
   if (use_poll)
     {
 #ifdef HAVE_POLL
@@ -1107,7 +1362,7 @@ create_timer (int ms, timer_handler_func *proc,
 	      gdb_client_data client_data)
 {
   using namespace std::chrono;
-  struct gdb_timer *timer_ptr, *timer_index, *prev_timer;
+  struct gdb_timer *timer_ptr;
 
   steady_clock::time_point time_now = steady_clock::now ();
 
@@ -1118,36 +1373,28 @@ create_timer (int ms, timer_handler_func *proc,
   timer_list.num_timers++;
   timer_ptr->timer_id = timer_list.num_timers;
 
-  /* Now add the timer to the timer queue, making sure it is sorted in
-     increasing order of expiration.  */
-
-  for (timer_index = timer_list.first_timer;
-       timer_index != NULL;
-       timer_index = timer_index->next)
-    {
-      if (timer_index->when > timer_ptr->when)
-	break;
-    }
+  /* Now add the timer to the timer heap.  */
+  timer_list.heap.push_back (timer_ptr);
+  std::push_heap (timer_list.heap.begin (), timer_list.heap.end (),
+		  timer_expires_later);
+  timer_list.by_id[timer_ptr->timer_id] = timer_ptr;
 
-  if (timer_index == timer_list.first_timer)
-    {
-      timer_ptr->next = timer_list.first_timer;
-      timer_list.first_timer = timer_ptr;
+  gdb_notifier.timeout_valid = 0;
+  return timer_ptr->timer_id;
+}
 
-    }
-  else
-    {
-      for (prev_timer = timer_list.first_timer;
-	   prev_timer->next != timer_index;
-	   prev_timer = prev_timer->next)
-	;
+/* Remove the timer that expires first from the timer heap, and
+   return it.  */
 
-      prev_timer->next = timer_ptr;
-      timer_ptr->next = timer_index;
-    }
+static struct gdb_timer *
+pop_first_timer (void)
+{
+  struct gdb_timer *timer_ptr = timer_list.heap.front ();
 
-  gdb_notifier.timeout_valid = 0;
-  return timer_ptr->timer_id;
+  std::pop_heap (timer_list.heap.begin (), timer_list.heap.end (),
+		 timer_expires_later);
+  timer_list.heap.pop_back ();
+  return timer_ptr;
 }
 
 /* There is a chance that the creator of the timer wants to get rid of
@@ -1155,33 +1402,47 @@ create_timer (int ms, timer_handler_func *proc,
 void
 delete_timer (int id)
 {
-  struct gdb_timer *timer_ptr, *prev_timer = NULL;
-
   /* Find the entry for the given timer.  */
+  auto it = timer_list.by_id.find (id);
+
+  if (it == timer_list.by_id.end ())
+    return;
 
-  for (timer_ptr = timer_list.first_timer; timer_ptr != NULL;
-       timer_ptr = timer_ptr->next)
+  /* Get rid of the timer in the timer heap.  The first timer is
+     cheap to remove; others are only marked dead, by clearing their
+     PROC, and are disposed of once they reach the front.  */
+  struct gdb_timer *timer_ptr = it->second;
+  timer_list.by_id.erase (it);
+
+  if (timer_ptr == timer_list.heap.front ())
     {
-      if (timer_ptr->timer_id == id)
-	break;
+      pop_first_timer ();
+      delete timer_ptr;
     }
-
-  if (timer_ptr == NULL)
-    return;
-  /* Get rid of the timer in the timer list.  */
-  if (timer_ptr == timer_list.first_timer)
-    timer_list.first_timer = timer_ptr->next;
   else
+    timer_ptr->proc = NULL;
+
+  gdb_notifier.timeout_valid = 0;
+}
+
+/* Dispose of the deleted timers at the front of the timer heap, and
+   return the first live timer, or NULL if there's none.  */
+
+static struct gdb_timer *
+first_live_timer (void)
+{
+  while (!timer_list.heap.empty ())
     {
-      for (prev_timer = timer_list.first_timer;
-	   prev_timer->next != timer_ptr;
-	   prev_timer = prev_timer->next)
-	;
-      prev_timer->next = timer_ptr->next;
+      struct gdb_timer *timer_ptr = timer_list.heap.front ();
+
+      if (timer_ptr->proc != NULL)
+	return timer_ptr;
+
+      pop_first_timer ();
+      delete timer_ptr;
     }
-  delete timer_ptr;
 
-  gdb_notifier.timeout_valid = 0;
+  return NULL;
 }
 
 /* Convert a std::chrono duration to a struct timeval.  */
@@ -1206,13 +1467,15 @@ duration_cast_timeval (const Duration &d)
 static int
 update_wait_timeout (void)
 {
-  if (timer_list.first_timer != NULL)
+  struct gdb_timer *first_timer = first_live_timer ();
+
+  if (first_timer != NULL)
     {
       using namespace std::chrono;
       steady_clock::time_point time_now = steady_clock::now ();
       struct timeval timeout;
 
-      if (timer_list.first_timer->when < time_now)
+      if (first_timer->when < time_now)
 	{
 	  /* It expired already.  */
 	  timeout.tv_sec = 0;
@@ -1220,7 +1483,7 @@ update_wait_timeout (void)
 	}
       else
 	{
-	  steady_clock::duration d = timer_list.first_timer->when - time_now;
+	  steady_clock::duration d = first_timer->when - time_now;
 	  timeout = duration_cast_timeval (d);
 	}
 
@@ -1228,7 +1491,10 @@ update_wait_timeout (void)
       if (use_poll)
 	{
 #ifdef HAVE_POLL
-	  gdb_notifier.poll_timeout = timeout.tv_sec * 1000;
+	  /* Round up, so that we don't wake up just before the timer
+	     expires, and then spin with a zero timeout.  */
+	  gdb_notifier.poll_timeout = (timeout.tv_sec * 1000
+				       + (timeout.tv_usec + 999) / 1000);
 #else
 	  internal_error (__FILE__, __LINE__,
 			  _("use_poll without HAVE_POLL"));
@@ -1241,7 +1507,7 @@ update_wait_timeout (void)
 	}
       gdb_notifier.timeout_valid = 1;
 
-      if (timer_list.first_timer->when < time_now)
+      if (first_timer->when < time_now)
 	return 1;
     }
   else
@@ -1260,12 +1526,13 @@ poll_timers (void)
 {
   if (update_wait_timeout ())
     {
-      struct gdb_timer *timer_ptr = timer_list.first_timer;
+      struct gdb_timer *timer_ptr = pop_first_timer ();
       timer_handler_func *proc = timer_ptr->proc;
       gdb_client_data client_data = timer_ptr->client_data;
 
-      /* Get rid of the timer from the beginning of the list.  */
-      timer_list.first_timer = timer_ptr->next;
+      /* update_wait_timeout made sure the first timer is live.  */
+      gdb_assert (proc != NULL);
+      timer_list.by_id.erase (timer_ptr->timer_id);
 
       /* Delete the timer before calling the callback, not after, in
 	 case the callback itself decides to try deleting the timer
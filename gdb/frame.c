@@ -329,6 +329,20 @@ show_backtrace_limit (struct ui_file *file, int from_tty,
 		    value);
 }
 
+/* See frame.h.  */
+
+unsigned int backtrace_unique_prefix = 8;
+
+static void
+show_backtrace_unique_prefix (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file,
+		    _("The number of innermost frames that identify "
+		      "a stack in \"backtrace unique\" is %s.\n"),
+		    value);
+}
+
 
 static void
 fprint_field (struct ui_file *file, const char *name, int p, CORE_ADDR addr)
@@ -2971,6 +2985,19 @@ Literal \"unlimited\" or zero means no limit."),
 			    &set_backtrace_cmdlist,
 			    &show_backtrace_cmdlist);
 
+  add_setshow_uinteger_cmd ("unique-prefix", class_stack,
+			    &backtrace_unique_prefix, _("\
+Set the number of innermost frames that identify a stack in \"backtrace unique\"."), _("\
+Show the number of innermost frames that identify a stack in \"backtrace unique\"."), _("\
+Once this many innermost frames of a thread match those of exactly one\n\
+stack already seen, \"backtrace unique\" assumes the thread has that stack\n\
+and stops unwinding it.  Literal \"unlimited\" or zero means always unwind\n\
+whole stacks and compare them."),
+			    NULL,
+			    show_backtrace_unique_prefix,
+			    &set_backtrace_cmdlist,
+			    &show_backtrace_cmdlist);
+
   /* Debug this files internals.  */
   add_setshow_zuinteger_cmd ("frame", class_maintenance, &frame_debug,  _("\
 Set frame debugging."), _("\
@@ -200,6 +200,13 @@ extern const struct frame_id outer_frame_id;
 
 extern unsigned int frame_debug;
 
+/* The number of innermost frames that must match those of a stack
+   already seen for "backtrace unique" to assume that the rest of the
+   stack matches too, and to stop unwinding.  UINT_MAX means always
+   unwind and compare whole stacks.  */
+
+extern unsigned int backtrace_unique_prefix;
+
 /* Construct a frame ID.  The first parameter is the frame's constant
    stack address (typically the outer-bound), and the second the
    frame's constant code address (typically the entry point).
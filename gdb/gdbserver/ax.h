@@ -20,6 +20,7 @@
 #define AX_H 1
 
 #include "regcache.h"
+#include "common/ax-interp.h"
 
 #ifdef IN_PROCESS_AGENT
 extern int debug_agent;
@@ -28,22 +29,6 @@ extern int debug_agent;
 
 struct traceframe;
 
-/* Enumeration of the different kinds of things that can happen during
-   agent expression evaluation.  */
-
-enum eval_result_type
-  {
-    expr_eval_no_error,
-    expr_eval_empty_expression,
-    expr_eval_empty_stack,
-    expr_eval_stack_overflow,
-    expr_eval_stack_underflow,
-    expr_eval_unhandled_opcode,
-    expr_eval_unrecognized_opcode,
-    expr_eval_divide_by_zero,
-    expr_eval_invalid_goto
-  };
-
 struct agent_expr
 {
   int length;
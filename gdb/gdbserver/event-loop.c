@@ -30,6 +30,24 @@
 
 #include <unistd.h>
 #include <queue>
+#include <vector>
+
+/* Use epoll when the host has it; it doesn't need the whole fd set
+   to be passed in and scanned on every wait.  */
+#if defined (HAVE_EPOLL_CREATE1) && defined (HAVE_SYS_EPOLL_H)
+#define USE_EPOLL 1
+#include <sys/epoll.h>
+
+/* Maximum number of events collected by a single epoll_wait call.  */
+#define EPOLL_MAX_EVENTS 16
+#else
+#define USE_EPOLL 0
+#endif
+
+/* Do we use epoll or select?  Cleared if epoll_create1 fails, or if
+   a descriptor epoll refuses to watch (e.g. a regular file) is
+   registered; we then fall back to select for good.  */
+static unsigned char use_epoll = USE_EPOLL;
 
 typedef int (event_handler_func) (gdb_fildes_t);
 
@@ -102,6 +120,20 @@ static struct
     /* Ptr to head of file handler list.  */
     file_handler *first_file_handler;
 
+#if USE_EPOLL
+    /* The epoll instance all file handlers are registered with, or 0
+       if it hasn't been created yet.  */
+    int epoll_fd;
+
+    /* Events returned by the last call to epoll_wait.  */
+    struct epoll_event epoll_events[EPOLL_MAX_EVENTS];
+
+    /* The file handlers registered with the epoll instance, indexed
+       by file descriptor, so that ready descriptors map to their
+       handler without walking the list.  */
+    std::vector<file_handler *> epoll_handlers;
+#endif
+
     /* Masks to be used in the next call to select.  Bits are set in
        response to calls to create_file_handler.  */
     fd_set check_masks[3];
@@ -109,7 +141,8 @@ static struct
     /* What file descriptors were found ready by select.  */
     fd_set ready_masks[3];
 
-    /* Number of valid bits (highest fd value + 1). (for select) */
+    /* Number of file descriptors to monitor (for epoll).  */
+    /* Number of valid bits (highest fd value + 1) (for select).  */
     int num_fds;
   }
 gdb_notifier;
@@ -254,6 +287,125 @@ process_callback (void)
   return 0;
 }
 
+/* Add FILE_PTR's descriptor to the select masks, according to its
+   event mask.  */
+
+static void
+select_add_file (file_handler *file_ptr)
+{
+  gdb_fildes_t fd = file_ptr->fd;
+  int mask = file_ptr->mask;
+
+  if (mask & GDB_READABLE)
+    FD_SET (fd, &gdb_notifier.check_masks[0]);
+  else
+    FD_CLR (fd, &gdb_notifier.check_masks[0]);
+
+  if (mask & GDB_WRITABLE)
+    FD_SET (fd, &gdb_notifier.check_masks[1]);
+  else
+    FD_CLR (fd, &gdb_notifier.check_masks[1]);
+
+  if (mask & GDB_EXCEPTION)
+    FD_SET (fd, &gdb_notifier.check_masks[2]);
+  else
+    FD_CLR (fd, &gdb_notifier.check_masks[2]);
+
+  if (gdb_notifier.num_fds <= fd)
+    gdb_notifier.num_fds = fd + 1;
+}
+
+#if USE_EPOLL
+
+/* Convert a mask of GDB_READABLE etc. bits to epoll events.
+   Exceptional conditions are always reported by epoll, as EPOLLERR
+   and EPOLLHUP.  */
+
+static uint32_t
+epoll_events_from_mask (int mask)
+{
+  uint32_t events = 0;
+
+  if (mask & GDB_READABLE)
+    events |= EPOLLIN;
+  if (mask & GDB_WRITABLE)
+    events |= EPOLLOUT;
+  if (mask & GDB_EXCEPTION)
+    events |= EPOLLPRI;
+  return events;
+}
+
+/* Tell the epoll instance to watch FILE_PTR's descriptor, creating
+   the instance on first use.  Return false if epoll can't watch it.  */
+
+static bool
+epoll_add_file (file_handler *file_ptr)
+{
+  struct epoll_event ev;
+
+  if (gdb_notifier.epoll_fd == 0)
+    {
+      gdb_notifier.epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+      if (gdb_notifier.epoll_fd < 0)
+	{
+	  gdb_notifier.epoll_fd = 0;
+	  return false;
+	}
+    }
+
+  memset (&ev, 0, sizeof (ev));
+  ev.events = epoll_events_from_mask (file_ptr->mask);
+  ev.data.fd = file_ptr->fd;
+
+  if (epoll_ctl (gdb_notifier.epoll_fd, EPOLL_CTL_ADD,
+		 file_ptr->fd, &ev) != 0
+      /* The descriptor is already in the set when an existing file
+	 handler is being updated.  */
+      && (errno != EEXIST
+	  || epoll_ctl (gdb_notifier.epoll_fd, EPOLL_CTL_MOD,
+			file_ptr->fd, &ev) != 0))
+    return false;
+
+  if (gdb_notifier.epoll_handlers.size () <= file_ptr->fd)
+    gdb_notifier.epoll_handlers.resize (file_ptr->fd + 1);
+  gdb_notifier.epoll_handlers[file_ptr->fd] = file_ptr;
+  return true;
+}
+
+/* Return the file handler registered with the epoll instance for FD,
+   or NULL if there is none.  */
+
+static file_handler *
+epoll_file_handler (gdb_fildes_t fd)
+{
+  if (fd < 0 || fd >= gdb_notifier.epoll_handlers.size ())
+    return NULL;
+  return gdb_notifier.epoll_handlers[fd];
+}
+
+/* Stop using epoll, and move all the registered file handlers over
+   to the select masks.  */
+
+static void
+epoll_fall_back_to_select (void)
+{
+  file_handler *file_ptr;
+
+  if (gdb_notifier.epoll_fd > 0)
+    close (gdb_notifier.epoll_fd);
+  gdb_notifier.epoll_fd = 0;
+  gdb_notifier.epoll_handlers.clear ();
+  use_epoll = 0;
+
+  gdb_notifier.num_fds = 0;
+  for (file_ptr = gdb_notifier.first_file_handler;
+       file_ptr != NULL;
+       file_ptr = file_ptr->next_file)
+    select_add_file (file_ptr);
+}
+
+#endif /* USE_EPOLL */
+
 /* Add a file handler/descriptor to the list of descriptors we are
    interested in.  FD is the file descriptor for the file/stream to be
    listened to.  MASK is a combination of READABLE, WRITABLE,
@@ -280,28 +432,33 @@ create_file_handler (gdb_fildes_t fd, int mask, handler_func *proc,
     {
       file_ptr = XNEW (struct file_handler);
       file_ptr->fd = fd;
+      file_ptr->mask = mask;
       file_ptr->ready_mask = 0;
       file_ptr->next_file = gdb_notifier.first_file_handler;
       gdb_notifier.first_file_handler = file_ptr;
 
-      if (mask & GDB_READABLE)
-	FD_SET (fd, &gdb_notifier.check_masks[0]);
-      else
-	FD_CLR (fd, &gdb_notifier.check_masks[0]);
-
-      if (mask & GDB_WRITABLE)
-	FD_SET (fd, &gdb_notifier.check_masks[1]);
-      else
-	FD_CLR (fd, &gdb_notifier.check_masks[1]);
-
-      if (mask & GDB_EXCEPTION)
-	FD_SET (fd, &gdb_notifier.check_masks[2]);
+#if USE_EPOLL
+      if (use_epoll)
+	{
+	  if (epoll_add_file (file_ptr))
+	    gdb_notifier.num_fds++;
+	  else
+	    epoll_fall_back_to_select ();
+	}
       else
-	FD_CLR (fd, &gdb_notifier.check_masks[2]);
-
-      if (gdb_notifier.num_fds <= fd)
-	gdb_notifier.num_fds = fd + 1;
+#endif
+	select_add_file (file_ptr);
+    }
+#if USE_EPOLL
+  else if (use_epoll)
+    {
+      /* Re-register, in case the mask changed, or FD was closed and
+	 reused (closing it removed it from the epoll set).  */
+      file_ptr->mask = mask;
+      if (!epoll_add_file (file_ptr))
+	epoll_fall_back_to_select ();
     }
+#endif
 
   file_ptr->proc = proc;
   file_ptr->client_data = client_data;
@@ -337,26 +494,39 @@ delete_file_handler (gdb_fildes_t fd)
   if (file_ptr == NULL)
     return;
 
-  if (file_ptr->mask & GDB_READABLE)
-    FD_CLR (fd, &gdb_notifier.check_masks[0]);
-  if (file_ptr->mask & GDB_WRITABLE)
-    FD_CLR (fd, &gdb_notifier.check_masks[1]);
-  if (file_ptr->mask & GDB_EXCEPTION)
-    FD_CLR (fd, &gdb_notifier.check_masks[2]);
-
-  /* Find current max fd.  */
-
-  if ((fd + 1) == gdb_notifier.num_fds)
+#if USE_EPOLL
+  if (use_epoll)
     {
+      /* This fails harmlessly if FD was already closed; closing it
+	 removed it from the epoll set.  */
+      epoll_ctl (gdb_notifier.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+      gdb_notifier.epoll_handlers[fd] = NULL;
       gdb_notifier.num_fds--;
-      for (i = gdb_notifier.num_fds; i; i--)
+    }
+  else
+#endif
+    {
+      if (file_ptr->mask & GDB_READABLE)
+	FD_CLR (fd, &gdb_notifier.check_masks[0]);
+      if (file_ptr->mask & GDB_WRITABLE)
+	FD_CLR (fd, &gdb_notifier.check_masks[1]);
+      if (file_ptr->mask & GDB_EXCEPTION)
+	FD_CLR (fd, &gdb_notifier.check_masks[2]);
+
+      /* Find current max fd.  */
+
+      if ((fd + 1) == gdb_notifier.num_fds)
 	{
-	  if (FD_ISSET (i - 1, &gdb_notifier.check_masks[0])
-	      || FD_ISSET (i - 1, &gdb_notifier.check_masks[1])
-	      || FD_ISSET (i - 1, &gdb_notifier.check_masks[2]))
-	    break;
+	  gdb_notifier.num_fds--;
+	  for (i = gdb_notifier.num_fds; i; i--)
+	    {
+	      if (FD_ISSET (i - 1, &gdb_notifier.check_masks[0])
+		  || FD_ISSET (i - 1, &gdb_notifier.check_masks[1])
+		  || FD_ISSET (i - 1, &gdb_notifier.check_masks[2]))
+		break;
+	    }
+	  gdb_notifier.num_fds = i;
 	}
-      gdb_notifier.num_fds = i;
     }
 
   /* Deactivate the file descriptor, by clearing its mask, so that it
@@ -443,6 +613,74 @@ create_file_event (gdb_fildes_t fd)
   return file_event_ptr;
 }
 
+/* Record that MASK events were seen on FILE_PTR, and enqueue an
+   event for it unless one is already pending.  */
+
+static void
+note_file_ready (file_handler *file_ptr, int mask)
+{
+  /* Enqueue an event only if this is still a new event for this
+     fd.  */
+
+  if (file_ptr->ready_mask == 0)
+    {
+      gdb_event *file_event_ptr = create_file_event (file_ptr->fd);
+
+      event_queue.emplace (file_event_ptr);
+    }
+  file_ptr->ready_mask = mask;
+}
+
+#if USE_EPOLL
+
+/* The epoll variant of wait_for_event.  Only the descriptors that
+   are actually ready are returned by the kernel, so there's no need
+   to walk all the registered file handlers.  */
+
+static int
+epoll_wait_for_event (void)
+{
+  int num_found, i;
+
+  num_found = epoll_wait (gdb_notifier.epoll_fd, gdb_notifier.epoll_events,
+			  EPOLL_MAX_EVENTS, -1);
+  if (num_found == -1)
+    {
+      /* Dont print anything if we got a signal, let gdb handle
+	 it.  */
+      if (errno != EINTR)
+	perror_with_name ("epoll_wait");
+      return 0;
+    }
+
+  for (i = 0; i < num_found; i++)
+    {
+      struct epoll_event *ev = &gdb_notifier.epoll_events[i];
+      file_handler *file_ptr = epoll_file_handler (ev->data.fd);
+      int mask = 0;
+
+      if (file_ptr == NULL)
+	continue;
+
+      /* Like select, report hangups and errors as readability; the
+	 handler finds out about them when it reads.  */
+      if (ev->events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+	mask |= GDB_READABLE;
+      if (ev->events & EPOLLOUT)
+	mask |= GDB_WRITABLE;
+      if (ev->events & EPOLLPRI)
+	mask |= GDB_EXCEPTION;
+
+      mask &= file_ptr->mask;
+      if (mask != 0)
+	note_file_ready (file_ptr, mask);
+    }
+
+  return 0;
+}
+
+#endif /* USE_EPOLL */
+
 /* Called by do_one_event to wait for new events on the monitored file
    descriptors.  Queue file events as they are detected by the poll.
    If there are no events, this function will block in the call to
@@ -462,6 +700,11 @@ wait_for_event (void)
   if (gdb_notifier.num_fds == 0)
     return -1;
 
+#if USE_EPOLL
+  if (use_epoll)
+    return epoll_wait_for_event ();
+#endif
+
   gdb_notifier.ready_masks[0] = gdb_notifier.check_masks[0];
   gdb_notifier.ready_masks[1] = gdb_notifier.check_masks[1];
   gdb_notifier.ready_masks[2] = gdb_notifier.check_masks[2];
@@ -505,16 +748,7 @@ wait_for_event (void)
       else
 	num_found--;
 
-      /* Enqueue an event only if this is still a new event for this
-	 fd.  */
-
-      if (file_ptr->ready_mask == 0)
-	{
-	  gdb_event *file_event_ptr = create_file_event (file_ptr->fd);
-
-	  event_queue.emplace (file_event_ptr);
-	}
-      file_ptr->ready_mask = mask;
+      note_file_ready (file_ptr, mask);
     }
 
   return 0;
@@ -50,6 +50,10 @@
 #endif
 
 #include "netstuff.h"
+#include "rsp-stats.h"
+#include <string>
+#include <thread>
+#include <vector>
 
 #ifndef HAVE_SOCKLEN_T
 typedef int socklen_t;
@@ -60,6 +64,124 @@ typedef int socklen_t;
 
 static int remote_desc;
 
+/* Whether to echo the logfile to stdout as it is replayed.  */
+
+static bool echo_log = true;
+
+/* The simulated one-way latency of the link to gdb, added before each
+   batch of data sent to it, and the simulated bandwidth of the link
+   in bytes per second, or 0 for unlimited.  */
+
+static rsp_clock::duration link_latency;
+static ULONGEST link_bandwidth;
+
+/* Whether to report timings and packet counts at the end.  */
+
+static bool report_stats;
+
+/* A phase of the replayed session: the remote protocol traffic
+   following one gdb command in the logfile.  */
+
+struct replay_phase
+{
+  explicit replay_phase (const std::string &command_)
+    : command (command_)
+  {
+  }
+
+  /* The gdb command, as recorded in the logfile.  */
+  std::string command;
+
+  /* Whether any data was exchanged yet, and when the first byte of
+     the phase was exchanged.  */
+  bool started = false;
+  rsp_clock::time_point start {};
+
+  /* The time from the first byte exchanged to the last one sent to
+     gdb, and the parts of it spent waiting for gdb and in the
+     simulated link.  */
+  rsp_clock::duration elapsed {};
+  rsp_clock::duration gdb_time {};
+  rsp_clock::duration link_time {};
+
+  /* The number of packets gdb sent, and the number of bytes
+     exchanged in each direction.  */
+  ULONGEST packets = 0;
+  ULONGEST bytes_from_gdb = 0;
+  ULONGEST bytes_to_gdb = 0;
+};
+
+/* The phases of the session so far; the last one is the current one.
+   The first one covers the traffic before the first command.  */
+
+static std::vector<replay_phase> phases;
+
+/* Packet statistics for the whole session, by packet type.  Bytes
+   "out" are those sent by gdb, bytes "in" those sent to it.  */
+
+static rsp_stats packet_stats;
+
+/* The type of the last packet gdb sent, to which replies are
+   credited.  */
+
+static std::string last_packet_type;
+
+/* Incremental parser of the '$' packets exchanged with gdb, to count
+   them by type.  */
+
+struct packet_scanner
+{
+  /* Feed CH to the scanner.  Return true when it completes a packet,
+     whose payload is then in PAYLOAD.  */
+  bool feed (int ch)
+  {
+    switch (state)
+      {
+      case IDLE:
+	if (ch == '$')
+	  {
+	    payload.clear ();
+	    state = PAYLOAD;
+	  }
+	return false;
+      case PAYLOAD:
+	if (ch == '#')
+	  state = CSUM1;
+	else
+	  payload += (char) ch;
+	return false;
+      case CSUM1:
+	state = CSUM2;
+	return false;
+      case CSUM2:
+      default:
+	state = IDLE;
+	return true;
+      }
+  }
+
+  enum { IDLE, PAYLOAD, CSUM1, CSUM2 } state = IDLE;
+  std::string payload;
+};
+
+static packet_scanner gdb_scanner;
+static packet_scanner replay_scanner;
+
+/* Return the current phase, marking it started if it is not yet.  */
+
+static replay_phase &
+current_phase (void)
+{
+  replay_phase &phase = phases.back ();
+
+  if (!phase.started)
+    {
+      phase.started = true;
+      phase.start = rsp_clock::now ();
+    }
+  return phase;
+}
+
 #ifdef __MINGW32CE__
 
 #ifndef COUNTOF
@@ -310,6 +432,19 @@ fromhex (int ch)
   exit (1);
 }
 
+/* Echo logfile character CH to stdout, unless told not to.  */
+
+static void
+echo_char (int ch)
+{
+  if (!echo_log || ch == EOF)
+    return;
+
+  fputc (ch, stdout);
+  if (ch == '\n')
+    fflush (stdout);
+}
+
 static int
 logchar (FILE *fp)
 {
@@ -317,8 +452,7 @@ logchar (FILE *fp)
   int ch2;
 
   ch = fgetc (fp);
-  fputc (ch, stdout);
-  fflush (stdout);
+  echo_char (ch);
   switch (ch)
     {
     case '\n':
@@ -326,8 +460,7 @@ logchar (FILE *fp)
       break;
     case '\\':
       ch = fgetc (fp);
-      fputc (ch, stdout);
-      fflush (stdout);
+      echo_char (ch);
       switch (ch)
 	{
 	case '\\':
@@ -352,12 +485,10 @@ logchar (FILE *fp)
 	  break;
 	case 'x':
 	  ch2 = fgetc (fp);
-	  fputc (ch2, stdout);
-	  fflush (stdout);
+	  echo_char (ch2);
 	  ch = fromhex (ch2) << 4;
 	  ch2 = fgetc (fp);
-	  fputc (ch2, stdout);
-	  fflush (stdout);
+	  echo_char (ch2);
 	  ch |= fromhex (ch2);
 	  break;
 	default:
@@ -370,15 +501,70 @@ logchar (FILE *fp)
   return (ch);
 }
 
+/* Return the next character gdb sent on DESC, or -1 on error.  Input
+   is read in blocks; the time spent blocked waiting for it is
+   credited to the current phase, which starts when its first byte
+   arrives.  */
+
 static int
 gdbchar (int desc)
 {
-  unsigned char fromgdb;
+  static unsigned char buf[BUFSIZ];
+  static int buf_len, buf_pos;
 
-  if (read (desc, &fromgdb, 1) != 1)
-    return -1;
-  else
-    return fromgdb;
+  if (buf_pos == buf_len)
+    {
+      replay_phase &phase = phases.back ();
+      rsp_clock::time_point before = rsp_clock::now ();
+
+      buf_len = read (desc, buf, sizeof (buf));
+      buf_pos = 0;
+      if (buf_len <= 0)
+	{
+	  buf_len = 0;
+	  return -1;
+	}
+
+      if (phase.started)
+	phase.gdb_time += rsp_clock::now () - before;
+      else
+	current_phase ();
+    }
+
+  return buf[buf_pos++];
+}
+
+/* Send the LEN bytes at BUF to gdb, through the simulated link.  */
+
+static void
+send_to_gdb (const char *buf, size_t len)
+{
+  replay_phase &phase = current_phase ();
+
+  if (link_latency != rsp_clock::duration::zero () || link_bandwidth != 0)
+    {
+      rsp_clock::duration delay = link_latency;
+
+      if (link_bandwidth != 0)
+	delay += std::chrono::duration_cast<rsp_clock::duration>
+	  (std::chrono::microseconds (len * 1000000 / link_bandwidth));
+
+      std::this_thread::sleep_for (delay);
+      phase.link_time += delay;
+    }
+
+  phase.bytes_to_gdb += len;
+  while (len > 0)
+    {
+      int written = write (remote_desc, buf, len);
+
+      if (written <= 0)
+	remote_error ("Error during write to gdb");
+      buf += written;
+      len -= written;
+    }
+
+  phase.elapsed = rsp_clock::now () - phase.start;
 }
 
 /* Accept input from gdb and match with chars from fp (after skipping one
@@ -403,6 +589,20 @@ expect (FILE *fp)
       fromgdb = gdbchar (remote_desc);
       if (fromgdb < 0)
 	remote_error ("Error during read from gdb");
+
+      replay_phase &phase = phases.back ();
+      phase.bytes_from_gdb++;
+      if (gdb_scanner.feed (fromgdb))
+	{
+	  const std::string &payload = gdb_scanner.payload;
+
+	  last_packet_type = rsp_packet_type (payload.c_str (),
+					      payload.size ());
+	  rsp_packet_stats &ps = packet_stats[last_packet_type];
+	  ps.count++;
+	  ps.bytes_out += payload.size () + 4;
+	  phase.packets++;
+	}
     }
   while (fromlog == fromgdb);
 
@@ -420,7 +620,7 @@ static void
 play (FILE *fp)
 {
   int fromlog;
-  char ch;
+  std::string data;
 
   if ((fromlog = logchar (fp)) != ' ')
     {
@@ -429,10 +629,19 @@ play (FILE *fp)
     }
   while ((fromlog = logchar (fp)) != EOL)
     {
-      ch = fromlog;
-      if (write (remote_desc, &ch, 1) != 1)
-	remote_error ("Error during write to gdb");
+      if (fromlog == EOF)
+	break;
+
+      data += (char) fromlog;
+      if (replay_scanner.feed (fromlog) && !last_packet_type.empty ())
+	{
+	  rsp_packet_stats &ps = packet_stats[last_packet_type];
+	  ps.replies++;
+	  ps.bytes_in += replay_scanner.payload.size () + 4;
+	}
     }
+
+  send_to_gdb (data.data (), data.size ());
 }
 
 static void
@@ -449,11 +658,97 @@ gdbreplay_version (void)
 static void
 gdbreplay_usage (FILE *stream)
 {
-  fprintf (stream, "Usage:\tgdbreplay <logfile> <host:port>\n");
+  fprintf (stream, "Usage:\tgdbreplay [OPTIONS] <logfile> <host:port>\n"
+	   "\n"
+	   "Options:\n"
+	   "  --quiet               Do not echo the logfile while replaying it.\n"
+	   "  --stats               Report the time taken by, and the packets\n"
+	   "                        exchanged for, each command of the session.\n"
+	   "  --latency=MS          Simulate a link with a one-way latency of MS\n"
+	   "                        milliseconds.\n"
+	   "  --bandwidth=BYTES     Simulate a link that carries BYTES bytes per\n"
+	   "                        second.\n"
+	   "  --version             Display version information and exit.\n"
+	   "  --help                Print this message and exit.\n");
   if (REPORT_BUGS_TO[0] && stream == stdout)
     fprintf (stream, "Report bugs to \"%s\".\n", REPORT_BUGS_TO);
 }
 
+/* Return D in milliseconds.  */
+
+static double
+duration_ms (rsp_clock::duration d)
+{
+  return std::chrono::duration<double, std::milli> (d).count ();
+}
+
+/* Print the timings and packet counts of the session to stderr.  */
+
+static void
+print_stats (void)
+{
+  replay_phase total ("(total)");
+
+  fprintf (stderr, "\n%-5s %10s %10s %10s %8s %10s %10s  %s\n",
+	   "Phase", "Time(ms)", "Gdb(ms)", "Link(ms)", "Packets",
+	   "From gdb", "To gdb", "Command");
+
+  /* Commands run by other commands, such as those of "thread apply
+     all", are logged too; runs of the same command are shown as one
+     phase.  */
+  for (size_t i = 0; i < phases.size (); )
+    {
+      replay_phase phase (phases[i].command);
+      size_t first = i;
+
+      for (; i < phases.size () && phases[i].command == phase.command; i++)
+	{
+	  phase.elapsed += phases[i].elapsed;
+	  phase.gdb_time += phases[i].gdb_time;
+	  phase.link_time += phases[i].link_time;
+	  phase.packets += phases[i].packets;
+	  phase.bytes_from_gdb += phases[i].bytes_from_gdb;
+	  phase.bytes_to_gdb += phases[i].bytes_to_gdb;
+	}
+
+      std::string command = phase.command;
+      if (i - first > 1)
+	command += string_printf (" (x%s)", pulongest (i - first));
+
+      fprintf (stderr, "%-5s %10.3f %10.3f %10.3f %8s %10s %10s  %s\n",
+	       pulongest (first), duration_ms (phase.elapsed),
+	       duration_ms (phase.gdb_time), duration_ms (phase.link_time),
+	       pulongest (phase.packets), pulongest (phase.bytes_from_gdb),
+	       pulongest (phase.bytes_to_gdb), command.c_str ());
+
+      total.elapsed += phase.elapsed;
+      total.gdb_time += phase.gdb_time;
+      total.link_time += phase.link_time;
+      total.packets += phase.packets;
+      total.bytes_from_gdb += phase.bytes_from_gdb;
+      total.bytes_to_gdb += phase.bytes_to_gdb;
+    }
+
+  fprintf (stderr, "%-5s %10.3f %10.3f %10.3f %8s %10s %10s\n",
+	   "Total", duration_ms (total.elapsed),
+	   duration_ms (total.gdb_time), duration_ms (total.link_time),
+	   pulongest (total.packets), pulongest (total.bytes_from_gdb),
+	   pulongest (total.bytes_to_gdb));
+
+  fprintf (stderr, "\n%-24s %8s %8s %10s %10s\n",
+	   "Packet type", "Count", "Replies", "Bytes out", "Bytes in");
+  for (const auto &entry : packet_stats)
+    {
+      const rsp_packet_stats &ps = entry.second;
+
+      fprintf (stderr, "%-24s %8s %8s %10s %10s\n",
+	       entry.first.c_str (), pulongest (ps.count),
+	       pulongest (ps.replies), pulongest (ps.bytes_out),
+	       pulongest (ps.bytes_in));
+    }
+  fflush (stderr);
+}
+
 /* Main function.  This is called by the real "main" function,
    wrapped in a TRY_CATCH that handles any uncaught exceptions.  */
 
@@ -462,29 +757,64 @@ captured_main (int argc, char *argv[])
 {
   FILE *fp;
   int ch;
+  int i;
 
-  if (argc >= 2 && strcmp (argv[1], "--version") == 0)
-    {
-      gdbreplay_version ();
-      exit (0);
-    }
-  if (argc >= 2 && strcmp (argv[1], "--help") == 0)
+  for (i = 1; i < argc && startswith (argv[i], "--"); i++)
     {
-      gdbreplay_usage (stdout);
-      exit (0);
+      const char *arg = argv[i];
+
+      if (strcmp (arg, "--version") == 0)
+	{
+	  gdbreplay_version ();
+	  exit (0);
+	}
+      else if (strcmp (arg, "--help") == 0)
+	{
+	  gdbreplay_usage (stdout);
+	  exit (0);
+	}
+      else if (strcmp (arg, "--quiet") == 0)
+	echo_log = false;
+      else if (strcmp (arg, "--stats") == 0)
+	report_stats = true;
+      else if (startswith (arg, "--latency="))
+	{
+	  char *end;
+	  double ms = strtod (arg + strlen ("--latency="), &end);
+
+	  if (*end != '\0' || ms < 0)
+	    error (_("Invalid latency: %s"), arg);
+	  link_latency = std::chrono::duration_cast<rsp_clock::duration>
+	    (std::chrono::duration<double, std::milli> (ms));
+	}
+      else if (startswith (arg, "--bandwidth="))
+	{
+	  const char *end;
+
+	  link_bandwidth = strtoulst (arg + strlen ("--bandwidth="), &end, 10);
+	  if (*end != '\0' || link_bandwidth == 0)
+	    error (_("Invalid bandwidth: %s"), arg);
+	}
+      else
+	{
+	  fprintf (stderr, "Unknown argument: %s\n", arg);
+	  gdbreplay_usage (stderr);
+	  exit (1);
+	}
     }
 
-  if (argc < 3)
+  if (argc - i < 2)
     {
       gdbreplay_usage (stderr);
       exit (1);
     }
-  fp = fopen (argv[1], "r");
+  fp = fopen (argv[i], "r");
   if (fp == NULL)
     {
-      perror_with_name (argv[1]);
+      perror_with_name (argv[i]);
     }
-  remote_open (argv[2]);
+  remote_open (argv[i + 1]);
+  phases.emplace_back ("(connect)");
   while ((ch = logchar (fp)) != EOF)
     {
       switch (ch)
@@ -498,12 +828,21 @@ captured_main (int argc, char *argv[])
 	  play (fp);
 	  break;
 	case 'c':
-	  /* Command executed by gdb */
-	  while ((ch = logchar (fp)) != EOL);
+	  /* Command executed by gdb; it starts a new phase */
+	  {
+	    std::string command;
+
+	    while ((ch = logchar (fp)) != EOL && ch != EOF)
+	      if (ch != ' ' || !command.empty ())
+		command += (char) ch;
+	    phases.emplace_back (command);
+	  }
 	  break;
 	}
     }
   remote_close ();
+  if (report_stats)
+    print_stats ();
   exit (0);
 }
 
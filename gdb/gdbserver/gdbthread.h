@@ -71,10 +71,30 @@ struct thread_info
 
   /* Branch trace target information for this thread.  */
   struct btrace_target_info *btrace;
+
+  /* The thread list generation at which this thread was added.  */
+  ULONGEST generation;
+
+  /* The name last sent to GDB in the thread list, or NULL.  */
+  char *reported_name;
 };
 
 extern std::list<thread_info *> all_threads;
 
+/* The thread list generation.  It is incremented whenever a thread is
+   added or removed, so that GDB can ask for the changes since a
+   thread list it has already seen.  */
+
+extern ULONGEST thread_list_generation;
+
+/* Append to EXITED the ids of the threads removed after generation
+   SINCE, oldest first.  Return false if SINCE is not a generation of
+   the current thread list or if some of those threads have been
+   forgotten; EXITED is then left unchanged.  */
+
+extern bool threads_exited_since (ULONGEST since,
+				  std::vector<ptid_t> *exited);
+
 void remove_thread (struct thread_info *thread);
 struct thread_info *add_thread (ptid_t ptid, void *target_data);
 
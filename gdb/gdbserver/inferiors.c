@@ -21,12 +21,28 @@
 #include "server.h"
 #include "gdbthread.h"
 #include "dll.h"
+#include <deque>
 
 std::list<process_info *> all_processes;
 std::list<thread_info *> all_threads;
 
 struct thread_info *current_thread;
 
+/* See gdbthread.h.  */
+
+ULONGEST thread_list_generation;
+
+/* The threads removed recently, with the generation their removal
+   created, oldest first.  */
+static std::deque<std::pair<ULONGEST, ptid_t>> exited_threads;
+
+/* The most exited threads remembered.  */
+#define MAX_EXITED_THREADS 4096
+
+/* The latest generation whose removed threads are no longer all in
+   EXITED_THREADS.  */
+static ULONGEST exited_threads_forgotten;
+
 /* The current working directory used to start the inferior.  */
 static const char *current_inferior_cwd = NULL;
 
@@ -38,6 +54,7 @@ add_thread (ptid_t thread_id, void *target_data)
   new_thread->id = thread_id;
   new_thread->last_resume_kind = resume_continue;
   new_thread->last_status.kind = TARGET_WAITKIND_IGNORE;
+  new_thread->generation = ++thread_list_generation;
 
   all_threads.push_back (new_thread);
 
@@ -91,6 +108,7 @@ static void
 free_one_thread (thread_info *thread)
 {
   free_register_cache (thread_regcache_data (thread));
+  xfree (thread->reported_name);
   free (thread);
 }
 
@@ -102,11 +120,34 @@ remove_thread (struct thread_info *thread)
 
   discard_queued_stop_replies (ptid_of (thread));
   all_threads.remove (thread);
+
+  exited_threads.emplace_back (++thread_list_generation, ptid_of (thread));
+  if (exited_threads.size () > MAX_EXITED_THREADS)
+    {
+      exited_threads_forgotten = exited_threads.front ().first;
+      exited_threads.pop_front ();
+    }
+
   free_one_thread (thread);
   if (current_thread == thread)
     current_thread = NULL;
 }
 
+/* See gdbthread.h.  */
+
+bool
+threads_exited_since (ULONGEST since, std::vector<ptid_t> *exited)
+{
+  if (since > thread_list_generation || since < exited_threads_forgotten)
+    return false;
+
+  for (const auto &entry : exited_threads)
+    if (entry.first > since)
+      exited->push_back (entry.second);
+
+  return true;
+}
+
 void *
 thread_target_data (struct thread_info *thread)
 {
@@ -131,6 +172,10 @@ clear_inferiors (void)
   for_each_thread (free_one_thread);
   all_threads.clear ();
 
+  /* The threads are gone without being remembered as exited.  */
+  exited_threads.clear ();
+  exited_threads_forgotten = ++thread_list_generation;
+
   clear_dlls ();
 
   current_thread = NULL;
@@ -7032,7 +7032,7 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
   const struct link_map_offsets *lmo;
   unsigned int machine;
   int ptr_size;
-  CORE_ADDR lm_addr = 0, lm_prev = 0;
+  CORE_ADDR lm_addr = 0, lm_prev = 0, compact = 0;
   CORE_ADDR l_name, l_addr, l_ld, l_next, l_prev;
   int header_done = 0;
 
@@ -7062,6 +7062,8 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
 	addrp = &lm_addr;
       else if (len == 4 && startswith (annex, "prev"))
 	addrp = &lm_prev;
+      else if (len == 7 && startswith (annex, "compact"))
+	addrp = &compact;
       else
 	{
 	  annex = strchr (sep, ';');
@@ -7105,7 +7107,12 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
 	}
     }
 
-  std::string document = "<library-list-svr4 version=\"1.0\"";
+  /* The compact form of the list has a line per entry instead of XML
+     elements; see the "compact-libraries-svr4" feature in the
+     manual.  */
+  std::string document = (compact
+			  ? "library-list-svr4-compact 1\n"
+			  : "<library-list-svr4 version=\"1.0\"");
 
   while (lm_addr
 	 && read_one_ptr (lm_addr + lmo->l_name_offset,
@@ -7135,7 +7142,13 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
 	 executable does not have PT_DYNAMIC present and this function already
 	 exited above due to failed get_r_debug.  */
       if (lm_prev == 0)
-	string_appendf (document, " main-lm=\"0x%lx\"", (unsigned long) lm_addr);
+	{
+	  if (compact)
+	    string_appendf (document, "m %lx\n", (unsigned long) lm_addr);
+	  else
+	    string_appendf (document, " main-lm=\"0x%lx\"",
+			    (unsigned long) lm_addr);
+	}
       else
 	{
 	  /* Not checking for error because reading may stop before
@@ -7143,7 +7156,21 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
 	  libname[0] = '\0';
 	  linux_read_memory (l_name, libname, sizeof (libname) - 1);
 	  libname[sizeof (libname) - 1] = '\0';
-	  if (libname[0] != '\0')
+	  if (libname[0] != '\0' && compact)
+	    {
+	      string_appendf (document, "l %lx %lx %lx ",
+			      (unsigned long) lm_addr, (unsigned long) l_addr,
+			      (unsigned long) l_ld);
+	      for (const unsigned char *p = libname; *p != '\0'; p++)
+		if (*p == '\\')
+		  document += "\\\\";
+		else if (*p == '\n')
+		  document += "\\n";
+		else
+		  document += *p;
+	      document += '\n';
+	    }
+	  else if (libname[0] != '\0')
 	    {
 	      if (!header_done)
 		{
@@ -7165,7 +7192,11 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
       lm_addr = l_next;
     }
 
-  if (!header_done)
+  if (compact)
+    {
+      /* The compact form has no terminator.  */
+    }
+  else if (!header_done)
     {
       /* Empty list; terminate `<library-list-svr4'.  */
       document += "/>";
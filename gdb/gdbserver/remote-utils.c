@@ -25,6 +25,7 @@
 #include "tdesc.h"
 #include "dll.h"
 #include "rsp-low.h"
+#include "rsp-compress.h"
 #include "gdbthread.h"
 #include "netstuff.h"
 #include "filestuff.h"
@@ -137,6 +138,16 @@ remote_connection_is_stdio (void)
   return remote_is_stdio;
 }
 
+/* See remote-utils.h.  */
+
+int
+remote_max_packet_size (void)
+{
+  client_state &cs = get_client_state ();
+
+  return cs.transport_is_reliable ? MAX_PBUFSIZ : PBUFSIZ;
+}
+
 static void
 enable_async_notification (int fd)
 {
@@ -637,6 +648,35 @@ read_prim (void *buf, int count)
     return read (remote_desc, buf, count);
 }
 
+/* See remote-utils.h.  */
+
+ULONGEST remote_bytes_out;
+ULONGEST remote_bytes_in;
+
+/* The number of bytes of packets sent and received compressed,
+   before and after compression.  */
+
+static ULONGEST compressed_sent_raw;
+static ULONGEST compressed_sent;
+static ULONGEST compressed_received_raw;
+static ULONGEST compressed_received;
+
+/* Log that a packet of RAW bytes went over the wire as a compressed
+   packet of SIZE bytes, and the totals so far in that direction,
+   TOTAL_RAW and TOTAL.  WHAT says which direction.  */
+
+static void
+debug_compression (const char *what, int raw, int size,
+		   ULONGEST total_raw, ULONGEST total)
+{
+  debug_printf ("[%s compressed packet: %d -> %d bytes (%d%%), "
+		"%s -> %s bytes so far (%d%%)]\n",
+		what, raw, size, (int) (size * 100LL / raw),
+		pulongest (total_raw), pulongest (total),
+		(int) (total * 100 / total_raw));
+  debug_flush ();
+}
+
 /* Send a packet to the remote machine, with error checking.
    The data of the packet is in BUF, and the length of the
    packet is in CNT.  Returns >= 0 on success, -1 otherwise.  */
@@ -650,6 +690,28 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
   char *buf2;
   char *p;
   int cc;
+  gdb::unique_xmalloc_ptr<char> compressed;
+
+  /* Send large packets compressed if GDB asked for that, unless that
+     would not make them any smaller.  Notifications are always sent
+     as they are.  */
+  if (cs.compression_feature && !is_notif
+      && cnt >= rsp_compress_threshold (buf))
+    {
+      compressed.reset ((char *) xmalloc (cnt));
+
+      int len = rsp_compress_packet (buf, cnt, compressed.get ());
+      if (len >= 0)
+	{
+	  compressed_sent_raw += cnt;
+	  compressed_sent += len;
+	  if (remote_debug)
+	    debug_compression ("sending", cnt, len,
+			       compressed_sent_raw, compressed_sent);
+	  buf = compressed.get ();
+	  cnt = len;
+	}
+    }
 
   buf2 = (char *) xmalloc (strlen ("$") + cnt + strlen ("#nn") + 1);
 
@@ -681,6 +743,7 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
 	  free (buf2);
 	  return -1;
 	}
+      remote_bytes_out += p - buf2;
 
       if (cs.noack_mode || is_notif)
 	{
@@ -1026,6 +1089,7 @@ getpkt (char *buf)
 
       c1 = fromhex (readchar ());
       c2 = fromhex (readchar ());
+      remote_bytes_in += bp - buf + 4;
 
       if (csum == (c1 << 4) + c2)
 	break;
@@ -1088,6 +1152,35 @@ getpkt (char *buf)
       (*the_target->request_interrupt) ();
     }
 
+  if (cs.compression_feature && bp > buf && buf[0] == RSP_COMPRESSED_PREFIX)
+    {
+      int cnt = bp - buf;
+      gdb::unique_xmalloc_ptr<char> data ((char *) xmalloc (cnt));
+      int len;
+
+      memcpy (data.get (), buf, cnt);
+      len = rsp_decompress_packet (data.get (), cnt, buf, MAX_PBUFSIZ);
+      if (len < 0)
+	{
+	  /* The packet made it here intact, so only its compressed
+	     data is bad.  Reject it and wait for the next one.  */
+	  char reply[] = "E01";
+
+	  warning ("Received a corrupt compressed packet.");
+	  if (putpkt (reply) < 0)
+	    return -1;
+	  return getpkt (buf);
+	}
+      buf[len] = '\0';
+
+      compressed_received_raw += len;
+      compressed_received += cnt;
+      if (remote_debug)
+	debug_compression ("received", len, cnt,
+			   compressed_received_raw, compressed_received);
+      return len;
+    }
+
   return bp - buf;
 }
 
@@ -1099,6 +1192,19 @@ write_ok (char *buf)
   buf[2] = '\0';
 }
 
+/* See remote-utils.h.  */
+
+int
+write_binary_memory (char *buf, const unsigned char *data, int len)
+{
+  int out_len_units;
+
+  buf[0] = 'b';
+  return remote_escape_output (data, len, 1, (unsigned char *) buf + 1,
+			       &out_len_units,
+			       remote_max_packet_size () - 1) + 1;
+}
+
 void
 write_enn (char *buf)
 {
@@ -1352,10 +1458,8 @@ decode_m_packet (char *from, CORE_ADDR *mem_addr_ptr, unsigned int *len_ptr)
       *mem_addr_ptr |= fromhex (ch) & 0x0f;
     }
 
-  for (j = 0; j < 4; j++)
+  while ((ch = from[i++]) != 0)
     {
-      if ((ch = from[i++]) == 0)
-	break;
       *len_ptr = *len_ptr << 4;
       *len_ptr |= fromhex (ch) & 0x0f;
     }
@@ -1531,20 +1635,28 @@ look_up_one_symbol (const char *name, CORE_ADDR *addrp, int may_ask_gdb)
      while it figures out the address of the symbol.  */
   while (1)
     {
-      if (cs.own_buf[0] == 'm')
+      if (cs.own_buf[0] == 'm' || cs.own_buf[0] == 'x')
 	{
 	  CORE_ADDR mem_addr;
 	  unsigned char *mem_buf;
 	  unsigned int mem_len;
+	  int new_len = -1;
 
 	  decode_m_packet (&cs.own_buf[1], &mem_addr, &mem_len);
+	  mem_len = std::min (mem_len, (unsigned int) (cs.own_buf[0] == 'm'
+						       ? MAX_PBUFSIZ / 2
+						       : MAX_PBUFSIZ));
 	  mem_buf = (unsigned char *) xmalloc (mem_len);
-	  if (read_inferior_memory (mem_addr, mem_buf, mem_len) == 0)
-	    bin2hex (mem_buf, cs.own_buf, mem_len);
-	  else
+	  if (read_inferior_memory (mem_addr, mem_buf, mem_len) != 0)
 	    write_enn (cs.own_buf);
+	  else if (cs.own_buf[0] == 'x')
+	    new_len = write_binary_memory (cs.own_buf, mem_buf, mem_len);
+	  else
+	    bin2hex (mem_buf, cs.own_buf, mem_len);
 	  free (mem_buf);
-	  if (putpkt (cs.own_buf) < 0)
+	  if ((new_len != -1
+	       ? putpkt_binary (cs.own_buf, new_len)
+	       : putpkt (cs.own_buf)) < 0)
 	    return -1;
 	}
       else if (cs.own_buf[0] == 'v')
@@ -1624,20 +1736,27 @@ relocate_instruction (CORE_ADDR *to, CORE_ADDR oldloc)
      wait for the qRelocInsn "response".  That requires re-entering
      the main loop.  For now, this is an adequate approximation; allow
      GDB to access memory.  */
-  while (cs.own_buf[0] == 'm' || cs.own_buf[0] == 'M' || cs.own_buf[0] == 'X')
+  while (cs.own_buf[0] == 'm' || cs.own_buf[0] == 'x'
+	 || cs.own_buf[0] == 'M' || cs.own_buf[0] == 'X')
     {
       CORE_ADDR mem_addr;
       unsigned char *mem_buf = NULL;
       unsigned int mem_len;
+      int new_len = -1;
 
-      if (cs.own_buf[0] == 'm')
+      if (cs.own_buf[0] == 'm' || cs.own_buf[0] == 'x')
 	{
 	  decode_m_packet (&cs.own_buf[1], &mem_addr, &mem_len);
+	  mem_len = std::min (mem_len, (unsigned int) (cs.own_buf[0] == 'm'
+						       ? MAX_PBUFSIZ / 2
+						       : MAX_PBUFSIZ));
 	  mem_buf = (unsigned char *) xmalloc (mem_len);
-	  if (read_inferior_memory (mem_addr, mem_buf, mem_len) == 0)
-	    bin2hex (mem_buf, cs.own_buf, mem_len);
-	  else
+	  if (read_inferior_memory (mem_addr, mem_buf, mem_len) != 0)
 	    write_enn (cs.own_buf);
+	  else if (cs.own_buf[0] == 'x')
+	    new_len = write_binary_memory (cs.own_buf, mem_buf, mem_len);
+	  else
+	    bin2hex (mem_buf, cs.own_buf, mem_len);
 	}
       else if (cs.own_buf[0] == 'X')
 	{
@@ -1657,7 +1776,9 @@ relocate_instruction (CORE_ADDR *to, CORE_ADDR oldloc)
 	    write_enn (cs.own_buf);
 	}
       free (mem_buf);
-      if (putpkt (cs.own_buf) < 0)
+      if ((new_len != -1
+	   ? putpkt_binary (cs.own_buf, new_len)
+	   : putpkt (cs.own_buf)) < 0)
 	return -1;
       len = getpkt (cs.own_buf);
       if (len < 0)
@@ -26,9 +26,18 @@ int gdb_connected (void);
 #define STDIO_CONNECTION_NAME "stdio"
 int remote_connection_is_stdio (void);
 
+/* Return the size of the largest packet gdbserver accepts over the
+   current connection, as advertised in its qSupported reply.  */
+int remote_max_packet_size (void);
+
 ptid_t read_ptid (const char *buf, const char **obuf);
 char *write_ptid (char *buf, ptid_t ptid);
 
+/* The number of bytes of packets written to and read from GDB,
+   including the framing.  */
+extern ULONGEST remote_bytes_out;
+extern ULONGEST remote_bytes_in;
+
 int putpkt (char *buf);
 int putpkt_binary (char *buf, int len);
 int putpkt_notif (char *buf);
@@ -38,6 +47,11 @@ void remote_open (const char *name);
 void remote_close (void);
 void write_ok (char *buf);
 void write_enn (char *buf);
+
+/* Write to BUF the reply to a binary memory read ("x") request, with
+   as much of the LEN bytes at DATA as fits in a packet.  Return the
+   length of the reply.  */
+int write_binary_memory (char *buf, const unsigned char *data, int len);
 void initialize_async_io (void);
 void enable_async_io (void);
 void disable_async_io (void);
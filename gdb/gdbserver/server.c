@@ -22,6 +22,7 @@
 #include "notif.h"
 #include "tdesc.h"
 #include "rsp-low.h"
+#include "rsp-stats.h"
 #include "signals-state-save-restore.h"
 #include <ctype.h>
 #include <unistd.h>
@@ -43,6 +44,7 @@
 #include "pathstuff.h"
 
 #include "common/selftest.h"
+#include "common/byte-vector.h"
 
 #define require_running_or_return(BUF)		\
   if (!target_running ())			\
@@ -78,6 +80,15 @@ static int extended_protocol;
 static int response_needed;
 static int exit_requested;
 
+/* Statistics about the packets received from GDB, by packet type, for
+   the "monitor remote-stats" command.  The latency of a packet is the
+   time taken to handle it, and the wait time is how long we were idle
+   before it arrived.  */
+static rsp_stats packet_stats;
+
+/* When we last finished handling a packet.  */
+static rsp_clock::time_point last_packet_done;
+
 /* --once: Exit after the first connection has closed.  */
 int run_once;
 
@@ -960,10 +971,94 @@ monitor_show_help (void)
   monitor_output ("    Options: all, none");
   monitor_output (", timestamp");
   monitor_output ("\n");
+  monitor_output ("  remote-stats [json] [reset]\n");
+  monitor_output ("    Show statistics about the packets received from GDB\n");
   monitor_output ("  exit\n");
   monitor_output ("    Quit GDBserver\n");
 }
 
+/* Send TEXT to GDB as console output, one line at a time so that long
+   texts do not need huge packets.  */
+
+static void
+monitor_output_lines (const std::string &text)
+{
+  size_t start = 0;
+
+  while (start < text.size ())
+    {
+      size_t end = text.find ('\n', start);
+
+      end = end == std::string::npos ? text.size () : end + 1;
+      monitor_output (text.substr (start, end - start).c_str ());
+      start = end;
+    }
+}
+
+/* Handle the "monitor remote-stats" command, whose arguments are
+   ARGS.  */
+
+static void
+handle_remote_stats_command (const char *args, char *own_buf)
+{
+  bool json = false, reset = false;
+
+  for (const char *p = skip_spaces (args); *p != '\0'; p = skip_spaces (p))
+    {
+      const char *end = skip_to_space (p);
+      std::string arg (p, end - p);
+
+      if (arg == "json")
+	json = true;
+      else if (arg == "reset")
+	reset = true;
+      else
+	{
+	  monitor_output ("Usage: monitor remote-stats [json] [reset]\n");
+	  write_enn (own_buf);
+	  return;
+	}
+      p = end;
+    }
+
+  if (json)
+    monitor_output_lines (rsp_stats_to_json (packet_stats));
+  else
+    {
+      std::string text
+	= string_printf ("%-24s %8s %10s %10s %12s %9s %12s  %s\n",
+			 "Packet", "Count", "Bytes in", "Bytes out",
+			 "Handling us", "Max us", "Idle us",
+			 "Latency <10us/<100us/<1ms/<10ms/<100ms/<1s/>=1s");
+
+      for (const auto &entry : packet_stats)
+	{
+	  const rsp_packet_stats &ps = entry.second;
+	  std::string histogram;
+
+	  for (ULONGEST n : ps.latency_histogram)
+	    {
+	      if (!histogram.empty ())
+		histogram += '/';
+	      histogram += pulongest (n);
+	    }
+
+	  text += string_printf ("%-24s %8s %10s %10s %12s %9s %12s  %s\n",
+				 entry.first.c_str (), pulongest (ps.count),
+				 pulongest (ps.bytes_in),
+				 pulongest (ps.bytes_out),
+				 plongest (rsp_duration_us (ps.total_latency)),
+				 plongest (rsp_duration_us (ps.max_latency)),
+				 plongest (rsp_duration_us (ps.wait_time)),
+				 histogram.c_str ());
+	}
+      monitor_output_lines (text);
+    }
+
+  if (reset)
+    packet_stats.clear ();
+}
+
 /* Read trace frame or inferior memory.  Returns the number of bytes
    actually read, zero when no further transfer is possible, and -1 on
    error.  Return of a positive value smaller than LEN does not
@@ -1189,6 +1284,240 @@ handle_search_memory (char *own_buf, int packet_len)
   free (pattern);
 }
 
+/* Parse a hex number from P into *RESULT.  Return a pointer past the
+   character SEP that must follow it, or NULL if it doesn't.  */
+
+static const char *
+unpack_hex_field (const char *p, ULONGEST *result, char sep)
+{
+  p = unpack_varlen_hex (p, result);
+  return *p == sep ? p + 1 : NULL;
+}
+
+/* Handle qMemReadV packets, which read several blocks of memory in
+   one request.  The request is either
+
+     qMemReadV:ADDR,LENGTH;ADDR,LENGTH;...
+
+   which reads each of the blocks, or
+
+     qMemReadV:follow:OFFSET,SIZE,COUNT,END:ADDR,LENGTH
+
+   which reads the block at ADDR, then the block that the SIZE-byte
+   pointer at OFFSET in it points to, and so on, up to COUNT blocks or
+   until a null pointer or a pointer to END.  The reply is 'V'
+   followed by ';' and the contents of each block read, in hex.  A
+   block that can't be read is 'E', and a block that doesn't fit in
+   the reply is cut short or left out.  */
+
+static void
+handle_read_memory_vector (char *own_buf)
+{
+  const char *p = own_buf + sizeof ("qMemReadV:") - 1;
+  std::vector<std::pair<CORE_ADDR, ULONGEST>> blocks;
+  ULONGEST offset = 0, size = 0, count = 0, end = 0;
+  bool follow = false;
+
+  if (startswith (p, "follow:"))
+    {
+      follow = true;
+      p += sizeof ("follow:") - 1;
+      if ((p = unpack_hex_field (p, &offset, ',')) == NULL
+	  || (p = unpack_hex_field (p, &size, ',')) == NULL
+	  || (p = unpack_hex_field (p, &count, ',')) == NULL
+	  || (p = unpack_hex_field (p, &end, ':')) == NULL
+	  || count == 0
+	  || (size != 1 && size != 2 && size != 4 && size != 8))
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+    }
+
+  while (*p != '\0')
+    {
+      ULONGEST addr, len;
+
+      if ((p = unpack_hex_field (p, &addr, ',')) == NULL)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      p = unpack_varlen_hex (p, &len);
+      if (*p == ';')
+	p++;
+      else if (*p != '\0')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      blocks.emplace_back (addr, len);
+    }
+
+  if (follow && (blocks.size () != 1 || offset + size > blocks[0].second))
+    {
+      write_enn (own_buf);
+      return;
+    }
+
+  /* The request is parsed; from here on OWN_BUF holds the reply.  */
+  char *out = own_buf;
+  int room = remote_max_packet_size () - 1;
+
+  *out++ = 'V';
+  room--;
+
+  for (size_t i = 0; i < blocks.size () && room > 0; i++)
+    {
+      CORE_ADDR addr = blocks[i].first;
+      int len = std::min (blocks[i].second, (ULONGEST) (room - 1) / 2);
+
+      *out++ = ';';
+      room--;
+
+      if (len == 0)
+	{
+	  if (follow)
+	    break;
+	  continue;
+	}
+      if (gdb_read_memory (addr, mem_buf, len) != len)
+	{
+	  if (room > 0)
+	    {
+	      *out++ = 'E';
+	      room--;
+	    }
+	  if (follow)
+	    break;
+	  continue;
+	}
+      out += bin2hex (mem_buf, out, len) * 2;
+      room -= len * 2;
+
+      if (!follow || len < blocks[i].second || --count == 0)
+	continue;
+
+      /* Queue the block the pointer leads to.  */
+      ULONGEST next;
+      const unsigned char *ptr = mem_buf + offset;
+
+      switch (size)
+	{
+	case 1:
+	  next = *ptr;
+	  break;
+	case 2:
+	  {
+	    uint16_t val;
+
+	    memcpy (&val, ptr, sizeof (val));
+	    next = val;
+	  }
+	  break;
+	case 4:
+	  {
+	    uint32_t val;
+
+	    memcpy (&val, ptr, sizeof (val));
+	    next = val;
+	  }
+	  break;
+	default:
+	  {
+	    uint64_t val;
+
+	    memcpy (&val, ptr, sizeof (val));
+	    next = val;
+	  }
+	  break;
+	}
+
+      if (next != 0 && next != end)
+	blocks.emplace_back (next, blocks[i].second);
+    }
+
+  *out = '\0';
+}
+
+/* Handle qAllRegisters packets, which read the registers of all the
+   stopped threads in one request.  The request is either
+
+     qAllRegisters
+
+   or, to go on from where a previous reply stopped,
+
+     qAllRegisters:THREAD-ID
+
+   which starts with the thread after THREAD-ID.  The reply is 'm', if
+   some threads did not fit in it, or 'l', followed by a ';'-separated
+   list of THREAD-ID:REGISTERS entries, where REGISTERS is as in a 'g'
+   reply.  */
+
+static void
+handle_all_registers (char *own_buf)
+{
+  const char *p = own_buf + strlen ("qAllRegisters");
+  thread_info *after = NULL;
+
+  if (*p == ':')
+    {
+      after = find_thread_ptid (read_ptid (p + 1, &p));
+      if (*p != '\0')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+    }
+  else if (*p != '\0')
+    {
+      write_enn (own_buf);
+      return;
+    }
+
+  /* The request is parsed; from here on OWN_BUF holds the reply.  */
+  char *out = own_buf + 1;
+  int room = remote_max_packet_size () - 2;
+  bool skip = after != NULL;
+  bool more = false;
+
+  for (thread_info *thread : all_threads)
+    {
+      if (skip)
+	{
+	  skip = thread != after;
+	  continue;
+	}
+
+      if (get_thread_process (thread)->tdesc == NULL
+	  || (the_target->thread_stopped != NULL && !thread_stopped (thread)))
+	continue;
+
+      char id[100];
+      int size = 2 * get_thread_process (thread)->tdesc->registers_size;
+
+      write_ptid (id, ptid_of (thread));
+      if ((int) strlen (id) + 2 + size > room)
+	{
+	  more = true;
+	  break;
+	}
+
+      if (out != own_buf + 1)
+	{
+	  *out++ = ';';
+	  room--;
+	}
+      out += sprintf (out, "%s:", id);
+      registers_to_string (get_thread_regcache (thread, 1), out);
+      out += size;
+      room -= strlen (id) + 1 + size;
+    }
+
+  own_buf[0] = more ? 'm' : 'l';
+  *out = '\0';
+}
+
 /* Handle the "D" packet.  */
 
 static void
@@ -1398,6 +1727,9 @@ handle_monitor_command (char *mon, char *own_buf)
 	  write_enn (own_buf);
 	}
     }
+  else if (strcmp (mon, "remote-stats") == 0
+	   || startswith (mon, "remote-stats "))
+    handle_remote_stats_command (mon + strlen ("remote-stats"), own_buf);
   else if (strcmp (mon, "help") == 0)
     monitor_show_help ();
   else if (strcmp (mon, "exit") == 0)
@@ -1530,6 +1862,68 @@ handle_qxfer_features (const char *annex,
   return len;
 }
 
+/* A qXfer document describing the stopped inferior.  Large documents
+   take several reads at increasing offsets, and GDB may read them
+   again before resuming; rather than generating the document for each
+   read, it is kept until the inferior runs again.  */
+
+struct qxfer_document
+{
+  /* Whether DOCUMENT is up to date.  */
+  bool valid = false;
+
+  /* The process and annex DOCUMENT was generated for.  */
+  int pid = 0;
+  std::string annex;
+
+  std::string document;
+
+  /* Return true if DOCUMENT is up to date for ANNEX of the current
+     process.  */
+  bool matches (const char *annex_) const
+  {
+    return (valid
+	    && pid == pid_of (current_thread)
+	    && annex == annex_);
+  }
+
+  /* Set DOCUMENT to DOCUMENT_, generated for ANNEX of the current
+     process.  */
+  void set (const char *annex_, std::string &&document_)
+  {
+    valid = true;
+    pid = pid_of (current_thread);
+    annex = annex_;
+    document = std::move (document_);
+  }
+
+  /* Copy up to LEN bytes of DOCUMENT at OFFSET to READBUF, as a qXfer
+     read handler does.  */
+  int read (gdb_byte *readbuf, ULONGEST offset, LONGEST len) const
+  {
+    if (offset > document.length ())
+      return -1;
+
+    if (offset + len > document.length ())
+      len = document.length () - offset;
+
+    memcpy (readbuf, document.data () + offset, len);
+    return len;
+  }
+};
+
+static qxfer_document libraries_document;
+static qxfer_document libraries_svr4_document;
+
+/* See server.h.  */
+
+void
+invalidate_qxfer_documents (void)
+{
+  libraries_document.valid = false;
+  libraries_svr4_document.valid = false;
+}
+
 /* Handle qXfer:libraries:read.  */
 
 static int
@@ -1543,24 +1937,21 @@ handle_qxfer_libraries (const char *annex,
   if (annex[0] != '\0' || current_thread == NULL)
     return -1;
 
-  std::string document = "<library-list version=\"1.0\">\n";
-
-  for (const dll_info &dll : all_dlls)
-    document += string_printf
-      ("  <library name=\"%s\"><segment address=\"0x%lx\"/></library>\n",
-       dll.name.c_str (), (long) dll.base_addr);
-
-  document += "</library-list>\n";
+  if (!libraries_document.matches (annex))
+    {
+      std::string document = "<library-list version=\"1.0\">\n";
 
-  if (offset > document.length ())
-    return -1;
+      for (const dll_info &dll : all_dlls)
+	document += string_printf
+	  ("  <library name=\"%s\"><segment address=\"0x%lx\"/></library>\n",
+	   dll.name.c_str (), (long) dll.base_addr);
 
-  if (offset + len > document.length ())
-    len = document.length () - offset;
+      document += "</library-list>\n";
 
-  memcpy (readbuf, &document[offset], len);
+      libraries_document.set (annex, std::move (document));
+    }
 
-  return len;
+  return libraries_document.read (readbuf, offset, len);
 }
 
 /* Handle qXfer:libraries-svr4:read.  */
@@ -1576,7 +1967,26 @@ handle_qxfer_libraries_svr4 (const char *annex,
   if (current_thread == NULL || the_target->qxfer_libraries_svr4 == NULL)
     return -1;
 
-  return the_target->qxfer_libraries_svr4 (annex, readbuf, writebuf, offset, len);
+  if (!libraries_svr4_document.matches (annex))
+    {
+      /* Generating the list walks the dynamic linker's data in the
+	 inferior's memory; do it once, reading the whole list.  */
+      gdb::byte_vector buf (PBUFSIZ);
+      int ret;
+
+      while ((ret = the_target->qxfer_libraries_svr4 (annex, buf.data (),
+						      NULL, 0, buf.size ()))
+	     == (int) buf.size ())
+	buf.resize (buf.size () * 2);
+
+      if (ret < 0)
+	return ret;
+
+      libraries_svr4_document.set (annex,
+				   std::string ((char *) buf.data (), ret));
+    }
+
+  return libraries_svr4_document.read (readbuf, offset, len);
 }
 
 /* Handle qXfer:osadata:read.  */
@@ -1648,16 +2058,30 @@ handle_qxfer_statictrace (const char *annex,
 }
 
 /* Helper for handle_qxfer_threads_proper.
-   Emit the XML to describe the thread of INF.  */
+   Emit the XML to describe the thread of INF.  If SINCE is not NULL,
+   only do so if the thread was added after generation *SINCE or its
+   name changed since it was last sent.  */
 
 static void
-handle_qxfer_threads_worker (thread_info *thread, struct buffer *buffer)
+handle_qxfer_threads_worker (thread_info *thread, struct buffer *buffer,
+			     const ULONGEST *since)
 {
   ptid_t ptid = ptid_of (thread);
+  const char *name = target_thread_name (ptid);
+
+  if (since != NULL && thread->generation <= *since
+      && (name == NULL
+	  ? thread->reported_name == NULL
+	  : (thread->reported_name != NULL
+	     && strcmp (name, thread->reported_name) == 0)))
+    return;
+
+  xfree (thread->reported_name);
+  thread->reported_name = name != NULL ? xstrdup (name) : NULL;
+
   char ptid_s[100];
   int core = target_core_of_thread (ptid);
   char core_s[21];
-  const char *name = target_thread_name (ptid);
   int handle_len;
   gdb_byte *handle;
   bool handle_status = target_thread_handle (ptid, &handle, &handle_len);
@@ -1685,18 +2109,38 @@ handle_qxfer_threads_worker (thread_info *thread, struct buffer *buffer)
   buffer_xml_printf (buffer, "/>\n");
 }
 
-/* Helper for handle_qxfer_threads.  */
+/* Helper for handle_qxfer_threads.  If SINCE is not NULL, describe
+   only the changes to the thread list since generation *SINCE, if
+   they are all known.  */
 
 static void
-handle_qxfer_threads_proper (struct buffer *buffer)
+handle_qxfer_threads_proper (struct buffer *buffer, const ULONGEST *since)
 {
-  buffer_grow_str (buffer, "<threads>\n");
+  std::vector<ptid_t> exited;
+
+  if (since != NULL && !threads_exited_since (*since, &exited))
+    since = NULL;
+
+  buffer_xml_printf (buffer, "<threads generation=\"%s\"",
+		     pulongest (thread_list_generation));
+  if (since != NULL)
+    buffer_xml_printf (buffer, " since=\"%s\" count=\"%s\"",
+		       pulongest (*since), pulongest (all_threads.size ()));
+  buffer_grow_str (buffer, ">\n");
 
   for_each_thread ([&] (thread_info *thread)
     {
-      handle_qxfer_threads_worker (thread, buffer);
+      handle_qxfer_threads_worker (thread, buffer, since);
     });
 
+  for (ptid_t ptid : exited)
+    {
+      char ptid_s[100];
+
+      write_ptid (ptid_s, ptid);
+      buffer_xml_printf (buffer, "<exited id=\"%s\"/>\n", ptid_s);
+    }
+
   buffer_grow_str0 (buffer, "</threads>\n");
 }
 
@@ -1713,6 +2157,17 @@ handle_qxfer_threads (const char *annex,
   if (writebuf != NULL)
     return -2;
 
+  /* The annex is either empty, asking for the whole thread list, or
+     "since=GENERATION", asking only for the changes since GENERATION
+     (in hex).  */
+  ULONGEST since;
+  bool delta = false;
+
+  if (startswith (annex, "since="))
+    {
+      annex = unpack_varlen_hex (annex + strlen ("since="), &since);
+      delta = true;
+    }
   if (annex[0] != '\0')
     return -1;
 
@@ -1726,7 +2181,7 @@ handle_qxfer_threads (const char *annex,
 
       buffer_init (&buffer);
 
-      handle_qxfer_threads_proper (&buffer);
+      handle_qxfer_threads_proper (&buffer, delta ? &since : NULL);
 
       result = buffer_finish (&buffer);
       result_length = strlen (result);
@@ -2345,6 +2800,12 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 		}
 	      else if (strcmp (p, "vContSupported+") == 0)
 		cs.vCont_supported = 1;
+	      else if (strcmp (p, "compression+") == 0)
+		{
+		  /* GDB accepts compressed packets from now on, this
+		     reply included.  */
+		  cs.compression_feature = 1;
+		}
 	      else if (strcmp (p, "QThreadEvents+") == 0)
 		;
 	      else if (strcmp (p, "no-resumed+") == 0)
@@ -2376,14 +2837,15 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	       "QStartupWithShell+;QEnvironmentHexEncoded+;"
 	       "QEnvironmentReset+;QEnvironmentUnset+;"
 	       "QSetWorkingDir+",
-	       PBUFSIZ - 1);
+	       remote_max_packet_size () - 1);
 
       if (target_supports_catch_syscall ())
 	strcat (own_buf, ";QCatchSyscalls+");
 
       if (the_target->qxfer_libraries_svr4 != NULL)
 	strcat (own_buf, ";qXfer:libraries-svr4:read+"
-		";augmented-libraries-svr4-read+");
+		";augmented-libraries-svr4-read+"
+		";compact-libraries-svr4+");
       else
 	{
 	  /* We do not have any hook to indicate whether the non-SVR4 target
@@ -2434,6 +2896,7 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	strcat (own_buf, ";QDisableRandomization+");
 
       strcat (own_buf, ";qXfer:threads:read+");
+      strcat (own_buf, ";thread-list-delta+");
 
       if (target_supports_tracepoints ())
 	{
@@ -2479,6 +2942,14 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 
       strcat (own_buf, ";no-resumed+");
 
+      strcat (own_buf, ";binary-upload+");
+
+      strcat (own_buf, ";qMemReadV+");
+
+      strcat (own_buf, ";qAllRegisters+");
+
+      strcat (own_buf, ";compression+");
+
       /* Reinitialize components as needed for the new connection.  */
       hostio_handle_new_gdb_connection ();
       target_handle_new_gdb_connection ();
@@ -2577,8 +3048,8 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
   /* Handle "monitor" commands.  */
   if (startswith (own_buf, "qRcmd,"))
     {
-      char *mon = (char *) malloc (PBUFSIZ);
       int len = strlen (own_buf + 6);
+      char *mon = (char *) malloc (len / 2 + 1);
 
       if (mon == NULL)
 	{
@@ -2606,6 +3077,21 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       return;
     }
 
+  if (startswith (own_buf, "qMemReadV:"))
+    {
+      require_running_or_return (own_buf);
+      handle_read_memory_vector (own_buf);
+      return;
+    }
+
+  if (strcmp (own_buf, "qAllRegisters") == 0
+      || startswith (own_buf, "qAllRegisters:"))
+    {
+      require_running_or_return (own_buf);
+      handle_all_registers (own_buf);
+      return;
+    }
+
   if (startswith (own_buf, "qSearch:memory:"))
     {
       require_running_or_return (own_buf);
@@ -2867,6 +3353,7 @@ resume (struct thread_resume *actions, size_t num_actions)
       enable_async_io ();
     }
 
+  invalidate_qxfer_documents ();
   (*the_target->resume) (actions, num_actions);
 
   if (non_stop)
@@ -3782,7 +4269,7 @@ captured_main (int argc, char *argv[])
     initialize_tracepoint ();
   initialize_notif ();
 
-  mem_buf = (unsigned char *) xmalloc (PBUFSIZ);
+  mem_buf = (unsigned char *) xmalloc (MAX_PBUFSIZ);
 
   if (selftest)
     {
@@ -3853,6 +4340,8 @@ captured_main (int argc, char *argv[])
       cs.swbreak_feature = 0;
       cs.hwbreak_feature = 0;
       cs.vCont_supported = 0;
+      cs.compression_feature = 0;
+      last_packet_done = rsp_clock::time_point ();
 
       remote_open (port);
 
@@ -4032,6 +4521,8 @@ process_serial_event (void)
   unsigned char sig;
   int packet_len;
   int new_packet_len = -1;
+  ULONGEST bytes_in = remote_bytes_in;
+  ULONGEST bytes_out = remote_bytes_out;
 
   disable_async_io ();
 
@@ -4045,6 +4536,9 @@ process_serial_event (void)
     }
   response_needed = 1;
 
+  rsp_clock::time_point start = rsp_clock::now ();
+  std::string packet_type = rsp_packet_type (cs.own_buf, packet_len);
+
   char ch = cs.own_buf[0];
   switch (ch)
     {
@@ -4173,12 +4667,26 @@ process_serial_event (void)
     case 'm':
       require_running_or_break (cs.own_buf);
       decode_m_packet (&cs.own_buf[1], &mem_addr, &len);
+      /* Return a short read if the reply wouldn't fit.  */
+      if (len > MAX_PBUFSIZ / 2)
+	len = MAX_PBUFSIZ / 2;
       res = gdb_read_memory (mem_addr, mem_buf, len);
       if (res < 0)
 	write_enn (cs.own_buf);
       else
 	bin2hex (mem_buf, cs.own_buf, res);
       break;
+    case 'x':
+      require_running_or_break (cs.own_buf);
+      decode_m_packet (&cs.own_buf[1], &mem_addr, &len);
+      if (len > MAX_PBUFSIZ)
+	len = MAX_PBUFSIZ;
+      res = gdb_read_memory (mem_addr, mem_buf, len);
+      if (res < 0)
+	write_enn (cs.own_buf);
+      else
+	new_packet_len = write_binary_memory (cs.own_buf, mem_buf, res);
+      break;
     case 'M':
       require_running_or_break (cs.own_buf);
       decode_M_packet (&cs.own_buf[1], &mem_addr, &len, &mem_buf);
@@ -4373,6 +4881,22 @@ process_serial_event (void)
 
   response_needed = 0;
 
+  /* Look the statistics up only now, as the packet may have reset
+     them.  */
+  rsp_packet_stats &stats = packet_stats[packet_type];
+  rsp_clock::time_point now = rsp_clock::now ();
+  rsp_clock::duration idle {};
+
+  if (last_packet_done != rsp_clock::time_point ())
+    idle = start - last_packet_done;
+
+  stats.count++;
+  stats.replies++;
+  stats.bytes_in += remote_bytes_in - bytes_in;
+  stats.bytes_out += remote_bytes_out - bytes_out;
+  stats.add_latency (now - start, idle);
+  last_packet_done = now;
+
   if (exit_requested)
     return -1;
 
@@ -100,6 +100,10 @@ extern void discard_queued_stop_replies (ptid_t ptid);
    the vStopped notifications queue.  */
 extern int in_queued_stop_replies (ptid_t ptid);
 
+/* Forget the qXfer documents kept since the inferior last stopped.
+   Called when it runs again or its memory is written.  */
+extern void invalidate_qxfer_documents (void);
+
 #include "remote-utils.h"
 
 #include "utils.h"
@@ -115,6 +119,12 @@ extern int in_queued_stop_replies (ptid_t ptid);
    as large as the largest register set supported by gdbserver.  */
 #define PBUFSIZ 18432
 
+/* Size of the packet buffers.  Over reliable connections (TCP or
+   stdio), where a large packet costs little more than a small one,
+   gdbserver advertises this rather than PBUFSIZ as its PacketSize, so
+   that GDB transfers memory in fewer packets.  */
+#define MAX_PBUFSIZ (256 * 1024)
+
 /* Definition for an unknown syscall, used basically in error-cases.  */
 #define UNKNOWN_SYSCALL (-1)
 
@@ -139,7 +149,7 @@ extern unsigned long signal_pid;
 struct client_state
 {
   client_state ():
-    own_buf ((char *) xmalloc (PBUFSIZ + 1)) 
+    own_buf ((char *) xmalloc (MAX_PBUFSIZ + 1)) 
   {}
 
   /* The thread set with an `Hc' packet.  `Hc' is deprecated in favor of
@@ -174,6 +184,10 @@ struct client_state
      "vCont?" packet.  */
   int vCont_supported = 0;
 
+  /* True if the "compression+" feature is active.  In that case, we
+     may send and receive compressed packets.  */
+  int compression_feature = 0;
+
   /* Whether we should attempt to disable the operating system's address
      space randomization feature before starting an inferior.  */
   int disable_randomization = 1;
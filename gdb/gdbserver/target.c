@@ -162,6 +162,7 @@ write_inferior_memory (CORE_ADDR memaddr, const unsigned char *myaddr,
   buffer = (unsigned char *) xmalloc (len);
   memcpy (buffer, myaddr, len);
   check_mem_write (memaddr, buffer, myaddr, len);
+  invalidate_qxfer_documents ();
   res = (*the_target->write_memory) (memaddr, buffer, len);
   free (buffer);
   buffer = NULL;
@@ -187,6 +188,7 @@ mywait (ptid_t ptid, struct target_waitstatus *ourstatus, int options,
     server_waiting = 1;
 
   ret = target_wait (ptid, ourstatus, options);
+  invalidate_qxfer_documents ();
 
   /* We don't expose _LOADED events to gdbserver core.  See the
      `dlls_changed' global.  */
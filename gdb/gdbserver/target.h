@@ -383,7 +383,9 @@ struct target_ops
      for use as a fast tracepoint.  */
   int (*get_min_fast_tracepoint_insn_len) (void);
 
-  /* Read solib info on SVR4 platforms.  */
+  /* Read solib info on SVR4 platforms.  Targets implementing this
+     must also honor the "compact" annex key, as GDBserver advertises
+     compact-libraries-svr4 support for them.  */
   int (*qxfer_libraries_svr4) (const char *annex, unsigned char *readbuf,
 			       unsigned const char *writebuf,
 			       CORE_ADDR offset, int len);
@@ -864,7 +864,9 @@ static const char *eval_result_names[] =
     "terror:stack underflow",
     "terror:unhandled opcode",
     "terror:unrecognized opcode",
-    "terror:divide by zero"
+    "terror:divide by zero",
+    "terror:invalid goto",
+    "terror:malformed expression"
   };
 
 #endif
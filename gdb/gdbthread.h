@@ -33,6 +33,7 @@ struct symtab;
 #include "cli/cli-utils.h"
 #include "common/refcounted-object.h"
 #include "common-gdbthread.h"
+#include "common/function-view.h"
 
 /* Frontend view of the thread state.  Possible extensions: stepping,
    finishing, until(ling),...  */
@@ -475,6 +476,12 @@ void thread_change_ptid (ptid_t old_ptid, ptid_t new_ptid);
 typedef int (*thread_callback_func) (struct thread_info *, void *);
 extern struct thread_info *iterate_over_threads (thread_callback_func, void *);
 
+/* Call FN once for each live thread, in ascending thread ID order if
+   ASCENDING, else in descending order, with that thread selected.
+   The selected thread and frame are restored afterwards.  */
+extern void iterate_over_live_threads_ordered
+  (bool ascending, gdb::function_view<void (thread_info *)> fn);
+
 /* Traverse all threads.  */
 #define ALL_THREADS(T)				\
   for (T = thread_list; T; T = T->next)		\
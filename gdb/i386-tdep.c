@@ -62,8 +62,10 @@
 #include "cli/cli-utils.h"
 #include "expression.h"
 #include "parser-defs.h"
+#include "observable.h"
 #include <ctype.h>
 #include <algorithm>
+#include <map>
 
 /* Register names.  */
 
@@ -4636,6 +4638,54 @@ enum
   OP_CMPL,
 };
 
+/* A memory operand of a recorded instruction.  Its address is DISP
+   plus the values of the raw registers BASE and INDEX (the latter
+   shifted left by SCALE), truncated to WIDTH bits.  BASE and INDEX
+   are -1 if unused.  */
+
+struct i386_record_addr
+{
+  int base;
+  int index;
+  int scale;
+  ULONGEST disp;
+  int width;
+};
+
+/* One change that an instruction makes: raw register REGNUM, or if
+   REGNUM is -1, LEN bytes of memory at ADDR.  */
+
+struct i386_record_op
+{
+  int regnum;
+  struct i386_record_addr addr;
+  int len;
+};
+
+/* What the decoder found out about an instruction of GDBARCH in
+   address space ASPACE.  Recording the instruction again only needs
+   to record OPS, in order.  */
+
+struct i386_record_template
+{
+  struct gdbarch *gdbarch;
+  const struct address_space *aspace;
+  std::vector<struct i386_record_op> ops;
+};
+
+/* The templates of the instructions recorded so far, by address.
+   While the inferior is being recorded, it can only change its code
+   with recorded instructions and system calls, which forget the
+   templates they may overwrite.  GDB's own writes to memory, and
+   changes to the objfiles or the inferior, are handled by the
+   observers below.  */
+
+static std::map<CORE_ADDR, struct i386_record_template>
+  i386_record_templates;
+
+/* Forget all the templates when there are this many.  */
+#define I386_RECORD_TEMPLATES_MAX 65536
+
 struct i386_record_s
 {
   struct gdbarch *gdbarch;
@@ -4653,17 +4703,148 @@ struct i386_record_s
   int rip_offset;
   int popl_esp_hack;
   const int *regmap;
+
+  /* The first INSN_LEN bytes at ORIG_ADDR, read at once.  */
+  gdb_byte insn[I386_MAX_INSN_LEN];
+  int insn_len;
+
+  /* The changes recorded so far, and whether they only depend on the
+     instruction, so that they can be used as a template.  */
+  struct i386_record_template *tmpl;
+  bool cacheable;
 };
 
+/* Read LEN bytes of the instruction being recorded at ADDR into BUF.
+   Returns -1 if something goes wrong, 0 otherwise.  */
+
+static int
+i386_record_read_insn (struct i386_record_s *irp, CORE_ADDR addr,
+		       gdb_byte *buf, int len)
+{
+  CORE_ADDR offset = addr - irp->orig_addr;
+
+  if (offset + len <= irp->insn_len)
+    {
+      memcpy (buf, irp->insn + offset, len);
+      return 0;
+    }
+
+  return record_read_memory (irp->gdbarch, addr, buf, len);
+}
+
+/* Forget the templates of the instructions that overlap the LEN
+   bytes at ADDR.  */
+
+static void
+i386_record_templates_invalidate (CORE_ADDR addr, ULONGEST len)
+{
+  CORE_ADDR lo = addr < I386_MAX_INSN_LEN ? 0 : addr - I386_MAX_INSN_LEN + 1;
+  auto first = i386_record_templates.lower_bound (lo);
+  auto last = i386_record_templates.lower_bound (addr + len);
+
+  if (addr + len < addr)
+    last = i386_record_templates.end ();
+  i386_record_templates.erase (first, last);
+}
+
+/* Note that the instruction recorded by IRP writes LEN bytes at ADDR.
+   An instruction that overwrites itself can't be used as a
+   template.  */
+
+static void
+i386_record_write (struct i386_record_s *irp, CORE_ADDR addr, int len)
+{
+  if (addr < irp->orig_addr + I386_MAX_INSN_LEN
+      && irp->orig_addr < addr + len)
+    irp->cacheable = false;
+  i386_record_templates_invalidate (addr, len);
+}
+
+/* Read raw register REGNUM into *VAL.  The changes of an instruction
+   that depend on register values can't be used as a template.  */
+
+static void
+i386_record_read_reg (struct i386_record_s *irp, int regnum, ULONGEST *val)
+{
+  irp->cacheable = false;
+  regcache_raw_read_unsigned (irp->regcache, regnum, val);
+}
+
+/* Record the value of raw register REGNUM.  Returns -1 if something
+   goes wrong, 0 otherwise.  */
+
+static int
+i386_record_reg (struct i386_record_s *irp, int regnum)
+{
+  struct i386_record_op op;
+
+  op.regnum = regnum;
+  irp->tmpl->ops.push_back (op);
+  return record_full_arch_list_add_reg (irp->regcache, regnum);
+}
+
+/* Record LEN bytes of memory at ADDR, where ADDR was computed from
+   register values.  Returns -1 if something goes wrong, 0
+   otherwise.  */
+
+static int
+i386_record_mem (struct i386_record_s *irp, CORE_ADDR addr, int len)
+{
+  irp->cacheable = false;
+  i386_record_write (irp, addr, len);
+  return record_full_arch_list_add_mem (addr, len);
+}
+
+/* Return the address of the memory operand ADDR in REGCACHE.  */
+
+static ULONGEST
+i386_record_addr_value (struct regcache *regcache,
+			const struct i386_record_addr *addr)
+{
+  ULONGEST value = addr->disp;
+  ULONGEST reg;
+
+  if (addr->base >= 0)
+    {
+      regcache_raw_read_unsigned (regcache, addr->base, &reg);
+      value += reg;
+    }
+  if (addr->index >= 0)
+    {
+      regcache_raw_read_unsigned (regcache, addr->index, &reg);
+      value += reg << addr->scale;
+    }
+  if (addr->width < 64)
+    value &= ((ULONGEST) 1 << addr->width) - 1;
+
+  return value;
+}
+
+/* Record LEN bytes of memory at the operand ADDR.  Returns -1 if
+   something goes wrong, 0 otherwise.  */
+
+static int
+i386_record_mem_at (struct i386_record_s *irp,
+		    const struct i386_record_addr *addr, int len)
+{
+  ULONGEST value = i386_record_addr_value (irp->regcache, addr);
+  struct i386_record_op op;
+
+  op.regnum = -1;
+  op.addr = *addr;
+  op.len = len;
+  irp->tmpl->ops.push_back (op);
+  i386_record_write (irp, value, len);
+  return record_full_arch_list_add_mem (value, len);
+}
+
 /* Parse the "modrm" part of the memory address irp->addr points at.
    Returns -1 if something goes wrong, 0 otherwise.  */
 
 static int
 i386_record_modrm (struct i386_record_s *irp)
 {
-  struct gdbarch *gdbarch = irp->gdbarch;
-
-  if (record_read_memory (gdbarch, irp->addr, &irp->modrm, 1))
+  if (i386_record_read_insn (irp, irp->addr, &irp->modrm, 1))
     return -1;
 
   irp->addr++;
@@ -4674,18 +4855,21 @@ i386_record_modrm (struct i386_record_s *irp)
   return 0;
 }
 
-/* Extract the memory address that the current instruction writes to,
-   and return it in *ADDR.  Return -1 if something goes wrong.  */
+/* Parse the memory operand of the current instruction, and return it
+   in *ADDR.  Return -1 if something goes wrong.  */
 
 static int
-i386_record_lea_modrm_addr (struct i386_record_s *irp, uint64_t *addr)
+i386_record_lea_modrm_operand (struct i386_record_s *irp,
+			       struct i386_record_addr *addr)
 {
   struct gdbarch *gdbarch = irp->gdbarch;
   enum bfd_endian byte_order = gdbarch_byte_order (gdbarch);
   gdb_byte buf[4];
-  ULONGEST offset64;
 
-  *addr = 0;
+  addr->base = -1;
+  addr->index = -1;
+  addr->scale = 0;
+  addr->disp = 0;
   if (irp->aflag || irp->regmap[X86_RECORD_R8_REGNUM])
     {
       /* 32/64 bits */
@@ -4698,7 +4882,7 @@ i386_record_lea_modrm_addr (struct i386_record_s *irp, uint64_t *addr)
       if (base == 4)
 	{
 	  havesib = 1;
-	  if (record_read_memory (gdbarch, irp->addr, &byte, 1))
+	  if (i386_record_read_insn (irp, irp->addr, &byte, 1))
 	    return -1;
 	  irp->addr++;
 	  scale = (byte >> 6) & 3;
@@ -4713,161 +4897,112 @@ i386_record_lea_modrm_addr (struct i386_record_s *irp, uint64_t *addr)
 	  if ((base & 7) == 5)
 	    {
 	      base = 0xff;
-	      if (record_read_memory (gdbarch, irp->addr, buf, 4))
+	      if (i386_record_read_insn (irp, irp->addr, buf, 4))
 		return -1;
 	      irp->addr += 4;
-	      *addr = extract_signed_integer (buf, 4, byte_order);
+	      addr->disp = extract_signed_integer (buf, 4, byte_order);
 	      if (irp->regmap[X86_RECORD_R8_REGNUM] && !havesib)
-		*addr += irp->addr + irp->rip_offset;
+		addr->disp += irp->addr + irp->rip_offset;
 	    }
 	  break;
 	case 1:
-	  if (record_read_memory (gdbarch, irp->addr, buf, 1))
+	  if (i386_record_read_insn (irp, irp->addr, buf, 1))
 	    return -1;
 	  irp->addr++;
-	  *addr = (int8_t) buf[0];
+	  addr->disp = (int8_t) buf[0];
 	  break;
 	case 2:
-	  if (record_read_memory (gdbarch, irp->addr, buf, 4))
+	  if (i386_record_read_insn (irp, irp->addr, buf, 4))
 	    return -1;
-	  *addr = extract_signed_integer (buf, 4, byte_order);
+	  addr->disp = extract_signed_integer (buf, 4, byte_order);
 	  irp->addr += 4;
 	  break;
 	}
 
-      offset64 = 0;
       if (base != 0xff)
         {
 	  if (base == 4 && irp->popl_esp_hack)
-	    *addr += irp->popl_esp_hack;
-	  regcache_raw_read_unsigned (irp->regcache, irp->regmap[base],
-                                      &offset64);
+	    addr->disp += irp->popl_esp_hack;
+	  addr->base = irp->regmap[base];
 	}
-      if (irp->aflag == 2)
-        {
-	  *addr += offset64;
-        }
-      else
-        *addr = (uint32_t) (offset64 + *addr);
 
       if (havesib && (index != 4 || scale != 0))
 	{
-	  regcache_raw_read_unsigned (irp->regcache, irp->regmap[index],
-                                      &offset64);
-	  if (irp->aflag == 2)
-	    *addr += offset64 << scale;
-	  else
-	    *addr = (uint32_t) (*addr + (offset64 << scale));
+	  addr->index = irp->regmap[index];
+	  addr->scale = scale;
 	}
 
-      if (!irp->aflag)
-	{
-	  /* Since we are in 64-bit mode with ADDR32 prefix, zero-extend
-	     address from 32-bit to 64-bit.  */
-	    *addr = (uint32_t) *addr;
-	}
+      /* Without the 64-bit address size, the address wraps around at
+	 32 bits; in 64-bit mode with ADDR32 prefix, it is then
+	 zero-extended to 64 bits.  */
+      addr->width = irp->aflag == 2 ? 64 : 32;
     }
   else
     {
       /* 16 bits */
+      static const int base_regs[8] =
+	{
+	  X86_RECORD_REBX_REGNUM, X86_RECORD_REBX_REGNUM,
+	  X86_RECORD_REBP_REGNUM, X86_RECORD_REBP_REGNUM,
+	  X86_RECORD_RESI_REGNUM, X86_RECORD_REDI_REGNUM,
+	  X86_RECORD_REBP_REGNUM, X86_RECORD_REBX_REGNUM
+	};
+      static const int index_regs[8] =
+	{
+	  X86_RECORD_RESI_REGNUM, X86_RECORD_REDI_REGNUM,
+	  X86_RECORD_RESI_REGNUM, X86_RECORD_REDI_REGNUM,
+	  -1, -1, -1, -1
+	};
+
       switch (irp->mod)
 	{
 	case 0:
 	  if (irp->rm == 6)
 	    {
-	      if (record_read_memory (gdbarch, irp->addr, buf, 2))
+	      if (i386_record_read_insn (irp, irp->addr, buf, 2))
 		return -1;
 	      irp->addr += 2;
-	      *addr = extract_signed_integer (buf, 2, byte_order);
+	      addr->disp = extract_signed_integer (buf, 2, byte_order);
+	      addr->width = 64;
 	      irp->rm = 0;
-	      goto no_rm;
+	      return 0;
 	    }
 	  break;
 	case 1:
-	  if (record_read_memory (gdbarch, irp->addr, buf, 1))
+	  if (i386_record_read_insn (irp, irp->addr, buf, 1))
 	    return -1;
 	  irp->addr++;
-	  *addr = (int8_t) buf[0];
+	  addr->disp = (int8_t) buf[0];
 	  break;
 	case 2:
-	  if (record_read_memory (gdbarch, irp->addr, buf, 2))
+	  if (i386_record_read_insn (irp, irp->addr, buf, 2))
 	    return -1;
 	  irp->addr += 2;
-	  *addr = extract_signed_integer (buf, 2, byte_order);
+	  addr->disp = extract_signed_integer (buf, 2, byte_order);
 	  break;
 	}
 
-      switch (irp->rm)
-	{
-	case 0:
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REBX_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_RESI_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  break;
-	case 1:
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REBX_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REDI_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  break;
-	case 2:
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REBP_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_RESI_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  break;
-	case 3:
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REBP_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REDI_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  break;
-	case 4:
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_RESI_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  break;
-	case 5:
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REDI_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  break;
-	case 6:
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REBP_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  break;
-	case 7:
-	  regcache_raw_read_unsigned (irp->regcache,
-				      irp->regmap[X86_RECORD_REBX_REGNUM],
-                                      &offset64);
-	  *addr = (uint32_t) (*addr + offset64);
-	  break;
-	}
-      *addr &= 0xffff;
+      addr->base = irp->regmap[base_regs[irp->rm]];
+      if (index_regs[irp->rm] >= 0)
+	addr->index = irp->regmap[index_regs[irp->rm]];
+      addr->width = 16;
     }
 
- no_rm:
+  return 0;
+}
+
+/* Extract the memory address that the current instruction writes to,
+   and return it in *ADDR.  Return -1 if something goes wrong.  */
+
+static int
+i386_record_lea_modrm_addr (struct i386_record_s *irp, uint64_t *addr)
+{
+  struct i386_record_addr operand;
+
+  if (i386_record_lea_modrm_operand (irp, &operand))
+    return -1;
+
+  *addr = i386_record_addr_value (irp->regcache, &operand);
   return 0;
 }
 
@@ -4879,10 +5014,11 @@ static int
 i386_record_lea_modrm (struct i386_record_s *irp)
 {
   struct gdbarch *gdbarch = irp->gdbarch;
-  uint64_t addr;
+  struct i386_record_addr operand;
 
   if (irp->override >= 0)
     {
+      irp->cacheable = false;
       if (record_full_memory_query)
         {
           if (yquery (_("\
@@ -4896,10 +5032,10 @@ Do you want to stop the program?"),
       return 0;
     }
 
-  if (i386_record_lea_modrm_addr (irp, &addr))
+  if (i386_record_lea_modrm_operand (irp, &operand))
     return -1;
 
-  if (record_full_arch_list_add_mem (addr, 1 << irp->ot))
+  if (i386_record_mem_at (irp, &operand, 1 << irp->ot))
     return -1;
 
   return 0;
@@ -4911,20 +5047,127 @@ Do you want to stop the program?"),
 static int
 i386_record_push (struct i386_record_s *irp, int size)
 {
-  ULONGEST addr;
+  struct i386_record_addr operand;
 
-  if (record_full_arch_list_add_reg (irp->regcache,
-				     irp->regmap[X86_RECORD_RESP_REGNUM]))
+  if (i386_record_reg (irp, irp->regmap[X86_RECORD_RESP_REGNUM]))
     return -1;
-  regcache_raw_read_unsigned (irp->regcache,
-			      irp->regmap[X86_RECORD_RESP_REGNUM],
-			      &addr);
-  if (record_full_arch_list_add_mem ((CORE_ADDR) addr - size, size))
+
+  operand.base = irp->regmap[X86_RECORD_RESP_REGNUM];
+  operand.index = -1;
+  operand.scale = 0;
+  operand.disp = -size;
+  operand.width = 64;
+  if (i386_record_mem_at (irp, &operand, size))
+    return -1;
+
+  return 0;
+}
+
+/* Look for the template of the instruction at ADDR in REGCACHE's
+   address space.  Return NULL if there is none.  */
+
+static const struct i386_record_template *
+i386_record_template_lookup (struct regcache *regcache, CORE_ADDR addr)
+{
+  auto it = i386_record_templates.find (addr);
+
+  if (it == i386_record_templates.end ()
+      || it->second.gdbarch != regcache->arch ()
+      || it->second.aspace != regcache->aspace ())
+    return NULL;
+
+  return &it->second;
+}
+
+/* Remember the changes that IRP recorded as the template of its
+   instruction, if they only depend on the instruction bytes.  */
+
+static void
+i386_record_template_save (struct i386_record_s *irp)
+{
+  if (!irp->cacheable)
+    return;
+
+  if (i386_record_templates.size () >= I386_RECORD_TEMPLATES_MAX)
+    i386_record_templates.clear ();
+
+  struct i386_record_template &tmpl = i386_record_templates[irp->orig_addr];
+
+  tmpl.gdbarch = irp->gdbarch;
+  tmpl.aspace = irp->regcache->aspace ();
+  tmpl.ops = std::move (irp->tmpl->ops);
+}
+
+/* Record the changes of the instruction described by TMPL, in
+   REGCACHE.  Returns -1 if something goes wrong, 0 otherwise.  */
+
+static int
+i386_record_template_replay (struct regcache *regcache,
+			     const struct i386_record_template *tmpl)
+{
+  CORE_ADDR lo = 0, hi = 0;
+
+  for (const struct i386_record_op &op : tmpl->ops)
+    {
+      if (op.regnum >= 0)
+	{
+	  if (record_full_arch_list_add_reg (regcache, op.regnum))
+	    return -1;
+	}
+      else
+	{
+	  ULONGEST addr = i386_record_addr_value (regcache, &op.addr);
+
+	  if (record_full_arch_list_add_mem (addr, op.len))
+	    return -1;
+	  if (lo == hi || addr < lo)
+	    lo = addr;
+	  if (lo == hi || addr + op.len > hi)
+	    hi = addr + op.len;
+	}
+    }
+
+  /* This may forget TMPL itself.  */
+  if (lo != hi)
+    i386_record_templates_invalidate (lo, hi - lo);
+
+  if (record_full_arch_list_add_end ())
     return -1;
 
   return 0;
 }
 
+/* Forget the templates that GDB's writes to the inferior's memory
+   may have overwritten.  */
+
+static void
+i386_record_templates_memory_written (CORE_ADDR addr, ULONGEST len)
+{
+  i386_record_templates_invalidate (addr, len);
+}
+
+/* Forget all the templates when code may have been loaded or unloaded,
+   and when process record starts or stops, since the inferior may have
+   changed its code in the meantime.  */
+
+static void
+i386_record_templates_objfile_changed (struct objfile *objfile)
+{
+  i386_record_templates.clear ();
+}
+
+static void
+i386_record_templates_inferior_exit (struct inferior *inf)
+{
+  i386_record_templates.clear ();
+}
+
+static void
+i386_record_templates_record_changed (struct inferior *inf, int started,
+				      const char *method, const char *format)
+{
+  i386_record_templates.clear ();
+}
 
 /* Defines contents to record.  */
 #define I386_SAVE_FPU_REGS              0xfffd
@@ -4951,7 +5194,7 @@ static int i386_record_floats (struct gdbarch *gdbarch,
     {
       for (i = I387_ST0_REGNUM (tdep); i <= I387_ST0_REGNUM (tdep) + 7; i++)
         {
-          if (record_full_arch_list_add_reg (ir->regcache, i))
+          if (i386_record_reg (ir, i))
             return -1;
         }
     }
@@ -4959,7 +5202,7 @@ static int i386_record_floats (struct gdbarch *gdbarch,
     {
       for (i = I387_FCTRL_REGNUM (tdep); i <= I387_FOP_REGNUM (tdep); i++)
 	      {
-	      if (record_full_arch_list_add_reg (ir->regcache, i))
+	      if (i386_record_reg (ir, i))
 	        return -1;
 	      }
     }
@@ -4967,14 +5210,14 @@ static int i386_record_floats (struct gdbarch *gdbarch,
     {
       for (i = I387_ST0_REGNUM (tdep); i <= I387_FOP_REGNUM (tdep); i++)
       {
-        if (record_full_arch_list_add_reg (ir->regcache, i))
+        if (i386_record_reg (ir, i))
           return -1;
       }
     }
   else if ((iregnum >= I387_ST0_REGNUM (tdep)) &&
            (iregnum <= I387_FOP_REGNUM (tdep)))
     {
-      if (record_full_arch_list_add_reg (ir->regcache,iregnum))
+      if (i386_record_reg (ir,iregnum))
         return -1;
     }
   else
@@ -4986,7 +5229,7 @@ static int i386_record_floats (struct gdbarch *gdbarch,
     {
     for (i = I387_FCTRL_REGNUM (tdep); i <= I387_FOP_REGNUM (tdep); i++)
       {
-      if (record_full_arch_list_add_reg (ir->regcache, i))
+      if (i386_record_reg (ir, i))
         return -1;
       }
     }
@@ -4998,7 +5241,7 @@ static int i386_record_floats (struct gdbarch *gdbarch,
    instruction.  Returns -1 if something goes wrong, 0 otherwise.  */
 
 #define I386_RECORD_FULL_ARCH_LIST_ADD_REG(regnum) \
-    record_full_arch_list_add_reg (ir.regcache, ir.regmap[(regnum)])
+    i386_record_reg (&ir, ir.regmap[(regnum)])
 
 int
 i386_process_record (struct gdbarch *gdbarch, struct regcache *regcache,
@@ -5012,6 +5255,8 @@ i386_process_record (struct gdbarch *gdbarch, struct regcache *regcache,
   ULONGEST addr;
   gdb_byte buf[I386_MAX_REGISTER_SIZE];
   struct i386_record_s ir;
+  struct i386_record_template tmpl;
+  const struct i386_record_template *cached;
   struct gdbarch_tdep *tdep = gdbarch_tdep (gdbarch);
   uint8_t rex_w = -1;
   uint8_t rex_r = 0;
@@ -5026,16 +5271,29 @@ i386_process_record (struct gdbarch *gdbarch, struct regcache *regcache,
   ir.popl_esp_hack = 0;
   ir.regmap = tdep->record_regmap;
   ir.gdbarch = gdbarch;
+  ir.tmpl = &tmpl;
 
   if (record_debug > 1)
     fprintf_unfiltered (gdb_stdlog, "Process record: i386_process_record "
 			            "addr = %s\n",
 			paddress (gdbarch, ir.addr));
 
+  /* If the instruction was decoded before, only record the changes
+     the decoder found then.  */
+  cached = i386_record_template_lookup (regcache, ir.orig_addr);
+  if (cached != NULL)
+    return i386_record_template_replay (regcache, cached);
+
+  /* Otherwise, read the instruction at once.  Near the end of a
+     readable region, read it byte by byte as needed.  */
+  if (target_read_memory (ir.orig_addr, ir.insn, I386_MAX_INSN_LEN) == 0)
+    ir.insn_len = I386_MAX_INSN_LEN;
+  ir.cacheable = true;
+
   /* prefixes */
   while (1)
     {
-      if (record_read_memory (gdbarch, ir.addr, &opcode8, 1))
+      if (i386_record_read_insn (&ir, ir.addr, &opcode8, 1))
 	return -1;
       ir.addr++;
       switch (opcode8)	/* Instruction prefixes */
@@ -5126,7 +5384,7 @@ i386_process_record (struct gdbarch *gdbarch, struct regcache *regcache,
   switch (opcode)
     {
     case 0x0f:
-      if (record_read_memory (gdbarch, ir.addr, &opcode8, 1))
+      if (i386_record_read_insn (&ir, ir.addr, &opcode8, 1))
 	return -1;
       ir.addr++;
       opcode = (uint32_t) opcode8 | 0x0f00;
@@ -5791,6 +6049,7 @@ i386_process_record (struct gdbarch *gdbarch, struct regcache *regcache,
     case 0xa3:
       if (ir.override >= 0)
         {
+          ir.cacheable = false;
           if (record_full_memory_query)
             {
               if (yquery (_("\
@@ -5809,26 +6068,26 @@ Do you want to stop the program?"),
 	    ir.ot = ir.dflag + OT_WORD;
 	  if (ir.aflag == 2)
 	    {
-              if (record_read_memory (gdbarch, ir.addr, buf, 8))
+              if (i386_record_read_insn (&ir, ir.addr, buf, 8))
 		return -1;
 	      ir.addr += 8;
 	      addr = extract_unsigned_integer (buf, 8, byte_order);
 	    }
           else if (ir.aflag)
 	    {
-              if (record_read_memory (gdbarch, ir.addr, buf, 4))
+              if (i386_record_read_insn (&ir, ir.addr, buf, 4))
 		return -1;
 	      ir.addr += 4;
               addr = extract_unsigned_integer (buf, 4, byte_order);
 	    }
           else
 	    {
-              if (record_read_memory (gdbarch, ir.addr, buf, 2))
+              if (i386_record_read_insn (&ir, ir.addr, buf, 2))
 		return -1;
 	      ir.addr += 2;
               addr = extract_unsigned_integer (buf, 2, byte_order);
 	    }
-	  if (record_full_arch_list_add_mem (addr, 1 << ir.ot))
+	  if (i386_record_mem (&ir, addr, 1 << ir.ot))
 	    return -1;
         }
       break;
@@ -5974,7 +6233,7 @@ Do you want to stop the program?"),
 	return -1;
       if (ir.mod == 3)
 	{
-	  if (record_full_arch_list_add_reg (ir.regcache, ir.rm))
+	  if (i386_record_reg (&ir, ir.rm))
 	    return -1;
 	}
       else
@@ -6077,17 +6336,17 @@ Do you want to stop the program?"),
 		  switch (ir.reg >> 4)
 		    {
 		    case 0:
-		      if (record_full_arch_list_add_mem (addr64, 4))
+		      if (i386_record_mem (&ir, addr64, 4))
 			return -1;
 		      break;
 		    case 2:
-		      if (record_full_arch_list_add_mem (addr64, 8))
+		      if (i386_record_mem (&ir, addr64, 8))
 			return -1;
 		      break;
 		    case 3:
 		      break;
 		    default:
-		      if (record_full_arch_list_add_mem (addr64, 2))
+		      if (i386_record_mem (&ir, addr64, 2))
 			return -1;
 		      break;
 		    }
@@ -6096,7 +6355,7 @@ Do you want to stop the program?"),
 		  switch (ir.reg >> 4)
 		    {
 		    case 0:
-		      if (record_full_arch_list_add_mem (addr64, 4))
+		      if (i386_record_mem (&ir, addr64, 4))
 			return -1;
 		      if (3 == (ir.reg & 7))
 			{
@@ -6107,7 +6366,7 @@ Do you want to stop the program?"),
 			}
 		      break;
 		    case 1:
-		      if (record_full_arch_list_add_mem (addr64, 4))
+		      if (i386_record_mem (&ir, addr64, 4))
 			return -1;
 		      if ((3 == (ir.reg & 7))
 			  || (5 == (ir.reg & 7))
@@ -6120,7 +6379,7 @@ Do you want to stop the program?"),
 			}
 		      break;
 		    case 2:
-		      if (record_full_arch_list_add_mem (addr64, 8))
+		      if (i386_record_mem (&ir, addr64, 8))
 			return -1;
 		      if (3 == (ir.reg & 7))
 			{
@@ -6140,7 +6399,7 @@ Do you want to stop the program?"),
 			}
 		      /* Fall through */
 		    default:
-		      if (record_full_arch_list_add_mem (addr64, 2))
+		      if (i386_record_mem (&ir, addr64, 2))
 			return -1;
 		      break;
 		    }
@@ -6167,18 +6426,18 @@ Do you want to stop the program?"),
 	    case 0x0e:
 	      if (ir.dflag)
 		{
-		  if (record_full_arch_list_add_mem (addr64, 28))
+		  if (i386_record_mem (&ir, addr64, 28))
 		    return -1;
 		}
 	      else
 		{
-		  if (record_full_arch_list_add_mem (addr64, 14))
+		  if (i386_record_mem (&ir, addr64, 14))
 		    return -1;
 		}
 	      break;
 	    case 0x0f:
 	    case 0x2f:
-	      if (record_full_arch_list_add_mem (addr64, 2))
+	      if (i386_record_mem (&ir, addr64, 2))
 		return -1;
               /* Insn fstp, fbstp.  */
               if (i386_record_floats (gdbarch, &ir, I386_SAVE_FPU_REGS))
@@ -6186,23 +6445,23 @@ Do you want to stop the program?"),
 	      break;
 	    case 0x1f:
 	    case 0x3e:
-	      if (record_full_arch_list_add_mem (addr64, 10))
+	      if (i386_record_mem (&ir, addr64, 10))
 		return -1;
 	      break;
 	    case 0x2e:
 	      if (ir.dflag)
 		{
-		  if (record_full_arch_list_add_mem (addr64, 28))
+		  if (i386_record_mem (&ir, addr64, 28))
 		    return -1;
 		  addr64 += 28;
 		}
 	      else
 		{
-		  if (record_full_arch_list_add_mem (addr64, 14))
+		  if (i386_record_mem (&ir, addr64, 14))
 		    return -1;
 		  addr64 += 14;
 		}
-	      if (record_full_arch_list_add_mem (addr64, 80))
+	      if (i386_record_mem (&ir, addr64, 80))
 		return -1;
 	      /* Insn fsave.  */
 	      if (i386_record_floats (gdbarch, &ir,
@@ -6210,7 +6469,7 @@ Do you want to stop the program?"),
 		return -1;
 	      break;
 	    case 0x3f:
-	      if (record_full_arch_list_add_mem (addr64, 8))
+	      if (i386_record_mem (&ir, addr64, 8))
 		return -1;
 	      /* Insn fistp.  */
 	      if (i386_record_floats (gdbarch, &ir, I386_SAVE_FPU_REGS))
@@ -6416,8 +6675,7 @@ Do you want to stop the program?"),
             case 0xdf:
               if (0xe0 == ir.modrm)
                 {
-		  if (record_full_arch_list_add_reg (ir.regcache,
-						     I386_EAX_REGNUM))
+		  if (i386_record_reg (&ir, I386_EAX_REGNUM))
 		    return -1;
                 }
               else if ((0x0f == ir.modrm >> 4) || (0x0e == ir.modrm >> 4))
@@ -6436,9 +6694,7 @@ Do you want to stop the program?"),
     case 0xab:
     case 0x6c:    /* insS */
     case 0x6d:
-      regcache_raw_read_unsigned (ir.regcache,
-                                  ir.regmap[X86_RECORD_RECX_REGNUM],
-                                  &addr);
+      i386_record_read_reg (&ir, ir.regmap[X86_RECORD_RECX_REGNUM], &addr);
       if (addr)
         {
           ULONGEST es, ds;
@@ -6447,16 +6703,10 @@ Do you want to stop the program?"),
 	    ir.ot = OT_BYTE;
           else
 	    ir.ot = ir.dflag + OT_WORD;
-          regcache_raw_read_unsigned (ir.regcache,
-                                      ir.regmap[X86_RECORD_REDI_REGNUM],
-                                      &addr);
-
-          regcache_raw_read_unsigned (ir.regcache,
-                                      ir.regmap[X86_RECORD_ES_REGNUM],
-                                      &es);
-          regcache_raw_read_unsigned (ir.regcache,
-                                      ir.regmap[X86_RECORD_DS_REGNUM],
-                                      &ds);
+          i386_record_read_reg (&ir, ir.regmap[X86_RECORD_REDI_REGNUM], &addr);
+
+          i386_record_read_reg (&ir, ir.regmap[X86_RECORD_ES_REGNUM], &es);
+          i386_record_read_reg (&ir, ir.regmap[X86_RECORD_DS_REGNUM], &ds);
           if (ir.aflag && (es != ds))
             {
               /* addr += ((uint32_t) read_register (I386_ES_REGNUM)) << 4; */
@@ -6472,7 +6722,7 @@ Do you want to stop the program?"),
             }
           else
             {
-              if (record_full_arch_list_add_mem (addr, 1 << ir.ot))
+              if (i386_record_mem (&ir, addr, 1 << ir.ot))
                 return -1;
             }
 
@@ -6737,9 +6987,7 @@ Do you want to stop the program?"),
           uint64_t addr64;
           if (i386_record_lea_modrm_addr (&ir, &addr64))
             return -1;
-          regcache_raw_read_unsigned (ir.regcache,
-                                      ir.regmap[ir.reg | rex_r],
-                                      &addr);
+          i386_record_read_reg (&ir, ir.regmap[ir.reg | rex_r], &addr);
           switch (ir.dflag)
             {
             case 0:
@@ -6752,7 +7000,7 @@ Do you want to stop the program?"),
               addr64 += ((int64_t) addr >> 6) << 6;
               break;
             }
-          if (record_full_arch_list_add_mem (addr64, 1 << ir.ot))
+          if (i386_record_mem (&ir, addr64, 1 << ir.ot))
             return -1;
           if (i386_record_lea_modrm (&ir))
             return -1;
@@ -6792,7 +7040,7 @@ Do you want to stop the program?"),
       break;
 
     case 0x9b:    /* fwait */
-      if (record_read_memory (gdbarch, ir.addr, &opcode8, 1))
+      if (i386_record_read_insn (&ir, ir.addr, &opcode8, 1))
 	return -1;
       opcode = (uint32_t) opcode8;
       ir.addr++;
@@ -6812,7 +7060,7 @@ Do you want to stop the program?"),
       {
 	int ret;
 	uint8_t interrupt;
-	if (record_read_memory (gdbarch, ir.addr, &interrupt, 1))
+	if (i386_record_read_insn (&ir, ir.addr, &interrupt, 1))
 	  return -1;
 	ir.addr++;
 	if (interrupt != 0x80
@@ -6824,6 +7072,8 @@ Do you want to stop the program?"),
 	    ir.addr -= 2;
 	    goto no_support;
 	  }
+	ir.cacheable = false;
+	i386_record_templates.clear ();
 	ret = tdep->i386_intx80_record (ir.regcache);
 	if (ret)
 	  return ret;
@@ -6912,6 +7162,8 @@ Do you want to stop the program?"),
 	    ir.addr -= 2;
 	    goto no_support;
 	  }
+	ir.cacheable = false;
+	i386_record_templates.clear ();
 	ret = tdep->i386_sysenter_record (ir.regcache);
 	if (ret)
 	  return ret;
@@ -6935,6 +7187,8 @@ Do you want to stop the program?"),
 	    ir.addr -= 2;
 	    goto no_support;
 	  }
+	ir.cacheable = false;
+	i386_record_templates.clear ();
 	ret = tdep->i386_syscall_record (ir.regcache);
 	if (ret)
 	  return ret;
@@ -7010,6 +7264,7 @@ Do you want to stop the program?"),
 	      }
 	    if (ir.override >= 0)
 	      {
+                ir.cacheable = false;
                 if (record_full_memory_query)
                   {
                     if (yquery (_("\
@@ -7024,17 +7279,17 @@ Do you want to stop the program?"),
 	      {
 		if (i386_record_lea_modrm_addr (&ir, &addr64))
 		  return -1;
-		if (record_full_arch_list_add_mem (addr64, 2))
+		if (i386_record_mem (&ir, addr64, 2))
 		  return -1;
 		addr64 += 2;
                 if (ir.regmap[X86_RECORD_R8_REGNUM])
                   {
-                    if (record_full_arch_list_add_mem (addr64, 8))
+                    if (i386_record_mem (&ir, addr64, 8))
 		      return -1;
                   }
                 else
                   {
-                    if (record_full_arch_list_add_mem (addr64, 4))
+                    if (i386_record_mem (&ir, addr64, 4))
 		      return -1;
                   }
 	      }
@@ -7062,6 +7317,7 @@ Do you want to stop the program?"),
 	      /* sidt */
 	      if (ir.override >= 0)
 		{
+                  ir.cacheable = false;
                   if (record_full_memory_query)
                     {
                       if (yquery (_("\
@@ -7078,17 +7334,17 @@ Do you want to stop the program?"),
 
 		  if (i386_record_lea_modrm_addr (&ir, &addr64))
 		    return -1;
-		  if (record_full_arch_list_add_mem (addr64, 2))
+		  if (i386_record_mem (&ir, addr64, 2))
 		    return -1;
 		  addr64 += 2;
                   if (ir.regmap[X86_RECORD_R8_REGNUM])
                     {
-                      if (record_full_arch_list_add_mem (addr64, 8))
+                      if (i386_record_mem (&ir, addr64, 8))
 		        return -1;
                     }
                   else
                     {
-                      if (record_full_arch_list_add_mem (addr64, 4))
+                      if (i386_record_mem (&ir, addr64, 4))
 		        return -1;
                     }
 		}
@@ -7120,7 +7376,7 @@ Do you want to stop the program?"),
 	case 4:  /* smsw */
 	  if (ir.mod == 3)
 	    {
-	      if (record_full_arch_list_add_reg (ir.regcache, ir.rm | ir.rex_b))
+	      if (i386_record_reg (&ir, ir.rm | ir.rex_b))
 		return -1;
 	    }
 	  else
@@ -7268,13 +7524,13 @@ Do you want to stop the program?"),
     case 0x0f77:    /* emms */
       if (i386_fpc_regnum_p (gdbarch, I387_FTAG_REGNUM(tdep)))
         goto no_support;
-      record_full_arch_list_add_reg (ir.regcache, I387_FTAG_REGNUM(tdep));
+      i386_record_reg (&ir, I387_FTAG_REGNUM(tdep));
       break;
 
     case 0x0f0f:    /* 3DNow! data */
       if (i386_record_modrm (&ir))
 	return -1;
-      if (record_read_memory (gdbarch, ir.addr, &opcode8, 1))
+      if (i386_record_read_insn (&ir, ir.addr, &opcode8, 1))
 	return -1;
       ir.addr++;
       switch (opcode8)
@@ -7305,7 +7561,7 @@ Do you want to stop the program?"),
         case 0xbf:    /* 3DNow! pavgusb */
           if (!i386_mmx_regnum_p (gdbarch, I387_MM0_REGNUM (tdep) + ir.reg))
             goto no_support_3dnow_data;
-          record_full_arch_list_add_reg (ir.regcache, ir.reg);
+          i386_record_reg (&ir, ir.reg);
           break;
 
         default:
@@ -7340,7 +7596,7 @@ no_support_3dnow_data:
             I386_RECORD_FULL_ARCH_LIST_ADD_REG (X86_RECORD_EFLAGS_REGNUM);
 	    if (i386_record_lea_modrm_addr (&ir, &tmpu64))
 	      return -1;
-            if (record_full_arch_list_add_mem (tmpu64, 512))
+            if (i386_record_mem (&ir, tmpu64, 512))
               return -1;
           }
           break;
@@ -7353,30 +7609,29 @@ no_support_3dnow_data:
 
             for (i = I387_MM0_REGNUM (tdep);
                  i386_mmx_regnum_p (gdbarch, i); i++)
-              record_full_arch_list_add_reg (ir.regcache, i);
+              i386_record_reg (&ir, i);
 
             for (i = I387_XMM0_REGNUM (tdep);
                  i386_xmm_regnum_p (gdbarch, i); i++)
-              record_full_arch_list_add_reg (ir.regcache, i);
+              i386_record_reg (&ir, i);
 
             if (i386_mxcsr_regnum_p (gdbarch, I387_MXCSR_REGNUM(tdep)))
-              record_full_arch_list_add_reg (ir.regcache,
-					     I387_MXCSR_REGNUM(tdep));
+              i386_record_reg (&ir, I387_MXCSR_REGNUM(tdep));
 
             for (i = I387_ST0_REGNUM (tdep);
                  i386_fp_regnum_p (gdbarch, i); i++)
-              record_full_arch_list_add_reg (ir.regcache, i);
+              i386_record_reg (&ir, i);
 
             for (i = I387_FCTRL_REGNUM (tdep);
                  i386_fpc_regnum_p (gdbarch, i); i++)
-              record_full_arch_list_add_reg (ir.regcache, i);
+              i386_record_reg (&ir, i);
           }
           break;
 
         case 2:    /* ldmxcsr */
           if (!i386_mxcsr_regnum_p (gdbarch, I387_MXCSR_REGNUM(tdep)))
             goto no_support;
-          record_full_arch_list_add_reg (ir.regcache, I387_MXCSR_REGNUM(tdep));
+          i386_record_reg (&ir, I387_MXCSR_REGNUM(tdep));
           break;
 
         case 3:    /* stmxcsr */
@@ -7544,7 +7799,7 @@ reswitch_prefix_add:
         case 0xf20f38:
         case 0x0f3a:
         case 0x660f3a:
-          if (record_read_memory (gdbarch, ir.addr, &opcode8, 1))
+          if (i386_record_read_insn (&ir, ir.addr, &opcode8, 1))
 	    return -1;
           ir.addr++;
           opcode = (uint32_t) opcode8 | opcode << 8;
@@ -7755,8 +8010,7 @@ reswitch_prefix_add:
           ir.reg |= rex_r;
           if (!i386_xmm_regnum_p (gdbarch, I387_XMM0_REGNUM (tdep) + ir.reg))
             goto no_support;
-          record_full_arch_list_add_reg (ir.regcache,
-					 I387_XMM0_REGNUM (tdep) + ir.reg);
+          i386_record_reg (&ir, I387_XMM0_REGNUM (tdep) + ir.reg);
           if ((opcode & 0xfffffffc) == 0x660f3a60)
             I386_RECORD_FULL_ARCH_LIST_ADD_REG (X86_RECORD_EFLAGS_REGNUM);
           break;
@@ -7788,8 +8042,7 @@ reswitch_prefix_add:
               if (!i386_xmm_regnum_p (gdbarch,
 				      I387_XMM0_REGNUM (tdep) + ir.rm))
                 goto no_support;
-              record_full_arch_list_add_reg (ir.regcache,
-					     I387_XMM0_REGNUM (tdep) + ir.rm);
+              i386_record_reg (&ir, I387_XMM0_REGNUM (tdep) + ir.rm);
             }
           else
             {
@@ -7943,8 +8196,7 @@ reswitch_prefix_add:
 	    return -1;
           if (!i386_mmx_regnum_p (gdbarch, I387_MM0_REGNUM (tdep) + ir.reg))
             goto no_support;
-          record_full_arch_list_add_reg (ir.regcache,
-					 I387_MM0_REGNUM (tdep) + ir.reg);
+          i386_record_reg (&ir, I387_MM0_REGNUM (tdep) + ir.reg);
           break;
 
         case 0x0f71:    /* psllw */
@@ -7954,8 +8206,7 @@ reswitch_prefix_add:
 	    return -1;
           if (!i386_mmx_regnum_p (gdbarch, I387_MM0_REGNUM (tdep) + ir.rm))
             goto no_support;
-          record_full_arch_list_add_reg (ir.regcache,
-					 I387_MM0_REGNUM (tdep) + ir.rm);
+          i386_record_reg (&ir, I387_MM0_REGNUM (tdep) + ir.rm);
           break;
 
         case 0x660f71:    /* psllw */
@@ -7966,8 +8217,7 @@ reswitch_prefix_add:
           ir.rm |= ir.rex_b;
           if (!i386_xmm_regnum_p (gdbarch, I387_XMM0_REGNUM (tdep) + ir.rm))
             goto no_support;
-          record_full_arch_list_add_reg (ir.regcache,
-					 I387_XMM0_REGNUM (tdep) + ir.rm);
+          i386_record_reg (&ir, I387_XMM0_REGNUM (tdep) + ir.rm);
           break;
 
         case 0x0f7e:      /* movd */
@@ -7994,8 +8244,7 @@ reswitch_prefix_add:
             {
               if (!i386_mmx_regnum_p (gdbarch, I387_MM0_REGNUM (tdep) + ir.rm))
                 goto no_support;
-              record_full_arch_list_add_reg (ir.regcache,
-					     I387_MM0_REGNUM (tdep) + ir.rm);
+              i386_record_reg (&ir, I387_MM0_REGNUM (tdep) + ir.rm);
             }
           else
             {
@@ -8021,8 +8270,7 @@ reswitch_prefix_add:
               if (!i386_xmm_regnum_p (gdbarch,
 				      I387_XMM0_REGNUM (tdep) + ir.rm))
                 goto no_support;
-              record_full_arch_list_add_reg (ir.regcache,
-					     I387_XMM0_REGNUM (tdep) + ir.rm);
+              i386_record_reg (&ir, I387_XMM0_REGNUM (tdep) + ir.rm);
             }
           else
             {
@@ -8041,18 +8289,14 @@ reswitch_prefix_add:
           break;
 
         case 0x0ff7:    /* maskmovq */
-          regcache_raw_read_unsigned (ir.regcache,
-                                      ir.regmap[X86_RECORD_REDI_REGNUM],
-                                      &addr);
-          if (record_full_arch_list_add_mem (addr, 64))
+          i386_record_read_reg (&ir, ir.regmap[X86_RECORD_REDI_REGNUM], &addr);
+          if (i386_record_mem (&ir, addr, 64))
             return -1;
           break;
 
         case 0x660ff7:    /* maskmovdqu */
-          regcache_raw_read_unsigned (ir.regcache,
-                                      ir.regmap[X86_RECORD_REDI_REGNUM],
-                                      &addr);
-          if (record_full_arch_list_add_mem (addr, 128))
+          i386_record_read_reg (&ir, ir.regmap[X86_RECORD_REDI_REGNUM], &addr);
+          if (i386_record_mem (&ir, addr, 128))
             return -1;
           break;
 
@@ -8069,6 +8313,7 @@ reswitch_prefix_add:
 
   /* In the future, maybe still need to deal with need_dasm.  */
   I386_RECORD_FULL_ARCH_LIST_ADD_REG (X86_RECORD_REIP_REGNUM);
+  i386_record_template_save (&ir);
   if (record_full_arch_list_add_end ())
     return -1;
 
@@ -9056,6 +9301,14 @@ Show Intel Memory Protection Extensions specific variables."),
   /* Tell remote stub that we support XML target description.  */
   register_remote_support_xml ("i386");
 
+  gdb::observers::target_memory_written.attach
+    (i386_record_templates_memory_written);
+  gdb::observers::new_objfile.attach (i386_record_templates_objfile_changed);
+  gdb::observers::free_objfile.attach (i386_record_templates_objfile_changed);
+  gdb::observers::inferior_exit.attach (i386_record_templates_inferior_exit);
+  gdb::observers::record_changed.attach
+    (i386_record_templates_record_changed);
+
 #if GDB_SELF_TEST
   struct
   {
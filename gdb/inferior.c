@@ -286,6 +286,7 @@ inferior_appeared (struct inferior *inf, int pid)
 
 #ifdef ENABLE_PIP
   inf->pipid = PIP_GDBIF_PIPID_ANY;
+  inf->pip_root_pid = 0;
   inf->pip_load_address = 0;
   inf->pip_pathname = NULL;
 #endif
@@ -480,6 +481,31 @@ inferior_pid_to_str (int pid)
 }
 
 #ifdef ENABLE_PIP
+/* If true, watchpoints set in a PiP task also catch the accesses made
+   by the other PiP tasks.  */
+static int pip_share_watchpoints = 0;
+
+/* See inferior.h.  */
+
+bool
+pip_inferiors_share_memory_p (struct inferior *a, struct inferior *b)
+{
+  return (a != b
+	  && a->pipid != PIP_GDBIF_PIPID_ANY
+	  && b->pipid != PIP_GDBIF_PIPID_ANY
+	  && a->pip_root_pid != 0
+	  && a->pip_root_pid == b->pip_root_pid);
+}
+
+/* See inferior.h.  */
+
+bool
+pip_watchpoints_shared_p (struct inferior *a, struct inferior *b)
+{
+  return a == b || (pip_share_watchpoints
+		    && pip_inferiors_share_memory_p (a, b));
+}
+
 static const char *
 inferior_id_string (struct inferior *inf)
 {
@@ -1038,4 +1064,15 @@ Show printing of inferior events (e.g., inferior start and exit)."), NULL,
          &setprintlist, &showprintlist);
 
   create_internalvar_type_lazy ("_inferior", &inferior_funcs, NULL);
+
+#ifdef ENABLE_PIP
+  add_setshow_boolean_cmd ("pip-share-watchpoints", class_breakpoint,
+			   &pip_share_watchpoints, _("\
+Set whether watchpoints watch the accesses of all PiP tasks."), _("\
+Show whether watchpoints watch the accesses of all PiP tasks."), _("\
+PiP tasks share one address space.  When this is on, a watchpoint set\n\
+in one PiP task also triggers when another PiP task accesses the\n\
+watched memory, and the stop is reported in the task that did."),
+			   NULL, NULL, &setlist, &showlist);
+#endif
 }
@@ -345,6 +345,9 @@ public:
 
 #ifdef ENABLE_PIP
   int pipid;
+  /* The pid of the PiP root whose address space this PiP task runs
+     in, or 0 if it is not known.  */
+  int pip_root_pid;
   CORE_ADDR pip_load_address;
   gdb::unique_xmalloc_ptr<char> pip_pathname;
 #endif
@@ -573,4 +576,17 @@ extern struct inferior *add_inferior_with_spaces (void);
 /* Print the current selected inferior.  */
 extern void print_selected_inferior (struct ui_out *uiout);
 
+#ifdef ENABLE_PIP
+/* Return true if inferiors A and B are distinct PiP tasks of the same
+   PiP root, which run in one shared address space.  */
+extern bool pip_inferiors_share_memory_p (struct inferior *a,
+					  struct inferior *b);
+
+/* Return true if the watchpoints set in inferior A also watch the
+   accesses made by inferior B.  This is the case of PiP tasks when
+   "set pip-share-watchpoints" is on.  */
+extern bool pip_watchpoints_shared_p (struct inferior *a,
+				      struct inferior *b);
+#endif
+
 #endif /* !defined (INFERIOR_H) */
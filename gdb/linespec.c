@@ -406,6 +406,21 @@ static int compare_msymbols (const void *a, const void *b);
    previous parser.  */
 static const char *const linespec_quote_characters = "\"\'";
 
+/* See linespec.h.  */
+
+struct objfile *linespec_search_objfile;
+
+/* Return true if symbols and source files of OBJFILE should be
+   searched, given linespec_search_objfile.  */
+
+static bool
+linespec_searches_objfile_p (struct objfile *objfile)
+{
+  return (linespec_search_objfile == NULL
+	  || objfile_is_or_separate_debug_of (objfile,
+					      linespec_search_objfile));
+}
+
 /* Lexer functions.  */
 
 /* Lex a number from the input in PARSER.  This only supports
@@ -1129,6 +1144,9 @@ iterate_over_all_matching_symtabs
     {
       struct compunit_symtab *cu;
 
+      if (!linespec_searches_objfile_p (objfile))
+	continue;
+
       if (objfile->sf)
 	objfile->sf->qf->expand_symtabs_matching (objfile,
 						  NULL,
@@ -3835,6 +3853,9 @@ symtab_collector::operator () (struct symtab *symtab)
 {
   void **slot;
 
+  if (!linespec_searches_objfile_p (SYMTAB_OBJFILE (symtab)))
+    return false;
+
   slot = htab_find_slot (m_symtab_table, symtab, INSERT);
   if (!*slot)
     {
@@ -4417,6 +4438,9 @@ search_minsyms_for_name (struct collect_info *info,
 
 	ALL_OBJFILES (objfile)
 	{
+	  if (!linespec_searches_objfile_p (objfile))
+	    continue;
+
 	  iterate_over_minimal_symbols (objfile, name,
 					[&] (struct minimal_symbol *msym)
 					  {
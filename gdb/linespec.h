@@ -131,6 +131,13 @@ extern void decode_line_full (const struct event_location *location, int flags,
 			      const char *select_mode,
 			      const char *filter);
 
+/* If non-NULL, linespec only searches this objfile, and its separate
+   debug objfiles, for symbols and source files.  Used to find out
+   cheaply whether a location can match anything in a newly added
+   objfile.  */
+
+extern struct objfile *linespec_search_objfile;
+
 /* Given a string, return the line specified by it, using the current
    source symtab and line as defaults.
    This is for commands like "list" and "breakpoint".  */
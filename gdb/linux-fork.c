@@ -27,6 +27,7 @@
 #include "objfiles.h"
 #include "linux-fork.h"
 #include "linux-nat.h"
+#include "linux-snapshot.h"
 #include "gdbthread.h"
 #include "source.h"
 
@@ -38,6 +39,41 @@
 struct fork_info *fork_list;
 static int highest_fork_num;
 
+/* How the checkpoint commands work: by forking the process, or by
+   taking snapshots of its memory (see linux-snapshot.c).  */
+static const char checkpoint_mode_fork[] = "fork";
+static const char checkpoint_mode_snapshot[] = "snapshot";
+static const char *const checkpoint_mode_enums[] =
+{
+  checkpoint_mode_fork,
+  checkpoint_mode_snapshot,
+  NULL
+};
+static const char *checkpoint_mode_1 = checkpoint_mode_fork;
+static const char *checkpoint_mode = checkpoint_mode_fork;
+
+static void
+set_checkpoint_mode (const char *args, int from_tty,
+		     struct cmd_list_element *c)
+{
+  if (checkpoint_mode_1 != checkpoint_mode
+      && (forks_exist_p () || linux_snapshots_exist_p ()))
+    {
+      checkpoint_mode_1 = checkpoint_mode;
+      error (_("Cannot change the checkpoint mode while there are "
+	       "checkpoints."));
+    }
+
+  checkpoint_mode = checkpoint_mode_1;
+}
+
+static void
+show_checkpoint_mode (struct ui_file *file, int from_tty,
+		      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Checkpoints are made by \"%s\".\n"), value);
+}
+
 /* Fork list data structure:  */
 struct fork_info
 {
@@ -251,13 +287,72 @@ call_lseek (int fd, off_t offset, int whence)
   return (off_t) parse_and_eval_long (&exp[0]);
 }
 
+/* See linux-fork.h.  */
+
+void
+linux_fork_save_file_positions (pid_t pid, off_t **filepos, int *maxfd)
+{
+  char path[PATH_MAX];
+  struct dirent *de;
+  DIR *d;
+
+  snprintf (path, PATH_MAX, "/proc/%ld/fd", (long) pid);
+  if ((d = opendir (path)) != NULL)
+    {
+      long tmp;
+
+      *maxfd = 0;
+      while ((de = readdir (d)) != NULL)
+	{
+	  /* Count open file descriptors (actually find highest
+	     numbered).  */
+	  tmp = strtol (&de->d_name[0], NULL, 10);
+	  if (*maxfd < tmp)
+	    *maxfd = tmp;
+	}
+      /* Allocate array of file positions.  */
+      *filepos = XRESIZEVEC (off_t, *filepos, *maxfd + 1);
+
+      /* Initialize to -1 (invalid).  */
+      for (tmp = 0; tmp <= *maxfd; tmp++)
+	(*filepos)[tmp] = -1;
+
+      /* Now find actual file positions.  */
+      rewinddir (d);
+      while ((de = readdir (d)) != NULL)
+	if (isdigit (de->d_name[0]))
+	  {
+	    tmp = strtol (&de->d_name[0], NULL, 10);
+	    (*filepos)[tmp] = call_lseek (tmp, 0, SEEK_CUR);
+	  }
+      closedir (d);
+    }
+}
+
+/* See linux-fork.h.  */
+
+void
+linux_fork_restore_file_positions (const off_t *filepos, int maxfd)
+{
+  int i;
+
+  if (filepos)
+    {
+      for (i = 0; i <= maxfd; i++)
+	if (filepos[i] != (off_t) -1)
+	  call_lseek (i, filepos[i], SEEK_SET);
+      /* NOTE: I can get away with using SEEK_SET and SEEK_CUR because
+	 this is native-only.  If it ever has to be cross, we'll have
+	 to rethink this.  */
+    }
+}
+
 /* Load infrun state for the fork PTID.  */
 
 static void
 fork_load_infrun_state (struct fork_info *fp)
 {
   extern void nullify_last_target_wait_ptid ();
-  int i;
 
   linux_nat_switch_fork (fp->ptid);
 
@@ -272,15 +367,7 @@ fork_load_infrun_state (struct fork_info *fp)
   nullify_last_target_wait_ptid ();
 
   /* Now restore the file positions of open file descriptors.  */
-  if (fp->filepos)
-    {
-      for (i = 0; i <= fp->maxfd; i++)
-	if (fp->filepos[i] != (off_t) -1)
-	  call_lseek (i, fp->filepos[i], SEEK_SET);
-      /* NOTE: I can get away with using SEEK_SET and SEEK_CUR because
-	 this is native-only.  If it ever has to be cross, we'll have
-	 to rethink this.  */
-    }
+  linux_fork_restore_file_positions (fp->filepos, fp->maxfd);
 }
 
 /* Save infrun state for the fork PTID.
@@ -289,10 +376,6 @@ fork_load_infrun_state (struct fork_info *fp)
 static void
 fork_save_infrun_state (struct fork_info *fp, int clobber_regs)
 {
-  char path[PATH_MAX];
-  struct dirent *de;
-  DIR *d;
-
   if (fp->savedregs)
     delete fp->savedregs;
 
@@ -304,38 +387,8 @@ fork_save_infrun_state (struct fork_info *fp, int clobber_regs)
     {
       /* Now save the 'state' (file position) of all open file descriptors.
 	 Unfortunately fork does not take care of that for us...  */
-      snprintf (path, PATH_MAX, "/proc/%ld/fd",
-		(long) fp->ptid.pid ());
-      if ((d = opendir (path)) != NULL)
-	{
-	  long tmp;
-
-	  fp->maxfd = 0;
-	  while ((de = readdir (d)) != NULL)
-	    {
-	      /* Count open file descriptors (actually find highest
-		 numbered).  */
-	      tmp = strtol (&de->d_name[0], NULL, 10);
-	      if (fp->maxfd < tmp)
-		fp->maxfd = tmp;
-	    }
-	  /* Allocate array of file positions.  */
-	  fp->filepos = XRESIZEVEC (off_t, fp->filepos, fp->maxfd + 1);
-
-	  /* Initialize to -1 (invalid).  */
-	  for (tmp = 0; tmp <= fp->maxfd; tmp++)
-	    fp->filepos[tmp] = -1;
-
-	  /* Now find actual file positions.  */
-	  rewinddir (d);
-	  while ((de = readdir (d)) != NULL)
-	    if (isdigit (de->d_name[0]))
-	      {
-		tmp = strtol (&de->d_name[0], NULL, 10);
-		fp->filepos[tmp] = call_lseek (tmp, 0, SEEK_CUR);
-	      }
-	  closedir (d);
-	}
+      linux_fork_save_file_positions (fp->ptid.pid (), &fp->filepos,
+				      &fp->maxfd);
     }
 }
 
@@ -514,6 +567,12 @@ delete_checkpoint_command (const char *args, int from_tty)
   if (!args || !*args)
     error (_("Requires argument (checkpoint id to delete)"));
 
+  if (checkpoint_mode == checkpoint_mode_snapshot)
+    {
+      linux_snapshot_delete (parse_and_eval_long (args), from_tty);
+      return;
+    }
+
   ptid = fork_id_to_ptid (parse_and_eval_long (args));
   if (ptid == minus_one_ptid)
     error (_("No such checkpoint id, %s"), args);
@@ -555,6 +614,10 @@ detach_checkpoint_command (const char *args, int from_tty)
   if (!args || !*args)
     error (_("Requires argument (checkpoint id to detach)"));
 
+  if (checkpoint_mode == checkpoint_mode_snapshot)
+    error (_("Snapshot checkpoints are not processes and can't be "
+	     "detached."));
+
   ptid = fork_id_to_ptid (parse_and_eval_long (args));
   if (ptid == minus_one_ptid)
     error (_("No such checkpoint id, %s"), args);
@@ -572,21 +635,50 @@ Please switch to another checkpoint before detaching the current one"));
   delete_fork (ptid);
 }
 
+/* See linux-fork.h.  */
+
+void
+linux_fork_print_checkpoint_pc (struct gdbarch *gdbarch, CORE_ADDR pc)
+{
+  struct symtab_and_line sal;
+
+  fputs_filtered (paddress (gdbarch, pc), gdb_stdout);
+
+  sal = find_pc_line (pc, 0);
+  if (sal.symtab)
+    printf_filtered (_(", file %s"),
+		     symtab_to_filename_for_display (sal.symtab));
+  if (sal.line)
+    printf_filtered (_(", line %d"), sal.line);
+  if (!sal.symtab && !sal.line)
+    {
+      struct bound_minimal_symbol msym;
+
+      msym = lookup_minimal_symbol_by_pc (pc);
+      if (msym.minsym)
+	printf_filtered (", <%s>", MSYMBOL_LINKAGE_NAME (msym.minsym));
+    }
+}
+
 /* Print information about currently known checkpoints.  */
 
 static void
 info_checkpoints_command (const char *arg, int from_tty)
 {
   struct gdbarch *gdbarch = get_current_arch ();
-  struct symtab_and_line sal;
   struct fork_info *fp;
-  ULONGEST pc;
   int requested = -1;
   struct fork_info *printed = NULL;
 
   if (arg && *arg)
     requested = (int) parse_and_eval_long (arg);
 
+  if (checkpoint_mode == checkpoint_mode_snapshot)
+    {
+      linux_snapshot_info (requested);
+      return;
+    }
+
   for (fp = fork_list; fp; fp = fp->next)
     {
       if (requested > 0 && fp->num != requested)
@@ -598,27 +690,11 @@ info_checkpoints_command (const char *arg, int from_tty)
       else
 	printf_filtered ("  ");
 
-      pc = fp->pc;
       printf_filtered ("%d %s", fp->num, target_pid_to_str (fp->ptid));
       if (fp->num == 0)
 	printf_filtered (_(" (main process)"));
       printf_filtered (_(" at "));
-      fputs_filtered (paddress (gdbarch, pc), gdb_stdout);
-
-      sal = find_pc_line (pc, 0);
-      if (sal.symtab)
-	printf_filtered (_(", file %s"),
-			 symtab_to_filename_for_display (sal.symtab));
-      if (sal.line)
-	printf_filtered (_(", line %d"), sal.line);
-      if (!sal.symtab && !sal.line)
-	{
-	  struct bound_minimal_symbol msym;
-
-	  msym = lookup_minimal_symbol_by_pc (pc);
-	  if (msym.minsym)
-	    printf_filtered (", <%s>", MSYMBOL_LINKAGE_NAME (msym.minsym));
-	}
+      linux_fork_print_checkpoint_pc (gdbarch, fp->pc);
 
       putchar_filtered ('\n');
     }
@@ -678,6 +754,12 @@ checkpoint_command (const char *args, int from_tty)
   struct fork_info *fp;
   pid_t retpid;
 
+  if (checkpoint_mode == checkpoint_mode_snapshot)
+    {
+      linux_snapshot_checkpoint (from_tty);
+      return;
+    }
+
   if (!target_has_execution) 
     error (_("The program is not being run."));
 
@@ -768,6 +850,12 @@ restart_command (const char *args, int from_tty)
   if (!args || !*args)
     error (_("Requires argument (checkpoint id to restart)"));
 
+  if (checkpoint_mode == checkpoint_mode_snapshot)
+    {
+      linux_snapshot_restart (parse_and_eval_long (args), from_tty);
+      return;
+    }
+
   if ((fp = find_fork_id (parse_and_eval_long (args))) == NULL)
     error (_("Not found: checkpoint id %s"), args);
 
@@ -811,4 +899,18 @@ Detach from a checkpoint (experimental)."),
 
   add_info ("checkpoints", info_checkpoints_command,
 	    _("IDs of currently known checkpoints."));
+
+  add_setshow_enum_cmd ("checkpoint-mode", class_obscure,
+			checkpoint_mode_enums, &checkpoint_mode_1, _("\
+Set how checkpoints are made."), _("\
+Show how checkpoints are made."), _("\
+When \"fork\" (the default), a checkpoint is a copy of the process made\n\
+by forking it, and restarting it switches to that process.  When\n\
+\"snapshot\", a checkpoint records the registers and the pages of memory\n\
+that changed since the previous one, and restarting it writes them back\n\
+into the same process.  The mode can't be changed while there are\n\
+checkpoints."),
+			set_checkpoint_mode,
+			show_checkpoint_mode,
+			&setlist, &showlist);
 }
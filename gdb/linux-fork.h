@@ -25,3 +25,19 @@ extern void linux_fork_mourn_inferior (void);
 extern void linux_fork_detach (int);
 extern int forks_exist_p (void);
 extern int linux_fork_checkpointing_p (int);
+
+/* Record the file positions of the open file descriptors of process
+   PID, the current inferior, in *FILEPOS (which is reallocated),
+   indexed by descriptor, and the highest descriptor in *MAXFD.  */
+extern void linux_fork_save_file_positions (pid_t pid, off_t **filepos,
+					    int *maxfd);
+
+/* Restore file positions recorded by linux_fork_save_file_positions
+   in the current inferior.  */
+extern void linux_fork_restore_file_positions (const off_t *filepos,
+					       int maxfd);
+
+/* Print PC, and the source line or symbol it is at, for "info
+   checkpoints".  */
+extern void linux_fork_print_checkpoint_pc (struct gdbarch *gdbarch,
+					    CORE_ADDR pc);
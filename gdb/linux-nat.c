@@ -32,6 +32,7 @@
 #include "nat/linux-procfs.h"
 #include "nat/linux-personality.h"
 #include "linux-fork.h"
+#include "linux-snapshot.h"
 #include "gdbthread.h"
 #include "gdbcmd.h"
 #include "regcache.h"
@@ -66,6 +67,13 @@
 #include "objfiles.h"
 #include "nat/linux-namespaces.h"
 #include "fileio.h"
+#include "ax.h"
+#include "breakpoint.h"
+#include "common/byte-vector.h"
+#include <sys/mman.h>
+#include <algorithm>
+#include <map>
+#include <vector>
 
 #ifndef SPUFS_MAGIC
 #define SPUFS_MAGIC 0x23c9b64e
@@ -282,11 +290,16 @@ static struct lwp_info *add_lwp (ptid_t ptid);
 static void purge_lwp_list (int pid);
 static void delete_lwp (ptid_t ptid);
 static struct lwp_info *find_lwp_pid (ptid_t ptid);
+static void queue_event_lwp (struct lwp_info *lp);
 
 static int lwp_status_pending_p (struct lwp_info *lp);
 
 static void save_stop_reason (struct lwp_info *lp);
 
+static bool page_watch_fault_p (struct lwp_info *lp, int status,
+				CORE_ADDR *addrp);
+static void forget_page_watches (struct inferior *inf);
+
 
 /* LWP accessors.  */
 
@@ -589,6 +602,7 @@ linux_nat_target::follow_fork (int follow_child, int detach_fork)
 	      parent_lp->status = 0;
 	      parent_lp->waitstatus.kind = TARGET_WAITKIND_VFORK_DONE;
 	      parent_lp->stopped = 1;
+	      queue_event_lwp (parent_lp);
 
 	      /* If we're in async mode, need to tell the event loop
 		 there's something here to process.  */
@@ -744,6 +758,41 @@ lwp_list_remove (struct lwp_info *lp)
     lwp_list = lp->next;
 }
 
+/* LWPs that have, or may have, a wait status pending, in the order
+   their events were collected.  Every LWP with a pending status is
+   in the queue, so linux_nat_wait_1 and select_event_lwp can find
+   event LWPs without walking the whole LWP list, which dominates
+   with thousands of threads hitting breakpoints.  Entries whose
+   status has since been consumed are dropped lazily, by
+   iterate_over_event_lwps.  Freed LWPs leave a NULL entry.  */
+static std::vector<lwp_info *> event_lwp_queue;
+
+/* Add LP to the event queue, if it isn't there already.  Called
+   whenever a wait status may have been stored in LP.  */
+
+static void
+queue_event_lwp (struct lwp_info *lp)
+{
+  if (!lp->event_queued)
+    {
+      lp->event_queued = 1;
+      event_lwp_queue.push_back (lp);
+    }
+}
+
+/* Remove LP from the event queue, if it is there.  */
+
+static void
+dequeue_event_lwp (struct lwp_info *lp)
+{
+  if (lp->event_queued)
+    {
+      std::replace (event_lwp_queue.begin (), event_lwp_queue.end (),
+		    lp, (lwp_info *) NULL);
+      lp->event_queued = 0;
+    }
+}
+
 
 
 /* Original signal mask.  */
@@ -814,6 +863,8 @@ static int check_ptrace_stopped_lwp_gone (struct lwp_info *lp);
 static void
 lwp_free (struct lwp_info *lp)
 {
+  dequeue_event_lwp (lp);
+
   /* Let the arch specific bits release arch_lwp_info.  */
   linux_target->low_delete_thread (lp->arch_private);
 
@@ -1268,6 +1319,7 @@ linux_nat_target::attach (const char *args, int from_tty)
 			(long) lp->ptid.pid (), status_to_str (status));
 
   lp->status = status;
+  queue_event_lwp (lp);
 
   /* We must attach to every LWP.  If /proc is mounted, use that to
      find them now.  The inferior may be using raw clone instead of
@@ -1512,6 +1564,8 @@ linux_nat_target::detach (inferior *inf, int from_tty)
 
   iterate_over_lwps (ptid_t (pid), detach_callback, NULL);
 
+  linux_snapshot_forget (pid);
+
   /* Only the initial process should be left right now.  */
   gdb_assert (num_lwps (pid) == 1);
 
@@ -2105,11 +2159,13 @@ linux_handle_extended_wait (struct lwp_info *lp, int status)
 				    (long) new_lp->ptid.lwp (),
 				    status_to_str (status));
 	      new_lp->status = status;
+	      queue_event_lwp (new_lp);
 	    }
 	  else if (report_thread_events)
 	    {
 	      new_lp->waitstatus.kind = TARGET_WAITKIND_THREAD_CREATED;
 	      new_lp->status = status;
+	      queue_event_lwp (new_lp);
 	    }
 
 	  return 1;
@@ -2120,6 +2176,8 @@ linux_handle_extended_wait (struct lwp_info *lp, int status)
 
   if (event == PTRACE_EVENT_EXEC)
     {
+      struct inferior *inf;
+
       if (debug_linux_nat)
 	fprintf_unfiltered (gdb_stdlog,
 			    "LHEW: Got exec event from LWP %ld\n",
@@ -2129,6 +2187,13 @@ linux_handle_extended_wait (struct lwp_info *lp, int status)
       ourstatus->value.execd_pathname
 	= xstrdup (linux_proc_pid_to_exec_file (pid));
 
+      /* The protected pages, and the memory snapshots were taken
+	 of, went away with the old image.  */
+      inf = find_inferior_pid (pid);
+      if (inf != NULL)
+	forget_page_watches (inf);
+      linux_snapshot_forget (pid);
+
       /* The thread that execed must have been resumed, but, when a
 	 thread execs, it changes its tid to the tgid, and the old
 	 tgid thread might have not been resumed.  */
@@ -2283,6 +2348,7 @@ wait_lwp (struct lwp_info *lp)
 		 core.  Store it in lp->waitstatus, because lp->status
 		 would be ambiguous (W_EXITCODE(0,0) == 0).  */
 	      store_waitstatus (&lp->waitstatus, status);
+	      queue_event_lwp (lp);
 	      return 0;
 	    }
 
@@ -2338,6 +2404,7 @@ wait_lwp (struct lwp_info *lp)
 			    "WL: Handling extended status 0x%06x\n",
 			    status);
       linux_handle_extended_wait (lp, status);
+      queue_event_lwp (lp);
       return 0;
     }
 
@@ -2563,6 +2630,24 @@ stop_wait_callback (struct lwp_info *lp, void *data)
 
       maybe_clear_ignore_sigint (lp);
 
+      if (page_watch_fault_p (lp, status, NULL))
+	{
+	  /* A fault on a page protected for a page watchpoint.  The
+	     faulting instruction runs again once the LWP is resumed,
+	     and the fault is handled then.  */
+	  errno = 0;
+	  ptrace (PTRACE_CONT, lp->ptid.lwp (), 0, 0);
+	  lp->stopped = 0;
+	  if (debug_linux_nat)
+	    fprintf_unfiltered (gdb_stdlog,
+				"PTRACE_CONT %s, 0, 0 (%s) "
+				"(discarding page watchpoint fault)\n",
+				target_pid_to_str (lp->ptid),
+				errno ? safe_strerror (errno) : "OK");
+
+	  return stop_wait_callback (lp, NULL);
+	}
+
       if (WSTOPSIG (status) != SIGSTOP)
 	{
 	  /* The thread was stopped with a signal other than SIGSTOP.  */
@@ -2575,6 +2660,7 @@ stop_wait_callback (struct lwp_info *lp, void *data)
 
 	  /* Save the sigtrap event.  */
 	  lp->status = status;
+	  queue_event_lwp (lp);
 	  gdb_assert (lp->signalled);
 	  save_stop_reason (lp);
 	}
@@ -2595,6 +2681,7 @@ stop_wait_callback (struct lwp_info *lp, void *data)
 	  if (lp->last_resume_kind == resume_stop)
 	    {
 	      lp->status = status;
+	      queue_event_lwp (lp);
 	      save_stop_reason (lp);
 	    }
 	}
@@ -2706,6 +2793,47 @@ lwp_status_pending_p (struct lwp_info *lp)
   return lp->status != 0 || lp->waitstatus.kind != TARGET_WAITKIND_IGNORE;
 }
 
+/* Like iterate_over_lwps, but only visit the LWPs in the event queue
+   that match FILTER and still have a status pending, oldest event
+   first.  Queue entries whose status has been consumed are dropped
+   along the way.  */
+
+static struct lwp_info *
+iterate_over_event_lwps (ptid_t filter,
+			 iterate_over_lwps_ftype callback,
+			 void *data)
+{
+  struct lwp_info *found = NULL;
+  size_t i, j;
+
+  /* Index-based, as CALLBACK may queue more LWPs, or free some.  */
+  for (i = 0, j = 0; i < event_lwp_queue.size (); i++)
+    {
+      struct lwp_info *lp = event_lwp_queue[i];
+
+      if (lp == NULL)
+	continue;
+
+      if (found == NULL
+	  && lwp_status_pending_p (lp)
+	  && lp->ptid.matches (filter)
+	  && (*callback) (lp, data) != 0)
+	found = lp;
+
+      /* CALLBACK may have freed LP.  */
+      if (event_lwp_queue[i] == NULL)
+	continue;
+
+      if (lwp_status_pending_p (lp))
+	event_lwp_queue[j++] = lp;
+      else
+	lp->event_queued = 0;
+    }
+  event_lwp_queue.resize (j);
+
+  return found;
+}
+
 /* Select the Nth LWP that has had an event.  */
 
 static int
@@ -2846,6 +2974,999 @@ save_stop_reason (struct lwp_info *lp)
   lp->stop_pc = pc;
 }
 
+/* A software breakpoint inserted with conditions for us to evaluate
+   (target-side condition evaluation).  */
+
+struct linux_nat_cond_breakpoint
+{
+  /* The breakpoint as placed, used to lift it and put it back while
+     stepping a thread past it.  Its CONDITIONS and TCOMMANDS are
+     left empty.  */
+  struct bp_target_info placed;
+
+  /* The architecture the breakpoint was inserted with.  */
+  struct gdbarch *gdbarch;
+
+  /* Private copies of the conditions.  The core's agent expressions
+     belong to the breakpoint locations, which may be deleted while
+     another location at the same address keeps the breakpoint
+     inserted.  */
+  std::vector<agent_expr_up> conditions;
+};
+
+/* All inserted breakpoints with target-side conditions.  */
+
+static std::vector<linux_nat_cond_breakpoint> cond_breakpoints;
+
+/* Return the conditional breakpoint inserted at ADDR in ASPACE, or
+   NULL.  */
+
+static struct linux_nat_cond_breakpoint *
+find_cond_breakpoint (struct address_space *aspace, CORE_ADDR addr)
+{
+  for (linux_nat_cond_breakpoint &bp : cond_breakpoints)
+    if (bp.placed.placed_address_space == aspace
+	&& bp.placed.placed_address == addr)
+      return &bp;
+
+  return NULL;
+}
+
+/* Forget the conditional breakpoint at ADDR in ASPACE, if any.  */
+
+static void
+forget_cond_breakpoint (struct address_space *aspace, CORE_ADDR addr)
+{
+  struct linux_nat_cond_breakpoint *bp = find_cond_breakpoint (aspace, addr);
+
+  if (bp != NULL)
+    cond_breakpoints.erase (cond_breakpoints.begin ()
+			    + (bp - cond_breakpoints.data ()));
+}
+
+/* Return true if LP, which just stopped for a software breakpoint,
+   hit a breakpoint with target-side conditions that all evaluate to
+   false.  Any error evaluating a condition counts as true, so that
+   the core gets to evaluate it.  */
+
+static bool
+cond_breakpoint_false_p (struct lwp_info *lp,
+			 struct linux_nat_cond_breakpoint *bp)
+{
+  struct regcache *regcache = get_thread_regcache (lp->ptid);
+
+  scoped_restore save_inferior_ptid = make_scoped_restore (&inferior_ptid);
+  inferior_ptid = lp->ptid;
+
+  for (const agent_expr_up &cond : bp->conditions)
+    {
+      TRY
+	{
+	  if (ax_eval (cond.get (), regcache, false) != 0)
+	    return false;
+	}
+      CATCH (ex, RETURN_MASK_ERROR)
+	{
+	  if (debug_linux_nat)
+	    fprintf_unfiltered (gdb_stdlog,
+				"CBF: error evaluating condition at %s "
+				"for %s: %s\n",
+				paddress (bp->gdbarch,
+					  bp->placed.placed_address),
+				target_pid_to_str (lp->ptid), ex.message);
+	  return false;
+	}
+      END_CATCH
+    }
+
+  return true;
+}
+
+/* Return the address space that stands for the memory of INF.  That
+   is INF's own, except for PiP tasks, which run in the memory of
+   their PiP root.  */
+
+static struct address_space *
+memory_aspace (struct inferior *inf)
+{
+#ifdef ENABLE_PIP
+  if (inf->pip_root_pid != 0)
+    {
+      struct inferior *root = find_inferior_pid (inf->pip_root_pid);
+
+      if (root != NULL)
+	return root->aspace;
+    }
+#endif
+
+  return inf->aspace;
+}
+
+/* Callback for iterate_over_lwps.  Send a SIGSTOP to LP if it is
+   running in the memory DATA (see memory_aspace).  LP is marked with
+   STOPPED_FOR_STEP_OVER so that it can be resumed later.  */
+
+static int
+stop_for_step_over_callback (struct lwp_info *lp, void *data)
+{
+  struct inferior *inf = find_inferior_ptid (lp->ptid);
+
+  if (inf == NULL || memory_aspace (inf) != (struct address_space *) data)
+    return 0;
+
+  if (!lp->stopped && !lp->signalled)
+    {
+      lp->stopped_for_step_over = 1;
+      stop_callback (lp, NULL);
+    }
+  return 0;
+}
+
+/* Callback for iterate_over_lwps.  Wait for LP to stop if it was
+   stopped by stop_for_step_over_callback.  */
+
+static int
+stop_wait_for_step_over_callback (struct lwp_info *lp, void *data)
+{
+  if (lp->stopped_for_step_over)
+    stop_wait_callback (lp, NULL);
+  return 0;
+}
+
+/* Callback for iterate_over_lwps.  Resume LP if it was stopped by
+   stop_for_step_over_callback and has nothing to report.  */
+
+static int
+resume_after_step_over_callback (struct lwp_info *lp, void *data)
+{
+  if (lp->stopped_for_step_over)
+    {
+      lp->stopped_for_step_over = 0;
+      resume_lwp (lp, lp->step, GDB_SIGNAL_0);
+    }
+  return 0;
+}
+
+/* Stop every running LWP that shares the memory of inferior INF, so
+   that one LWP can be stepped while something that protects that
+   memory (a breakpoint, a page protection) is lifted.  Events that
+   arrive meanwhile are left pending, to be reported as usual.  Undone
+   by resume_lwps_after_step_over.  */
+
+static void
+stop_lwps_for_step_over (struct inferior *inf)
+{
+  iterate_over_lwps (minus_one_ptid, stop_for_step_over_callback,
+		     memory_aspace (inf));
+  iterate_over_lwps (minus_one_ptid, stop_wait_for_step_over_callback, NULL);
+}
+
+/* Resume the LWPs stopped by stop_lwps_for_step_over.  */
+
+static void
+resume_lwps_after_step_over (void)
+{
+  iterate_over_lwps (minus_one_ptid, resume_after_step_over_callback, NULL);
+}
+
+/* Return a stopped LWP of process PID, or NULL.  */
+
+static struct lwp_info *
+find_stopped_lwp_of_pid (int pid)
+{
+  struct lwp_info *lp;
+
+  for (lp = lwp_list; lp != NULL; lp = lp->next)
+    if (lp->ptid.pid () == pid && lp->stopped)
+      return lp;
+
+  return NULL;
+}
+
+/* Step LP, which is stopped at the conditional breakpoint BP, past
+   it and let it run again.  Like gdbserver does, every other LWP that
+   could run through the lifted breakpoint is stopped meanwhile.
+   Events that arrive in the process are left pending, to be reported
+   as usual.  */
+
+static void
+step_over_cond_breakpoint (struct lwp_info *lp,
+			   struct linux_nat_cond_breakpoint *bp)
+{
+  ptid_t ptid = lp->ptid;
+  int status;
+
+  if (debug_linux_nat)
+    fprintf_unfiltered (gdb_stdlog,
+			"CBF: condition false at %s, stepping %s over\n",
+			paddress (bp->gdbarch, bp->placed.placed_address),
+			target_pid_to_str (ptid));
+
+  stop_lwps_for_step_over (find_inferior_ptid (ptid));
+
+  scoped_restore save_inferior_ptid = make_scoped_restore (&inferior_ptid);
+  inferior_ptid = ptid;
+
+  gdbarch_memory_remove_breakpoint (bp->gdbarch, &bp->placed);
+  linux_resume_one_lwp (lp, 1, GDB_SIGNAL_0);
+  status = wait_lwp (lp);
+
+  /* LP may be gone now; put the breakpoint back through any stopped
+     LWP of the process.  */
+  lp = find_lwp_pid (ptid);
+  if (lp == NULL)
+    {
+      struct lwp_info *other = find_stopped_lwp_of_pid (ptid.pid ());
+
+      if (other != NULL)
+	inferior_ptid = other->ptid;
+    }
+  if (lp != NULL || inferior_ptid != ptid)
+    gdbarch_memory_insert_breakpoint (bp->gdbarch, &bp->placed);
+
+  if (status != 0)
+    {
+      gdb_assert (lp != NULL && lp->stopped);
+
+      lp->status = status;
+      save_stop_reason (lp);
+      if (WSTOPSIG (status) == SIGTRAP
+	  && lp->stop_reason == TARGET_STOPPED_BY_NO_REASON
+	  && lp->waitstatus.kind == TARGET_WAITKIND_IGNORE)
+	{
+	  /* Just the end of the step.  */
+	  lp->status = 0;
+	  linux_resume_one_lwp (lp, 0, GDB_SIGNAL_0);
+	}
+      else
+	{
+	  /* Something else happened (a signal, a watchpoint
+	     trigger, ...).  Leave it for the core.  If the LWP did
+	     not get past the breakpoint, it hits it again once
+	     resumed.  */
+	  lp->step = 0;
+	  queue_event_lwp (lp);
+	}
+    }
+
+  resume_lwps_after_step_over ();
+}
+
+/* Called when LP stopped for a software breakpoint.  If the
+   breakpoint has target-side conditions and they are all false, step
+   LP past it, resume it, and return true; the event is consumed.
+   Otherwise return false, and the event is reported as usual.  */
+
+static bool
+linux_nat_skip_false_cond_breakpoint (struct lwp_info *lp)
+{
+  struct linux_nat_cond_breakpoint *bp;
+  struct inferior *inf;
+
+  if (cond_breakpoints.empty ()
+      || lp->stop_reason != TARGET_STOPPED_BY_SW_BREAKPOINT
+      || lp->step
+      || lp->signalled
+      || lp->last_resume_kind == resume_stop)
+    return false;
+
+  inf = find_inferior_ptid (lp->ptid);
+  if (inf == NULL || inf->vfork_child != NULL)
+    return false;
+
+  bp = find_cond_breakpoint (inf->aspace, lp->stop_pc);
+  if (bp == NULL || !cond_breakpoint_false_p (lp, bp))
+    return false;
+
+  lp->status = 0;
+  lp->stop_reason = TARGET_STOPPED_BY_NO_REASON;
+  step_over_cond_breakpoint (lp, bp);
+  return true;
+}
+
+/* Implement the insert_breakpoint target method.  Remember the
+   breakpoint if it comes with conditions for us to evaluate.  */
+
+int
+linux_nat_target::insert_breakpoint (struct gdbarch *gdbarch,
+				     struct bp_target_info *bp_tgt)
+{
+  int ret = inf_ptrace_target::insert_breakpoint (gdbarch, bp_tgt);
+
+  /* This may be a re-insertion with an updated condition list.  */
+  forget_cond_breakpoint (bp_tgt->placed_address_space,
+			  bp_tgt->placed_address);
+
+  if (ret == 0 && !bp_tgt->conditions.empty ())
+    {
+      linux_nat_cond_breakpoint bp;
+
+      bp.placed = *bp_tgt;
+      bp.placed.conditions.clear ();
+      bp.placed.tcommands.clear ();
+      bp.gdbarch = gdbarch;
+      for (agent_expr *cond : bp_tgt->conditions)
+	{
+	  agent_expr_up copy (new agent_expr (cond->gdbarch, cond->scope));
+
+	  for (int i = 0; i < cond->len; i++)
+	    ax_raw_byte (copy.get (), cond->buf[i]);
+	  bp.conditions.push_back (std::move (copy));
+	}
+      cond_breakpoints.push_back (std::move (bp));
+    }
+
+  return ret;
+}
+
+/* Implement the remove_breakpoint target method.  */
+
+int
+linux_nat_target::remove_breakpoint (struct gdbarch *gdbarch,
+				     struct bp_target_info *bp_tgt,
+				     enum remove_bp_reason reason)
+{
+  /* Detaching breakpoints takes them out of a fork child only; the
+     parent keeps them, conditions included.  */
+  if (reason != DETACH_BREAKPOINT)
+    forget_cond_breakpoint (bp_tgt->placed_address_space,
+			    bp_tgt->placed_address);
+
+  return inf_ptrace_target::remove_breakpoint (gdbarch, bp_tgt, reason);
+}
+
+/* Implement the supports_evaluation_of_breakpoint_conditions target
+   method.  */
+
+bool
+linux_nat_target::supports_evaluation_of_breakpoint_conditions ()
+{
+  return true;
+}
+
+
+/* Page-protection watchpoints.
+
+   When the debug registers cannot take a watchpoint, the native
+   target may protect the pages holding the watched range instead
+   (see linux_nat_insert_page_watchpoint).  Accesses to those pages
+   then fault with SIGSEGV.  linux_nat_filter_event recognizes these
+   faults, steps the faulting LWP over the access with the protection
+   lifted and every other LWP of the address space stopped, puts the
+   protection back, and reports a watchpoint trigger if the access
+   was to a watched range.  Protections are changed by running
+   mprotect in the inferior, see low_inferior_mprotect.  */
+
+/* A watchpoint implemented with page protections.  ASPACE is the
+   memory it watches (see memory_aspace), INF the inferior it was set
+   in.  */
+
+struct linux_nat_page_watch
+{
+  struct address_space *aspace;
+  struct inferior *inf;
+  CORE_ADDR addr;
+  int len;
+  enum target_hw_bp_type type;
+};
+
+static std::vector<linux_nat_page_watch> page_watches;
+
+/* Whether new watchpoints may be implemented with page protections
+   ("set can-use-page-watchpoints").  Off by default: system calls that
+   write to a protected page fail instead of triggering them.  */
+static int can_use_page_watchpoints = 0;
+
+/* A page whose protection was changed for page watchpoints.  */
+
+struct linux_nat_protected_page
+{
+  /* The protection the page had before, and the one it has now.  */
+  int orig_prot;
+  int prot;
+};
+
+typedef std::pair<struct address_space *, CORE_ADDR> protected_page_key;
+
+static std::map<protected_page_key, linux_nat_protected_page>
+  protected_pages;
+
+/* The most bytes a single instruction is assumed to access.  A fault
+   at ADDR is a watchpoint trigger if ADDR is inside a watched range.
+   An access that faults before a write watchpoint, but no further
+   than this, may still reach into it; it is a trigger if stepping
+   over it changes the watched bytes.  */
+#define PAGE_WATCH_ACCESS_MAX 64
+
+/* Return the size of the pages that are protected.  */
+
+static CORE_ADDR
+page_watch_page_size (void)
+{
+  static CORE_ADDR page_size;
+
+  if (page_size == 0)
+    page_size = sysconf (_SC_PAGESIZE);
+  return page_size;
+}
+
+/* A mapping read from /proc/PID/maps.  */
+
+struct linux_nat_mapping
+{
+  CORE_ADDR start;
+  CORE_ADDR end;
+  int prot;
+};
+
+/* Read the mappings of process PID, in ascending address order.  */
+
+static std::vector<linux_nat_mapping>
+linux_proc_read_mappings (int pid)
+{
+  std::vector<linux_nat_mapping> mappings;
+  char filename[100];
+  char line[256];
+  bool line_start = true;
+
+  xsnprintf (filename, sizeof filename, "/proc/%d/maps", pid);
+  gdb_file_up file = gdb_fopen_cloexec (filename, "r");
+  if (file == NULL)
+    return mappings;
+
+  while (fgets (line, sizeof line, file.get ()) != NULL)
+    {
+      unsigned long start, end;
+      char perms[5];
+      bool at_start = line_start;
+
+      /* Only look at the start of each line; the file names may be
+	 longer than LINE.  */
+      line_start = strchr (line, '\n') != NULL;
+      if (!at_start
+	  || sscanf (line, "%lx-%lx %4s", &start, &end, perms) != 3)
+	continue;
+
+      linux_nat_mapping m;
+
+      m.start = start;
+      m.end = end;
+      m.prot = ((perms[0] == 'r' ? PROT_READ : 0)
+		| (perms[1] == 'w' ? PROT_WRITE : 0)
+		| (perms[2] == 'x' ? PROT_EXEC : 0));
+      mappings.push_back (m);
+    }
+
+  return mappings;
+}
+
+/* Return the protection of the page at PAGE in MAPPINGS, or -1 if it
+   is not mapped.  */
+
+static int
+mappings_page_prot (const std::vector<linux_nat_mapping> &mappings,
+		    CORE_ADDR page)
+{
+  auto it = std::upper_bound (mappings.begin (), mappings.end (), page,
+			      [] (CORE_ADDR addr, const linux_nat_mapping &m)
+			      {
+				return addr < m.start;
+			      });
+
+  if (it == mappings.begin () || page >= (it - 1)->end)
+    return -1;
+  return (it - 1)->prot;
+}
+
+/* Return the protection the page at PAGE in ASPACE needs, given that
+   it originally had ORIG_PROT.  */
+
+static int
+page_watch_wanted_prot (struct address_space *aspace, CORE_ADDR page,
+			int orig_prot)
+{
+  CORE_ADDR page_end = page + page_watch_page_size ();
+  int prot = orig_prot;
+
+  for (const linux_nat_page_watch &w : page_watches)
+    if (w.aspace == aspace && w.addr < page_end && page < w.addr + w.len)
+      {
+	/* Reads do not fault on a page that is merely read-only.  */
+	if (w.type == hw_write)
+	  prot &= ~PROT_WRITE;
+	else
+	  prot = PROT_NONE;
+      }
+
+  return prot;
+}
+
+/* Run mprotect (ADDR, LEN, PROT) in process PID, through one of its
+   stopped LWPs.  Return 0 on success, or a negated errno value.  The
+   other LWPs of the process must not be running.  */
+
+static int
+page_watch_mprotect (int pid, CORE_ADDR addr, ULONGEST len, int prot)
+{
+  struct lwp_info *lp = find_lwp_pid (inferior_ptid);
+  int lwpid;
+
+  if (lp == NULL || lp->ptid.pid () != pid || !lp->stopped)
+    lp = find_stopped_lwp_of_pid (pid);
+
+  /* A fork child being detached is not in the LWP list, but it is
+     stopped.  */
+  lwpid = lp != NULL ? lp->ptid.lwp () : pid;
+
+  if (debug_linux_nat)
+    fprintf_unfiltered (gdb_stdlog,
+			"PW: mprotect (%s, %s, %d) in LWP %d\n",
+			core_addr_to_string (addr), pulongest (len),
+			prot, lwpid);
+
+  return linux_target->low_inferior_mprotect (lwpid, addr, len, prot);
+}
+
+/* Bring the protection of the pages covering [LO, HI) in ASPACE, the
+   address space of process PID, in line with PAGE_WATCHES.  Return 0
+   on success, -1 on failure.  */
+
+static int
+page_watch_update_range (struct address_space *aspace, int pid,
+			 CORE_ADDR lo, CORE_ADDR hi)
+{
+  struct page_change
+  {
+    CORE_ADDR page;
+    int orig_prot;
+    int prot;
+  };
+  CORE_ADDR page_size = page_watch_page_size ();
+  std::vector<linux_nat_mapping> mappings;
+  std::vector<page_change> changes;
+  CORE_ADDR page;
+  int ret = 0;
+
+  lo &= ~(page_size - 1);
+  hi = (hi + page_size - 1) & ~(page_size - 1);
+
+  for (page = lo; page < hi; page += page_size)
+    {
+      auto it = protected_pages.find (protected_page_key (aspace, page));
+      int orig_prot, prot;
+
+      if (it != protected_pages.end ())
+	orig_prot = it->second.orig_prot;
+      else
+	{
+	  if (mappings.empty ())
+	    mappings = linux_proc_read_mappings (pid);
+	  orig_prot = mappings_page_prot (mappings, page);
+	  if (orig_prot == -1)
+	    return -1;
+	}
+
+      prot = page_watch_wanted_prot (aspace, page, orig_prot);
+      if (prot != (it != protected_pages.end () ? it->second.prot
+		   : orig_prot))
+	changes.push_back ({page, orig_prot, prot});
+    }
+
+  /* Change runs of adjacent pages that get the same protection
+     together.  */
+  for (size_t i = 0; i < changes.size (); )
+    {
+      size_t j;
+
+      for (j = i + 1; j < changes.size (); j++)
+	if (changes[j].page != changes[j - 1].page + page_size
+	    || changes[j].prot != changes[i].prot)
+	  break;
+
+      if (page_watch_mprotect (pid, changes[i].page,
+			       changes[j - 1].page + page_size
+			       - changes[i].page,
+			       changes[i].prot) != 0)
+	ret = -1;
+      else
+	for (size_t k = i; k < j; k++)
+	  {
+	    protected_page_key key (aspace, changes[k].page);
+
+	    if (changes[k].prot == changes[k].orig_prot)
+	      protected_pages.erase (key);
+	    else
+	      protected_pages[key] = { changes[k].orig_prot, changes[k].prot };
+	  }
+
+      i = j;
+    }
+
+  return ret;
+}
+
+/* Forget the page watchpoints of INF, which exited or exec'd.  If
+   another live inferior shares its memory, the protections are
+   brought in line through that inferior; otherwise the pages are
+   gone.  */
+
+static void
+forget_page_watches (struct inferior *inf)
+{
+  struct address_space *aspace = memory_aspace (inf);
+  struct inferior *other = NULL;
+  std::vector<linux_nat_page_watch> gone;
+
+  for (auto it = page_watches.begin (); it != page_watches.end (); )
+    if (it->inf == inf)
+      {
+	gone.push_back (*it);
+	it = page_watches.erase (it);
+      }
+    else
+      ++it;
+
+#ifdef ENABLE_PIP
+  ALL_NON_EXITED_INFERIORS (other)
+    if (pip_inferiors_share_memory_p (inf, other))
+      break;
+#endif
+
+  if (other != NULL)
+    {
+      stop_lwps_for_step_over (other);
+      scoped_restore save_inferior_ptid
+	= make_scoped_restore (&inferior_ptid);
+      inferior_ptid = ptid_t (other->pid);
+      for (const linux_nat_page_watch &w : gone)
+	page_watch_update_range (aspace, other->pid, w.addr, w.addr + w.len);
+      resume_lwps_after_step_over ();
+      return;
+    }
+
+  for (auto it = protected_pages.begin (); it != protected_pages.end (); )
+    if (it->first.first == aspace)
+      it = protected_pages.erase (it);
+    else
+      ++it;
+}
+
+/* See linux-nat.h.  */
+
+bool
+linux_nat_can_use_page_watchpoints (void)
+{
+  return can_use_page_watchpoints;
+}
+
+/* See linux-nat.h.  */
+
+int
+linux_nat_page_watch_orig_prot (struct inferior *inf, CORE_ADDR page)
+{
+  auto it = protected_pages.find (protected_page_key (memory_aspace (inf),
+						      page));
+
+  if (it == protected_pages.end ())
+    return -1;
+  return it->second.orig_prot;
+}
+
+/* See linux-nat.h.  */
+
+int
+linux_nat_insert_page_watchpoint (CORE_ADDR addr, int len,
+				  enum target_hw_bp_type type)
+{
+  struct inferior *inf = find_inferior_ptid (inferior_ptid);
+  struct address_space *aspace;
+  int ret;
+
+  if (inf == NULL || len <= 0)
+    return -1;
+
+  aspace = memory_aspace (inf);
+  page_watches.push_back ({aspace, inf, addr, len, type});
+
+  stop_lwps_for_step_over (inf);
+  ret = page_watch_update_range (aspace, inf->pid, addr, addr + len);
+  if (ret != 0)
+    {
+      page_watches.pop_back ();
+      page_watch_update_range (aspace, inf->pid, addr, addr + len);
+    }
+  resume_lwps_after_step_over ();
+
+  return ret;
+}
+
+/* See linux-nat.h.  */
+
+int
+linux_nat_remove_page_watchpoint (CORE_ADDR addr, int len,
+				  enum target_hw_bp_type type)
+{
+  struct inferior *inf = current_inferior ();
+  struct address_space *aspace = memory_aspace (inf);
+  int pid = inferior_ptid.pid ();
+  int ret;
+
+  auto it = std::find_if (page_watches.begin (), page_watches.end (),
+			  [=] (const linux_nat_page_watch &w)
+			  {
+			    return (w.inf == inf && w.addr == addr
+				    && w.len == len && w.type == type);
+			  });
+  if (it == page_watches.end ())
+    return 1;
+
+  if (find_inferior_pid (pid) == NULL)
+    {
+      CORE_ADDR page_size = page_watch_page_size ();
+      CORE_ADDR page;
+
+      /* This is a fork child of the current inferior, getting rid of
+	 the watchpoints it inherited (see detach_breakpoints).  The
+	 child got copies of the protected pages; give them their
+	 original protection back, and leave the parent alone.  */
+      ret = 0;
+      for (page = addr & ~(page_size - 1); page < addr + len;
+	   page += page_size)
+	{
+	  auto p = protected_pages.find (protected_page_key (aspace, page));
+
+	  if (p != protected_pages.end ()
+	      && page_watch_mprotect (pid, page, page_size,
+				      p->second.orig_prot) != 0)
+	    ret = -1;
+	}
+      return ret;
+    }
+
+  page_watches.erase (it);
+
+  stop_lwps_for_step_over (inf);
+  ret = page_watch_update_range (aspace, inf->pid, addr, addr + len);
+  resume_lwps_after_step_over ();
+
+  return ret;
+}
+
+/* Return true if STATUS, the wait status of LP, is a fault on a page
+   protected for page watchpoints.  If ADDRP is not NULL, store the
+   faulting address there.  */
+
+static bool
+page_watch_fault_p (struct lwp_info *lp, int status, CORE_ADDR *addrp)
+{
+  CORE_ADDR page_size = page_watch_page_size ();
+  struct inferior *inf;
+  siginfo_t siginfo;
+  CORE_ADDR addr;
+
+  if (protected_pages.empty ()
+      || !WIFSTOPPED (status) || WSTOPSIG (status) != SIGSEGV
+      || !linux_nat_get_siginfo (lp->ptid, &siginfo)
+      || siginfo.si_signo != SIGSEGV || siginfo.si_code != SEGV_ACCERR)
+    return false;
+
+  inf = find_inferior_ptid (lp->ptid);
+  if (inf == NULL)
+    return false;
+
+  addr = (CORE_ADDR) (uintptr_t) siginfo.si_addr;
+  if (protected_pages.find (protected_page_key (memory_aspace (inf),
+						addr & ~(page_size - 1)))
+      == protected_pages.end ())
+    return false;
+
+  if (addrp != NULL)
+    *addrp = addr;
+  return true;
+}
+
+/* Return true if the page watchpoint W applies to accesses by
+   inferior INF.  */
+
+static bool
+page_watch_applies_p (const linux_nat_page_watch &w, struct inferior *inf)
+{
+  if (w.aspace != memory_aspace (inf))
+    return false;
+#ifdef ENABLE_PIP
+  return pip_watchpoints_shared_p (w.inf, inf);
+#else
+  return w.inf == inf;
+#endif
+}
+
+/* Return the page watchpoint that a fault at ADDR by inferior INF
+   triggers, or NULL.  */
+
+static const linux_nat_page_watch *
+page_watch_hit (struct inferior *inf, CORE_ADDR addr)
+{
+  for (const linux_nat_page_watch &w : page_watches)
+    if (addr >= w.addr && addr < w.addr + w.len
+	&& page_watch_applies_p (w, inf))
+      return &w;
+
+  return NULL;
+}
+
+/* Return the write page watchpoint that an access by inferior INF
+   faulting at ADDR, just before it, may reach into, or NULL.  */
+
+static const linux_nat_page_watch *
+page_watch_near (struct inferior *inf, CORE_ADDR addr)
+{
+  for (const linux_nat_page_watch &w : page_watches)
+    if (w.type == hw_write
+	&& addr < w.addr && w.addr - addr < PAGE_WATCH_ACCESS_MAX
+	&& page_watch_applies_p (w, inf))
+      return &w;
+
+  return NULL;
+}
+
+/* LP stopped with a fault at ADDR, on a page protected for page
+   watchpoints.  Step it over the faulting instruction with the
+   protection lifted, then protect the page again.  Every other LWP
+   of the address space is stopped meanwhile.  Return LP if it has an
+   event to report (a watchpoint trigger, the end of a single-step,
+   or whatever else happened during the step), or NULL if it was
+   resumed.  */
+
+static struct lwp_info *
+step_over_page_watch_fault (struct lwp_info *lp, CORE_ADDR addr)
+{
+  struct inferior *inf = find_inferior_ptid (lp->ptid);
+  struct address_space *aspace = memory_aspace (inf);
+  CORE_ADDR page_size = page_watch_page_size ();
+  ptid_t ptid = lp->ptid;
+  int step = lp->step;
+  std::vector<CORE_ADDR> lifted;
+  CORE_ADDR data_addr = 0;
+  bool hit = false;
+  int status = 0;
+  /* The bytes of a write watchpoint that the access might reach, and
+     their contents before the step.  */
+  CORE_ADDR near_addr = 0;
+  gdb::byte_vector near_bytes;
+
+  stop_lwps_for_step_over (inf);
+
+  scoped_restore save_inferior_ptid = make_scoped_restore (&inferior_ptid);
+  inferior_ptid = ptid;
+
+  /* An instruction may touch more than one protected page; lift them
+     one at a time, as the faults come.  */
+  while (1)
+    {
+      CORE_ADDR page = addr & ~(page_size - 1);
+      const linux_nat_page_watch *w = page_watch_hit (inf, addr);
+
+      if (debug_linux_nat)
+	fprintf_unfiltered (gdb_stdlog,
+			    "PWF: %s faulted at %s (%s)\n",
+			    target_pid_to_str (ptid),
+			    core_addr_to_string (addr),
+			    w != NULL ? "hit" : "miss");
+
+      if (w != NULL && !hit)
+	{
+	  hit = true;
+	  data_addr = addr;
+	}
+      else if (w == NULL && !hit && near_bytes.empty ())
+	{
+	  const linux_nat_page_watch *near = page_watch_near (inf, addr);
+
+	  if (near != NULL)
+	    {
+	      near_addr = near->addr;
+	      near_bytes.resize (std::min<ULONGEST>
+				 (near->len,
+				  addr + PAGE_WATCH_ACCESS_MAX - near->addr));
+	      if (target_read_memory (near_addr, near_bytes.data (),
+				      near_bytes.size ()) != 0)
+		near_bytes.clear ();
+	    }
+	}
+
+      /* A fault on a page we already lifted is not ours.  */
+      if (std::find (lifted.begin (), lifted.end (), page) != lifted.end ()
+	  || (page_watch_mprotect (ptid.pid (), page, page_size,
+				   protected_pages[protected_page_key
+						   (aspace, page)].orig_prot)
+	      != 0))
+	break;
+      lifted.push_back (page);
+
+      linux_resume_one_lwp (lp, 1, GDB_SIGNAL_0);
+      status = wait_lwp (lp);
+
+      lp = find_lwp_pid (ptid);
+      if (status == 0 || !page_watch_fault_p (lp, status, &addr))
+	break;
+    }
+
+  /* Protect the pages again, through any stopped LWP of the process
+     if LP is gone.  */
+  if (lp == NULL)
+    {
+      struct lwp_info *other = find_stopped_lwp_of_pid (ptid.pid ());
+
+      if (other != NULL)
+	inferior_ptid = other->ptid;
+    }
+  if (lp != NULL || inferior_ptid != ptid)
+    for (CORE_ADDR page : lifted)
+      page_watch_mprotect (ptid.pid (), page, page_size,
+			   protected_pages[protected_page_key
+					   (aspace, page)].prot);
+
+  if (lp != NULL && lifted.empty ())
+    {
+      /* The protection could not be lifted; report the fault.  */
+      lp->status = W_STOPCODE (SIGSEGV);
+      save_stop_reason (lp);
+      queue_event_lwp (lp);
+    }
+  else if (lp != NULL && status != 0)
+    {
+      lp->status = status;
+      save_stop_reason (lp);
+      lp->step = step;
+      if (WSTOPSIG (status) == SIGTRAP
+	  && lp->stop_reason == TARGET_STOPPED_BY_NO_REASON
+	  && lp->waitstatus.kind == TARGET_WAITKIND_IGNORE)
+	{
+	  /* The access is done.  An access that faulted before a
+	     write watchpoint hit it if it changed the watched bytes.  */
+	  if (!hit && !near_bytes.empty ())
+	    {
+	      gdb::byte_vector now (near_bytes.size ());
+
+	      if (target_read_memory (near_addr, now.data (), now.size ()) == 0
+		  && now != near_bytes)
+		{
+		  hit = true;
+		  data_addr = near_addr;
+		}
+	    }
+	  if (hit)
+	    {
+	      lp->stop_reason = TARGET_STOPPED_BY_WATCHPOINT;
+	      lp->stopped_data_address_p = 1;
+	      lp->stopped_data_address = data_addr;
+	      queue_event_lwp (lp);
+	    }
+	  else if (step)
+	    queue_event_lwp (lp);
+	  else
+	    {
+	      lp->status = 0;
+	      linux_resume_one_lwp (lp, 0, GDB_SIGNAL_0);
+	      lp = NULL;
+	    }
+	}
+      else
+	{
+	  /* Something else happened (a signal, a hardware watchpoint
+	     trigger, ...).  Leave it for the core.  */
+	  queue_event_lwp (lp);
+	}
+    }
+  else
+    {
+      /* LP is gone, or has an extended event pending already.  */
+      lp = NULL;
+    }
+
+  resume_lwps_after_step_over ();
+  return lp;
+}
 
 /* Returns true if the LWP had stopped for a software breakpoint.  */
 
@@ -2899,6 +4020,7 @@ select_event_lwp (ptid_t filter, struct lwp_info **orig_lp, int *status)
 
   /* Record the wait status for the original LWP.  */
   (*orig_lp)->status = *status;
+  queue_event_lwp (*orig_lp);
 
   /* In all-stop, give preference to the LWP that is being
      single-stepped.  There will be at most one, and it will be the
@@ -2911,8 +4033,9 @@ select_event_lwp (ptid_t filter, struct lwp_info **orig_lp, int *status)
      signal.  */
   if (!target_is_non_stop_p ())
     {
-      event_lp = iterate_over_lwps (filter,
-				    select_singlestep_lwp_callback, NULL);
+      event_lp = iterate_over_event_lwps (filter,
+					  select_singlestep_lwp_callback,
+					  NULL);
       if (event_lp != NULL)
 	{
 	  if (debug_linux_nat)
@@ -2927,7 +4050,7 @@ select_event_lwp (ptid_t filter, struct lwp_info **orig_lp, int *status)
       /* Pick one at random, out of those which have had events.  */
 
       /* First see how many events we have.  */
-      iterate_over_lwps (filter, count_events_callback, &num_events);
+      iterate_over_event_lwps (filter, count_events_callback, &num_events);
       gdb_assert (num_events > 0);
 
       /* Now randomly pick a LWP out of those that have had
@@ -2940,9 +4063,9 @@ select_event_lwp (ptid_t filter, struct lwp_info **orig_lp, int *status)
 			    "SEL: Found %d events, selecting #%d\n",
 			    num_events, random_selector);
 
-      event_lp = iterate_over_lwps (filter,
-				    select_event_lwp_callback,
-				    &random_selector);
+      event_lp = iterate_over_event_lwps (filter,
+					  select_event_lwp_callback,
+					  &random_selector);
     }
 
   if (event_lp != NULL)
@@ -2972,6 +4095,7 @@ linux_nat_filter_event (int lwpid, int status)
 {
   struct lwp_info *lp;
   int event = linux_ptrace_get_extended_event (status);
+  CORE_ADDR addr;
 
   lp = find_lwp_pid (ptid_t (lwpid));
 
@@ -3061,6 +4185,7 @@ linux_nat_filter_event (int lwpid, int status)
 			    status);
       if (linux_handle_extended_wait (lp, status))
 	return NULL;
+      queue_event_lwp (lp);
     }
 
   /* Check if the thread has exited.  */
@@ -3096,6 +4221,7 @@ linux_nat_filter_event (int lwpid, int status)
       /* Store the pending event in the waitstatus, because
 	 W_EXITCODE(0,0) == 0.  */
       store_waitstatus (&lp->waitstatus, status);
+      queue_event_lwp (lp);
       return lp;
     }
 
@@ -3156,6 +4282,21 @@ linux_nat_filter_event (int lwpid, int status)
       return NULL;
     }
 
+  /* Faults on pages protected for page watchpoints are ours, even if
+     the program's own SIGSEGVs are passed to it silently.  */
+  if (WIFSTOPPED (status) && page_watch_fault_p (lp, status, &addr))
+    {
+      if (lp->signalled)
+	{
+	  /* A SIGSTOP is on its way; let the LWP collect it.  The
+	     fault happens again later.  */
+	  linux_resume_one_lwp (lp, lp->step, GDB_SIGNAL_0);
+	  return NULL;
+	}
+
+      return step_over_page_watch_fault (lp, addr);
+    }
+
   /* Don't report signals that GDB isn't interested in, such as
      signals that are neither printed nor stopped upon.  Stopping all
      threads can be a bit time-consuming so if we want decent
@@ -3211,6 +4352,13 @@ linux_nat_filter_event (int lwpid, int status)
   gdb_assert (lp);
   lp->status = status;
   save_stop_reason (lp);
+
+  /* A breakpoint whose target-side conditions are false is not an
+     event at all.  */
+  if (linux_nat_skip_false_cond_breakpoint (lp))
+    return NULL;
+
+  queue_event_lwp (lp);
   return lp;
 }
 
@@ -3323,7 +4471,7 @@ linux_nat_wait_1 (ptid_t ptid, struct target_waitstatus *ourstatus,
   block_child_signals (&prev_mask);
 
   /* First check if there is a LWP with a wait status pending.  */
-  lp = iterate_over_lwps (ptid, status_callback, NULL);
+  lp = iterate_over_event_lwps (ptid, status_callback, NULL);
   if (lp != NULL)
     {
       if (debug_linux_nat)
@@ -3384,10 +4532,24 @@ linux_nat_wait_1 (ptid_t ptid, struct target_waitstatus *ourstatus,
 
       /* ... and find an LWP with a status to report to the core, if
 	 any.  */
-      lp = iterate_over_lwps (ptid, status_callback, NULL);
+      lp = iterate_over_event_lwps (ptid, status_callback, NULL);
       if (lp != NULL)
 	break;
 
+      /* Nothing queued.  Before going to sleep, double check with a
+	 walk over all LWPs; this is once per batch of events rather
+	 than once per event.  */
+      lp = iterate_over_lwps (ptid, status_callback, NULL);
+      if (lp != NULL)
+	{
+	  if (debug_linux_nat)
+	    fprintf_unfiltered (gdb_stdlog,
+				"LLW: %s has an unqueued status pending\n",
+				target_pid_to_str (lp->ptid));
+	  queue_event_lwp (lp);
+	  break;
+	}
+
       /* Check for zombie thread group leaders.  Those can't be reaped
 	 until all other threads in the thread group are.  */
       check_zombie_leaders ();
@@ -3789,9 +4951,25 @@ void
 linux_nat_target::mourn_inferior ()
 {
   int pid = inferior_ptid.pid ();
+  struct inferior *inf;
 
   purge_lwp_list (pid);
 
+  /* The breakpoints and watchpoints of a process that is gone are
+     never removed.  */
+  inf = find_inferior_pid (pid);
+  if (inf != NULL)
+    cond_breakpoints.erase
+      (std::remove_if (cond_breakpoints.begin (), cond_breakpoints.end (),
+		       [=] (const linux_nat_cond_breakpoint &bp)
+		       {
+			 return bp.placed.placed_address_space == inf->aspace;
+		       }),
+       cond_breakpoints.end ());
+  if (inf != NULL)
+    forget_page_watches (inf);
+  linux_snapshot_forget (pid);
+
   if (! forks_exist_p ())
     /* Normal case, no other forks available.  */
     inf_ptrace_target::mourn_inferior ();
@@ -4745,6 +5923,19 @@ Enables printf debugging output."),
 			   NULL,
 			   &setdebuglist, &showdebuglist);
 
+  add_setshow_boolean_cmd ("can-use-page-watchpoints", class_support,
+			   &can_use_page_watchpoints, _("\
+Set whether watchpoints may be implemented by protecting memory pages."), _("\
+Show whether watchpoints may be implemented by protecting memory pages."), _("\
+When on, watchpoints that the debug registers cannot take are set by\n\
+protecting the pages that hold the watched memory, instead of becoming\n\
+software watchpoints.  System calls that write to a protected page fail\n\
+with EFAULT rather than triggering the watchpoint.  This only affects\n\
+watchpoints set afterwards."),
+			   NULL,
+			   NULL,
+			   &setlist, &showlist);
+
   /* Save this mask as the default.  */
   sigprocmask (SIG_SETMASK, NULL, &normal_mask);
 
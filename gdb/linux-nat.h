@@ -74,6 +74,12 @@ public:
   bool stopped_by_sw_breakpoint () override;
   bool supports_stopped_by_sw_breakpoint () override;
 
+  int insert_breakpoint (struct gdbarch *, struct bp_target_info *) override;
+  int remove_breakpoint (struct gdbarch *, struct bp_target_info *,
+			 enum remove_bp_reason) override;
+
+  bool supports_evaluation_of_breakpoint_conditions () override;
+
   bool stopped_by_hw_breakpoint () override;
   bool supports_stopped_by_hw_breakpoint () override;
 
@@ -181,6 +187,13 @@ public:
   /* SIGTRAP-like breakpoint status events recognizer.  The default
      recognizes SIGTRAP only.  */
   virtual bool low_status_is_event (int status);
+
+  /* Make the stopped LWP LWPID call mprotect (ADDR, LEN, PROT), for
+     page-protection watchpoints.  The LWP is left as it was found.
+     Return 0 on success, or a negated errno value.  */
+  virtual int low_inferior_mprotect (int lwpid, CORE_ADDR addr,
+				     ULONGEST len, int prot)
+  { return -ENOSYS; }
 };
 
 /* The final/concrete instance.  */
@@ -266,6 +279,15 @@ struct lwp_info
   /* Arch-specific additions.  */
   struct arch_lwp_info *arch_private;
 
+  /* Non-zero if this LWP is in the queue of LWPs that may have a
+     wait status pending.  */
+  int event_queued;
+
+  /* Non-zero if this LWP was stopped so that another LWP could step
+     past a lifted breakpoint or page protection, and must be resumed
+     afterwards.  */
+  int stopped_for_step_over;
+
   /* Previous and next pointers in doubly-linked list of known LWPs,
      sorted by reverse creation order.  */
   struct lwp_info *prev;
@@ -322,3 +344,26 @@ void linux_nat_switch_fork (ptid_t new_ptid);
    Return 1 if it was retrieved successfully, 0 otherwise (*SIGINFO is
    uninitialized in such case).  */
 int linux_nat_get_siginfo (ptid_t ptid, siginfo_t *siginfo);
+
+/* Return true if watchpoints the hardware cannot take may be
+   implemented with linux_nat_insert_page_watchpoint ("set
+   can-use-page-watchpoints").  */
+extern bool linux_nat_can_use_page_watchpoints (void);
+
+/* Watch [ADDR, ADDR + LEN) for accesses of type TYPE in the current
+   inferior by protecting the pages that hold it, for when the
+   hardware cannot watch the range.  Return 0 on success, -1 on
+   failure.  Needs an implementation of low_inferior_mprotect.  */
+extern int linux_nat_insert_page_watchpoint (CORE_ADDR addr, int len,
+					     enum target_hw_bp_type type);
+
+/* Remove a watchpoint inserted with linux_nat_insert_page_watchpoint.
+   Return 0 on success, -1 on failure, and 1 if there is no such page
+   watchpoint.  */
+extern int linux_nat_remove_page_watchpoint (CORE_ADDR addr, int len,
+					     enum target_hw_bp_type type);
+
+/* Return the protection the page at PAGE of INF had before page
+   watchpoints changed it, or -1 if they did not.  */
+extern int linux_nat_page_watch_orig_prot (struct inferior *inf,
+					   CORE_ADDR page);
@@ -0,0 +1,932 @@
+/* GNU/Linux native snapshot checkpoints.
+
+   Copyright (C) 2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* A snapshot records the registers of the (single-threaded) process
+   and the contents of its private writable memory.  Snapshots form a
+   tree: each one is taken from the state the process was in, which
+   is that of the last snapshot taken or restarted (the current one)
+   plus whatever changed since.  A snapshot stores only the pages
+   that differ from its parent, in a reference-counted arena of
+   pages, so taking one costs memory in proportion to what the
+   program wrote.
+
+   The pages the program wrote are found with the kernel's soft-dirty
+   bits (/proc/PID/clear_refs and /proc/PID/pagemap) when it has
+   them, and by comparing the resident pages with the contents of the
+   current snapshot otherwise.  Restarting snapshot N writes back only
+   the pages that changed since the current snapshot, plus those that
+   differ between the two snapshots.
+
+   Unlike fork checkpoints, snapshots do not undo changes to the
+   mappings of the process, nor to kernel state other than file
+   positions.  */
+
+#include "defs.h"
+#include "arch-utils.h"
+#include "inferior.h"
+#include "infrun.h"
+#include "regcache.h"
+#include "gdbcmd.h"
+#include "gdbthread.h"
+#include "target.h"
+#include "target-dcache.h"
+#include "breakpoint.h"
+#include "stack.h"
+#include "linux-fork.h"
+#include "linux-nat.h"
+#include "linux-snapshot.h"
+#include "common/filestuff.h"
+#include "common/scoped_fd.h"
+#include "common/byte-vector.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/* Bits of /proc/PID/pagemap entries.  */
+#define PAGEMAP_PRESENT ((uint64_t) 1 << 63)
+#define PAGEMAP_SWAPPED ((uint64_t) 1 << 62)
+#define PAGEMAP_SOFT_DIRTY ((uint64_t) 1 << 55)
+
+/* The most pages read or written with one system call.  */
+#define SNAPSHOT_IO_PAGES 64
+
+/* The number of pages in each block of the arena.  */
+#define SNAPSHOT_ARENA_BLOCK_PAGES 256
+
+/* A page of snapshot contents: an index into the arena, or
+   SNAPSHOT_ZERO_PAGE for a page of zeros, which takes no space.  */
+typedef unsigned int snapshot_page_ref;
+
+#define SNAPSHOT_ZERO_PAGE ((snapshot_page_ref) -1)
+
+/* Reference-counted storage for the contents of snapshot pages.  */
+
+class snapshot_arena
+{
+public:
+  /* Store a copy of the page at DATA, with a reference count of
+     one, and return its reference.  */
+  snapshot_page_ref add (const gdb_byte *data);
+
+  /* Add or drop a reference to PAGE.  */
+  void ref (snapshot_page_ref page);
+  void unref (snapshot_page_ref page);
+
+  /* Return the contents of PAGE, which must not be the zero page.  */
+  const gdb_byte *contents (snapshot_page_ref page) const
+  {
+    return (m_blocks[page / SNAPSHOT_ARENA_BLOCK_PAGES].get ()
+	    + (page % SNAPSHOT_ARENA_BLOCK_PAGES) * m_page_size);
+  }
+
+  /* The number of pages stored.  */
+  size_t pages () const
+  { return m_refcounts.size () - m_free.size (); }
+
+  /* Free all pages, and set the page size to PAGE_SIZE.  */
+  void clear (size_t page_size);
+
+private:
+  size_t m_page_size = 0;
+  std::vector<gdb::unique_xmalloc_ptr<gdb_byte>> m_blocks;
+  std::vector<unsigned int> m_refcounts;
+  std::vector<snapshot_page_ref> m_free;
+};
+
+snapshot_page_ref
+snapshot_arena::add (const gdb_byte *data)
+{
+  snapshot_page_ref page;
+
+  if (m_free.empty ())
+    {
+      m_blocks.emplace_back
+	((gdb_byte *) xmalloc (SNAPSHOT_ARENA_BLOCK_PAGES * m_page_size));
+      for (int i = SNAPSHOT_ARENA_BLOCK_PAGES - 1; i >= 0; i--)
+	m_free.push_back (m_refcounts.size () + i);
+      m_refcounts.resize (m_refcounts.size () + SNAPSHOT_ARENA_BLOCK_PAGES);
+    }
+
+  page = m_free.back ();
+  m_free.pop_back ();
+  m_refcounts[page] = 1;
+  memcpy ((gdb_byte *) contents (page), data, m_page_size);
+  return page;
+}
+
+void
+snapshot_arena::ref (snapshot_page_ref page)
+{
+  if (page != SNAPSHOT_ZERO_PAGE)
+    m_refcounts[page]++;
+}
+
+void
+snapshot_arena::unref (snapshot_page_ref page)
+{
+  if (page != SNAPSHOT_ZERO_PAGE && --m_refcounts[page] == 0)
+    m_free.push_back (page);
+}
+
+void
+snapshot_arena::clear (size_t page_size)
+{
+  m_page_size = page_size;
+  m_blocks.clear ();
+  m_refcounts.clear ();
+  m_free.clear ();
+}
+
+/* A private mapping of the process whose contents snapshots
+   record.  */
+
+struct snapshot_mapping
+{
+  CORE_ADDR start;
+  CORE_ADDR end;
+
+  /* True if the mapping is not backed by a file, so that the pages
+     the program never wrote read as zeros.  */
+  bool anonymous;
+};
+
+/* A page of a snapshot.  */
+
+struct snapshot_page
+{
+  CORE_ADDR addr;
+  snapshot_page_ref ref;
+};
+
+struct linux_snapshot
+{
+  /* The checkpoint id.  */
+  int num;
+
+  /* The snapshot this one was taken from, or NULL.  */
+  struct linux_snapshot *parent;
+
+  /* The registers and the PC of the process.  */
+  std::unique_ptr<readonly_detached_regcache> regs;
+  CORE_ADDR pc;
+
+  /* The file positions of the open file descriptors.  */
+  gdb::unique_xmalloc_ptr<off_t> filepos;
+  int maxfd;
+
+  /* The mappings the pages are from.  */
+  std::vector<snapshot_mapping> mappings;
+
+  /* The pages that differ from PARENT, in ascending address
+     order.  */
+  std::vector<snapshot_page> pages;
+};
+
+/* The process the snapshots are of.  */
+static int snapshot_pid;
+
+/* The snapshots, in checkpoint id order.  */
+static std::vector<std::unique_ptr<linux_snapshot>> snapshots;
+static int highest_snapshot_num;
+
+/* The snapshot the process was last taken from or restored to.  */
+static struct linux_snapshot *snapshot_current;
+
+/* The contents of every page recorded by SNAPSHOT_CURRENT and its
+   ancestors, as of SNAPSHOT_CURRENT.  The references are owned by
+   the snapshots.  */
+static std::unordered_map<CORE_ADDR, snapshot_page_ref> snapshot_head;
+
+static snapshot_arena arena;
+static size_t snapshot_page_size;
+
+/* The most memory snapshots may use, in kilobytes, or UINT_MAX for
+   no limit.  */
+static unsigned int snapshot_memory_limit = UINT_MAX;
+
+static void
+show_snapshot_memory_limit (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  if (snapshot_memory_limit == UINT_MAX)
+    fprintf_filtered (file, _("The memory snapshot checkpoints may use "
+			      "is unlimited.\n"));
+  else
+    fprintf_filtered (file, _("The memory snapshot checkpoints may use "
+			      "is limited to %s kilobytes.\n"), value);
+}
+
+/* Write "4" to /proc/PID/clear_refs, which clears the soft-dirty bits
+   of the pages of process PID.  Return true on success.  */
+
+static bool
+snapshot_clear_soft_dirty (int pid)
+{
+  char filename[64];
+
+  xsnprintf (filename, sizeof filename, "/proc/%d/clear_refs", pid);
+  scoped_fd fd (gdb_open_cloexec (filename, O_WRONLY, 0));
+  return fd.get () >= 0 && write (fd.get (), "4", 1) == 1;
+}
+
+/* Read the /proc/PID/pagemap entries of the COUNT pages from ADDR of
+   the process whose pagemap is open as FD into ENTRIES.  */
+
+static void
+snapshot_read_pagemap (int fd, CORE_ADDR addr, size_t count,
+		       uint64_t *entries)
+{
+  off_t offset = addr / snapshot_page_size * sizeof (uint64_t);
+  size_t len = count * sizeof (uint64_t);
+
+  if (pread (fd, entries, len, offset) != (ssize_t) len)
+    perror_with_name (_("Couldn't read the page map"));
+}
+
+/* Return true if the kernel keeps soft-dirty bits.  Kernels that
+   don't accept clearing them but never set them, so check that one
+   of GDB's own pages gets one.  */
+
+static bool
+snapshot_soft_dirty_p ()
+{
+  static int supported = -1;
+
+  if (supported == -1)
+    {
+      void *page = mmap (NULL, snapshot_page_size, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      supported = 0;
+      if (page != MAP_FAILED)
+	{
+	  *(volatile char *) page = 1;
+	  if (snapshot_clear_soft_dirty (getpid ()))
+	    {
+	      scoped_fd fd (gdb_open_cloexec ("/proc/self/pagemap",
+					      O_RDONLY, 0));
+	      uint64_t entry;
+
+	      *(volatile char *) page = 2;
+	      if (fd.get () >= 0
+		  && pread (fd.get (), &entry, sizeof entry,
+			    ((uintptr_t) page / snapshot_page_size
+			     * sizeof entry)) == sizeof entry
+		  && (entry & PAGEMAP_SOFT_DIRTY) != 0)
+		supported = 1;
+	    }
+	  munmap (page, snapshot_page_size);
+	}
+    }
+
+  return supported;
+}
+
+/* Return the private mappings of process PID whose contents snapshots
+   record: the writable ones, and those that page watchpoints made
+   read-only.  Adjacent mappings of the same kind are merged.  */
+
+static std::vector<snapshot_mapping>
+snapshot_read_mappings (int pid)
+{
+  std::vector<snapshot_mapping> mappings;
+  struct inferior *inf = find_inferior_pid (pid);
+  char filename[64];
+  char line[256];
+  bool line_start = true;
+
+  xsnprintf (filename, sizeof filename, "/proc/%d/maps", pid);
+  gdb_file_up file = gdb_fopen_cloexec (filename, "r");
+  if (file == NULL)
+    perror_with_name (filename);
+
+  while (fgets (line, sizeof line, file.get ()) != NULL)
+    {
+      unsigned long start, end, offset, inode;
+      char perms[5], dev[16];
+      bool at_start = line_start;
+      int orig_prot;
+
+      /* Only look at the start of each line; the file names may be
+	 longer than LINE.  */
+      line_start = strchr (line, '\n') != NULL;
+      if (!at_start
+	  || sscanf (line, "%lx-%lx %4s %lx %15s %lu", &start, &end, perms,
+		     &offset, dev, &inode) != 6
+	  || perms[3] != 'p')
+	continue;
+
+      orig_prot = inf != NULL ? linux_nat_page_watch_orig_prot (inf, start)
+			      : -1;
+      if (perms[1] != 'w'
+	  && (orig_prot == -1 || (orig_prot & PROT_WRITE) == 0))
+	continue;
+
+      if (!mappings.empty ()
+	  && mappings.back ().end == start
+	  && mappings.back ().anonymous == (inode == 0))
+	mappings.back ().end = end;
+      else
+	mappings.push_back ({start, end, inode == 0});
+    }
+
+  return mappings;
+}
+
+/* Return the mapping of MAPPINGS that contains ADDR, or NULL.  */
+
+static const snapshot_mapping *
+snapshot_find_mapping (const std::vector<snapshot_mapping> &mappings,
+		       CORE_ADDR addr)
+{
+  auto it = std::upper_bound (mappings.begin (), mappings.end (), addr,
+			      [] (CORE_ADDR a, const snapshot_mapping &m)
+			      {
+				return a < m.start;
+			      });
+
+  if (it == mappings.begin () || addr >= (it - 1)->end)
+    return NULL;
+  return &*(it - 1);
+}
+
+/* Return the pages of MAPPINGS, the mappings of process PID, whose
+   contents differ from SNAPSHOT_HEAD, in ascending address order.
+   SNAPSHOT_HEAD is as of a snapshot whose mappings were OLD_MAPPINGS.
+   If STORE, the new contents are added to the arena, and the result
+   holds a reference to them.  */
+
+static std::vector<snapshot_page>
+snapshot_changed_pages (int pid, const std::vector<snapshot_mapping> &mappings,
+			const std::vector<snapshot_mapping> &old_mappings,
+			bool store)
+{
+  std::vector<snapshot_page> changed;
+  bool soft_dirty = snapshot_soft_dirty_p ();
+  gdb::byte_vector buf (SNAPSHOT_IO_PAGES * snapshot_page_size);
+  gdb::byte_vector zero (snapshot_page_size, 0);
+  uint64_t entries[SNAPSHOT_IO_PAGES];
+  char filename[64];
+
+  xsnprintf (filename, sizeof filename, "/proc/%d/mem", pid);
+  scoped_fd mem (gdb_open_cloexec (filename, O_RDONLY, 0));
+  if (mem.get () < 0)
+    perror_with_name (filename);
+  xsnprintf (filename, sizeof filename, "/proc/%d/pagemap", pid);
+  scoped_fd pagemap (gdb_open_cloexec (filename, O_RDONLY, 0));
+  if (pagemap.get () < 0)
+    perror_with_name (filename);
+
+  TRY
+    {
+      for (const snapshot_mapping &m : mappings)
+	for (CORE_ADDR addr = m.start; addr < m.end; )
+	  {
+	    size_t count
+	      = std::min<CORE_ADDR> ((m.end - addr) / snapshot_page_size,
+				     SNAPSHOT_IO_PAGES);
+	    bool candidate[SNAPSHOT_IO_PAGES];
+
+	    snapshot_read_pagemap (pagemap.get (), addr, count, entries);
+
+	    /* Find the pages that may have changed.  Those of file-backed
+	       mappings are all recorded the first time the mapping is
+	       seen; the pages of anonymous mappings only once they are
+	       in use.  */
+	    for (size_t i = 0; i < count; i++)
+	      {
+		CORE_ADDR page = addr + i * snapshot_page_size;
+		const snapshot_mapping *old
+		  = snapshot_find_mapping (old_mappings, page);
+		bool known = old != NULL && old->anonymous == m.anonymous;
+		bool in_use = (entries[i] & (PAGEMAP_PRESENT
+					     | PAGEMAP_SWAPPED)) != 0;
+		bool dirty = (entries[i] & PAGEMAP_SOFT_DIRTY) != 0;
+
+		if (!known)
+		  candidate[i] = !m.anonymous || in_use;
+		else if (soft_dirty)
+		  candidate[i] = dirty;
+		else
+		  candidate[i] = !m.anonymous || in_use;
+
+		/* A page that was given back to the kernel reads as zeros
+		   again, without being dirty.  */
+		if (!candidate[i] && known && m.anonymous && !in_use)
+		  {
+		    auto it = snapshot_head.find (page);
+
+		    candidate[i] = (it != snapshot_head.end ()
+				    && it->second != SNAPSHOT_ZERO_PAGE);
+		  }
+	      }
+
+	    for (size_t i = 0; i < count; )
+	      {
+		size_t j;
+
+		if (!candidate[i])
+		  {
+		    i++;
+		    continue;
+		  }
+
+		for (j = i + 1; j < count && candidate[j]; j++)
+		  ;
+
+		CORE_ADDR run = addr + i * snapshot_page_size;
+		size_t len = (j - i) * snapshot_page_size;
+
+		if (pread (mem.get (), buf.data (), len, run) != (ssize_t) len)
+		  perror_with_name (_("Couldn't read the memory of "
+				      "the process"));
+
+		for (size_t k = i; k < j; k++)
+		  {
+		    CORE_ADDR page = addr + k * snapshot_page_size;
+		    const gdb_byte *contents
+		      = buf.data () + (k - i) * snapshot_page_size;
+		    bool is_zero = memcmp (contents, zero.data (),
+					   snapshot_page_size) == 0;
+		    auto it = snapshot_head.find (page);
+		    bool same;
+
+		    if (it == snapshot_head.end ())
+		      {
+			const snapshot_mapping *old
+			  = snapshot_find_mapping (old_mappings, page);
+
+			same = (is_zero && old != NULL && old->anonymous
+				&& m.anonymous);
+		      }
+		    else if (it->second == SNAPSHOT_ZERO_PAGE)
+		      same = is_zero;
+		    else
+		      same = memcmp (contents, arena.contents (it->second),
+				     snapshot_page_size) == 0;
+
+		    if (!same)
+		      changed.push_back ({page,
+					  (store && !is_zero
+					   ? arena.add (contents)
+					   : SNAPSHOT_ZERO_PAGE)});
+		  }
+
+		i = j;
+	      }
+
+	    addr += count * snapshot_page_size;
+	  }
+    }
+  CATCH (ex, RETURN_MASK_ALL)
+    {
+      /* Don't leak the pages stored so far.  */
+      if (store)
+	for (const snapshot_page &p : changed)
+	  arena.unref (p.ref);
+      throw_exception (ex);
+    }
+  END_CATCH
+
+  return changed;
+}
+
+/* Return the page at ADDR of PAGES, or NULL.  */
+
+static const snapshot_page *
+snapshot_find_page (const std::vector<snapshot_page> &pages, CORE_ADDR addr)
+{
+  auto it = std::lower_bound (pages.begin (), pages.end (), addr,
+			      [] (const snapshot_page &p, CORE_ADDR a)
+			      {
+				return p.addr < a;
+			      });
+
+  if (it == pages.end () || it->addr != addr)
+    return NULL;
+  return &*it;
+}
+
+/* Make SNAPSHOT_HEAD hold the contents as of snapshot S.  */
+
+static void
+snapshot_materialize (struct linux_snapshot *s)
+{
+  std::vector<struct linux_snapshot *> chain;
+
+  for (; s != NULL; s = s->parent)
+    chain.push_back (s);
+
+  snapshot_head.clear ();
+  for (auto it = chain.rbegin (); it != chain.rend (); ++it)
+    for (const snapshot_page &p : (*it)->pages)
+      snapshot_head[p.addr] = p.ref;
+}
+
+static struct linux_snapshot *
+find_snapshot (int num)
+{
+  for (const std::unique_ptr<linux_snapshot> &s : snapshots)
+    if (s->num == num)
+      return s.get ();
+
+  return NULL;
+}
+
+/* Free all snapshots.  */
+
+static void
+snapshot_clear ()
+{
+  snapshots.clear ();
+  snapshot_head.clear ();
+  snapshot_current = NULL;
+  snapshot_pid = 0;
+  arena.clear (snapshot_page_size);
+}
+
+/* Check that the current inferior can be snapshotted or restored,
+   and return its pid.  */
+
+static int
+snapshot_check_process ()
+{
+  struct thread_info *tp;
+  int count = 0;
+
+  if (!target_has_execution)
+    error (_("The program is not being run."));
+
+  if (!snapshots.empty () && inferior_ptid.pid () != snapshot_pid)
+    error (_("The snapshot checkpoints are of process %d."), snapshot_pid);
+
+  update_thread_list ();
+  ALL_NON_EXITED_THREADS (tp)
+    if (tp->inf == current_inferior ())
+      count++;
+  if (count > 1)
+    error (_("checkpoint: can't checkpoint multiple threads."));
+
+#ifdef ENABLE_PIP
+  /* Other PiP tasks write to the memory of this one without stopping
+     at its snapshots, and restarting one would undo their writes.  */
+  struct inferior *inf;
+
+  ALL_NON_EXITED_INFERIORS (inf)
+    if (pip_inferiors_share_memory_p (current_inferior (), inf))
+      error (_("checkpoint: can't make snapshot checkpoints of a PiP "
+	       "task, which shares its memory with inferior %d."),
+	     inf->num);
+#endif
+
+  if (inferior_thread ()->executing)
+    error (_("The program is running."));
+
+  return inferior_ptid.pid ();
+}
+
+/* See linux-snapshot.h.  */
+
+bool
+linux_snapshots_exist_p ()
+{
+  return !snapshots.empty ();
+}
+
+/* See linux-snapshot.h.  */
+
+void
+linux_snapshot_checkpoint (int from_tty)
+{
+  int pid = snapshot_check_process ();
+  std::unique_ptr<linux_snapshot> s (new linux_snapshot ());
+  static const std::vector<snapshot_mapping> no_mappings;
+  off_t *filepos = NULL;
+
+  if (snapshots.empty ())
+    snapshot_clear ();
+
+  /* Read the file positions first: that calls functions in the
+     program, and the stack they use must be recorded with the
+     rest.  */
+  linux_fork_save_file_positions (pid, &filepos, &s->maxfd);
+  s->filepos.reset (filepos);
+
+  s->mappings = snapshot_read_mappings (pid);
+  s->pages = snapshot_changed_pages (pid, s->mappings,
+				     (snapshot_current != NULL
+				      ? snapshot_current->mappings
+				      : no_mappings),
+				     true);
+
+  if (snapshot_memory_limit != UINT_MAX
+      && (arena.pages () * snapshot_page_size
+	  > (size_t) snapshot_memory_limit * 1024))
+    {
+      for (const snapshot_page &p : s->pages)
+	arena.unref (p.ref);
+      error (_("checkpoint: snapshots would use more than "
+	       "checkpoint-memory-limit; delete some checkpoints first."));
+    }
+
+  if (snapshot_soft_dirty_p () && !snapshot_clear_soft_dirty (pid))
+    warning (_("Couldn't clear the soft-dirty bits of process %d."), pid);
+
+  s->regs.reset (new readonly_detached_regcache (*get_current_regcache ()));
+  s->pc = regcache_read_pc (get_current_regcache ());
+  s->parent = snapshot_current;
+  s->num = snapshots.empty () ? (highest_snapshot_num = 1)
+			      : ++highest_snapshot_num;
+
+  for (const snapshot_page &p : s->pages)
+    snapshot_head[p.addr] = p.ref;
+  snapshot_pid = pid;
+  snapshot_current = s.get ();
+  snapshots.push_back (std::move (s));
+
+  if (from_tty)
+    printf_filtered (_("checkpoint %d: snapshot of %s pages.\n"),
+		     snapshot_current->num,
+		     pulongest (snapshot_current->pages.size ()));
+}
+
+/* Write the pages at ADDRS (ascending), as of snapshot S, to the
+   memory of process PID.  */
+
+static void
+snapshot_write_pages (int pid, struct linux_snapshot *s,
+		      const std::vector<CORE_ADDR> &addrs)
+{
+  gdb::byte_vector buf (SNAPSHOT_IO_PAGES * snapshot_page_size);
+  char filename[64];
+  CORE_ADDR run = 0;
+  size_t count = 0;
+
+  xsnprintf (filename, sizeof filename, "/proc/%d/mem", pid);
+  scoped_fd mem (gdb_open_cloexec (filename, O_RDWR, 0));
+  if (mem.get () < 0)
+    perror_with_name (filename);
+
+  auto flush = [&] ()
+    {
+      size_t len = count * snapshot_page_size;
+
+      if (count != 0
+	  && pwrite (mem.get (), buf.data (), len, run) != (ssize_t) len)
+	perror_with_name (_("Couldn't write the memory of the process"));
+      count = 0;
+    };
+
+  for (CORE_ADDR addr : addrs)
+    {
+      const snapshot_mapping *m = snapshot_find_mapping (s->mappings, addr);
+      const snapshot_page *page = NULL;
+
+      if (m == NULL)
+	continue;
+
+      for (struct linux_snapshot *p = s; p != NULL && page == NULL;
+	   p = p->parent)
+	page = snapshot_find_page (p->pages, addr);
+
+      /* Pages of file-backed mappings are all recorded; those of
+	 anonymous mappings that are not were never written.  */
+      if (page == NULL && !m->anonymous)
+	continue;
+
+      if (count != 0
+	  && (count == SNAPSHOT_IO_PAGES
+	      || addr != run + count * snapshot_page_size))
+	flush ();
+      if (count == 0)
+	run = addr;
+
+      gdb_byte *dest = buf.data () + count * snapshot_page_size;
+
+      if (page == NULL || page->ref == SNAPSHOT_ZERO_PAGE)
+	memset (dest, 0, snapshot_page_size);
+      else
+	memcpy (dest, arena.contents (page->ref), snapshot_page_size);
+      count++;
+    }
+
+  flush ();
+}
+
+/* See linux-snapshot.h.  */
+
+void
+linux_snapshot_restart (int num, int from_tty)
+{
+  extern void nullify_last_target_wait_ptid ();
+  struct linux_snapshot *s = find_snapshot (num);
+  std::unordered_set<struct linux_snapshot *> ancestors;
+  std::vector<CORE_ADDR> addrs;
+  struct linux_snapshot *p;
+  int pid;
+
+  if (s == NULL)
+    error (_("Not found: checkpoint id %d"), num);
+  pid = snapshot_check_process ();
+
+  std::vector<snapshot_mapping> mappings = snapshot_read_mappings (pid);
+  for (const snapshot_mapping &m : s->mappings)
+    {
+      const snapshot_mapping *cur = snapshot_find_mapping (mappings, m.start);
+
+      if (cur == NULL || cur->end < m.end || cur->anonymous != m.anonymous)
+	error (_("Can't restart checkpoint %d: the memory at %s was "
+		 "unmapped since."),
+	       num, paddress (target_gdbarch (), m.start));
+    }
+
+  /* The pages to write are those that changed since the current
+     snapshot, and those that differ between it and S: the ones in
+     the snapshots between either of them and their closest common
+     ancestor.  */
+  for (const snapshot_page &page
+	 : snapshot_changed_pages (pid, mappings, snapshot_current->mappings,
+				   false))
+    addrs.push_back (page.addr);
+
+  for (p = snapshot_current; p != NULL; p = p->parent)
+    ancestors.insert (p);
+  for (p = s; p != NULL && ancestors.count (p) == 0; p = p->parent)
+    for (const snapshot_page &page : p->pages)
+      addrs.push_back (page.addr);
+  for (struct linux_snapshot *q = snapshot_current; q != p; q = q->parent)
+    for (const snapshot_page &page : q->pages)
+      addrs.push_back (page.addr);
+
+  std::sort (addrs.begin (), addrs.end ());
+  addrs.erase (std::unique (addrs.begin (), addrs.end ()), addrs.end ());
+
+  remove_breakpoints ();
+
+  snapshot_write_pages (pid, s, addrs);
+  snapshot_current = s;
+  snapshot_materialize (s);
+
+  /* Clear the soft-dirty bits before restoring the file positions,
+     so that the stack those calls use counts as changed.  */
+  if (snapshot_soft_dirty_p () && !snapshot_clear_soft_dirty (pid))
+    warning (_("Couldn't clear the soft-dirty bits of process %d."), pid);
+
+  target_dcache_invalidate ();
+  get_current_regcache ()->restore (s->regs.get ());
+  registers_changed ();
+  reinit_frame_cache ();
+  inferior_thread ()->suspend.stop_pc
+    = regcache_read_pc (get_current_regcache ());
+  nullify_last_target_wait_ptid ();
+
+  linux_fork_restore_file_positions (s->filepos.get (), s->maxfd);
+
+  insert_breakpoints ();
+
+  if (from_tty)
+    printf_filtered (_("Restored checkpoint %d (%s pages).\n"), num,
+		     pulongest (addrs.size ()));
+
+  print_stack_frame (get_selected_frame (NULL), 1, SRC_AND_LOC, 1);
+}
+
+/* See linux-snapshot.h.  */
+
+void
+linux_snapshot_delete (int num, int from_tty)
+{
+  struct linux_snapshot *s = find_snapshot (num);
+
+  if (s == NULL)
+    error (_("No such checkpoint id, %d"), num);
+
+  if (s == snapshot_current)
+    error (_("\
+Please switch to another checkpoint before deleting the current one"));
+
+  /* The children of S inherit the pages of S that they don't
+     override.  */
+  for (const std::unique_ptr<linux_snapshot> &child : snapshots)
+    if (child->parent == s)
+      {
+	std::vector<snapshot_page> merged;
+
+	merged.reserve (child->pages.size () + s->pages.size ());
+	auto c = child->pages.begin ();
+	for (const snapshot_page &page : s->pages)
+	  {
+	    for (; c != child->pages.end () && c->addr < page.addr; ++c)
+	      merged.push_back (*c);
+	    if (c == child->pages.end () || c->addr != page.addr)
+	      {
+		arena.ref (page.ref);
+		merged.push_back (page);
+	      }
+	  }
+	merged.insert (merged.end (), c, child->pages.end ());
+
+	child->pages = std::move (merged);
+	child->parent = s->parent;
+      }
+
+  for (const snapshot_page &page : s->pages)
+    arena.unref (page.ref);
+
+  snapshots.erase (std::find_if (snapshots.begin (), snapshots.end (),
+				 [=] (const std::unique_ptr<linux_snapshot> &p)
+				 {
+				   return p.get () == s;
+				 }));
+
+  if (from_tty)
+    printf_filtered (_("Deleted checkpoint %d\n"), num);
+
+  if (snapshots.empty ())
+    snapshot_clear ();
+}
+
+/* See linux-snapshot.h.  */
+
+void
+linux_snapshot_info (int requested)
+{
+  struct gdbarch *gdbarch = get_current_arch ();
+  bool printed = false;
+
+  for (const std::unique_ptr<linux_snapshot> &s : snapshots)
+    {
+      if (requested > 0 && s->num != requested)
+	continue;
+
+      printed = true;
+      printf_filtered ("%s%d snapshot of process %d at ",
+		       s.get () == snapshot_current ? "* " : "  ",
+		       s->num, snapshot_pid);
+      linux_fork_print_checkpoint_pc (gdbarch, s->pc);
+      printf_filtered (_(", %s pages"), pulongest (s->pages.size ()));
+      if (s->parent != NULL)
+	printf_filtered (_(" changed since %d"), s->parent->num);
+      putchar_filtered ('\n');
+    }
+
+  if (!printed)
+    {
+      if (requested > 0)
+	printf_filtered (_("No checkpoint number %d.\n"), requested);
+      else
+	printf_filtered (_("No checkpoints.\n"));
+    }
+  else if (requested <= 0)
+    printf_filtered (_("Snapshots use %s kilobytes in %s pages%s.\n"),
+		     pulongest (arena.pages () * snapshot_page_size / 1024),
+		     pulongest (arena.pages ()),
+		     (snapshot_soft_dirty_p ()
+		      ? _(", tracked with soft-dirty bits") : ""));
+}
+
+/* See linux-snapshot.h.  */
+
+void
+linux_snapshot_forget (int pid)
+{
+  if (!snapshots.empty () && pid == snapshot_pid)
+    snapshot_clear ();
+}
+
+void
+_initialize_linux_snapshot (void)
+{
+  snapshot_page_size = sysconf (_SC_PAGESIZE);
+  arena.clear (snapshot_page_size);
+
+  add_setshow_uinteger_cmd ("checkpoint-memory-limit", class_obscure,
+			    &snapshot_memory_limit, _("\
+Set the most memory snapshot checkpoints may use, in kilobytes."), _("\
+Show the most memory snapshot checkpoints may use, in kilobytes."), _("\
+A checkpoint that would make snapshots use more fails.\n\
+\"unlimited\" or 0 means there is no limit."),
+			    NULL,
+			    show_snapshot_memory_limit,
+			    &setlist, &showlist);
+}
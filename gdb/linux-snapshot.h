@@ -0,0 +1,50 @@
+/* GNU/Linux native snapshot checkpoints.
+
+   Copyright (C) 2018 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef LINUX_SNAPSHOT_H
+#define LINUX_SNAPSHOT_H
+
+/* Snapshot checkpoints record the memory and registers of the
+   current process, instead of forking it.  Each snapshot stores only
+   the pages that changed since the snapshot it was taken from, and
+   restarting one writes back only the pages that differ.  These
+   implement the checkpoint commands when "checkpoint-mode" is
+   "snapshot" (see linux-fork.c).  */
+
+/* Return true if there are snapshot checkpoints.  */
+extern bool linux_snapshots_exist_p ();
+
+/* Take a snapshot of the current process.  */
+extern void linux_snapshot_checkpoint (int from_tty);
+
+/* Restore the current process to snapshot NUM.  */
+extern void linux_snapshot_restart (int num, int from_tty);
+
+/* Delete snapshot NUM.  */
+extern void linux_snapshot_delete (int num, int from_tty);
+
+/* Print the snapshots, or only snapshot REQUESTED if it is
+   positive.  */
+extern void linux_snapshot_info (int requested);
+
+/* Forget the snapshots of process PID, which exited, exec'd or was
+   detached.  */
+extern void linux_snapshot_forget (int pid);
+
+#endif /* LINUX_SNAPSHOT_H */
@@ -48,6 +48,7 @@
 #include <algorithm>
 #include "common/pathstuff.h"
 #include "valprint.h"
+#include <sys/syscall.h>
 
 /* GNU/Linux libthread_db support.
 
@@ -167,26 +168,41 @@ static int thread_signals;
 static sigset_t thread_stop_set;
 static sigset_t thread_print_set;
 
-struct thread_db_info
-{
-  struct thread_db_info *next;
+/* A connection to libthread_db.  Processes that share one address
+   space and one libpthread image, such as the PiP tasks of a root
+   process, share one agent, so that libthread_db is only set up once
+   for all of them.  */
 
-  /* Process id this object refers to.  */
-  int pid;
+struct thread_db_agent
+{
+  /* Number of thread_db_info objects using this agent.  */
+  int refcount;
 
   /* Handle from dlopen for libthread_db.so.  */
   void *handle;
 
-  /* Absolute pathname from gdb_realpath to disk file used for dlopen-ing
-     HANDLE.  It may be NULL for system library.  */
-  char *filename;
-
   /* Structure that identifies the child process for the
-     <proc_service.h> interface.  */
+     <proc_service.h> interface.  Its thread is set to a stopped thread
+     of the process using the agent before each call.  */
   struct ps_prochandle proc_handle;
 
   /* Connection to the libthread_db library.  */
   td_thragent_t *thread_agent;
+};
+
+struct thread_db_info
+{
+  struct thread_db_info *next;
+
+  /* Process id this object refers to.  */
+  int pid;
+
+  /* Absolute pathname from gdb_realpath to disk file used for dlopen-ing
+     the agent's HANDLE.  It may be NULL for system library.  */
+  char *filename;
+
+  /* The libthread_db agent, possibly shared with other processes.  */
+  struct thread_db_agent *agent;
 
   /* True if we need to apply the workaround for glibc/BZ5983.  When
      we catch a PTRACE_O_TRACEFORK, and go query the child's thread
@@ -231,7 +247,9 @@ add_thread_db_info (void *handle)
   struct thread_db_info *info = XCNEW (struct thread_db_info);
 
   info->pid = inferior_ptid.pid ();
-  info->handle = handle;
+  info->agent = XCNEW (struct thread_db_agent);
+  info->agent->refcount = 1;
+  info->agent->handle = handle;
 
   /* The workaround works by reading from /proc/pid/status, so it is
      disabled for core files.  */
@@ -278,8 +296,19 @@ delete_thread_db_info (int pid)
   if (info == NULL)
     return;
 
-  if (info->handle != NULL)
-    dlclose (info->handle);
+  if (--info->agent->refcount == 0)
+    {
+      if (info->agent->handle != NULL)
+	dlclose (info->agent->handle);
+      xfree (info->agent);
+    }
+  else if (info->agent->proc_handle.thread != NULL
+	   && info->agent->proc_handle.thread->ptid.pid () == pid)
+    {
+      /* Don't leave the agent pointing at a thread that is going
+	 away.  */
+      info->agent->proc_handle.thread = NULL;
+    }
 
   xfree (info->filename);
 
@@ -399,8 +428,8 @@ thread_from_lwp (thread_info *stopped, ptid_t ptid)
   info = get_thread_db_info (ptid.pid ());
 
   /* Access an lwp we know is stopped.  */
-  info->proc_handle.thread = stopped;
-  err = info->td_ta_map_lwp2thr_p (info->thread_agent, ptid.lwp (),
+  info->agent->proc_handle.thread = stopped;
+  err = info->td_ta_map_lwp2thr_p (info->agent->thread_agent, ptid.lwp (),
 				   &th);
   if (err != TD_OK)
     error (_("Cannot find user-level thread for LWP %ld: %s"),
@@ -626,7 +655,7 @@ check_thread_db_callback (const td_thrhandle_t *th, void *arg)
   /* Check td_ta_thr_iter passed consistent arguments.  */
   CHECK (th != NULL);
   CHECK (arg == (void *) tdb_testinfo);
-  CHECK (th->th_ta_p == tdb_testinfo->info->thread_agent);
+  CHECK (th->th_ta_p == tdb_testinfo->info->agent->thread_agent);
 
   LOG (" %s", core_addr_to_string_nz ((CORE_ADDR) th->th_unique));
 
@@ -727,7 +756,7 @@ check_thread_db (struct thread_db_info *info, bool log_progress)
   td_ta_thr_iter_ftype *td_ta_thr_iter_p = info->td_ta_thr_iter_p;
   if (td_ta_thr_iter_p == NULL)
     {
-      void *thr_iter = verbose_dlsym (info->handle, "td_ta_thr_iter");
+      void *thr_iter = verbose_dlsym (info->agent->handle, "td_ta_thr_iter");
       if (thr_iter == NULL)
 	return 0;
 
@@ -751,7 +780,7 @@ check_thread_db (struct thread_db_info *info, bool log_progress)
 
   TRY
     {
-      td_err_e err = td_ta_thr_iter_p (info->thread_agent,
+      td_err_e err = td_ta_thr_iter_p (info->agent->thread_agent,
 				       check_thread_db_callback,
 				       tdb_testinfo,
 				       TD_THR_ANY_STATE,
@@ -793,6 +822,8 @@ check_thread_db (struct thread_db_info *info, bool log_progress)
    or when it refuses to work with the current inferior (e.g. due to
    version mismatch between libthread_db and libpthread).  */
 
+static int thread_db_enable (struct thread_db_info *info);
+
 static int
 try_thread_db_load_1 (struct thread_db_info *info)
 {
@@ -802,10 +833,11 @@ try_thread_db_load_1 (struct thread_db_info *info)
      Essential functions first.  */
 
 #define TDB_VERBOSE_DLSYM(info, func)			\
-  info->func ## _p = (func ## _ftype *) verbose_dlsym (info->handle, #func)
+  info->func ## _p = (func ## _ftype *) verbose_dlsym (info->agent->handle, \
+							#func)
 
 #define TDB_DLSYM(info, func)			\
-  info->func ## _p = (func ## _ftype *) dlsym (info->handle, #func)
+  info->func ## _p = (func ## _ftype *) dlsym (info->agent->handle, #func)
 
 #define CHK(a)								\
   do									\
@@ -827,10 +859,11 @@ try_thread_db_load_1 (struct thread_db_info *info)
   CHK (TDB_VERBOSE_DLSYM (info, td_ta_new));
 
   /* Initialize the structure that identifies the child process.  */
-  info->proc_handle.thread = inferior_thread ();
+  info->agent->proc_handle.thread = inferior_thread ();
 
   /* Now attempt to open a connection to the thread library.  */
-  err = info->td_ta_new_p (&info->proc_handle, &info->thread_agent);
+  err = info->td_ta_new_p (&info->agent->proc_handle,
+			   &info->agent->thread_agent);
   if (err != TD_OK)
     {
       if (libthread_db_debug)
@@ -887,6 +920,16 @@ try_thread_db_load_1 (struct thread_db_info *info)
 	return 0;
     }
 
+  return thread_db_enable (info);
+}
+
+/* Finish enabling libthread_db for the current inferior, described by
+   INFO, whose agent is ready: discover the inferior's threads, and
+   push the thread_db target if needed.  Return 1 on success.  */
+
+static int
+thread_db_enable (struct thread_db_info *info)
+{
   if (info->td_ta_thr_iter_p == NULL)
     {
       struct lwp_info *lp;
@@ -897,7 +940,13 @@ try_thread_db_load_1 (struct thread_db_info *info)
 
       ALL_LWPS (lp)
 	if (lp->ptid.pid () == pid)
-	  thread_from_lwp (curr_thread, lp->ptid);
+	  {
+	    thread_info *tp = find_thread_ptid (lp->ptid);
+
+	    /* Only look up the threads we don't know about yet.  */
+	    if (tp == NULL || tp->priv == NULL)
+	      thread_from_lwp (curr_thread, lp->ptid);
+	  }
 
       linux_unstop_all_lwps ();
     }
@@ -1153,6 +1202,112 @@ thread_db_load_search (void)
   return rc;
 }
 
+/* Return true if processes PID1 and PID2 share their address space,
+   as PiP tasks do with their root process.  */
+
+static bool
+same_address_space (int pid1, int pid2)
+{
+#ifdef SYS_kcmp
+  /* KCMP_VM from <linux/kcmp.h>, which older systems lack.  */
+  const int kcmp_vm = 1;
+
+  return syscall (SYS_kcmp, pid1, pid2, kcmp_vm, 0, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+/* Return the address of the "nptl_version" symbol of the libpthread
+   loaded in PSPACE, or 0 if there is none.  libthread_db checks this
+   symbol in td_ta_new, so equal addresses in processes that share an
+   address space mean that they use the same libpthread image.  */
+
+static CORE_ADDR
+nptl_version_address (struct program_space *pspace)
+{
+  scoped_restore_current_program_space restore_pspace;
+
+  set_current_program_space (pspace);
+
+  bound_minimal_symbol msym
+    = lookup_minimal_symbol ("nptl_version", NULL, NULL);
+  if (msym.minsym == NULL)
+    return 0;
+  return BMSYMBOL_VALUE_ADDRESS (msym);
+}
+
+/* Try to enable libthread_db for the current inferior by sharing the
+   agent of another process that has the same address space and the
+   same libpthread image.  This avoids searching for and initializing
+   libthread_db again for every PiP task.  Return 1 on success.  */
+
+static int
+thread_db_load_shared (void)
+{
+  struct thread_db_info *info;
+  int pid = inferior_ptid.pid ();
+  CORE_ADDR nptl_version = 0;
+
+  /* Sharing is only detected for live processes.  */
+  if (!target_has_execution)
+    return 0;
+
+  for (info = thread_db_list; info != NULL; info = info->next)
+    {
+      struct inferior *inf;
+
+      if (info->pid == pid || !same_address_space (info->pid, pid))
+	continue;
+
+      inf = find_inferior_pid (info->pid);
+      if (inf == NULL)
+	continue;
+
+      if (nptl_version == 0)
+	{
+	  nptl_version = nptl_version_address (current_program_space);
+	  if (nptl_version == 0)
+	    return 0;
+	}
+      if (nptl_version_address (inf->pspace) != nptl_version)
+	continue;
+
+      if (libthread_db_debug)
+	fprintf_unfiltered (gdb_stdlog,
+			    _("Sharing libthread_db agent of process %d "
+			      "with process %d.\n"), info->pid, pid);
+
+      struct thread_db_info *new_info = XCNEW (struct thread_db_info);
+
+      new_info->pid = pid;
+      new_info->need_stale_parent_threads_check = 1;
+      new_info->agent = info->agent;
+      new_info->agent->refcount++;
+      if (info->filename != NULL)
+	new_info->filename = xstrdup (info->filename);
+
+      new_info->td_init_p = info->td_init_p;
+      new_info->td_ta_new_p = info->td_ta_new_p;
+      new_info->td_ta_map_lwp2thr_p = info->td_ta_map_lwp2thr_p;
+      new_info->td_ta_thr_iter_p = info->td_ta_thr_iter_p;
+      new_info->td_thr_get_info_p = info->td_thr_get_info_p;
+      new_info->td_thr_tls_get_addr_p = info->td_thr_tls_get_addr_p;
+      new_info->td_thr_tlsbase_p = info->td_thr_tlsbase_p;
+
+      new_info->next = thread_db_list;
+      thread_db_list = new_info;
+
+      if (thread_db_enable (new_info))
+	return 1;
+
+      delete_thread_db_info (pid);
+      return 0;
+    }
+
+  return 0;
+}
+
 /* Return non-zero if the inferior has a libpthread.  */
 
 static int
@@ -1189,6 +1344,9 @@ thread_db_load (void)
   if (!(target_can_run () || core_bfd))
     return 0;
 
+  if (thread_db_load_shared ())
+    return 1;
+
   if (thread_db_load_search ())
     return 1;
 
@@ -1507,7 +1665,7 @@ find_new_threads_once (struct thread_db_info *info, int iteration,
   TRY
     {
       /* Iterate over all user-space threads to discover new threads.  */
-      err = info->td_ta_thr_iter_p (info->thread_agent,
+      err = info->td_ta_thr_iter_p (info->agent->thread_agent,
 				    find_new_threads_callback,
 				    &data,
 				    TD_THR_ANY_STATE,
@@ -1552,7 +1710,7 @@ thread_db_find_new_threads_2 (thread_info *stopped, bool until_no_new)
   info = get_thread_db_info (stopped->ptid.pid ());
 
   /* Access an lwp we know is stopped.  */
-  info->proc_handle.thread = stopped;
+  info->agent->proc_handle.thread = stopped;
 
   if (until_no_new)
     {
@@ -1719,6 +1877,9 @@ thread_db_target::get_thread_local_address (ptid_t ptid,
       thread_db_info *info = get_thread_db_info (ptid.pid ());
       thread_db_thread_info *priv = get_thread_db_thread_info (thread_info);
 
+      /* The agent may be shared with other processes.  */
+      info->agent->proc_handle.thread = thread_info;
+
       /* Finally, get the address of the variable.  */
       if (lm != 0)
 	{
@@ -1933,6 +2094,9 @@ maintenance_check_libthread_db (const char *args, int from_tty)
   if (info == NULL)
     error (_("No libthread_db loaded"));
 
+  /* The agent may be shared with other processes.  */
+  info->agent->proc_handle.thread = inferior_thread ();
+
   check_thread_db (info, true);
 }
 
@@ -512,6 +512,19 @@ objfile_separate_debug_iterate (const struct objfile *parent,
   return NULL;
 }
 
+/* See objfiles.h.  */
+
+bool
+objfile_is_or_separate_debug_of (const struct objfile *objfile,
+				 const struct objfile *parent)
+{
+  for (; objfile != NULL; objfile = objfile->separate_debug_objfile_backlink)
+    if (objfile == parent)
+      return true;
+
+  return false;
+}
+
 /* Put one object file before a specified on in the global list.
    This can be used to make sure an object file is destroyed before
    another when using ALL_OBJFILES_SAFE to free all objfiles.  */
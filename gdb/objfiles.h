@@ -487,6 +487,12 @@ extern void build_objfile_section_table (struct objfile *);
 extern struct objfile *objfile_separate_debug_iterate (const struct objfile *,
                                                        const struct objfile *);
 
+/* Return true if OBJFILE is PARENT, or one of PARENT's separate debug
+   objfiles.  */
+
+extern bool objfile_is_or_separate_debug_of (const struct objfile *objfile,
+					     const struct objfile *parent);
+
 extern void put_objfile_before (struct objfile *, struct objfile *);
 
 extern void add_separate_debug_objfile (struct objfile *, struct objfile *);
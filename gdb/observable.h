@@ -186,6 +186,12 @@ extern observable<struct inferior *> inferior_removed;
 extern observable<struct inferior *, CORE_ADDR, ssize_t, const bfd_byte *>
     memory_changed;
 
+/* LEN bytes at ADDR in the memory of the current inferior have been
+   written through the target stack.  Unlike memory_changed, this is
+   notified for all of GDB's writes, not only those the user asked
+   for, except for the insertion and removal of breakpoints.  */
+extern observable<CORE_ADDR, ULONGEST> target_memory_written;
+
 /* Called before a top-level prompt is displayed.  current_prompt is
    the current top-level prompt.  */
 extern observable<const char *> before_prompt;
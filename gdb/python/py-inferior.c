@@ -488,6 +488,32 @@ gdbpy_inferiors (PyObject *unused, PyObject *unused2)
 
 /* Membuf and memory manipulation.  */
 
+/* Return a Python buffer object for the LENGTH bytes at BUFFER, which
+   were read from ADDR.  Takes ownership of BUFFER.  Returns NULL on
+   error, with a python exception set.  */
+static PyObject *
+make_membuf (gdb_byte *buffer, CORE_ADDR addr, CORE_ADDR length)
+{
+  gdbpy_ref<membuf_object> membuf_obj (PyObject_New (membuf_object,
+						     &membuf_object_type));
+  if (membuf_obj == NULL)
+    {
+      xfree (buffer);
+      return NULL;
+    }
+
+  membuf_obj->buffer = buffer;
+  membuf_obj->addr = addr;
+  membuf_obj->length = length;
+
+#ifdef IS_PY3K
+  return PyMemoryView_FromObject ((PyObject *) membuf_obj.get ());
+#else
+  return PyBuffer_FromReadWriteObject ((PyObject *) membuf_obj.get (), 0,
+				      Py_END_OF_BUFFER);
+#endif
+}
+
 /* Implementation of Inferior.read_memory (address, length).
    Returns a Python buffer object with LENGTH bytes of the inferior's
    memory at ADDRESS.  Both arguments are integers.  Returns NULL on error,
@@ -497,7 +523,7 @@ infpy_read_memory (PyObject *self, PyObject *args, PyObject *kw)
 {
   CORE_ADDR addr, length;
   gdb_byte *buffer = NULL;
-  PyObject *addr_obj, *length_obj, *result;
+  PyObject *addr_obj, *length_obj;
   static const char *keywords[] = { "address", "length", NULL };
 
   if (!gdb_PyArg_ParseTupleAndKeywords (args, kw, "OO", keywords,
@@ -521,26 +547,163 @@ infpy_read_memory (PyObject *self, PyObject *args, PyObject *kw)
     }
   END_CATCH
 
-  gdbpy_ref<membuf_object> membuf_obj (PyObject_New (membuf_object,
-						     &membuf_object_type));
-  if (membuf_obj == NULL)
+  return make_membuf (buffer, addr, length);
+}
+
+/* Implementation of Inferior.read_memory_vector (ranges).
+   RANGES is a sequence of (address, length) pairs.  Returns a list
+   with a Python buffer object for each range, read in as few requests
+   to the target as possible.  A buffer is shorter than its range if
+   only part of the range could be read.  Returns NULL on error, with
+   a python exception set.  */
+static PyObject *
+infpy_read_memory_vector (PyObject *self, PyObject *args, PyObject *kw)
+{
+  PyObject *ranges_obj;
+  std::vector<memory_read_request> requests;
+  static const char *keywords[] = { "ranges", NULL };
+
+  if (!gdb_PyArg_ParseTupleAndKeywords (args, kw, "O", keywords,
+					&ranges_obj))
+    return NULL;
+
+  gdbpy_ref<> iter (PyObject_GetIter (ranges_obj));
+  if (iter == NULL)
+    return NULL;
+
+  while (true)
     {
-      xfree (buffer);
+      gdbpy_ref<> item (PyIter_Next (iter.get ()));
+      CORE_ADDR addr, length;
+
+      if (item == NULL)
+	{
+	  if (PyErr_Occurred ())
+	    return NULL;
+	  break;
+	}
+
+      if (!PySequence_Check (item.get ())
+	  || PySequence_Size (item.get ()) != 2)
+	{
+	  PyErr_SetString (PyExc_TypeError,
+			   _("Each range must be an (address, length) pair."));
+	  return NULL;
+	}
+
+      gdbpy_ref<> addr_obj (PySequence_GetItem (item.get (), 0));
+      gdbpy_ref<> length_obj (PySequence_GetItem (item.get (), 1));
+      if (addr_obj == NULL || length_obj == NULL
+	  || get_addr_from_python (addr_obj.get (), &addr) < 0
+	  || get_addr_from_python (length_obj.get (), &length) < 0)
+	return NULL;
+
+      requests.emplace_back (addr, length);
+    }
+
+  TRY
+    {
+      target_read_memory_vector (requests);
+    }
+  CATCH (except, RETURN_MASK_ALL)
+    {
+      GDB_PY_HANDLE_EXCEPTION (except);
+    }
+  END_CATCH
+
+  gdbpy_ref<> list (PyList_New (0));
+  if (list == NULL)
+    return NULL;
+
+  for (const memory_read_request &req : requests)
+    {
+      gdb_byte *buffer = (gdb_byte *) xmalloc (req.data.size ());
+
+      memcpy (buffer, req.data.data (), req.data.size ());
+      gdbpy_ref<> membuf (make_membuf (buffer, req.addr, req.data.size ()));
+      if (membuf == NULL || PyList_Append (list.get (), membuf.get ()) != 0)
+	return NULL;
+    }
+
+  return list.release ();
+}
+
+/* Implementation of
+   Inferior.read_memory_chain (address, length, offset, count).
+   Reads the nodes of a linked list, LENGTH bytes each, starting with
+   the one at ADDRESS and following the pointer at OFFSET in each
+   node, for at most COUNT nodes or until a null pointer or a pointer
+   back to ADDRESS.  Returns a list with a Python buffer object for
+   each node; the last one is shorter than LENGTH if only part of it
+   could be read.  Returns NULL on error, with a python exception
+   set.  */
+static PyObject *
+infpy_read_memory_chain (PyObject *self, PyObject *args, PyObject *kw)
+{
+  CORE_ADDR addr, length, offset;
+  int count;
+  PyObject *addr_obj, *length_obj, *offset_obj;
+  std::vector<gdb::byte_vector> nodes;
+  static const char *keywords[] = { "address", "length", "offset", "count",
+				    NULL };
+
+  if (!gdb_PyArg_ParseTupleAndKeywords (args, kw, "OOOi", keywords,
+					&addr_obj, &length_obj, &offset_obj,
+					&count))
+    return NULL;
+
+  if (get_addr_from_python (addr_obj, &addr) < 0
+      || get_addr_from_python (length_obj, &length) < 0
+      || get_addr_from_python (offset_obj, &offset) < 0)
+    return NULL;
+
+  struct gdbarch *gdbarch = target_gdbarch ();
+  int ptr_size = gdbarch_ptr_bit (gdbarch) / TARGET_CHAR_BIT;
+
+  if (offset > length || length - offset < (CORE_ADDR) ptr_size)
+    {
+      PyErr_SetString (PyExc_ValueError,
+		       _("The pointer is not within the node."));
+      return NULL;
+    }
+  if (count <= 0)
+    {
+      PyErr_SetString (PyExc_ValueError,
+		       _("The count must be positive."));
       return NULL;
     }
 
-  membuf_obj->buffer = buffer;
-  membuf_obj->addr = addr;
-  membuf_obj->length = length;
+  TRY
+    {
+      nodes = target_read_memory_chain (addr, length, offset, count);
+    }
+  CATCH (except, RETURN_MASK_ALL)
+    {
+      GDB_PY_HANDLE_EXCEPTION (except);
+    }
+  END_CATCH
 
-#ifdef IS_PY3K
-  result = PyMemoryView_FromObject ((PyObject *) membuf_obj.get ());
-#else
-  result = PyBuffer_FromReadWriteObject ((PyObject *) membuf_obj.get (), 0,
-					 Py_END_OF_BUFFER);
-#endif
+  gdbpy_ref<> list (PyList_New (0));
+  if (list == NULL)
+    return NULL;
 
-  return result;
+  CORE_ADDR node = addr;
+
+  for (const gdb::byte_vector &data : nodes)
+    {
+      gdb_byte *buffer = (gdb_byte *) xmalloc (data.size ());
+
+      memcpy (buffer, data.data (), data.size ());
+      gdbpy_ref<> membuf (make_membuf (buffer, node, data.size ()));
+      if (membuf == NULL || PyList_Append (list.get (), membuf.get ()) != 0)
+	return NULL;
+
+      if (data.size () == length)
+	node = extract_unsigned_integer (data.data () + offset, ptr_size,
+					 gdbarch_byte_order (gdbarch));
+    }
+
+  return list.release ();
 }
 
 /* Implementation of Inferior.write_memory (address, buffer [, length]).
@@ -965,6 +1128,16 @@ Return true if this inferior is valid, false if not." },
     METH_VARARGS | METH_KEYWORDS,
     "read_memory (address, length) -> buffer\n\
 Return a buffer object for reading from the inferior's memory." },
+  { "read_memory_vector", (PyCFunction) infpy_read_memory_vector,
+    METH_VARARGS | METH_KEYWORDS,
+    "read_memory_vector (ranges) -> list\n\
+Return a list of buffer objects for reading the given (address, length)\n\
+ranges of the inferior's memory." },
+  { "read_memory_chain", (PyCFunction) infpy_read_memory_chain,
+    METH_VARARGS | METH_KEYWORDS,
+    "read_memory_chain (address, length, offset, count) -> list\n\
+Return a list of buffer objects for reading the nodes of a linked list\n\
+in the inferior's memory." },
   { "write_memory", (PyCFunction) infpy_write_memory,
     METH_VARARGS | METH_KEYWORDS,
     "write_memory (address, buffer [, length])\n\
@@ -100,6 +100,12 @@ public:
 					ULONGEST offset, ULONGEST len,
 					ULONGEST *xfered_len) override;
 
+  bool read_memory_vector (std::vector<memory_read_request> *requests)
+    override;
+  bool read_memory_chain (CORE_ADDR addr, ULONGEST len,
+			  ULONGEST next_offset, int max_count,
+			  std::vector<gdb::byte_vector> *nodes) override;
+
   int insert_breakpoint (struct gdbarch *,
 			 struct bp_target_info *) override;
   int remove_breakpoint (struct gdbarch *, struct bp_target_info *,
@@ -1467,6 +1473,33 @@ record_btrace_target::xfer_partial (enum target_object object,
 					 offset, len, xfered_len);
 }
 
+/* The read_memory_vector method of target record-btrace.  During
+   replay, leave reading memory to xfer_partial, which filters it.  */
+
+bool
+record_btrace_target::read_memory_vector
+  (std::vector<memory_read_request> *requests)
+{
+  if (record_is_replaying (inferior_ptid))
+    return false;
+
+  return this->beneath ()->read_memory_vector (requests);
+}
+
+/* The read_memory_chain method of target record-btrace.  */
+
+bool
+record_btrace_target::read_memory_chain (CORE_ADDR addr, ULONGEST len,
+					 ULONGEST next_offset, int max_count,
+					 std::vector<gdb::byte_vector> *nodes)
+{
+  if (record_is_replaying (inferior_ptid))
+    return false;
+
+  return this->beneath ()->read_memory_chain (addr, len, next_offset,
+					      max_count, nodes);
+}
+
 /* The insert_breakpoint method of target record-btrace.  */
 
 int
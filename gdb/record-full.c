@@ -40,6 +40,11 @@
 #include "common/byte-vector.h"
 
 #include <signal.h>
+#include <algorithm>
+#include <deque>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 /* This module implements "target record-full", also known as "process
    record and replay".  This target sits on top of a "normal" target
@@ -64,9 +69,11 @@
 #define DEFAULT_RECORD_FULL_INSN_MAX_NUM	200000
 
 #define RECORD_FULL_IS_REPLAY \
-  (record_full_list->next || ::execution_direction == EXEC_REVERSE)
+  (record_full_next (record_full_list) != 0 \
+   || ::execution_direction == EXEC_REVERSE)
 
-#define RECORD_FULL_FILE_MAGIC	netorder32(0x20091016)
+#define RECORD_FULL_FILE_MAGIC	netorder32(0x20181018)
+#define RECORD_FULL_FILE_MAGIC_V2	netorder32(0x20091016)
 
 /* These are the core structs of the process record functionality.
 
@@ -76,8 +83,8 @@
    that indicates that this is the last struct record_full_entry of this
    instruction.
 
-   Each struct record_full_entry is linked to "record_full_list" by "prev"
-   and "next" pointers.  */
+   Entries are kept encoded in the execution log (see below); a struct
+   record_full_entry is an entry as decoded by record_full_read_entry.  */
 
 struct record_full_mem_entry
 {
@@ -86,22 +93,19 @@ struct record_full_mem_entry
   /* Set this flag if target memory for this entry
      can no longer be accessed.  */
   int mem_entry_not_accessible;
-  union
-  {
-    gdb_byte *ptr;
-    gdb_byte buf[sizeof (gdb_byte *)];
-  } u;
 };
 
 struct record_full_reg_entry
 {
-  unsigned short num;
-  unsigned short len;
-  union 
-  {
-    gdb_byte *ptr;
-    gdb_byte buf[2 * sizeof (gdb_byte *)];
-  } u;
+  int num;
+  int len;
+  /* Set if the value of this entry is not the other value of the
+     register, but bytes XOR_START to XOR_START + XOR_LEN of the
+     exclusive or of both values.  The other bytes of the exclusive
+     or are zero.  */
+  int delta;
+  int xor_start;
+  int xor_len;
 };
 
 struct record_full_end_entry
@@ -119,32 +123,43 @@ enum record_full_type
 
 /* This is the data structure that makes up the execution log.
 
-   The execution log consists of a single linked list of entries
-   of type "struct record_full_entry".  It is doubly linked so that it
-   can be traversed in either direction.
+   The execution log is a sequence of variable-length entries, stored
+   back to back in large chunks ("struct record_full_chunk").  Each
+   entry ends with its own size, so that the log can be traversed in
+   either direction.  An entry is identified by its position in the
+   log ("record_full_pos"), which stays valid until the entry is
+   released.
 
-   The start of the list is anchored by a struct called
-   "record_full_first".  The pointer "record_full_list" either points
-   to the last entry that was added to the list (in record mode), or to
-   the next entry in the list that will be executed (in replay mode).
-
-   Each list element (struct record_full_entry), in addition to next
-   and prev pointers, consists of a union of three entry types: mem,
-   reg, and end.  A field called "type" determines which entry type is
-   represented by a given list element.
+   The start of the log is anchored by a position called
+   "record_full_first", which has no entry of its own.  The position
+   "record_full_list" either points to the last entry that was added
+   to the log (in record mode), or to the next entry in the log that
+   will be executed (in replay mode).
 
    Each instruction that is added to the execution log is represented
-   by a variable number of list elements ('entries').  The instruction
-   will have one "reg" entry for each register that is changed by 
-   executing the instruction (including the PC in every case).  It 
-   will also have one "mem" entry for each memory change.  Finally,
-   each instruction will have an "end" entry that separates it from
-   the changes associated with the next instruction.  */
+   by a variable number of entries.  The instruction will have one
+   "reg" entry for each register that is changed by executing the
+   instruction (including the PC in every case).  It will also have
+   one "mem" entry for each memory change.  Finally, each instruction
+   will have an "end" entry that separates it from the changes
+   associated with the next instruction.
+
+   An entry is encoded as a tag byte, holding its type and flags,
+   followed by its fields and its value, and then by its size: one
+   byte if the size is less than 255, or else four bytes followed by
+   a 255 byte.  End entries store their signal in the byte after the
+   tag; all the other fields are ULEB128 numbers.
+
+   Executing an entry swaps its value with the current contents of
+   the register or memory it records.  Once an instruction has been
+   executed by the inferior, its register entries are rewritten as
+   the exclusive or of the values before and after the instruction,
+   trimmed to the bytes that differ (see record_full_compact_insn).
+   Executing such a delta entry in either direction just applies the
+   exclusive or to the register.  */
 
 struct record_full_entry
 {
-  struct record_full_entry *prev;
-  struct record_full_entry *next;
   enum record_full_type type;
   union
   {
@@ -155,8 +170,61 @@ struct record_full_entry
     /* end */
     struct record_full_end_entry end;
   } u;
+
+  /* The tag byte and the value of the entry in the log.  */
+  gdb_byte *tag;
+  gdb_byte *val;
+
+  /* The size of the encoded entry.  */
+  size_t size;
+};
+
+/* The bits of the tag byte of an entry.  */
+
+#define RECORD_FULL_TAG_TYPE		0x03
+#define RECORD_FULL_TAG_DELTA		0x04
+#define RECORD_FULL_TAG_NOT_ACCESSIBLE	0x08
+
+gdb_static_assert (GDB_SIGNAL_LAST <= 256);
+
+/* A chunk of the execution log.  */
+
+struct record_full_chunk
+{
+  gdb_byte *data;
+  /* The number of bytes allocated at DATA, and of those used by
+     entries.  */
+  size_t size;
+  size_t used;
+  /* The number of the last instruction that ends in this chunk or in
+     an earlier one, or zero.  This indexes the log by instruction
+     number.  */
+  ULONGEST last_insn;
+  /* True if DATA points into record_full_map, instead of being
+     allocated.  */
+  bool mapped;
+  /* False if the chunk was restored from a save file and its entries
+     have not been checked yet (see record_full_checked_chunk).  */
+  bool checked;
 };
 
+/* The usual size of a chunk of the execution log.  An entry that
+   does not fit gets a chunk of its own.  */
+
+#define RECORD_FULL_CHUNK_SIZE	(1024 * 1024)
+
+/* The position of an entry in the execution log: the sequence number
+   of its chunk in the upper 32 bits, and its offset in the chunk in
+   the lower 32 bits.  Chunk sequence numbers start at 1, so zero is
+   never the position of an entry.  */
+
+typedef ULONGEST record_full_pos;
+
+#define RECORD_FULL_POS(SEQ, OFFSET) \
+  (((record_full_pos) (SEQ) << 32) | (OFFSET))
+#define RECORD_FULL_POS_SEQ(POS) ((POS) >> 32)
+#define RECORD_FULL_POS_OFFSET(POS) ((size_t) ((POS) & 0xffffffff))
+
 /* If true, query if PREC cannot record memory
    change of next instruction.  */
 int record_full_memory_query = 0;
@@ -174,27 +242,54 @@ static struct target_section *record_full_core_start;
 static struct target_section *record_full_core_end;
 static struct record_full_core_buf_entry *record_full_core_buf_list = NULL;
 
-/* The following variables are used for managing the linked list that
-   represents the execution log.
+/* The following variables are used for managing the execution log.
+
+   record_full_chunks holds the chunks of the log, oldest first, and
+   record_full_chunks_seq is the sequence number of the oldest one.
+
+   record_full_start_pos is the position of the first entry of the
+   log, and record_full_end_pos the position just past its last entry,
+   or both are zero if the log is empty.
 
    record_full_first is the anchor that holds down the beginning of
-   the list.
+   the log.
 
    record_full_list serves two functions:
-     1) In record mode, it anchors the end of the list.
-     2) In replay mode, it traverses the list and points to
+     1) In record mode, it anchors the end of the log.
+     2) In replay mode, it traverses the log and points to
         the next instruction that must be emulated.
 
-   record_full_arch_list_head and record_full_arch_list_tail are used
-   to manage a separate list, which is used to build up the change
-   elements of the currently executing instruction during record mode.
-   When this instruction has been completely annotated in the "arch
-   list", it will be appended to the main execution log.  */
-
-static struct record_full_entry record_full_first;
-static struct record_full_entry *record_full_list = &record_full_first;
-static struct record_full_entry *record_full_arch_list_head = NULL;
-static struct record_full_entry *record_full_arch_list_tail = NULL;
+   record_full_arch_list_head and record_full_arch_list_tail are the
+   positions of the first and last entries of the currently executing
+   instruction during record mode (the "arch list").  They are placed
+   after the end of the log while the instruction is being annotated,
+   and become part of the log once it is completely annotated.  */
+
+static std::deque<struct record_full_chunk> record_full_chunks;
+static ULONGEST record_full_chunks_seq = 1;
+
+#ifdef HAVE_MMAP
+/* The mapping of the execution log of a restored file, and the number
+   of chunks that still point into it.  */
+static void *record_full_map;
+static bfd_size_type record_full_map_len;
+static int record_full_map_chunks;
+#endif
+/* The architecture of a restored execution log, which its unchecked
+   chunks are checked against.  */
+static struct gdbarch *record_full_restore_gdbarch;
+static record_full_pos record_full_start_pos;
+static record_full_pos record_full_end_pos;
+static const record_full_pos record_full_first = 1;
+static record_full_pos record_full_list = record_full_first;
+static record_full_pos record_full_arch_list_head = 0;
+static record_full_pos record_full_arch_list_tail = 0;
+
+/* The position of the first entry of the last instruction recorded
+   by record_full_message, as long as its register entries have not
+   been rewritten in delta form, and the thread that executes it.  */
+static record_full_pos record_full_compact_pos;
+static ptid_t record_full_compact_ptid;
 
 /* 1 ask user. 0 auto delete the last struct record_full_entry.  */
 static int record_full_stop_at_limit = 1;
@@ -376,156 +471,476 @@ static struct cmd_list_element *show_record_full_cmdlist;
 /* Command list for "record full".  */
 static struct cmd_list_element *record_full_cmdlist;
 
-static void record_full_goto_insn (struct record_full_entry *entry,
+static void record_full_goto_insn (record_full_pos entry,
 				   enum exec_direction_kind dir);
 
-/* Alloc and free functions for record_full_reg, record_full_mem, and
-   record_full_end entries.  */
+/* Return the number of bytes needed to encode VAL as ULEB128.  */
 
-/* Alloc a record_full_reg record entry.  */
-
-static inline struct record_full_entry *
-record_full_reg_alloc (struct regcache *regcache, int regnum)
+static size_t
+record_full_uleb_size (ULONGEST val)
 {
-  struct record_full_entry *rec;
-  struct gdbarch *gdbarch = regcache->arch ();
+  size_t size = 1;
+
+  while (val >= 0x80)
+    {
+      val >>= 7;
+      size++;
+    }
+  return size;
+}
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_reg;
-  rec->u.reg.num = regnum;
-  rec->u.reg.len = register_size (gdbarch, regnum);
-  if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-    rec->u.reg.u.ptr = (gdb_byte *) xmalloc (rec->u.reg.len);
+/* Encode VAL as ULEB128 at BUF, and return the byte after it.  */
 
-  return rec;
+static gdb_byte *
+record_full_write_uleb (gdb_byte *buf, ULONGEST val)
+{
+  while (val >= 0x80)
+    {
+      *buf++ = (val & 0x7f) | 0x80;
+      val >>= 7;
+    }
+  *buf++ = val;
+  return buf;
 }
 
-/* Free a record_full_reg record entry.  */
+/* Decode the ULEB128 number at BUF into *VAL, and return the byte
+   after it.  */
 
-static inline void
-record_full_reg_release (struct record_full_entry *rec)
+static gdb_byte *
+record_full_read_uleb (gdb_byte *buf, ULONGEST *val)
 {
-  gdb_assert (rec->type == record_full_reg);
-  if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-    xfree (rec->u.reg.u.ptr);
-  xfree (rec);
+  ULONGEST result = 0;
+  int shift = 0;
+  gdb_byte byte;
+
+  do
+    {
+      byte = *buf++;
+      result |= (ULONGEST) (byte & 0x7f) << shift;
+      shift += 7;
+    }
+  while (byte & 0x80);
+
+  *val = result;
+  return buf;
 }
 
-/* Alloc a record_full_mem record entry.  */
+/* Return the size of an entry whose tag, fields and value take BODY
+   bytes, including the size at its end.  */
 
-static inline struct record_full_entry *
-record_full_mem_alloc (CORE_ADDR addr, int len)
+static size_t
+record_full_entry_size (size_t body)
 {
-  struct record_full_entry *rec;
+  return body + 1 < 255 ? body + 1 : body + 5;
+}
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_mem;
-  rec->u.mem.addr = addr;
-  rec->u.mem.len = len;
-  if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-    rec->u.mem.u.ptr = (gdb_byte *) xmalloc (len);
+/* Return the size of the entry that ends at END.  */
 
-  return rec;
+static size_t
+record_full_size_before (const gdb_byte *end)
+{
+  if (end[-1] != 255)
+    return end[-1];
+  return extract_unsigned_integer (end - 5, 4, BFD_ENDIAN_LITTLE);
 }
 
-/* Free a record_full_mem record entry.  */
+/* Return the chunk of the execution log that holds position POS.  */
 
-static inline void
-record_full_mem_release (struct record_full_entry *rec)
+static inline struct record_full_chunk &
+record_full_chunk_of (record_full_pos pos)
 {
-  gdb_assert (rec->type == record_full_mem);
-  if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-    xfree (rec->u.mem.u.ptr);
-  xfree (rec);
+  return record_full_chunks[RECORD_FULL_POS_SEQ (pos)
+			    - record_full_chunks_seq];
 }
 
-/* Alloc a record_full_end record entry.  */
+static void record_full_check_chunk (struct gdbarch *gdbarch,
+				     const gdb_byte *buf, size_t len);
+
+/* Return the chunk of the execution log with sequence number SEQ,
+   about to be used to find or decode entries.  The entries of a chunk
+   restored from a save file are only checked here, the first time the
+   chunk is used, so that restoring a log does not read all of it.  */
 
-static inline struct record_full_entry *
-record_full_end_alloc (void)
+static struct record_full_chunk &
+record_full_checked_chunk (ULONGEST seq)
 {
-  struct record_full_entry *rec;
+  struct record_full_chunk &chunk
+    = record_full_chunks[seq - record_full_chunks_seq];
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_end;
+  if (!chunk.checked)
+    {
+      record_full_check_chunk (record_full_restore_gdbarch, chunk.data,
+			       chunk.used);
+      chunk.checked = true;
+    }
+  return chunk;
+}
+
+/* Return the length of the value of REC.  */
 
-  return rec;
+static int
+record_full_val_len (const struct record_full_entry *rec)
+{
+  switch (rec->type)
+    {
+    case record_full_reg:
+      return rec->u.reg.delta ? rec->u.reg.xor_len : rec->u.reg.len;
+    case record_full_mem:
+      return rec->u.mem.len;
+    default:
+      return 0;
+    }
 }
 
-/* Free a record_full_end record entry.  */
+/* Decode the entry at position POS of the execution log into REC.
+   record_full_first decodes as the end of instruction number 0.  */
 
-static inline void
-record_full_end_release (struct record_full_entry *rec)
+static void
+record_full_read_entry (record_full_pos pos, struct record_full_entry *rec)
 {
-  xfree (rec);
+  gdb_byte *buf;
+  ULONGEST val;
+
+  if (pos == record_full_first)
+    {
+      rec->type = record_full_end;
+      rec->u.end.sigval = GDB_SIGNAL_0;
+      rec->u.end.insn_num = 0;
+      rec->tag = NULL;
+      rec->val = NULL;
+      rec->size = 0;
+      return;
+    }
+
+  buf = (record_full_checked_chunk (RECORD_FULL_POS_SEQ (pos)).data
+	 + RECORD_FULL_POS_OFFSET (pos));
+  rec->tag = buf++;
+  rec->type = (enum record_full_type) (*rec->tag & RECORD_FULL_TAG_TYPE);
+  switch (rec->type)
+    {
+    case record_full_end:
+      rec->u.end.sigval = (enum gdb_signal) *buf++;
+      buf = record_full_read_uleb (buf, &rec->u.end.insn_num);
+      break;
+
+    case record_full_reg:
+      buf = record_full_read_uleb (buf, &val);
+      rec->u.reg.num = val;
+      buf = record_full_read_uleb (buf, &val);
+      rec->u.reg.len = val;
+      rec->u.reg.delta = (*rec->tag & RECORD_FULL_TAG_DELTA) != 0;
+      if (rec->u.reg.delta)
+	{
+	  buf = record_full_read_uleb (buf, &val);
+	  rec->u.reg.xor_start = val;
+	  buf = record_full_read_uleb (buf, &val);
+	  rec->u.reg.xor_len = val;
+	}
+      break;
+
+    case record_full_mem:
+      buf = record_full_read_uleb (buf, &val);
+      rec->u.mem.addr = val;
+      buf = record_full_read_uleb (buf, &val);
+      rec->u.mem.len = val;
+      rec->u.mem.mem_entry_not_accessible
+	= (*rec->tag & RECORD_FULL_TAG_NOT_ACCESSIBLE) != 0;
+      break;
+
+    default:
+      gdb_assert_not_reached ("unexpected record_full_entry type");
+    }
+
+  rec->val = buf;
+  rec->size = record_full_entry_size (buf + record_full_val_len (rec)
+				      - rec->tag);
 }
 
-/* Free one record entry, any type.
-   Return entry->type, in case caller wants to know.  */
+/* Return the size of the encoded form of REC.  */
 
-static inline enum record_full_type
-record_full_entry_release (struct record_full_entry *rec)
+static size_t
+record_full_encoded_size (const struct record_full_entry *rec)
 {
-  enum record_full_type type = rec->type;
+  size_t body = 1 + record_full_val_len (rec);
 
-  switch (type) {
-  case record_full_reg:
-    record_full_reg_release (rec);
-    break;
-  case record_full_mem:
-    record_full_mem_release (rec);
-    break;
-  case record_full_end:
-    record_full_end_release (rec);
-    break;
-  }
-  return type;
+  switch (rec->type)
+    {
+    case record_full_end:
+      body += 1 + record_full_uleb_size (rec->u.end.insn_num);
+      break;
+    case record_full_reg:
+      body += (record_full_uleb_size (rec->u.reg.num)
+	       + record_full_uleb_size (rec->u.reg.len));
+      if (rec->u.reg.delta)
+	body += (record_full_uleb_size (rec->u.reg.xor_start)
+		 + record_full_uleb_size (rec->u.reg.xor_len));
+      break;
+    case record_full_mem:
+      body += (record_full_uleb_size (rec->u.mem.addr)
+	       + record_full_uleb_size (rec->u.mem.len));
+      break;
+    }
+  return record_full_entry_size (body);
 }
 
-/* Free all record entries in list pointed to by REC.  */
+/* Encode REC at BUF, which has room for REC->size bytes, and point
+   REC->tag and REC->val into BUF.  The value itself is left for the
+   caller to store.  */
 
 static void
-record_full_list_release (struct record_full_entry *rec)
+record_full_encode (struct record_full_entry *rec, gdb_byte *buf)
 {
-  if (!rec)
-    return;
+  gdb_byte *end = buf + rec->size;
+
+  rec->tag = buf++;
+  *rec->tag = rec->type;
+  switch (rec->type)
+    {
+    case record_full_end:
+      *buf++ = rec->u.end.sigval;
+      buf = record_full_write_uleb (buf, rec->u.end.insn_num);
+      break;
+    case record_full_reg:
+      buf = record_full_write_uleb (buf, rec->u.reg.num);
+      buf = record_full_write_uleb (buf, rec->u.reg.len);
+      if (rec->u.reg.delta)
+	{
+	  *rec->tag |= RECORD_FULL_TAG_DELTA;
+	  buf = record_full_write_uleb (buf, rec->u.reg.xor_start);
+	  buf = record_full_write_uleb (buf, rec->u.reg.xor_len);
+	}
+      break;
+    case record_full_mem:
+      if (rec->u.mem.mem_entry_not_accessible)
+	*rec->tag |= RECORD_FULL_TAG_NOT_ACCESSIBLE;
+      buf = record_full_write_uleb (buf, rec->u.mem.addr);
+      buf = record_full_write_uleb (buf, rec->u.mem.len);
+      break;
+    }
+  rec->val = buf;
+
+  if (rec->size < 255)
+    end[-1] = rec->size;
+  else
+    {
+      store_unsigned_integer (end - 5, 4, BFD_ENDIAN_LITTLE, rec->size);
+      end[-1] = 255;
+    }
+}
+
+/* Return the position of the entry that follows the one at POS in
+   the execution log, or zero if POS is the last one.  */
+
+static record_full_pos
+record_full_next (record_full_pos pos)
+{
+  struct record_full_entry rec;
+
+  if (pos == record_full_first)
+    return record_full_start_pos;
+
+  record_full_read_entry (pos, &rec);
+  pos += rec.size;
+  if (pos == record_full_end_pos)
+    return 0;
+  if (RECORD_FULL_POS_OFFSET (pos) == record_full_chunk_of (pos).used)
+    pos = RECORD_FULL_POS (RECORD_FULL_POS_SEQ (pos) + 1, 0);
+  return pos;
+}
+
+/* Return the position of the entry that precedes the one at POS in
+   the execution log, or zero if POS is record_full_first.  */
+
+static record_full_pos
+record_full_prev (record_full_pos pos)
+{
+  ULONGEST seq = RECORD_FULL_POS_SEQ (pos);
+  size_t offset = RECORD_FULL_POS_OFFSET (pos);
 
-  while (rec->next)
-    rec = rec->next;
+  if (pos == record_full_first)
+    return 0;
+  if (pos == record_full_start_pos)
+    return record_full_first;
 
-  while (rec->prev)
+  /* The first entry of a chunk follows the last entry of the
+     previous chunk.  */
+  if (offset == 0)
     {
-      rec = rec->prev;
-      record_full_entry_release (rec->next);
+      seq--;
+      offset = record_full_chunks[seq - record_full_chunks_seq].used;
     }
 
-  if (rec == &record_full_first)
+  const struct record_full_chunk &chunk = record_full_checked_chunk (seq);
+
+  return RECORD_FULL_POS (seq, offset - record_full_size_before (chunk.data
+								 + offset));
+}
+
+/* Return the position of the last entry of the execution log, or
+   record_full_first if the log is empty.  */
+
+static record_full_pos
+record_full_last (void)
+{
+  if (record_full_end_pos == 0)
+    return record_full_first;
+
+  const struct record_full_chunk &chunk
+    = record_full_checked_chunk (RECORD_FULL_POS_SEQ (record_full_end_pos));
+
+  return record_full_end_pos - record_full_size_before
+    (chunk.data + RECORD_FULL_POS_OFFSET (record_full_end_pos));
+}
+
+/* Allocate SIZE bytes for a new entry at the end of the execution
+   log.  Store its position in *POS and return its storage.  */
+
+static gdb_byte *
+record_full_alloc (size_t size, record_full_pos *pos)
+{
+  if (record_full_chunks.empty ()
+      || (record_full_chunks.back ().size - record_full_chunks.back ().used
+	  < size))
     {
-      record_full_insn_num = 0;
-      record_full_first.next = NULL;
+      struct record_full_chunk chunk;
+
+      chunk.size = std::max (size, (size_t) RECORD_FULL_CHUNK_SIZE);
+      chunk.data = (gdb_byte *) xmalloc (chunk.size);
+      chunk.used = 0;
+      chunk.last_insn = (record_full_chunks.empty ()
+			 ? 0 : record_full_chunks.back ().last_insn);
+      chunk.mapped = false;
+      chunk.checked = true;
+      record_full_chunks.push_back (chunk);
     }
+
+  struct record_full_chunk &chunk = record_full_chunks.back ();
+
+  *pos = RECORD_FULL_POS (record_full_chunks_seq
+			  + record_full_chunks.size () - 1, chunk.used);
+  chunk.used += size;
+  return chunk.data + chunk.used - size;
+}
+
+/* Free the storage of CHUNK.  */
+
+static void
+record_full_chunk_free (struct record_full_chunk &chunk)
+{
+  if (!chunk.mapped)
+    {
+      xfree (chunk.data);
+      return;
+    }
+
+#ifdef HAVE_MMAP
+  if (--record_full_map_chunks == 0)
+    {
+      munmap (record_full_map, record_full_map_len);
+      record_full_map = NULL;
+    }
+#endif
+}
+
+/* Recompute the last_insn field of chunk number SEQ, whose entries
+   changed.  */
+
+static void
+record_full_chunk_reindex (ULONGEST seq)
+{
+  struct record_full_chunk &chunk = record_full_chunks[seq
+						       - record_full_chunks_seq];
+  struct record_full_entry rec;
+  size_t offset;
+
+  chunk.last_insn = (seq == record_full_chunks_seq
+		     ? 0 : record_full_chunks[seq - record_full_chunks_seq
+					      - 1].last_insn);
+  for (offset = 0; offset < chunk.used; offset += rec.size)
+    {
+      record_full_read_entry (RECORD_FULL_POS (seq, offset), &rec);
+      if (rec.type == record_full_end)
+	chunk.last_insn = rec.u.end.insn_num;
+    }
+}
+
+/* Free the storage of the execution log from position END onward, or
+   all of it if END is zero.  */
+
+static void
+record_full_truncate (record_full_pos end)
+{
+  ULONGEST seq;
+
+  if (end == 0)
+    seq = record_full_chunks_seq;
+  else if (RECORD_FULL_POS_OFFSET (end) == 0)
+    seq = RECORD_FULL_POS_SEQ (end);
   else
-    record_full_entry_release (rec);
+    {
+      struct record_full_chunk &chunk = record_full_chunk_of (end);
+
+      seq = RECORD_FULL_POS_SEQ (end) + 1;
+      if (chunk.used != RECORD_FULL_POS_OFFSET (end))
+	{
+	  chunk.used = RECORD_FULL_POS_OFFSET (end);
+	  record_full_chunk_reindex (seq - 1);
+	}
+    }
+
+  while (record_full_chunks_seq + record_full_chunks.size () > seq)
+    {
+      record_full_chunk_free (record_full_chunks.back ());
+      record_full_chunks.pop_back ();
+    }
+
+  if (record_full_compact_pos >= end)
+    record_full_compact_pos = 0;
 }
 
-/* Free all record entries forward of the given list position.  */
+/* Free all record entries.  */
 
 static void
-record_full_list_release_following (struct record_full_entry *rec)
+record_full_list_release (void)
+{
+  record_full_truncate (0);
+  record_full_start_pos = 0;
+  record_full_end_pos = 0;
+  record_full_arch_list_head = 0;
+  record_full_arch_list_tail = 0;
+  record_full_list = record_full_first;
+  record_full_insn_num = 0;
+}
+
+/* Free all record entries forward of the given log position.  */
+
+static void
+record_full_list_release_following (record_full_pos pos)
 {
-  struct record_full_entry *tmp = rec->next;
+  struct record_full_entry rec;
+  record_full_pos tmp;
 
-  rec->next = NULL;
-  while (tmp)
+  for (tmp = record_full_next (pos); tmp != 0; tmp = record_full_next (tmp))
     {
-      rec = tmp->next;
-      if (record_full_entry_release (tmp) == record_full_end)
+      record_full_read_entry (tmp, &rec);
+      if (rec.type == record_full_end)
 	{
 	  record_full_insn_num--;
 	  record_full_insn_count--;
 	}
-      tmp = rec;
     }
+
+  if (pos == record_full_first)
+    {
+      record_full_start_pos = 0;
+      record_full_end_pos = 0;
+    }
+  else
+    {
+      record_full_read_entry (pos, &rec);
+      record_full_end_pos = pos + rec.size;
+    }
+  record_full_truncate (record_full_end_pos);
 }
 
 /* Delete the first instruction from the beginning of the log, to make
@@ -536,74 +951,102 @@ record_full_list_release_following (struct record_full_entry *rec)
 static void
 record_full_list_release_first (void)
 {
-  struct record_full_entry *tmp;
+  struct record_full_entry rec;
 
-  if (!record_full_first.next)
+  if (record_full_start_pos == 0)
     return;
 
   /* Loop until a record_full_end.  */
   while (1)
     {
-      /* Cut record_full_first.next out of the linked list.  */
-      tmp = record_full_first.next;
-      record_full_first.next = tmp->next;
-      tmp->next->prev = &record_full_first;
+      record_full_read_entry (record_full_start_pos, &rec);
+      record_full_start_pos = record_full_next (record_full_start_pos);
 
-      /* tmp is now isolated, and can be deleted.  */
-      if (record_full_entry_release (tmp) == record_full_end)
+      if (rec.type == record_full_end)
 	break;	/* End loop at first record_full_end.  */
 
-      if (!record_full_first.next)
+      if (record_full_start_pos == 0)
 	{
 	  gdb_assert (record_full_insn_num == 1);
 	  break;	/* End loop when list is empty.  */
 	}
     }
+
+  if (record_full_start_pos == 0)
+    record_full_end_pos = 0;
+
+  /* Free the chunks that no longer hold any entry.  */
+  while (!record_full_chunks.empty ()
+	 && (record_full_start_pos == 0
+	     || (record_full_chunks_seq
+		 < RECORD_FULL_POS_SEQ (record_full_start_pos))))
+    {
+      record_full_chunk_free (record_full_chunks.front ());
+      record_full_chunks.pop_front ();
+      record_full_chunks_seq++;
+    }
+
+  if (record_full_list != record_full_first
+      && (record_full_start_pos == 0
+	  || record_full_list < record_full_start_pos))
+    record_full_list = record_full_first;
+  if (record_full_compact_pos < record_full_start_pos
+      || record_full_start_pos == 0)
+    record_full_compact_pos = 0;
 }
 
-/* Add a struct record_full_entry to record_full_arch_list.  */
+/* Add REC to record_full_arch_list, and return where the caller must
+   store its value.  */
 
-static void
+static gdb_byte *
 record_full_arch_list_add (struct record_full_entry *rec)
 {
+  record_full_pos pos;
+
+  rec->size = record_full_encoded_size (rec);
+  record_full_encode (rec, record_full_alloc (rec->size, &pos));
+  if (rec->type == record_full_end)
+    record_full_chunk_of (pos).last_insn = rec->u.end.insn_num;
+
   if (record_debug > 1)
     fprintf_unfiltered (gdb_stdlog,
 			"Process record: record_full_arch_list_add %s.\n",
-			host_address_to_string (rec));
+			hex_string (pos));
 
-  if (record_full_arch_list_tail)
-    {
-      record_full_arch_list_tail->next = rec;
-      rec->prev = record_full_arch_list_tail;
-      record_full_arch_list_tail = rec;
-    }
-  else
-    {
-      record_full_arch_list_head = rec;
-      record_full_arch_list_tail = rec;
-    }
+  if (record_full_arch_list_head == 0)
+    record_full_arch_list_head = pos;
+  record_full_arch_list_tail = pos;
+
+  return rec->val;
+}
+
+/* Free the entries in record_full_arch_list.  */
+
+static void
+record_full_arch_list_release (void)
+{
+  record_full_truncate (record_full_end_pos);
+  record_full_arch_list_head = 0;
+  record_full_arch_list_tail = 0;
 }
 
-/* Return the value storage location of a record entry.  */
-static inline gdb_byte *
-record_full_get_loc (struct record_full_entry *rec)
+/* Add the instruction in record_full_arch_list to the end of the
+   execution log.  */
+
+static void
+record_full_arch_list_commit (void)
 {
-  switch (rec->type) {
-  case record_full_mem:
-    if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-      return rec->u.mem.u.ptr;
-    else
-      return rec->u.mem.u.buf;
-  case record_full_reg:
-    if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-      return rec->u.reg.u.ptr;
-    else
-      return rec->u.reg.u.buf;
-  case record_full_end:
-  default:
-    gdb_assert_not_reached ("unexpected record_full_entry type");
-    return NULL;
-  }
+  struct record_full_entry rec;
+
+  record_full_read_entry (record_full_arch_list_tail, &rec);
+  if (record_full_start_pos == 0)
+    record_full_start_pos = record_full_arch_list_head;
+  record_full_end_pos = record_full_arch_list_tail + rec.size;
+  record_full_list = record_full_arch_list_tail;
+  record_full_compact_pos = 0;
+
+  record_full_arch_list_head = 0;
+  record_full_arch_list_tail = 0;
 }
 
 /* Record the value of a register NUM to record_full_arch_list.  */
@@ -611,7 +1054,7 @@ record_full_get_loc (struct record_full_entry *rec)
 int
 record_full_arch_list_add_reg (struct regcache *regcache, int regnum)
 {
-  struct record_full_entry *rec;
+  struct record_full_entry rec;
 
   if (record_debug > 1)
     fprintf_unfiltered (gdb_stdlog,
@@ -619,11 +1062,12 @@ record_full_arch_list_add_reg (struct regcache *regcache, int regnum)
 			"record list.\n",
 			regnum);
 
-  rec = record_full_reg_alloc (regcache, regnum);
+  rec.type = record_full_reg;
+  rec.u.reg.num = regnum;
+  rec.u.reg.len = register_size (regcache->arch (), regnum);
+  rec.u.reg.delta = 0;
 
-  regcache->raw_read (regnum, record_full_get_loc (rec));
-
-  record_full_arch_list_add (rec);
+  regcache->raw_read (regnum, record_full_arch_list_add (&rec));
 
   return 0;
 }
@@ -634,7 +1078,8 @@ record_full_arch_list_add_reg (struct regcache *regcache, int regnum)
 int
 record_full_arch_list_add_mem (CORE_ADDR addr, int len)
 {
-  struct record_full_entry *rec;
+  struct record_full_entry rec;
+  record_full_pos tail = record_full_arch_list_tail;
 
   if (record_debug > 1)
     fprintf_unfiltered (gdb_stdlog,
@@ -645,17 +1090,22 @@ record_full_arch_list_add_mem (CORE_ADDR addr, int len)
   if (!addr)	/* FIXME: Why?  Some arch must permit it...  */
     return 0;
 
-  rec = record_full_mem_alloc (addr, len);
+  rec.type = record_full_mem;
+  rec.u.mem.addr = addr;
+  rec.u.mem.len = len;
+  rec.u.mem.mem_entry_not_accessible = 0;
 
   if (record_read_memory (target_gdbarch (), addr,
-			  record_full_get_loc (rec), len))
+			  record_full_arch_list_add (&rec), len))
     {
-      record_full_mem_release (rec);
+      /* Take the entry back out of record_full_arch_list.  */
+      record_full_truncate (record_full_arch_list_tail);
+      record_full_arch_list_tail = tail;
+      if (tail == 0)
+	record_full_arch_list_head = 0;
       return -1;
     }
 
-  record_full_arch_list_add (rec);
-
   return 0;
 }
 
@@ -665,21 +1115,98 @@ record_full_arch_list_add_mem (CORE_ADDR addr, int len)
 int
 record_full_arch_list_add_end (void)
 {
-  struct record_full_entry *rec;
+  struct record_full_entry rec;
 
   if (record_debug > 1)
     fprintf_unfiltered (gdb_stdlog,
 			"Process record: add end to arch list.\n");
 
-  rec = record_full_end_alloc ();
-  rec->u.end.sigval = GDB_SIGNAL_0;
-  rec->u.end.insn_num = ++record_full_insn_count;
+  rec.type = record_full_end;
+  rec.u.end.sigval = GDB_SIGNAL_0;
+  rec.u.end.insn_num = ++record_full_insn_count;
 
-  record_full_arch_list_add (rec);
+  record_full_arch_list_add (&rec);
 
   return 0;
 }
 
+/* Rewrite the register entries of the instruction at
+   record_full_compact_pos in delta form, now that the inferior has
+   executed it.  REGCACHE holds the current registers of the thread
+   about to execute the next instruction.
+
+   The instruction is rewritten in place, so this is only done while
+   it is the last one of the log and is held in a single chunk.  A
+   register entry whose delta would not be smaller is left alone, and
+   one for a register that did not change is dropped.  */
+
+static void
+record_full_compact_insn (struct regcache *regcache)
+{
+  record_full_pos pos = record_full_compact_pos;
+  record_full_pos tmp;
+  struct record_full_entry rec;
+  gdb::byte_vector buf, reg;
+
+  record_full_compact_pos = 0;
+
+  if (pos == 0
+      || record_full_arch_list_head != 0
+      || record_full_next (record_full_list) != 0
+      || RECORD_FULL_POS_SEQ (pos) != RECORD_FULL_POS_SEQ (record_full_list)
+      || regcache->ptid () != record_full_compact_ptid)
+    return;
+
+  for (tmp = pos; tmp != 0; tmp = record_full_next (tmp))
+    {
+      size_t size = buf.size ();
+      int start, end;
+
+      record_full_read_entry (tmp, &rec);
+      if (rec.type == record_full_reg && !rec.u.reg.delta)
+	{
+	  reg.resize (rec.u.reg.len);
+	  if (regcache->raw_read (rec.u.reg.num, reg.data ()) == REG_VALID)
+	    {
+	      for (start = 0; start < rec.u.reg.len; start++)
+		reg[start] ^= rec.val[start];
+
+	      for (start = 0; start < rec.u.reg.len && reg[start] == 0;
+		   start++)
+		;
+	      if (start == rec.u.reg.len)
+		continue;
+	      for (end = rec.u.reg.len; reg[end - 1] == 0; end--)
+		;
+
+	      struct record_full_entry delta = rec;
+
+	      delta.u.reg.delta = 1;
+	      delta.u.reg.xor_start = start;
+	      delta.u.reg.xor_len = end - start;
+	      delta.size = record_full_encoded_size (&delta);
+	      if (delta.size < rec.size)
+		{
+		  buf.resize (size + delta.size);
+		  record_full_encode (&delta, &buf[size]);
+		  memcpy (delta.val, &reg[start], end - start);
+		  continue;
+		}
+	    }
+	}
+
+      buf.insert (buf.end (), rec.tag, rec.tag + rec.size);
+    }
+
+  struct record_full_chunk &chunk = record_full_chunk_of (pos);
+
+  memcpy (chunk.data + RECORD_FULL_POS_OFFSET (pos), buf.data (),
+	  buf.size ());
+  chunk.used = RECORD_FULL_POS_OFFSET (pos) + buf.size ();
+  record_full_end_pos = pos + buf.size ();
+  record_full_list = record_full_last ();
+}
+
 static void
 record_full_check_insn_num (void)
 {
@@ -709,10 +1236,12 @@ record_full_message (struct regcache *regcache, enum gdb_signal signal)
   int ret;
   struct gdbarch *gdbarch = regcache->arch ();
 
+  /* The previous instruction has been executed by now.  */
+  record_full_compact_insn (regcache);
+
   TRY
     {
-      record_full_arch_list_head = NULL;
-      record_full_arch_list_tail = NULL;
+      record_full_arch_list_release ();
 
       /* Check record_full_insn_num.  */
       record_full_check_insn_num ();
@@ -740,11 +1269,16 @@ record_full_message (struct regcache *regcache, enum gdb_signal signal)
 	 if we delivered it during the recording.  Therefore we should
 	 record the signal during record_full_wait, not
 	 record_full_resume.  */
-      if (record_full_list != &record_full_first)  /* FIXME better way
-						      to check */
+      if (record_full_list != record_full_first)  /* FIXME better way
+						     to check */
 	{
-	  gdb_assert (record_full_list->type == record_full_end);
-	  record_full_list->u.end.sigval = signal;
+	  struct record_full_entry rec;
+
+	  record_full_read_entry (record_full_list, &rec);
+	  gdb_assert (rec.type == record_full_end);
+
+	  /* The signal is the byte after the tag.  */
+	  rec.tag[1] = signal;
 	}
 
       if (signal == GDB_SIGNAL_0
@@ -764,14 +1298,16 @@ record_full_message (struct regcache *regcache, enum gdb_signal signal)
     }
   CATCH (ex, RETURN_MASK_ALL)
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_release ();
       throw_exception (ex);
     }
   END_CATCH
 
-  record_full_list->next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = record_full_list;
-  record_full_list = record_full_arch_list_tail;
+  record_full_pos head = record_full_arch_list_head;
+
+  record_full_arch_list_commit ();
+  record_full_compact_pos = head;
+  record_full_compact_ptid = regcache->ptid ();
 
   if (record_full_insn_num == record_full_insn_max_num)
     record_full_list_release_first ();
@@ -831,12 +1367,25 @@ record_full_exec_insn (struct regcache *regcache,
           fprintf_unfiltered (gdb_stdlog,
                               "Process record: record_full_reg %s to "
                               "inferior num = %d.\n",
-                              host_address_to_string (entry),
+                              host_address_to_string (entry->tag),
                               entry->u.reg.num);
 
         regcache->cooked_read (entry->u.reg.num, reg.data ());
-        regcache->cooked_write (entry->u.reg.num, record_full_get_loc (entry));
-        memcpy (record_full_get_loc (entry), reg.data (), entry->u.reg.len);
+	if (entry->u.reg.delta)
+	  {
+	    int i;
+
+	    /* The exclusive or of both values switches between them,
+	       whichever is current.  */
+	    for (i = 0; i < entry->u.reg.xor_len; i++)
+	      reg[entry->u.reg.xor_start + i] ^= entry->val[i];
+	    regcache->cooked_write (entry->u.reg.num, reg.data ());
+	  }
+	else
+	  {
+	    regcache->cooked_write (entry->u.reg.num, entry->val);
+	    memcpy (entry->val, reg.data (), entry->u.reg.len);
+	  }
       }
       break;
 
@@ -851,21 +1400,20 @@ record_full_exec_insn (struct regcache *regcache,
               fprintf_unfiltered (gdb_stdlog,
                                   "Process record: record_full_mem %s to "
                                   "inferior addr = %s len = %d.\n",
-                                  host_address_to_string (entry),
+                                  host_address_to_string (entry->tag),
                                   paddress (gdbarch, entry->u.mem.addr),
                                   entry->u.mem.len);
 
             if (record_read_memory (gdbarch,
 				    entry->u.mem.addr, mem.data (),
 				    entry->u.mem.len))
-	      entry->u.mem.mem_entry_not_accessible = 1;
+	      *entry->tag |= RECORD_FULL_TAG_NOT_ACCESSIBLE;
             else
               {
                 if (target_write_memory (entry->u.mem.addr, 
-					 record_full_get_loc (entry),
-					 entry->u.mem.len))
+					 entry->val, entry->u.mem.len))
                   {
-                    entry->u.mem.mem_entry_not_accessible = 1;
+                    *entry->tag |= RECORD_FULL_TAG_NOT_ACCESSIBLE;
                     if (record_debug)
                       warning (_("Process record: error writing memory at "
 				 "addr = %s len = %d."),
@@ -874,8 +1422,7 @@ record_full_exec_insn (struct regcache *regcache,
                   }
                 else
 		  {
-		    memcpy (record_full_get_loc (entry), mem.data (),
-			    entry->u.mem.len);
+		    memcpy (entry->val, mem.data (), entry->u.mem.len);
 
 		    /* We've changed memory --- check if a hardware
 		       watchpoint should trap.  Note that this
@@ -977,8 +1524,7 @@ record_full_open (const char *name, int from_tty)
   /* Reset */
   record_full_insn_num = 0;
   record_full_insn_count = 0;
-  record_full_list = &record_full_first;
-  record_full_list->next = NULL;
+  record_full_list_release ();
 
   if (core_bfd)
     record_full_core_open_1 (name, from_tty);
@@ -1005,7 +1551,7 @@ record_full_base_target::close ()
   if (record_debug)
     fprintf_unfiltered (gdb_stdlog, "Process record: record_full_close\n");
 
-  record_full_list_release (record_full_list);
+  record_full_list_release ();
 
   /* Release record_full_core_regbuf.  */
   if (record_full_core_regbuf)
@@ -1331,39 +1877,43 @@ record_full_wait_1 (struct target_ops *ops,
 
 	  /* In EXEC_FORWARD mode, record_full_list points to the tail of prev
 	     instruction.  */
-	  if (execution_direction == EXEC_FORWARD && record_full_list->next)
-	    record_full_list = record_full_list->next;
+	  if (execution_direction == EXEC_FORWARD
+	      && record_full_next (record_full_list))
+	    record_full_list = record_full_next (record_full_list);
 
 	  /* Loop over the record_full_list, looking for the next place to
 	     stop.  */
 	  do
 	    {
+	      struct record_full_entry rec;
+
 	      /* Check for beginning and end of log.  */
 	      if (execution_direction == EXEC_REVERSE
-		  && record_full_list == &record_full_first)
+		  && record_full_list == record_full_first)
 		{
 		  /* Hit beginning of record log in reverse.  */
 		  status->kind = TARGET_WAITKIND_NO_HISTORY;
 		  break;
 		}
 	      if (execution_direction != EXEC_REVERSE
-		  && !record_full_list->next)
+		  && !record_full_next (record_full_list))
 		{
 		  /* Hit end of record log going forward.  */
 		  status->kind = TARGET_WAITKIND_NO_HISTORY;
 		  break;
 		}
 
-	      record_full_exec_insn (regcache, gdbarch, record_full_list);
+	      record_full_read_entry (record_full_list, &rec);
+	      record_full_exec_insn (regcache, gdbarch, &rec);
 
-	      if (record_full_list->type == record_full_end)
+	      if (rec.type == record_full_end)
 		{
 		  if (record_debug > 1)
 		    fprintf_unfiltered
 		      (gdb_stdlog,
 		       "Process record: record_full_end %s to "
 		       "inferior.\n",
-		       host_address_to_string (record_full_list));
+		       hex_string (record_full_list));
 
 		  if (first_record_full_end
 		      && execution_direction == EXEC_REVERSE)
@@ -1412,7 +1962,7 @@ record_full_wait_1 (struct target_ops *ops,
 			  continue_flag = 0;
 			}
 		      /* Check target signal */
-		      if (record_full_list->u.end.sigval != GDB_SIGNAL_0)
+		      if (rec.u.end.sigval != GDB_SIGNAL_0)
 			/* FIXME: better way to check */
 			continue_flag = 0;
 		    }
@@ -1422,24 +1972,28 @@ record_full_wait_1 (struct target_ops *ops,
 		{
 		  if (execution_direction == EXEC_REVERSE)
 		    {
-		      if (record_full_list->prev)
-			record_full_list = record_full_list->prev;
+		      if (record_full_prev (record_full_list))
+			record_full_list = record_full_prev (record_full_list);
 		    }
 		  else
 		    {
-		      if (record_full_list->next)
-			record_full_list = record_full_list->next;
+		      if (record_full_next (record_full_list))
+			record_full_list = record_full_next (record_full_list);
 		    }
 		}
 	    }
 	  while (continue_flag);
 
 	replay_out:
+	  struct record_full_entry rec;
+
+	  record_full_read_entry (record_full_list, &rec);
 	  if (record_full_get_sig)
 	    status->value.sig = GDB_SIGNAL_INT;
-	  else if (record_full_list->u.end.sigval != GDB_SIGNAL_0)
+	  else if (rec.type == record_full_end
+		   && rec.u.end.sigval != GDB_SIGNAL_0)
 	    /* FIXME: better way to check */
-	    status->value.sig = record_full_list->u.end.sigval;
+	    status->value.sig = rec.u.end.sigval;
 	  else
 	    status->value.sig = GDB_SIGNAL_TRAP;
 	}
@@ -1447,11 +2001,11 @@ record_full_wait_1 (struct target_ops *ops,
 	{
 	  if (execution_direction == EXEC_REVERSE)
 	    {
-	      if (record_full_list->next)
-		record_full_list = record_full_list->next;
+	      if (record_full_next (record_full_list))
+		record_full_list = record_full_next (record_full_list);
 	    }
 	  else
-	    record_full_list = record_full_list->prev;
+	    record_full_list = record_full_prev (record_full_list);
 
 	  throw_exception (ex);
 	}
@@ -1540,8 +2094,7 @@ record_full_registers_change (struct regcache *regcache, int regnum)
   /* Check record_full_insn_num.  */
   record_full_check_insn_num ();
 
-  record_full_arch_list_head = NULL;
-  record_full_arch_list_tail = NULL;
+  record_full_arch_list_release ();
 
   if (regnum < 0)
     {
@@ -1551,7 +2104,7 @@ record_full_registers_change (struct regcache *regcache, int regnum)
 	{
 	  if (record_full_arch_list_add_reg (regcache, i))
 	    {
-	      record_full_list_release (record_full_arch_list_tail);
+	      record_full_arch_list_release ();
 	      error (_("Process record: failed to record execution log."));
 	    }
 	}
@@ -1560,18 +2113,16 @@ record_full_registers_change (struct regcache *regcache, int regnum)
     {
       if (record_full_arch_list_add_reg (regcache, regnum))
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_release ();
 	  error (_("Process record: failed to record execution log."));
 	}
     }
   if (record_full_arch_list_add_end ())
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_release ();
       error (_("Process record: failed to record execution log."));
     }
-  record_full_list->next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = record_full_list;
-  record_full_list = record_full_arch_list_tail;
+  record_full_arch_list_commit ();
 
   if (record_full_insn_num == record_full_insn_max_num)
     record_full_list_release_first ();
@@ -1665,11 +2216,10 @@ record_full_target::xfer_partial (enum target_object object,
       record_full_check_insn_num ();
 
       /* Record registers change to list as an instruction.  */
-      record_full_arch_list_head = NULL;
-      record_full_arch_list_tail = NULL;
+      record_full_arch_list_release ();
       if (record_full_arch_list_add_mem (offset, len))
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_release ();
 	  if (record_debug)
 	    fprintf_unfiltered (gdb_stdlog,
 				"Process record: failed to record "
@@ -1678,16 +2228,14 @@ record_full_target::xfer_partial (enum target_object object,
 	}
       if (record_full_arch_list_add_end ())
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_release ();
 	  if (record_debug)
 	    fprintf_unfiltered (gdb_stdlog,
 				"Process record: failed to record "
 				"execution log.");
 	  return TARGET_XFER_E_IO;
 	}
-      record_full_list->next = record_full_arch_list_head;
-      record_full_arch_list_head->prev = record_full_list;
-      record_full_list = record_full_arch_list_tail;
+      record_full_arch_list_commit ();
 
       if (record_full_insn_num == record_full_insn_max_num)
 	record_full_list_release_first ();
@@ -1852,11 +2400,13 @@ record_full_base_target::can_execute_reverse ()
 gdb_byte *
 record_full_base_target::get_bookmark (const char *args, int from_tty)
 {
+  struct record_full_entry rec;
   char *ret = NULL;
 
   /* Return stringified form of instruction count.  */
-  if (record_full_list && record_full_list->type == record_full_end)
-    ret = xstrdup (pulongest (record_full_list->u.end.insn_num));
+  record_full_read_entry (record_full_list, &rec);
+  if (rec.type == record_full_end)
+    ret = xstrdup (pulongest (rec.u.end.insn_num));
 
   if (record_debug)
     {
@@ -1912,7 +2462,8 @@ record_full_base_target::record_method (ptid_t ptid)
 void
 record_full_base_target::info_record ()
 {
-  struct record_full_entry *p;
+  struct record_full_entry rec;
+  record_full_pos p;
 
   if (RECORD_FULL_IS_REPLAY)
     printf_filtered (_("Replay mode:\n"));
@@ -1920,22 +2471,28 @@ record_full_base_target::info_record ()
     printf_filtered (_("Record mode:\n"));
 
   /* Find entry for first actual instruction in the log.  */
-  for (p = record_full_first.next;
-       p != NULL && p->type != record_full_end;
-       p = p->next)
-    ;
+  for (p = record_full_next (record_full_first); p != 0;
+       p = record_full_next (p))
+    {
+      record_full_read_entry (p, &rec);
+      if (rec.type == record_full_end)
+	break;
+    }
 
   /* Do we have a log at all?  */
-  if (p != NULL && p->type == record_full_end)
+  if (p != 0)
     {
       /* Display instruction number for first instruction in the log.  */
       printf_filtered (_("Lowest recorded instruction number is %s.\n"),
-		       pulongest (p->u.end.insn_num));
+		       pulongest (rec.u.end.insn_num));
 
       /* If in replay mode, display where we are in the log.  */
       if (RECORD_FULL_IS_REPLAY)
-	printf_filtered (_("Current instruction number is %s.\n"),
-			 pulongest (record_full_list->u.end.insn_num));
+	{
+	  record_full_read_entry (record_full_list, &rec);
+	  printf_filtered (_("Current instruction number is %s.\n"),
+			   pulongest (rec.u.end.insn_num));
+	}
 
       /* Display instruction number for last instruction in the log.  */
       printf_filtered (_("Highest recorded instruction number is %s.\n"),
@@ -1990,22 +2547,27 @@ record_full_base_target::record_will_replay (ptid_t ptid, int dir)
 /* Go to a specific entry.  */
 
 static void
-record_full_goto_entry (struct record_full_entry *p)
+record_full_goto_entry (record_full_pos p)
 {
-  if (p == NULL)
+  struct record_full_entry rec, cur;
+
+  if (p == 0)
     error (_("Target insn not found."));
   else if (p == record_full_list)
     error (_("Already at target insn."));
-  else if (p->u.end.insn_num > record_full_list->u.end.insn_num)
+
+  record_full_read_entry (p, &rec);
+  record_full_read_entry (record_full_list, &cur);
+  if (rec.u.end.insn_num > cur.u.end.insn_num)
     {
       printf_filtered (_("Go forward to insn number %s\n"),
-		       pulongest (p->u.end.insn_num));
+		       pulongest (rec.u.end.insn_num));
       record_full_goto_insn (p, EXEC_FORWARD);
     }
   else
     {
       printf_filtered (_("Go backward to insn number %s\n"),
-		       pulongest (p->u.end.insn_num));
+		       pulongest (rec.u.end.insn_num));
       record_full_goto_insn (p, EXEC_REVERSE);
     }
 
@@ -2021,11 +2583,15 @@ record_full_goto_entry (struct record_full_entry *p)
 void
 record_full_base_target::goto_record_begin ()
 {
-  struct record_full_entry *p = NULL;
+  struct record_full_entry rec;
+  record_full_pos p;
 
-  for (p = &record_full_first; p != NULL; p = p->next)
-    if (p->type == record_full_end)
-      break;
+  for (p = record_full_first; p != 0; p = record_full_next (p))
+    {
+      record_full_read_entry (p, &rec);
+      if (rec.type == record_full_end)
+	break;
+    }
 
   record_full_goto_entry (p);
 }
@@ -2035,13 +2601,15 @@ record_full_base_target::goto_record_begin ()
 void
 record_full_base_target::goto_record_end ()
 {
-  struct record_full_entry *p = NULL;
+  struct record_full_entry rec;
+  record_full_pos p;
 
-  for (p = record_full_list; p->next != NULL; p = p->next)
-    ;
-  for (; p!= NULL; p = p->prev)
-    if (p->type == record_full_end)
-      break;
+  for (p = record_full_last (); p != 0; p = record_full_prev (p))
+    {
+      record_full_read_entry (p, &rec);
+      if (rec.type == record_full_end)
+	break;
+    }
 
   record_full_goto_entry (p);
 }
@@ -2051,11 +2619,34 @@ record_full_base_target::goto_record_end ()
 void
 record_full_base_target::goto_record (ULONGEST target_insn)
 {
-  struct record_full_entry *p = NULL;
+  struct record_full_entry rec;
+  record_full_pos p = 0;
 
-  for (p = &record_full_first; p != NULL; p = p->next)
-    if (p->type == record_full_end && p->u.end.insn_num == target_insn)
-      break;
+  /* Only look in the chunk where instruction TARGET_INSN ends.  */
+  auto it = std::lower_bound (record_full_chunks.begin (),
+			      record_full_chunks.end (), target_insn,
+			      [] (const struct record_full_chunk &chunk,
+				  ULONGEST insn)
+			      {
+				return chunk.last_insn < insn;
+			      });
+
+  if (it != record_full_chunks.end () && record_full_start_pos != 0)
+    {
+      ULONGEST seq = record_full_chunks_seq + (it - record_full_chunks.begin ());
+
+      for (p = std::max (RECORD_FULL_POS (seq, 0), record_full_start_pos);
+	   p != 0 && RECORD_FULL_POS_SEQ (p) == seq;
+	   p = record_full_next (p))
+	{
+	  record_full_read_entry (p, &rec);
+	  if (rec.type == record_full_end
+	      && rec.u.end.insn_num == target_insn)
+	    break;
+	}
+      if (p != 0 && RECORD_FULL_POS_SEQ (p) != seq)
+	p = 0;
+    }
 
   record_full_goto_entry (p);
 }
@@ -2294,20 +2885,37 @@ record_full_core_target::has_execution (ptid_t the_ptid)
        8 bytes: memory address (network byte order).
        n bytes: memory value (n == memory length).
 
+   Version 3
+     4 bytes: magic number netorder32(0x20181018).
+       NOTE: be sure to change whenever this file format changes!
+     4 bytes: number of chunks (network byte order).
+     8 bytes: number of instructions (network byte order).
+
+   Index, for each chunk (network byte order):
+     8 bytes: offset of the chunk in the section.
+     8 bytes: size of the chunk.
+     8 bytes: number of the last instruction that ends in the chunk
+              or in an earlier one, or zero.
+
+   Chunks:
+     The entries, encoded as in memory (see struct record_full_entry),
+     each holding the value that executing it forward brings in.
+
 */
 
 /* bfdcore_read -- read bytes from a core file section.  */
 
 static inline void
-bfdcore_read (bfd *obfd, asection *osec, void *buf, int len, int *offset)
+bfdcore_read (bfd *obfd, asection *osec, void *buf, bfd_size_type len,
+	      file_ptr *offset)
 {
   int ret = bfd_get_section_contents (obfd, osec, buf, *offset, len);
 
   if (ret)
     *offset += len;
   else
-    error (_("Failed to read %d bytes from core file %s ('%s')."),
-	   len, bfd_get_filename (obfd),
+    error (_("Failed to read %s bytes from core file %s ('%s')."),
+	   pulongest (len), bfd_get_filename (obfd),
 	   bfd_errmsg (bfd_get_error ()));
 }
 
@@ -2331,54 +2939,19 @@ netorder32 (uint32_t input)
   return ret;
 }
 
-/* Restore the execution log from a core_bfd file.  */
+/* Restore the entries of a version 2 execution log from OSEC, a
+   section of core_bfd, starting at *BFD_OFFSET.  */
+
 static void
-record_full_restore (void)
+record_full_restore_entries (asection *osec, file_ptr *bfd_offset)
 {
-  uint32_t magic;
-  struct record_full_entry *rec;
-  asection *osec;
-  uint32_t osec_size;
-  int bfd_offset = 0;
+  struct record_full_entry rec;
+  bfd_size_type osec_size = bfd_section_size (core_bfd, osec);
   struct regcache *regcache;
 
-  /* We restore the execution log from the open core bfd,
-     if there is one.  */
-  if (core_bfd == NULL)
-    return;
-
-  /* "record_full_restore" can only be called when record list is empty.  */
-  gdb_assert (record_full_first.next == NULL);
- 
-  if (record_debug)
-    fprintf_unfiltered (gdb_stdlog, "Restoring recording from core file.\n");
-
-  /* Now need to find our special note section.  */
-  osec = bfd_get_section_by_name (core_bfd, "null0");
-  if (record_debug)
-    fprintf_unfiltered (gdb_stdlog, "Find precord section %s.\n",
-			osec ? "succeeded" : "failed");
-  if (osec == NULL)
-    return;
-  osec_size = bfd_section_size (core_bfd, osec);
-  if (record_debug)
-    fprintf_unfiltered (gdb_stdlog, "%s", bfd_section_name (core_bfd, osec));
-
-  /* Check the magic code.  */
-  bfdcore_read (core_bfd, osec, &magic, sizeof (magic), &bfd_offset);
-  if (magic != RECORD_FULL_FILE_MAGIC)
-    error (_("Version mis-match or file format error in core file %s."),
-	   bfd_get_filename (core_bfd));
-  if (record_debug)
-    fprintf_unfiltered (gdb_stdlog,
-			"  Reading 4-byte magic cookie "
-			"RECORD_FULL_FILE_MAGIC (0x%s)\n",
-			phex_nz (netorder32 (magic), 4));
-
   /* Restore the entries in recfd into record_full_arch_list_head and
      record_full_arch_list_tail.  */
-  record_full_arch_list_head = NULL;
-  record_full_arch_list_tail = NULL;
+  record_full_arch_list_release ();
   record_full_insn_num = 0;
 
   TRY
@@ -2392,77 +2965,84 @@ record_full_restore (void)
 	  uint64_t addr;
 
 	  /* We are finished when offset reaches osec_size.  */
-	  if (bfd_offset >= osec_size)
+	  if (*bfd_offset >= osec_size)
 	    break;
-	  bfdcore_read (core_bfd, osec, &rectype, sizeof (rectype), &bfd_offset);
+	  bfdcore_read (core_bfd, osec, &rectype, sizeof (rectype), bfd_offset);
 
 	  switch (rectype)
 	    {
 	    case record_full_reg: /* reg */
 	      /* Get register number to regnum.  */
 	      bfdcore_read (core_bfd, osec, &regnum,
-			    sizeof (regnum), &bfd_offset);
+			    sizeof (regnum), bfd_offset);
 	      regnum = netorder32 (regnum);
 
-	      rec = record_full_reg_alloc (regcache, regnum);
+	      rec.type = record_full_reg;
+	      rec.u.reg.num = regnum;
+	      rec.u.reg.len = register_size (regcache->arch (), regnum);
+	      rec.u.reg.delta = 0;
 
 	      /* Get val.  */
-	      bfdcore_read (core_bfd, osec, record_full_get_loc (rec),
-			    rec->u.reg.len, &bfd_offset);
+	      bfdcore_read (core_bfd, osec, record_full_arch_list_add (&rec),
+			    rec.u.reg.len, bfd_offset);
 
 	      if (record_debug)
 		fprintf_unfiltered (gdb_stdlog,
 				    "  Reading register %d (1 "
 				    "plus %lu plus %d bytes)\n",
-				    rec->u.reg.num,
+				    rec.u.reg.num,
 				    (unsigned long) sizeof (regnum),
-				    rec->u.reg.len);
+				    rec.u.reg.len);
 	      break;
 
 	    case record_full_mem: /* mem */
 	      /* Get len.  */
 	      bfdcore_read (core_bfd, osec, &len,
-			    sizeof (len), &bfd_offset);
+			    sizeof (len), bfd_offset);
 	      len = netorder32 (len);
 
 	      /* Get addr.  */
 	      bfdcore_read (core_bfd, osec, &addr,
-			    sizeof (addr), &bfd_offset);
+			    sizeof (addr), bfd_offset);
 	      addr = netorder64 (addr);
 
-	      rec = record_full_mem_alloc (addr, len);
+	      rec.type = record_full_mem;
+	      rec.u.mem.addr = addr;
+	      rec.u.mem.len = len;
+	      rec.u.mem.mem_entry_not_accessible = 0;
 
 	      /* Get val.  */
-	      bfdcore_read (core_bfd, osec, record_full_get_loc (rec),
-			    rec->u.mem.len, &bfd_offset);
+	      bfdcore_read (core_bfd, osec, record_full_arch_list_add (&rec),
+			    rec.u.mem.len, bfd_offset);
 
 	      if (record_debug)
 		fprintf_unfiltered (gdb_stdlog,
 				    "  Reading memory %s (1 plus "
 				    "%lu plus %lu plus %d bytes)\n",
 				    paddress (get_current_arch (),
-					      rec->u.mem.addr),
+					      rec.u.mem.addr),
 				    (unsigned long) sizeof (addr),
 				    (unsigned long) sizeof (len),
-				    rec->u.mem.len);
+				    rec.u.mem.len);
 	      break;
 
 	    case record_full_end: /* end */
-	      rec = record_full_end_alloc ();
+	      rec.type = record_full_end;
 	      record_full_insn_num ++;
 
 	      /* Get signal value.  */
 	      bfdcore_read (core_bfd, osec, &signal,
-			    sizeof (signal), &bfd_offset);
+			    sizeof (signal), bfd_offset);
 	      signal = netorder32 (signal);
-	      rec->u.end.sigval = (enum gdb_signal) signal;
+	      rec.u.end.sigval = (enum gdb_signal) signal;
 
 	      /* Get insn count.  */
 	      bfdcore_read (core_bfd, osec, &count,
-			    sizeof (count), &bfd_offset);
+			    sizeof (count), bfd_offset);
 	      count = netorder32 (count);
-	      rec->u.end.insn_num = count;
+	      rec.u.end.insn_num = count;
 	      record_full_insn_count = count + 1;
+	      record_full_arch_list_add (&rec);
 	      if (record_debug)
 		fprintf_unfiltered (gdb_stdlog,
 				    "  Reading record_full_end (1 + "
@@ -2470,7 +3050,7 @@ record_full_restore (void)
 				    (unsigned long) sizeof (signal),
 				    (unsigned long) sizeof (count),
 				    paddress (get_current_arch (),
-					      bfd_offset));
+					      *bfd_offset));
 	      break;
 
 	    default:
@@ -2478,24 +3058,281 @@ record_full_restore (void)
 		     bfd_get_filename (core_bfd));
 	      break;
 	    }
-
-	  /* Add rec to record arch list.  */
-	  record_full_arch_list_add (rec);
 	}
     }
   CATCH (ex, RETURN_MASK_ALL)
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_release ();
       throw_exception (ex);
     }
   END_CATCH
 
   /* Add record_full_arch_list_head to the end of record list.  */
-  record_full_first.next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = &record_full_first;
-  record_full_arch_list_tail->next = NULL;
-  record_full_list = &record_full_first;
+  if (record_full_arch_list_tail != 0)
+    record_full_arch_list_commit ();
+}
+
+/* Decode the ULEB128 number at BUF into *VAL, like record_full_read_uleb,
+   but return NULL if it does not end before END or does not fit.  */
+
+static const gdb_byte *
+record_full_read_uleb_checked (const gdb_byte *buf, const gdb_byte *end,
+			       ULONGEST *val)
+{
+  ULONGEST result = 0;
+  int shift = 0;
+  gdb_byte byte;
+
+  do
+    {
+      if (buf == end || shift >= 64)
+	return NULL;
+      byte = *buf++;
+      result |= (ULONGEST) (byte & 0x7f) << shift;
+      shift += 7;
+    }
+  while (byte & 0x80);
+
+  *val = result;
+  return buf;
+}
+
+/* Check that the LEN bytes at BUF, a chunk restored from a save file,
+   hold a sequence of well-formed entries for GDBARCH, so that
+   record_full_read_entry and record_full_exec_insn can trust them.
+   Throw an error if they do not.  */
+
+static void
+record_full_check_chunk (struct gdbarch *gdbarch, const gdb_byte *buf,
+			 size_t len)
+{
+  const gdb_byte *end = buf + len;
+
+  while (buf < end)
+    {
+      const gdb_byte *tag = buf++;
+      ULONGEST num, size, start, val_len = 0;
+      size_t body;
+
+      switch (*tag & RECORD_FULL_TAG_TYPE)
+	{
+	case record_full_end:
+	  if (buf == end || *buf >= GDB_SIGNAL_LAST)
+	    goto bad;
+	  buf = record_full_read_uleb_checked (buf + 1, end, &num);
+	  break;
+
+	case record_full_reg:
+	  buf = record_full_read_uleb_checked (buf, end, &num);
+	  if (buf == NULL || num >= gdbarch_num_regs (gdbarch))
+	    goto bad;
+	  buf = record_full_read_uleb_checked (buf, end, &size);
+	  if (buf == NULL || size != register_size (gdbarch, num))
+	    goto bad;
+	  val_len = size;
+	  if ((*tag & RECORD_FULL_TAG_DELTA) != 0)
+	    {
+	      buf = record_full_read_uleb_checked (buf, end, &start);
+	      if (buf == NULL)
+		goto bad;
+	      buf = record_full_read_uleb_checked (buf, end, &val_len);
+	      if (buf == NULL || start > size || val_len > size - start)
+		goto bad;
+	    }
+	  break;
+
+	case record_full_mem:
+	  buf = record_full_read_uleb_checked (buf, end, &num);
+	  if (buf == NULL)
+	    goto bad;
+	  buf = record_full_read_uleb_checked (buf, end, &val_len);
+	  if (buf == NULL || val_len > INT_MAX)
+	    goto bad;
+	  break;
+
+	default:
+	  goto bad;
+	}
+
+      if (buf == NULL || val_len > (size_t) (end - buf))
+	goto bad;
+      body = buf + val_len - tag;
+      size = record_full_entry_size (body);
+      if (size > (size_t) (end - tag))
+	goto bad;
+      buf = tag + size;
+      if (record_full_size_before (buf) != size)
+	goto bad;
+    }
+  return;
+
+ bad:
+  error (_("Bad execution log in core file %s."),
+	 bfd_get_filename (core_bfd));
+}
+
+/* Restore the chunks of a version 3 execution log from OSEC, a section
+   of core_bfd, starting at *BFD_OFFSET.  The chunks are mapped from
+   the file when possible, so that only the parts of the log that are
+   replayed get read.  Only the index is checked here; the entries of
+   each chunk are checked when it is first used.  */
+
+static void
+record_full_restore_chunks (asection *osec, file_ptr *bfd_offset)
+{
+  bfd_size_type osec_size = bfd_section_size (core_bfd, osec);
+  uint32_t nchunks, i;
+  uint64_t insn_num;
+  gdb_byte *data = NULL;
+
+  bfdcore_read (core_bfd, osec, &nchunks, sizeof (nchunks), bfd_offset);
+  nchunks = netorder32 (nchunks);
+  bfdcore_read (core_bfd, osec, &insn_num, sizeof (insn_num), bfd_offset);
+  insn_num = netorder64 (insn_num);
+
+  if (nchunks > (osec_size - *bfd_offset) / (8 + 8 + 8))
+    error (_("Bad execution log index in core file %s."),
+	   bfd_get_filename (core_bfd));
+
+  /* Read and check the index.  Each entry holds the offset of a chunk
+     in the section, its size, and the number of the last instruction
+     that ends in it or before it.  */
+  std::vector<uint64_t> index (nchunks * 3);
+
+  bfdcore_read (core_bfd, osec, index.data (),
+		index.size () * sizeof (uint64_t), bfd_offset);
+  for (i = 0; i < index.size (); i++)
+    index[i] = netorder64 (index[i]);
+  for (i = 0; i < nchunks; i++)
+    {
+      uint64_t offset = index[3 * i], size = index[3 * i + 1];
+      uint64_t prev_end = (i == 0 ? *bfd_offset
+			   : index[3 * i - 3] + index[3 * i - 2]);
+
+      if (offset != prev_end || size == 0 || size > 0xffffffff
+	  || size > osec_size - offset
+	  || (i > 0 && index[3 * i + 2] < index[3 * i - 1]))
+	error (_("Bad execution log index in core file %s."),
+	       bfd_get_filename (core_bfd));
+    }
+
+  if (nchunks == 0)
+    {
+      record_full_insn_num = 0;
+      return;
+    }
+
+#ifdef HAVE_MMAP
+  /* The log is only written to by executing its entries, and those
+     changes must not reach the file.  */
+  {
+    bfd_size_type len = (index[3 * nchunks - 3] + index[3 * nchunks - 2]
+			 - index[0]);
+    void *map_addr;
+    bfd_size_type map_len;
+
+    data = (gdb_byte *) bfd_mmap (core_bfd, 0, len, PROT_READ | PROT_WRITE,
+				  MAP_PRIVATE, osec->filepos + index[0],
+				  &map_addr, &map_len);
+    if (data == (gdb_byte *) MAP_FAILED)
+      data = NULL;
+    else
+      {
+	record_full_map = map_addr;
+	record_full_map_len = map_len;
+	record_full_map_chunks = nchunks;
+      }
+  }
+#endif
+
+  record_full_restore_gdbarch = get_current_regcache ()->arch ();
+
+  TRY
+    {
+      for (i = 0; i < nchunks; i++)
+	{
+	  struct record_full_chunk chunk;
+	  file_ptr offset = index[3 * i];
+
+	  chunk.size = index[3 * i + 1];
+	  chunk.used = chunk.size;
+	  chunk.last_insn = index[3 * i + 2];
+	  chunk.mapped = data != NULL;
+	  chunk.checked = false;
+	  if (chunk.mapped)
+	    chunk.data = data + (offset - index[0]);
+	  else
+	    chunk.data = (gdb_byte *) xmalloc (chunk.size);
+	  record_full_chunks.push_back (chunk);
+
+	  if (!chunk.mapped)
+	    bfdcore_read (core_bfd, osec, chunk.data, chunk.size, &offset);
+	}
+    }
+  CATCH (ex, RETURN_MASK_ALL)
+    {
+      record_full_list_release ();
+      throw_exception (ex);
+    }
+  END_CATCH
+
+  if (record_debug)
+    fprintf_unfiltered (gdb_stdlog,
+			"  Restored %s chunks (%s)\n", pulongest (nchunks),
+			data != NULL ? "mapped" : "read");
+
+  record_full_start_pos = RECORD_FULL_POS (record_full_chunks_seq, 0);
+  record_full_end_pos = RECORD_FULL_POS (record_full_chunks_seq + nchunks - 1,
+					 index[3 * nchunks - 2]);
+  record_full_insn_num = insn_num;
+  record_full_insn_count = index[3 * nchunks - 1] + 1;
+}
+
+/* Restore the execution log from a core_bfd file.  */
+static void
+record_full_restore (void)
+{
+  uint32_t magic;
+  asection *osec;
+  file_ptr bfd_offset = 0;
+
+  /* We restore the execution log from the open core bfd,
+     if there is one.  */
+  if (core_bfd == NULL)
+    return;
+
+  /* "record_full_restore" can only be called when record list is empty.  */
+  gdb_assert (record_full_start_pos == 0);
+ 
+  if (record_debug)
+    fprintf_unfiltered (gdb_stdlog, "Restoring recording from core file.\n");
+
+  /* Now need to find our special note section.  */
+  osec = bfd_get_section_by_name (core_bfd, "null0");
+  if (record_debug)
+    fprintf_unfiltered (gdb_stdlog, "Find precord section %s.\n",
+			osec ? "succeeded" : "failed");
+  if (osec == NULL)
+    return;
+  if (record_debug)
+    fprintf_unfiltered (gdb_stdlog, "%s", bfd_section_name (core_bfd, osec));
+
+  /* Check the magic code.  */
+  bfdcore_read (core_bfd, osec, &magic, sizeof (magic), &bfd_offset);
+  if (magic != RECORD_FULL_FILE_MAGIC && magic != RECORD_FULL_FILE_MAGIC_V2)
+    error (_("Version mis-match or file format error in core file %s."),
+	   bfd_get_filename (core_bfd));
+  if (record_debug)
+    fprintf_unfiltered (gdb_stdlog,
+			"  Reading 4-byte magic cookie "
+			"RECORD_FULL_FILE_MAGIC (0x%s)\n",
+			phex_nz (netorder32 (magic), 4));
 
+  if (magic == RECORD_FULL_FILE_MAGIC)
+    record_full_restore_chunks (osec, &bfd_offset);
+  else
+    record_full_restore_entries (osec, &bfd_offset);
+  record_full_list = record_full_first;
   /* Update record_full_insn_max_num.  */
   if (record_full_insn_num > record_full_insn_max_num)
     {
@@ -2514,18 +3351,76 @@ record_full_restore (void)
 /* bfdcore_write -- write bytes into a core file section.  */
 
 static inline void
-bfdcore_write (bfd *obfd, asection *osec, void *buf, int len, int *offset)
+bfdcore_write (bfd *obfd, asection *osec, void *buf, bfd_size_type len,
+	       file_ptr *offset)
 {
   int ret = bfd_set_section_contents (obfd, osec, buf, *offset, len);
 
   if (ret)
     *offset += len;
   else
-    error (_("Failed to write %d bytes to core file %s ('%s')."),
-	   len, bfd_get_filename (obfd),
+    error (_("Failed to write %s bytes to core file %s ('%s')."),
+	   pulongest (len), bfd_get_filename (obfd),
 	   bfd_errmsg (bfd_get_error ()));
 }
 
+/* Return the current value of register NUM while saving the execution
+   log, from REGS, or from REGCACHE the first time.  */
+
+static gdb::byte_vector &
+record_full_save_reg (struct regcache *regcache,
+		      std::vector<gdb::byte_vector> &regs, int num)
+{
+  if (num >= regs.size ())
+    regs.resize (num + 1);
+  if (regs[num].empty ())
+    {
+      regs[num].resize (register_size (regcache->arch (), num));
+      regcache->cooked_read (num, regs[num].data ());
+    }
+  return regs[num];
+}
+
+/* Execute the entry REC while saving the execution log.  Registers
+   are only changed in REGS: saving walks the whole log and comes back,
+   so writing each of them to the inferior would be wasted.  */
+
+static void
+record_full_save_exec (struct regcache *regcache, struct gdbarch *gdbarch,
+		       struct record_full_entry *rec,
+		       std::vector<gdb::byte_vector> &regs)
+{
+  if (rec->type != record_full_reg)
+    {
+      record_full_exec_insn (regcache, gdbarch, rec);
+      return;
+    }
+
+  gdb::byte_vector &reg = record_full_save_reg (regcache, regs,
+						rec->u.reg.num);
+  int i;
+
+  if (rec->u.reg.delta)
+    for (i = 0; i < rec->u.reg.xor_len; i++)
+      reg[rec->u.reg.xor_start + i] ^= rec->val[i];
+  else
+    std::swap_ranges (reg.begin (), reg.end (), rec->val);
+}
+
+/* Write the registers in REGS that saving the execution log has
+   changed to REGCACHE.  */
+
+static void
+record_full_save_sync_regs (struct regcache *regcache,
+			    std::vector<gdb::byte_vector> &regs)
+{
+  int num;
+
+  for (num = 0; num < regs.size (); num++)
+    if (!regs[num].empty ())
+      regcache->cooked_write (num, regs[num].data ());
+}
+
 /* Restore the execution log from a file.  We use a modified elf
    corefile format, with an extra section for our data.  */
 
@@ -2536,19 +3431,43 @@ cmd_record_full_restore (const char *args, int from_tty)
   record_full_open (args, from_tty);
 }
 
+/* Return the number of bytes of chunk number SEQ that hold entries of
+   the execution log, and if DATA is not NULL, set *DATA to the first
+   of them.  */
+
+static size_t
+record_full_save_chunk_size (ULONGEST seq, gdb_byte **data)
+{
+  const struct record_full_chunk &chunk
+    = record_full_chunks[seq - record_full_chunks_seq];
+  size_t start = 0, end = chunk.used;
+
+  if (seq == RECORD_FULL_POS_SEQ (record_full_start_pos))
+    start = RECORD_FULL_POS_OFFSET (record_full_start_pos);
+  if (seq == RECORD_FULL_POS_SEQ (record_full_end_pos))
+    end = RECORD_FULL_POS_OFFSET (record_full_end_pos);
+
+  if (data != NULL)
+    *data = chunk.data + start;
+  return end - start;
+}
+
 /* Save the execution log to a file.  We use a modified elf corefile
    format, with an extra section for our data.  */
 
 void
 record_full_base_target::save_record (const char *recfilename)
 {
-  struct record_full_entry *cur_record_full_list;
-  uint32_t magic;
+  record_full_pos cur_record_full_list;
+  struct record_full_entry rec;
+  uint32_t magic, nchunks;
+  uint64_t insn_num;
   struct regcache *regcache;
   struct gdbarch *gdbarch;
-  int save_size = 0;
+  bfd_size_type save_size, offset;
+  file_ptr bfd_offset = 0;
   asection *osec = NULL;
-  int bfd_offset = 0;
+  ULONGEST seq, first_seq = 0, last_seq = 0;
 
   /* Open the save file.  */
   if (record_debug)
@@ -2567,40 +3486,41 @@ record_full_base_target::save_record (const char *recfilename)
   /* Get the values of regcache and gdbarch.  */
   regcache = get_current_regcache ();
   gdbarch = regcache->arch ();
+  std::vector<gdb::byte_vector> regs (gdbarch_num_regs (gdbarch));
 
   /* Disable the GDB operation record.  */
   scoped_restore restore_operation_disable
     = record_full_gdb_operation_disable_set ();
 
-  /* Reverse execute to the begin of record list.  */
+  /* Reverse execute to the begin of record list.  Then every entry
+     holds the value that executing it forward brings in, which is what
+     the file stores.  */
   while (1)
     {
       /* Check for beginning and end of log.  */
-      if (record_full_list == &record_full_first)
+      if (record_full_list == record_full_first)
         break;
 
-      record_full_exec_insn (regcache, gdbarch, record_full_list);
+      record_full_read_entry (record_full_list, &rec);
+      record_full_save_exec (regcache, gdbarch, &rec, regs);
 
-      if (record_full_list->prev)
-        record_full_list = record_full_list->prev;
+      if (record_full_prev (record_full_list))
+        record_full_list = record_full_prev (record_full_list);
     }
 
-  /* Compute the size needed for the extra bfd section.  */
-  save_size = 4;	/* magic cookie */
-  for (record_full_list = record_full_first.next; record_full_list;
-       record_full_list = record_full_list->next)
-    switch (record_full_list->type)
-      {
-      case record_full_end:
-	save_size += 1 + 4 + 4;
-	break;
-      case record_full_reg:
-	save_size += 1 + 4 + record_full_list->u.reg.len;
-	break;
-      case record_full_mem:
-	save_size += 1 + 4 + 8 + record_full_list->u.mem.len;
-	break;
-      }
+  /* Compute the size needed for the extra bfd section: the header, the
+     index and the chunks that hold the log.  */
+  if (record_full_start_pos != 0)
+    {
+      first_seq = RECORD_FULL_POS_SEQ (record_full_start_pos);
+      last_seq = RECORD_FULL_POS_SEQ (record_full_end_pos);
+      if (RECORD_FULL_POS_OFFSET (record_full_end_pos) == 0)
+	last_seq--;
+    }
+  nchunks = record_full_start_pos != 0 ? last_seq - first_seq + 1 : 0;
+  save_size = 4 + 4 + 8 + nchunks * (8 + 8 + 8);
+  for (seq = first_seq; nchunks != 0 && seq <= last_seq; seq++)
+    save_size += record_full_save_chunk_size (seq, NULL);
 
   /* Make the new bfd section.  */
   osec = bfd_make_section_anyway_with_flags (obfd.get (), "precord",
@@ -2616,6 +3536,7 @@ record_full_base_target::save_record (const char *recfilename)
   bfd_section_lma (obfd.get (), osec) = 0;
 
   /* Save corefile state.  */
+  record_full_save_sync_regs (regcache, regs);
   write_gcore_file (obfd.get ());
 
   /* Write out the record log.  */
@@ -2628,111 +3549,49 @@ record_full_base_target::save_record (const char *recfilename)
 		      phex_nz (magic, 4));
   bfdcore_write (obfd.get (), osec, &magic, sizeof (magic), &bfd_offset);
 
-  /* Save the entries to recfd and forward execute to the end of
-     record list.  */
-  record_full_list = &record_full_first;
-  while (1)
-    {
-      /* Save entry.  */
-      if (record_full_list != &record_full_first)
-        {
-	  uint8_t type;
-	  uint32_t regnum, len, signal, count;
-          uint64_t addr;
-
-	  type = record_full_list->type;
-          bfdcore_write (obfd.get (), osec, &type, sizeof (type), &bfd_offset);
-
-          switch (record_full_list->type)
-            {
-            case record_full_reg: /* reg */
-	      if (record_debug)
-		fprintf_unfiltered (gdb_stdlog,
-				    "  Writing register %d (1 "
-				    "plus %lu plus %d bytes)\n",
-				    record_full_list->u.reg.num,
-				    (unsigned long) sizeof (regnum),
-				    record_full_list->u.reg.len);
-
-              /* Write regnum.  */
-              regnum = netorder32 (record_full_list->u.reg.num);
-              bfdcore_write (obfd.get (), osec, &regnum,
-			     sizeof (regnum), &bfd_offset);
-
-              /* Write regval.  */
-              bfdcore_write (obfd.get (), osec,
-			     record_full_get_loc (record_full_list),
-			     record_full_list->u.reg.len, &bfd_offset);
-              break;
-
-            case record_full_mem: /* mem */
-	      if (record_debug)
-		fprintf_unfiltered (gdb_stdlog,
-				    "  Writing memory %s (1 plus "
-				    "%lu plus %lu plus %d bytes)\n",
-				    paddress (gdbarch,
-					      record_full_list->u.mem.addr),
-				    (unsigned long) sizeof (addr),
-				    (unsigned long) sizeof (len),
-				    record_full_list->u.mem.len);
-
-	      /* Write memlen.  */
-	      len = netorder32 (record_full_list->u.mem.len);
-	      bfdcore_write (obfd.get (), osec, &len, sizeof (len),
-			     &bfd_offset);
-
-	      /* Write memaddr.  */
-	      addr = netorder64 (record_full_list->u.mem.addr);
-	      bfdcore_write (obfd.get (), osec, &addr, 
-			     sizeof (addr), &bfd_offset);
-
-	      /* Write memval.  */
-	      bfdcore_write (obfd.get (), osec,
-			     record_full_get_loc (record_full_list),
-			     record_full_list->u.mem.len, &bfd_offset);
-              break;
-
-              case record_full_end:
-		if (record_debug)
-		  fprintf_unfiltered (gdb_stdlog,
-				      "  Writing record_full_end (1 + "
-				      "%lu + %lu bytes)\n", 
-				      (unsigned long) sizeof (signal),
-				      (unsigned long) sizeof (count));
-		/* Write signal value.  */
-		signal = netorder32 (record_full_list->u.end.sigval);
-		bfdcore_write (obfd.get (), osec, &signal,
-			       sizeof (signal), &bfd_offset);
-
-		/* Write insn count.  */
-		count = netorder32 (record_full_list->u.end.insn_num);
-		bfdcore_write (obfd.get (), osec, &count,
-			       sizeof (count), &bfd_offset);
-                break;
-            }
-        }
-
-      /* Execute entry.  */
-      record_full_exec_insn (regcache, gdbarch, record_full_list);
+  /* Write the header and the index.  */
+  insn_num = netorder64 (record_full_insn_num);
+  nchunks = netorder32 (nchunks);
+  bfdcore_write (obfd.get (), osec, &nchunks, sizeof (nchunks), &bfd_offset);
+  bfdcore_write (obfd.get (), osec, &insn_num, sizeof (insn_num),
+		 &bfd_offset);
+  nchunks = netorder32 (nchunks);
 
-      if (record_full_list->next)
-        record_full_list = record_full_list->next;
-      else
-        break;
+  offset = bfd_offset + nchunks * (8 + 8 + 8);
+  for (seq = first_seq; nchunks != 0 && seq <= last_seq; seq++)
+    {
+      uint64_t index[3];
+      size_t size = record_full_save_chunk_size (seq, NULL);
+
+      index[0] = netorder64 (offset);
+      index[1] = netorder64 (size);
+      index[2] = netorder64 (record_full_chunks[seq
+					       - record_full_chunks_seq].last_insn);
+      bfdcore_write (obfd.get (), osec, index, sizeof (index), &bfd_offset);
+      offset += size;
     }
 
-  /* Reverse execute to cur_record_full_list.  */
-  while (1)
+  /* Write the chunks as they are.  */
+  for (seq = first_seq; nchunks != 0 && seq <= last_seq; seq++)
     {
-      /* Check for beginning and end of log.  */
-      if (record_full_list == cur_record_full_list)
-        break;
+      gdb_byte *data;
+      size_t size = record_full_save_chunk_size (seq, &data);
 
-      record_full_exec_insn (regcache, gdbarch, record_full_list);
+      if (record_debug)
+	fprintf_unfiltered (gdb_stdlog,
+			    "  Writing chunk %s (%s bytes)\n",
+			    pulongest (seq), pulongest (size));
+      bfdcore_write (obfd.get (), osec, data, size, &bfd_offset);
+    }
 
-      if (record_full_list->prev)
-        record_full_list = record_full_list->prev;
+  /* Forward execute to cur_record_full_list.  */
+  while (record_full_list != cur_record_full_list)
+    {
+      record_full_list = record_full_next (record_full_list);
+      record_full_read_entry (record_full_list, &rec);
+      record_full_save_exec (regcache, gdbarch, &rec, regs);
     }
+  record_full_save_sync_regs (regcache, regs);
 
   unlink_file.keep ();
 
@@ -2746,27 +3605,39 @@ record_full_base_target::save_record (const char *recfilename)
    correspondingly.  */
 
 static void
-record_full_goto_insn (struct record_full_entry *entry,
+record_full_goto_insn (record_full_pos entry,
 		       enum exec_direction_kind dir)
 {
   scoped_restore restore_operation_disable
     = record_full_gdb_operation_disable_set ();
   struct regcache *regcache = get_current_regcache ();
   struct gdbarch *gdbarch = regcache->arch ();
+  struct record_full_entry rec;
+  ULONGEST seq_from = RECORD_FULL_POS_SEQ (record_full_list);
+  ULONGEST seq_to = RECORD_FULL_POS_SEQ (entry);
+
+  /* Check the chunks on the way before executing anything, so that a
+     bad chunk of a restored log does not stop us half way.  */
+  if (seq_from > seq_to)
+    std::swap (seq_from, seq_to);
+  for (ULONGEST seq = std::max (seq_from, record_full_chunks_seq);
+       seq <= seq_to; seq++)
+    record_full_checked_chunk (seq);
 
   /* Assume everything is valid: we will hit the entry,
      and we will not hit the end of the recording.  */
 
   if (dir == EXEC_FORWARD)
-    record_full_list = record_full_list->next;
+    record_full_list = record_full_next (record_full_list);
 
   do
     {
-      record_full_exec_insn (regcache, gdbarch, record_full_list);
+      record_full_read_entry (record_full_list, &rec);
+      record_full_exec_insn (regcache, gdbarch, &rec);
       if (dir == EXEC_REVERSE)
-	record_full_list = record_full_list->prev;
+	record_full_list = record_full_prev (record_full_list);
       else
-	record_full_list = record_full_list->next;
+	record_full_list = record_full_next (record_full_list);
     } while (record_full_list != entry);
 }
 
@@ -2817,11 +3688,6 @@ _initialize_record_full (void)
 {
   struct cmd_list_element *c;
 
-  /* Init record_full_first.  */
-  record_full_first.prev = NULL;
-  record_full_first.next = NULL;
-  record_full_first.type = record_full_end;
-
   add_target (record_full_target_info, record_full_open);
   add_deprecated_target_alias (record_full_target_info, "record");
   add_target (record_full_core_target_info, record_full_open);
@@ -44,6 +44,8 @@
 #include "gdb_bfd.h"
 #include "filestuff.h"
 #include "rsp-low.h"
+#include "common/rsp-compress.h"
+#include "common/rsp-stats.h"
 #include "disasm.h"
 #include "location.h"
 
@@ -72,6 +74,8 @@
 #include "btrace.h"
 #include "record-btrace.h"
 #include <algorithm>
+#include <deque>
+#include <list>
 #include "common/scoped_restore.h"
 #include "environ.h"
 #include "common/byte-vector.h"
@@ -155,6 +159,10 @@ struct vCont_action_support
 
 #define MAXTHREADLISTRESULTS 32
 
+/* The number of blocks the vFile:pread readahead cache holds.  */
+
+#define READAHEAD_CACHE_BLOCKS 64
+
 /* Data for the vFile:pread readahead cache.  */
 
 struct readahead_cache
@@ -162,26 +170,34 @@ struct readahead_cache
   /* Invalidate the readahead cache.  */
   void invalidate ();
 
-  /* Invalidate the readahead cache if it is holding data for FD.  */
+  /* Invalidate the blocks of the readahead cache holding data for
+     FD.  */
   void invalidate_fd (int fd);
 
   /* Serve pread from the readahead cache.  Returns number of bytes
      read, or 0 if the request can't be served from the cache.  */
   int pread (int fd, gdb_byte *read_buf, size_t len, ULONGEST offset);
 
-  /* The file descriptor for the file that is being cached.  -1 if the
-     cache is invalid.  */
-  int fd = -1;
+  /* Add DATA, read from FD at OFFSET, to the cache, evicting the least
+     recently used block if it is full.  */
+  void add (int fd, ULONGEST offset, gdb::byte_vector &&data);
+
+  /* A block of cached file contents.  */
+  struct block
+  {
+    /* The file descriptor the block was read from.  */
+    int fd;
+
+    /* The offset into the file that the block corresponds to.  */
+    ULONGEST offset;
 
-  /* The offset into the file that the cache buffer corresponds
-     to.  */
-  ULONGEST offset = 0;
+    /* The block's contents.  We try to read as much as fits into a
+       packet at a time.  */
+    gdb::byte_vector data;
+  };
 
-  /* The buffer holding the cache contents.  */
-  gdb_byte *buf = nullptr;
-  /* The buffer's size.  We try to read as much as fits into a packet
-     at a time.  */
-  size_t bufsize = 0;
+  /* The cached blocks, most recently used first.  */
+  std::list<block> blocks;
 
   /* Cache hit and miss counters.  */
   ULONGEST hit_count = 0;
@@ -306,6 +322,10 @@ public: /* data */
      starts.  */
   struct serial *remote_desc = nullptr;
 
+  /* The name REMOTE_DESC was opened with, the argument of "target
+     remote".  */
+  std::string connection_name;
+
   /* These are the threads which we last sent to the remote system.  The
      TID member will be -1 for all or -2 for not sent yet.  */
   ptid_t general_thread = null_ptid;
@@ -364,8 +384,9 @@ public: /* data */
      involves a sequence of small reads.  E.g., when parsing an ELF
      file.  A readahead cache helps mostly the case of remote
      debugging on a connection with higher latency, due to the
-     request/reply nature of the RSP.  We only cache data for a single
-     file descriptor at a time.  */
+     request/reply nature of the RSP.  Loading the symbols of shared
+     libraries interleaves reads of several files, so blocks of all
+     the open files are cached.  */
   struct readahead_cache readahead_cache;
 
   /* The list of already fetched and acknowledged stop events.  This
@@ -390,6 +411,37 @@ public: /* data */
      this can go away.  */
   int wait_forever_enabled_p = 1;
 
+  /* True if we offered the "compression" feature to the stub, and so
+     accept compressed packets from it.  */
+  bool compression_offered = false;
+
+  /* The generation of the last full thread list read with
+     qXfer:threads:read, if we have one, so that only the changes
+     since can be asked for.  */
+  gdb::optional<ULONGEST> thread_list_generation;
+
+  /* The first thread whose registers were fetched since the last
+     resume, and whether the registers of all threads have been
+     fetched with qAllRegisters since.  */
+  ptid_t first_registers_ptid = null_ptid;
+  bool all_registers_fetched = false;
+
+  /* The number of bytes of packets sent and received compressed,
+     before and after compression.  */
+  ULONGEST compressed_sent_raw = 0;
+  ULONGEST compressed_sent = 0;
+  ULONGEST compressed_received_raw = 0;
+  ULONGEST compressed_received = 0;
+
+  /* Statistics about the packets exchanged, by packet type, for
+     "maint info remote-stats".  */
+  rsp_stats stats;
+
+  /* The requests sent that have not been replied to yet, oldest
+     first, with the time each was sent.  */
+  std::deque<std::pair<rsp_packet_stats *, rsp_clock::time_point>>
+    pending_requests;
+
 private:
   /* Mapping of remote protocol data for each gdbarch.  Usually there
      is only one entry here, though we may see more with stubs that
@@ -514,10 +566,18 @@ public:
 
   ULONGEST get_memory_xfer_limit () override;
 
+  bool read_memory_vector (std::vector<memory_read_request> *requests) override;
+
+  bool read_memory_chain (CORE_ADDR addr, ULONGEST len,
+			  ULONGEST next_offset, int max_count,
+			  std::vector<gdb::byte_vector> *nodes) override;
+
   void rcmd (const char *command, struct ui_file *output) override;
 
   char *pid_to_exec_file (int pid) override;
 
+  const char *connection_string () override;
+
   void log_command (const char *cmd) override
   {
     serial_log_command (this, cmd);
@@ -765,6 +825,8 @@ public: /* Remote specific methods.  */
   void remote_btrace_maybe_reopen ();
 
   void remove_new_fork_children (threads_listing_context *context);
+  void add_listed_threads (threads_listing_context *context);
+  void update_thread_list_delta (threads_listing_context *context);
   void kill_new_fork_children (int pid);
   void discard_pending_stop_replies (struct inferior *inf);
   int stop_reply_queue_length ();
@@ -849,7 +911,8 @@ public: /* Remote specific methods.  */
   int fetch_register_using_p (struct regcache *regcache,
 			      packet_reg *reg);
   int send_g_packet ();
-  void process_g_packet (struct regcache *regcache);
+  void process_g_packet (struct regcache *regcache, const char *buf);
+  bool fetch_registers_of_all_threads (struct regcache *regcache);
   void fetch_registers_using_g (struct regcache *regcache);
   int store_register_using_P (const struct regcache *regcache,
 			      packet_reg *reg);
@@ -872,6 +935,13 @@ public: /* Remote specific methods.  */
 					 const gdb_byte *myaddr, ULONGEST len,
 					 int unit_size, ULONGEST *xfered_len);
 
+  void send_memory_read_request (CORE_ADDR memaddr, ULONGEST len_units,
+				 bool binary);
+  LONGEST receive_memory_read_reply (gdb_byte *myaddr, ULONGEST len_units,
+				     int unit_size, bool binary);
+
+  bool can_read_memory_vector ();
+
   target_xfer_status remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
 					  ULONGEST len_units,
 					  int unit_size, ULONGEST *xfered_len_units);
@@ -2077,6 +2147,24 @@ enum {
   /* Support TARGET_WAITKIND_NO_RESUMED.  */
   PACKET_no_resumed,
 
+  /* Support for the binary memory read packet.  */
+  PACKET_x,
+
+  /* Support for the vectored memory read packet.  */
+  PACKET_qMemReadV,
+
+  /* Support for compressed packets.  */
+  PACKET_compression,
+
+  /* Support for the "since" annex of qXfer:threads:read.  */
+  PACKET_thread_list_delta,
+
+  /* Support for the qAllRegisters packet.  */
+  PACKET_qAllRegisters,
+
+  /* Support for the "compact" annex of qXfer:libraries-svr4:read.  */
+  PACKET_compact_libraries_svr4,
+
   PACKET_MAX
 };
 
@@ -3547,8 +3635,25 @@ struct threads_listing_context
       this->items.erase (it);
   }
 
-  /* The threads found on the remote target.  */
+  /* The threads found on the remote target.  In a delta listing,
+     only the threads added or changed since the previous listing.  */
   std::vector<thread_item> items;
+
+  /* True if this is a delta listing, describing only the changes to
+     the remote thread list since the previous listing.  */
+  bool delta = false;
+
+  /* In a delta listing, the threads that exited since the previous
+     listing.  */
+  std::vector<ptid_t> exited;
+
+  /* In a delta listing, the number of threads the remote target has,
+     if it said.  */
+  gdb::optional<ULONGEST> thread_count;
+
+  /* The generation of the remote thread list this listing describes,
+     if the remote target said.  */
+  gdb::optional<ULONGEST> generation;
 };
 
 static int
@@ -3604,6 +3709,42 @@ remote_target::remote_get_threads_with_ql (threads_listing_context *context)
 
 #if defined(HAVE_LIBEXPAT)
 
+static void
+start_threads (struct gdb_xml_parser *parser,
+	       const struct gdb_xml_element *element,
+	       void *user_data,
+	       std::vector<gdb_xml_value> &attributes)
+{
+  struct threads_listing_context *data
+    = (struct threads_listing_context *) user_data;
+  struct gdb_xml_value *attr;
+
+  attr = xml_find_attribute (attributes, "generation");
+  if (attr != NULL)
+    data->generation = *(ULONGEST *) attr->value.get ();
+
+  /* Only a delta listing has a "since" attribute.  */
+  data->delta = xml_find_attribute (attributes, "since") != NULL;
+
+  attr = xml_find_attribute (attributes, "count");
+  if (attr != NULL)
+    data->thread_count = *(ULONGEST *) attr->value.get ();
+}
+
+static void
+start_exited (struct gdb_xml_parser *parser,
+	      const struct gdb_xml_element *element,
+	      void *user_data,
+	      std::vector<gdb_xml_value> &attributes)
+{
+  struct threads_listing_context *data
+    = (struct threads_listing_context *) user_data;
+
+  char *id = (char *) xml_find_attribute (attributes, "id")->value.get ();
+
+  data->exited.push_back (read_ptid (id, NULL));
+}
+
 static void
 start_thread (struct gdb_xml_parser *parser,
 	      const struct gdb_xml_element *element,
@@ -3657,16 +3798,31 @@ const struct gdb_xml_element thread_children[] = {
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute exited_attributes[] = {
+  { "id", GDB_XML_AF_NONE, NULL, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_children[] = {
   { "thread", thread_attributes, thread_children,
     GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
     start_thread, end_thread },
+  { "exited", exited_attributes, NULL,
+    GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
+    start_exited, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute threads_attributes[] = {
+  { "generation", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { "since", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { "count", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_elements[] = {
-  { "threads", NULL, threads_children,
-    GDB_XML_EF_NONE, NULL, NULL },
+  { "threads", threads_attributes, threads_children,
+    GDB_XML_EF_NONE, start_threads, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
@@ -3680,13 +3836,29 @@ remote_target::remote_get_threads_with_qxfer (threads_listing_context *context)
 #if defined(HAVE_LIBEXPAT)
   if (packet_support (PACKET_qXfer_threads) == PACKET_ENABLE)
     {
+      struct remote_state *rs = get_remote_state ();
+      std::string annex;
+
+      /* If the target can tell what changed since the last list we
+	 read, only ask for that.  */
+      if (rs->thread_list_generation
+	  && packet_support (PACKET_thread_list_delta) == PACKET_ENABLE)
+	annex = string_printf ("since=%s",
+			       phex_nz (*rs->thread_list_generation, 0));
+
+      /* Forget the generation until this read succeeds.  */
+      rs->thread_list_generation.reset ();
+
       gdb::optional<gdb::char_vector> xml
-	= target_read_stralloc (this, TARGET_OBJECT_THREADS, NULL);
+	= target_read_stralloc (this, TARGET_OBJECT_THREADS,
+				annex.empty () ? NULL : annex.c_str ());
 
       if (xml && (*xml)[0] != '\0')
 	{
-	  gdb_xml_parse_quick (_("threads"), "threads.dtd",
-			       threads_elements, xml->data (), context);
+	  if (gdb_xml_parse_quick (_("threads"), "threads.dtd",
+				   threads_elements, xml->data (),
+				   context) == 0)
+	    rs->thread_list_generation = context->generation;
 	}
 
       return 1;
@@ -3756,6 +3928,12 @@ remote_target::update_thread_list ()
 
       got_list = 1;
 
+      if (context.delta)
+	{
+	  update_thread_list_delta (&context);
+	  return;
+	}
+
       if (context.items.empty ()
 	  && remote_thread_always_alive (inferior_ptid))
 	{
@@ -3785,26 +3963,7 @@ remote_target::update_thread_list ()
       remove_new_fork_children (&context);
 
       /* And now add threads we don't know about yet to our list.  */
-      for (thread_item &item : context.items)
-	{
-	  if (item.ptid != null_ptid)
-	    {
-	      /* In non-stop mode, we assume new found threads are
-		 executing until proven otherwise with a stop reply.
-		 In all-stop, we can only get here if all threads are
-		 stopped.  */
-	      int executing = target_is_non_stop_p () ? 1 : 0;
-
-	      remote_notice_new_inferior (item.ptid, executing);
-
-	      thread_info *tp = find_thread_ptid (item.ptid);
-	      remote_thread_info *info = get_remote_thread_info (tp);
-	      info->core = item.core;
-	      info->extra = std::move (item.extra);
-	      info->name = std::move (item.name);
-	      info->thread_handle = std::move (item.thread_handle);
-	    }
-	}
+      add_listed_threads (&context);
     }
 
   if (!got_list)
@@ -3817,6 +3976,73 @@ remote_target::update_thread_list ()
     }
 }
 
+/* Add the threads of CONTEXT that GDB does not know about yet to its
+   thread list, and update what GDB knows about the others.  */
+
+void
+remote_target::add_listed_threads (threads_listing_context *context)
+{
+  for (thread_item &item : context->items)
+    {
+      if (item.ptid != null_ptid)
+	{
+	  /* In non-stop mode, we assume new found threads are
+	     executing until proven otherwise with a stop reply.
+	     In all-stop, we can only get here if all threads are
+	     stopped.  */
+	  int executing = target_is_non_stop_p () ? 1 : 0;
+
+	  remote_notice_new_inferior (item.ptid, executing);
+
+	  thread_info *tp = find_thread_ptid (item.ptid);
+	  remote_thread_info *info = get_remote_thread_info (tp);
+	  info->core = item.core;
+	  info->extra = std::move (item.extra);
+	  info->name = std::move (item.name);
+	  info->thread_handle = std::move (item.thread_handle);
+	}
+    }
+}
+
+/* Apply the delta thread listing CONTEXT to GDB's thread list.  The
+   threads not mentioned in CONTEXT are left alone, and keep the core
+   they were last listed on.  */
+
+void
+remote_target::update_thread_list_delta (threads_listing_context *context)
+{
+  /* Delete the exited threads first, in case a new thread reuses the
+     id of one of them.  */
+  for (ptid_t ptid : context->exited)
+    {
+      thread_info *tp = find_thread_ptid (ptid);
+
+      if (tp != NULL)
+	delete_thread (tp);
+    }
+
+  remove_new_fork_children (context);
+  add_listed_threads (context);
+
+  /* If our list went out of sync with the target's, for instance
+     because GDB deleted threads the target still has, read the whole
+     list again.  */
+  if (context->thread_count)
+    {
+      struct thread_info *tp;
+      ULONGEST count = 0;
+
+      ALL_NON_EXITED_THREADS (tp)
+	count++;
+
+      if (count != *context->thread_count)
+	{
+	  get_remote_state ()->thread_list_generation.reset ();
+	  update_thread_list ();
+	}
+    }
+}
+
 /*
  * Collect a descriptive string about the given thread.
  * The target may say anything it wants to about the thread
@@ -5174,6 +5400,16 @@ static const struct protocol_feature remote_protocol_features[] = {
   { "vContSupported", PACKET_DISABLE, remote_supported_packet, PACKET_vContSupported },
   { "QThreadEvents", PACKET_DISABLE, remote_supported_packet, PACKET_QThreadEvents },
   { "no-resumed", PACKET_DISABLE, remote_supported_packet, PACKET_no_resumed },
+  { "binary-upload", PACKET_DISABLE, remote_supported_packet, PACKET_x },
+  { "qMemReadV", PACKET_DISABLE, remote_supported_packet, PACKET_qMemReadV },
+  { "compression", PACKET_DISABLE, remote_supported_packet,
+    PACKET_compression },
+  { "thread-list-delta", PACKET_DISABLE, remote_supported_packet,
+    PACKET_thread_list_delta },
+  { "qAllRegisters", PACKET_DISABLE, remote_supported_packet,
+    PACKET_qAllRegisters },
+  { "compact-libraries-svr4", PACKET_DISABLE, remote_supported_packet,
+    PACKET_compact_libraries_svr4 },
 };
 
 static char *remote_support_xml;
@@ -5267,6 +5503,14 @@ remote_target::remote_query_supported ()
       if (packet_set_cmd_state (PACKET_no_resumed) != AUTO_BOOLEAN_FALSE)
 	remote_query_supported_append (&q, "no-resumed+");
 
+      /* The stub may start compressing as soon as it sees this, so
+	 be ready to accept compressed packets from now on.  */
+      if (packet_set_cmd_state (PACKET_compression) != AUTO_BOOLEAN_FALSE)
+	{
+	  remote_query_supported_append (&q, "compression+");
+	  rs->compression_offered = true;
+	}
+
       /* Keep this one last to work around a gdbserver <= 7.10 bug in
 	 the qSupported:xmlRegisters=i386 handling.  */
       if (remote_support_xml != NULL
@@ -5502,6 +5746,7 @@ remote_target::open_1 (const char *name, int from_tty, int extended_p)
   rs->remote_desc = remote_serial_open (name);
   if (!rs->remote_desc)
     perror_with_name (name);
+  rs->connection_name = name;
 
   if (baud_rate != -1)
     {
@@ -6273,6 +6518,10 @@ remote_target::resume (ptid_t ptid, int step, enum gdb_signal siggnal)
 
   rs->last_resume_exec_dir = ::execution_direction;
 
+  /* Any registers fetched will be of the next stop.  */
+  rs->first_registers_ptid = null_ptid;
+  rs->all_registers_fetched = false;
+
   /* Prefer vCont, and fallback to s/c/S/C, which use Hc.  */
   if (!remote_resume_with_vcont (ptid, step, siggnal))
     remote_resume_with_hc (ptid, step, siggnal);
@@ -8021,22 +8270,24 @@ remote_target::send_g_packet ()
   return buf_len / 2;
 }
 
+/* Supply the registers in BUF, a 'g' packet reply, to REGCACHE.  */
+
 void
-remote_target::process_g_packet (struct regcache *regcache)
+remote_target::process_g_packet (struct regcache *regcache, const char *buf)
 {
   struct gdbarch *gdbarch = regcache->arch ();
   struct remote_state *rs = get_remote_state ();
   remote_arch_state *rsa = rs->get_remote_arch_state (gdbarch);
   int i, buf_len;
-  char *p;
+  const char *p;
   char *regs;
 
-  buf_len = strlen (rs->buf);
+  buf_len = strlen (buf);
 
   /* Further sanity checks, with knowledge of the architecture.  */
   if (buf_len > 2 * rsa->sizeof_g_packet)
     error (_("Remote 'g' packet reply is too long (expected %ld bytes, got %d "
-	     "bytes): %s"), rsa->sizeof_g_packet, buf_len / 2, rs->buf);
+	     "bytes): %s"), rsa->sizeof_g_packet, buf_len / 2, buf);
 
   /* Save the size of the packet sent to us by the target.  It is used
      as a heuristic when determining the max size of packets that the
@@ -8086,7 +8337,7 @@ remote_target::process_g_packet (struct regcache *regcache)
      hex characters.  Suck them all up, then supply them to the
      register cacheing/storage mechanism.  */
 
-  p = rs->buf;
+  p = buf;
   for (i = 0; i < rsa->sizeof_g_packet; i++)
     {
       if (p[0] == 0 || p[1] == 0)
@@ -8108,13 +8359,13 @@ remote_target::process_g_packet (struct regcache *regcache)
 
       if (r->in_g_packet)
 	{
-	  if ((r->offset + reg_size) * 2 > strlen (rs->buf))
+	  if ((r->offset + reg_size) * 2 > buf_len)
 	    /* This shouldn't happen - we adjusted in_g_packet above.  */
 	    internal_error (__FILE__, __LINE__,
 			    _("unexpected end of 'g' packet reply"));
-	  else if (rs->buf[r->offset * 2] == 'x')
+	  else if (buf[r->offset * 2] == 'x')
 	    {
-	      gdb_assert (r->offset * 2 < strlen (rs->buf));
+	      gdb_assert (r->offset * 2 < buf_len);
 	      /* The register isn't available, mark it as such (at
 		 the same time setting the value to zero).  */
 	      regcache->raw_supply (r->regnum, NULL);
@@ -8129,7 +8380,87 @@ void
 remote_target::fetch_registers_using_g (struct regcache *regcache)
 {
   send_g_packet ();
-  process_g_packet (regcache);
+  process_g_packet (regcache, get_remote_state ()->buf);
+}
+
+/* Fetch the registers in the 'g' packet of all the stopped threads of
+   REGCACHE's inferior at once, with qAllRegisters packets, if that
+   looks worth it.  Return true if REGCACHE was among them.  */
+
+bool
+remote_target::fetch_registers_of_all_threads (struct regcache *regcache)
+{
+  struct remote_state *rs = get_remote_state ();
+  ptid_t ptid = regcache->ptid ();
+
+  if (packet_support (PACKET_qAllRegisters) == PACKET_DISABLE
+      || target_is_non_stop_p ()
+      || get_traceframe_number () != -1
+      || rs->all_registers_fetched)
+    return false;
+
+  /* Most stops only look at the registers of the thread that
+     reported the event.  Only once a second thread's registers are
+     needed, as with "thread apply all backtrace", are the others
+     likely to be.  */
+  if (rs->first_registers_ptid == null_ptid
+      || rs->first_registers_ptid == ptid)
+    {
+      rs->first_registers_ptid = ptid;
+      return false;
+    }
+
+  rs->all_registers_fetched = true;
+
+  bool found = false;
+  std::string last;
+
+  do
+    {
+      if (last.empty ())
+	xsnprintf (rs->buf, get_remote_packet_size (), "qAllRegisters");
+      else
+	xsnprintf (rs->buf, get_remote_packet_size (), "qAllRegisters:%s",
+		   last.c_str ());
+      putpkt (rs->buf);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+      if (packet_ok (rs->buf, &remote_protocol_packets[PACKET_qAllRegisters])
+	  != PACKET_OK
+	  || (rs->buf[0] != 'm' && rs->buf[0] != 'l'))
+	return found;
+
+      /* The reply is a list of THREAD-ID:REGISTERS entries, separated
+	 by ';', where REGISTERS is as in a 'g' reply.  */
+      const char *p = rs->buf + 1;
+      while (*p != '\0')
+	{
+	  const char *id = p;
+	  ptid_t thread_ptid = read_ptid (p, &p);
+
+	  if (*p != ':')
+	    error (_("Malformed qAllRegisters reply: %s"), rs->buf);
+	  last = std::string (id, p);
+
+	  const char *end = strchrnul (p + 1, ';');
+	  std::string regs (p + 1, end);
+	  thread_info *tp = find_thread_ptid (thread_ptid);
+
+	  if (tp != NULL && tp->state != THREAD_EXITED
+	      && thread_ptid.pid () == ptid.pid ())
+	    {
+	      process_g_packet (get_thread_arch_regcache (thread_ptid,
+							  regcache->arch ()),
+				regs.c_str ());
+	      if (thread_ptid == ptid)
+		found = true;
+	    }
+
+	  p = *end == ';' ? end + 1 : end;
+	}
+    }
+  while (rs->buf[0] == 'm' && !last.empty ());
+
+  return found;
 }
 
 /* Make the remote selected traceframe match GDB's selected
@@ -8164,6 +8495,12 @@ remote_target::fetch_registers (struct regcache *regcache, int regnum)
   int i;
 
   set_remote_traceframe ();
+
+  bool prefetched = fetch_registers_of_all_threads (regcache);
+  if (prefetched && regnum >= 0
+      && regcache->get_register_status (regnum) != REG_UNKNOWN)
+    return;
+
   set_general_thread (regcache->ptid ());
 
   if (regnum >= 0)
@@ -8192,7 +8529,8 @@ remote_target::fetch_registers (struct regcache *regcache, int regnum)
       return;
     }
 
-  fetch_registers_using_g (regcache);
+  if (!prefetched)
+    fetch_registers_using_g (regcache);
 
   for (i = 0; i < gdbarch_num_regs (gdbarch); i++)
     if (!rsa->regs[i].in_g_packet)
@@ -8734,46 +9072,251 @@ remote_target::remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr,
    See the comment of remote_write_bytes_aux for an example of
    memory read/write exchange between gdb and the stub.  */
 
+/* The number of memory read packets that may be outstanding at once
+   when reading a block of memory larger than one packet.  */
+static unsigned int remote_memory_read_window = 8;
+
+/* Return how many units of UNIT_SIZE bytes a single memory read
+   packet asks for, given that the reply must fit in BUF_SIZE_BYTES.
+   If BINARY, the reply is an "x" packet reply, otherwise an "m"
+   packet reply.  */
+
+static ULONGEST
+memory_read_packet_units (long buf_size_bytes, int unit_size, bool binary)
+{
+  /* A binary reply is the 'b' marker followed by the data, escaped.
+     Leave some room for the escape characters of typical data; the
+     stub returns fewer units if the escaped data still doesn't fit.  */
+  if (binary)
+    return std::max ((buf_size_bytes - 1 - buf_size_bytes / 32) / unit_size,
+		     1L);
+
+  /* Each byte is encoded as two hex characters.  */
+  return (buf_size_bytes / unit_size) / 2;
+}
+
+/* Send a request to read LEN_UNITS units of memory at MEMADDR, as an
+   "x" packet if BINARY, otherwise as an "m" packet.  Don't wait for
+   the reply; see receive_memory_read_reply.  */
+
+void
+remote_target::send_memory_read_request (CORE_ADDR memaddr,
+					 ULONGEST len_units, bool binary)
+{
+  char buf[2 + 2 * 2 * sizeof (ULONGEST) + 1];
+  char *p = buf;
+
+  /* Construct "m"<memaddr>","<len>" or "x"<memaddr>","<len>".  */
+  *p++ = binary ? 'x' : 'm';
+  p += hexnumstr (p, (ULONGEST) remote_address_masked (memaddr));
+  *p++ = ',';
+  p += hexnumstr (p, len_units);
+  *p = '\0';
+  putpkt (buf);
+}
+
+/* Wait for the reply to a memory read request sent by
+   send_memory_read_request, for LEN_UNITS units of UNIT_SIZE bytes,
+   and decode it into MYADDR.  Return the number of units read, which
+   may be less than LEN_UNITS, -1 if the stub reported an error, -2 if
+   the reply could not be understood, or -3 if no reply came.  */
+
+LONGEST
+remote_target::receive_memory_read_reply (gdb_byte *myaddr,
+					  ULONGEST len_units,
+					  int unit_size, bool binary)
+{
+  struct remote_state *rs = get_remote_state ();
+  int packet_len;
+  int decoded_bytes;
+
+  rs->buf[0] = '\0';
+  packet_len = getpkt_sane (&rs->buf, &rs->buf_size, 0);
+  if (packet_len < 0)
+    return -3;
+  if (rs->buf[0] == 'E'
+      && isxdigit (rs->buf[1]) && isxdigit (rs->buf[2])
+      && rs->buf[3] == '\0')
+    return -1;
+
+  if (binary)
+    {
+      /* Reply is 'b' followed by the memory contents, escaped.  */
+      if (rs->buf[0] != 'b')
+	return -2;
+      decoded_bytes = remote_unescape_input ((gdb_byte *) rs->buf + 1,
+					     packet_len - 1, myaddr,
+					     len_units * unit_size);
+    }
+  else
+    {
+      /* Reply describes memory byte by byte, each byte encoded as two
+	 hex characters.  */
+      decoded_bytes = hex2bin (rs->buf, myaddr, len_units * unit_size);
+    }
+
+  return decoded_bytes / unit_size;
+}
+
+/* Read memory data directly from the remote machine.
+   This does not use the data cache; the data cache uses this.
+   MEMADDR is the address in the remote memory space.
+   MYADDR is the address of the buffer in our space.
+   LEN_UNITS is the number of addressable memory units to read..
+   UNIT_SIZE is the length in bytes of an addressable unit.
+
+   Return the transferred status, error or OK (an
+   'enum target_xfer_status' value).  Save the number of bytes
+   transferred in *XFERED_LEN_UNITS.
+
+   If the block does not fit in one packet, and the connection does
+   not use acknowledgments, up to remote_memory_read_window requests
+   are kept in flight at once, and the replies are decoded as they
+   arrive.  Reading stops at the first request that fails, though the
+   replies to the requests already sent are still collected.  Should a
+   reply be lost, or receiving one be interrupted, while others are
+   still due, the replies can no longer be matched with the requests,
+   and the connection is closed.
+
+   See the comment of remote_write_bytes_aux for an example of
+   memory read/write exchange between gdb and the stub.  */
+
 target_xfer_status
 remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
 				    ULONGEST len_units,
 				    int unit_size, ULONGEST *xfered_len_units)
 {
   struct remote_state *rs = get_remote_state ();
-  int buf_size_bytes;		/* Max size of packet output buffer.  */
-  char *p;
-  int todo_units;
-  int decoded_bytes;
+  bool binary = packet_support (PACKET_x) == PACKET_ENABLE;
+  ULONGEST packet_units;
+  unsigned int window = 1;
+
+  /* A range of units to read, as an offset from MEMADDR and a
+     length.  */
+  struct read_range
+  {
+    ULONGEST offset;
+    ULONGEST len;
+  };
+
+  /* Requests sent and waiting for their reply, oldest first; this is
+     the order the replies arrive in.  */
+  std::deque<read_range> in_flight;
+
+  /* Remainders of short replies, to request again.  */
+  std::deque<read_range> retry;
+
+  /* Offset of the next unit not yet requested.  */
+  ULONGEST next = 0;
+
+  /* Everything below LIMIT is, or will be, read.  A failed request
+     lowers it to the offset of that request.  */
+  ULONGEST limit = len_units;
+  LONGEST status = 0;
 
-  buf_size_bytes = get_memory_read_packet_size ();
   /* The packet buffer will be large enough for the payload;
      get_memory_packet_size ensures this.  */
+  packet_units = memory_read_packet_units (get_memory_read_packet_size (),
+					   unit_size, binary);
 
-  /* Number of units that will fit.  */
-  todo_units = std::min (len_units,
-			 (ULONGEST) (buf_size_bytes / unit_size) / 2);
+  /* With acknowledgments, the ack of one request would be mixed up
+     with the reply to the previous one, so only pipeline requests in
+     no-ack mode.  */
+  if (rs->noack_mode && remote_memory_read_window > 1)
+    window = remote_memory_read_window;
+
+  while (1)
+    {
+      while (in_flight.size () < window)
+	{
+	  read_range range;
+
+	  if (!retry.empty ())
+	    {
+	      range = retry.front ();
+	      retry.pop_front ();
+	      if (range.offset >= limit)
+		continue;
+	    }
+	  else if (next < limit)
+	    {
+	      range.offset = next;
+	      range.len = std::min (limit - next, packet_units);
+	      next += range.len;
+	    }
+	  else
+	    break;
+
+	  send_memory_read_request (memaddr + range.offset, range.len, binary);
+	  in_flight.push_back (range);
+	}
+
+      if (in_flight.empty ())
+	break;
+
+      read_range range = in_flight.front ();
+      in_flight.pop_front ();
+
+      LONGEST units;
+
+      TRY
+	{
+	  units = receive_memory_read_reply (myaddr
+					     + range.offset * unit_size,
+					     range.len, unit_size, binary);
+	}
+      CATCH (ex, RETURN_MASK_ALL)
+	{
+	  if (ex.error != TARGET_CLOSE_ERROR && !in_flight.empty ())
+	    {
+	      remote_unpush_target ();
+	      throw_error (TARGET_CLOSE_ERROR,
+			   _("Remote communication error.  Memory read "
+			     "replies still due: %s"), ex.message);
+	    }
+	  throw_exception (ex);
+	}
+      END_CATCH
+
+      if (units == -3)
+	{
+	  /* A late reply would be taken for that of the next request.  */
+	  if (!in_flight.empty ())
+	    {
+	      remote_unpush_target ();
+	      throw_error (TARGET_CLOSE_ERROR,
+			   _("Remote communication error.  "
+			     "Memory read reply lost."));
+	    }
+	  units = -1;
+	}
+
+      /* Ignore replies past a request that failed.  */
+      if (range.offset >= limit)
+	continue;
+
+      if (units <= 0)
+	{
+	  limit = range.offset;
+	  status = units;
+	}
+      else if ((ULONGEST) units < range.len)
+	{
+	  /* The stub may return fewer units than asked for, e.g. if the
+	     escaped data doesn't fit in a packet.  Ask for the rest,
+	     and keep the replies to the requests already sent.  */
+	  retry.push_back ({range.offset + units, range.len - units});
+	}
+    }
+
+  if (limit == 0 && status == -2)
+    error (_("Unexpected reply to memory read request: %s"), rs->buf);
 
-  /* Construct "m"<memaddr>","<len>".  */
-  memaddr = remote_address_masked (memaddr);
-  p = rs->buf;
-  *p++ = 'm';
-  p += hexnumstr (p, (ULONGEST) memaddr);
-  *p++ = ',';
-  p += hexnumstr (p, (ULONGEST) todo_units);
-  *p = '\0';
-  putpkt (rs->buf);
-  getpkt (&rs->buf, &rs->buf_size, 0);
-  if (rs->buf[0] == 'E'
-      && isxdigit (rs->buf[1]) && isxdigit (rs->buf[2])
-      && rs->buf[3] == '\0')
-    return TARGET_XFER_E_IO;
-  /* Reply describes memory byte by byte, each byte encoded as two hex
-     characters.  */
-  p = rs->buf;
-  decoded_bytes = hex2bin (p, myaddr, todo_units * unit_size);
   /* Return what we have.  Let higher layers handle partial reads.  */
-  *xfered_len_units = (ULONGEST) (decoded_bytes / unit_size);
-  return (*xfered_len_units != 0) ? TARGET_XFER_OK : TARGET_XFER_EOF;
+  *xfered_len_units = limit;
+  if (limit != 0)
+    return TARGET_XFER_OK;
+  return status != 0 ? TARGET_XFER_E_IO : TARGET_XFER_EOF;
 }
 
 /* Using the set of read-only target sections of remote, read live
@@ -9116,6 +9659,87 @@ putpkt (remote_target *remote, const char *buf)
   return remote->putpkt (buf);
 }
 
+/* Account for a request of SIZE bytes on the wire, with statistics
+   STATS, that is about to be sent.  */
+
+static void
+remote_note_request (struct remote_state *rs, rsp_packet_stats *stats,
+		     int size)
+{
+  stats->count++;
+  stats->bytes_out += size;
+
+  /* Only memory reads are pipelined, and always with requests of the
+     same type.  A request of another type still pending got no reply,
+     like 'k' sometimes does; forget it.  */
+  if (!rs->pending_requests.empty ()
+      && rs->pending_requests.back ().first != stats)
+    rs->pending_requests.clear ();
+
+  rs->pending_requests.emplace_back (stats, rsp_clock::now ());
+}
+
+/* Account for a reply of SIZE bytes on the wire to the oldest pending
+   request.  We started waiting for it at START.  */
+
+static void
+remote_note_reply (struct remote_state *rs, int size,
+		   rsp_clock::time_point start)
+{
+  rsp_clock::time_point now = rsp_clock::now ();
+
+  if (rs->pending_requests.empty ())
+    {
+      rsp_packet_stats &stats = rs->stats["(unsolicited)"];
+
+      stats.replies++;
+      stats.bytes_in += size;
+      return;
+    }
+
+  rsp_packet_stats *stats = rs->pending_requests.front ().first;
+  rsp_clock::time_point sent = rs->pending_requests.front ().second;
+
+  rs->pending_requests.pop_front ();
+  stats->replies++;
+  stats->bytes_in += size;
+  stats->add_latency (now - sent, now - std::max (start, sent));
+}
+
+/* Account for the SIZE bytes long notification BUF, including its
+   framing.  */
+
+static void
+remote_note_notification (struct remote_state *rs, const char *buf,
+			  int size)
+{
+  const char *colon = strchr (buf, ':');
+  int len = colon != NULL ? colon - buf : strlen (buf);
+  std::string type ("%");
+
+  type.append (buf, std::min (len, 40));
+
+  rsp_packet_stats &stats = rs->stats[type];
+  stats.count++;
+  stats.bytes_in += size;
+}
+
+/* Log that a packet of RAW bytes went over the wire as a compressed
+   packet of SIZE bytes, and the totals so far in that direction,
+   TOTAL_RAW and TOTAL.  WHAT says which direction.  */
+
+static void
+remote_debug_compression (const char *what, int raw, int size,
+			  ULONGEST total_raw, ULONGEST total)
+{
+  fprintf_unfiltered (gdb_stdlog,
+		      "%s compressed packet: %d -> %d bytes (%d%%), "
+		      "%s -> %s bytes so far (%d%%)\n",
+		      what, raw, size, (int) (size * 100LL / raw),
+		      pulongest (total_raw), pulongest (total),
+		      (int) (total * 100 / total_raw));
+}
+
 /* Send a packet to the remote machine, with error checking.  The data
    of the packet is in BUF.  The string in BUF can be at most
    get_remote_packet_size () - 5 to account for the $, # and checksum,
@@ -9128,8 +9752,8 @@ remote_target::putpkt_binary (const char *buf, int cnt)
   struct remote_state *rs = get_remote_state ();
   int i;
   unsigned char csum = 0;
-  gdb::def_vector<char> data (cnt + 6);
-  char *buf2 = data.data ();
+  gdb::def_vector<char> compressed;
+  rsp_packet_stats *stats;
 
   int ch;
   int tcount = 0;
@@ -9155,9 +9779,34 @@ remote_target::putpkt_binary (const char *buf, int cnt)
      stale cached response.  */
   rs->cached_wait_status = 0;
 
+  stats = &rs->stats[rsp_packet_type (buf, cnt)];
+
+  /* Once the stub has agreed, send large packets compressed, unless
+     that would not make them any smaller.  */
+  if (packet_support (PACKET_compression) == PACKET_ENABLE)
+    {
+      compressed.resize (cnt);
+
+      int len = rsp_compress_packet (buf, cnt, compressed.data ());
+      if (len >= 0)
+	{
+	  rs->compressed_sent_raw += cnt;
+	  rs->compressed_sent += len;
+	  if (remote_debug)
+	    remote_debug_compression ("Sending", cnt, len,
+				      rs->compressed_sent_raw,
+				      rs->compressed_sent);
+	  buf = compressed.data ();
+	  cnt = len;
+	}
+    }
+
   /* Copy the packet into buffer BUF2, encapsulating it
      and giving it a checksum.  */
 
+  gdb::def_vector<char> data (cnt + 6);
+  char *buf2 = data.data ();
+
   p = buf2;
   *p++ = '$';
 
@@ -9170,6 +9819,8 @@ remote_target::putpkt_binary (const char *buf, int cnt)
   *p++ = tohex ((csum >> 4) & 0xf);
   *p++ = tohex (csum & 0xf);
 
+  remote_note_request (rs, stats, p - buf2);
+
   /* Send it over and over until we get a positive ack.  */
 
   while (1)
@@ -9265,6 +9916,7 @@ remote_target::putpkt_binary (const char *buf, int cnt)
 		val = read_frame (&rs->buf, &rs->buf_size);
 		if (val >= 0)
 		  {
+		    remote_note_notification (rs, rs->buf, val + 4);
 		    if (remote_debug)
 		      {
 			std::string str = escape_buffer (rs->buf, val);
@@ -9492,6 +10144,38 @@ remote_target::read_frame (char **buf_p, long *sizeof_buf)
     }
 }
 
+/* Replace the VAL bytes long compressed packet in *BUF by its
+   original contents, growing *BUF if needed, and return the new
+   length.  */
+
+static int
+remote_decompress_packet (struct remote_state *rs,
+			  char **buf, long *sizeof_buf, int val)
+{
+  int len = rsp_compressed_packet_length (*buf, val);
+  if (len < 0)
+    error (_("Remote sent a corrupt compressed packet."));
+
+  gdb::def_vector<char> data (*buf, *buf + val);
+  if (len >= *sizeof_buf)
+    {
+      *sizeof_buf = len + 1;
+      *buf = (char *) xrealloc (*buf, *sizeof_buf);
+    }
+
+  if (rsp_decompress_packet (data.data (), val, *buf, len) != len)
+    error (_("Remote sent a corrupt compressed packet."));
+  (*buf)[len] = '\0';
+
+  rs->compressed_received_raw += len;
+  rs->compressed_received += val;
+  if (remote_debug)
+    remote_debug_compression ("Received", len, val,
+			      rs->compressed_received_raw,
+			      rs->compressed_received);
+  return len;
+}
+
 /* Read a packet from the remote machine, with error checking, and
    store it in *BUF.  Resize *BUF using xrealloc if necessary to hold
    the result, and update *SIZEOF_BUF.  If FOREVER, wait forever
@@ -9531,6 +10215,7 @@ remote_target::getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf,
   int tries;
   int timeout;
   int val = -1;
+  rsp_clock::time_point start = rsp_clock::now ();
 
   /* We're reading a new response.  Make sure we don't look at a
      previously cached response.  */
@@ -9603,6 +10288,10 @@ remote_target::getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf,
 	     packet/notification.  Give up.  */
 	  printf_unfiltered (_("Ignoring packet error, continuing...\n"));
 
+	  /* The reply is lost; don't take the next one for it.  */
+	  if (!rs->pending_requests.empty ())
+	    rs->pending_requests.pop_front ();
+
 	  /* Skip the ack char if we're in no-ack mode.  */
 	  if (!rs->noack_mode)
 	    remote_serial_write ("+", 1);
@@ -9633,6 +10322,12 @@ remote_target::getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf,
 	    remote_serial_write ("+", 1);
 	  if (is_notif != NULL)
 	    *is_notif = 0;
+
+	  remote_note_reply (rs, val + 4, start);
+
+	  if (rs->compression_offered
+	      && val > 0 && (*buf)[0] == RSP_COMPRESSED_PREFIX)
+	    val = remote_decompress_packet (rs, buf, sizeof_buf, val);
 	  return val;
 	}
 
@@ -9642,6 +10337,8 @@ remote_target::getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf,
 	{
 	  gdb_assert (c == '%');
 
+	  remote_note_notification (rs, *buf, val + 4);
+
 	  if (remote_debug)
 	    {
 	      std::string str = escape_buffer (*buf, val);
@@ -10978,9 +11675,27 @@ remote_target::xfer_partial (enum target_object object,
 	 &remote_protocol_packets[PACKET_qXfer_libraries]);
 
     case TARGET_OBJECT_LIBRARIES_SVR4:
+      /* Ask for the compact form of the list if the stub can send it;
+	 it is quicker to parse than XML, and needs no XML support.  */
+      if (packet_support (PACKET_compact_libraries_svr4) == PACKET_ENABLE)
+	{
+	  std::string compact_annex = "compact=1;";
+
+	  if (annex != NULL)
+	    compact_annex += annex;
+	  return remote_read_qxfer
+	    ("libraries-svr4", compact_annex.c_str (), readbuf, offset, len,
+	     xfered_len, &remote_protocol_packets[PACKET_qXfer_libraries_svr4]);
+	}
+
+#if !defined(HAVE_LIBEXPAT)
+      /* The XML form of the list could not be parsed anyway.  */
+      return TARGET_XFER_E_IO;
+#else
       return remote_read_qxfer
 	("libraries-svr4", annex, readbuf, offset, len, xfered_len,
 	 &remote_protocol_packets[PACKET_qXfer_libraries_svr4]);
+#endif
 
     case TARGET_OBJECT_MEMORY_MAP:
       gdb_assert (annex == NULL);
@@ -10996,7 +11711,6 @@ remote_target::xfer_partial (enum target_object object,
         &remote_protocol_packets[PACKET_qXfer_osdata]);
 
     case TARGET_OBJECT_THREADS:
-      gdb_assert (annex == NULL);
       return remote_read_qxfer ("threads", annex, readbuf, offset, len,
 				xfered_len,
 				&remote_protocol_packets[PACKET_qXfer_threads]);
@@ -11088,6 +11802,240 @@ remote_target::get_memory_xfer_limit ()
   return get_memory_write_packet_size ();
 }
 
+/* Decode REPLY, the reply to a qMemReadV packet, appending the
+   contents of each block to BLOCKS.  A block the stub failed to read
+   is marked 'E' and comes out empty; if FAILED is not NULL, append
+   whether each block failed to it.  Return false if the reply is
+   malformed.  */
+
+static bool
+parse_memory_vector_reply (const char *reply,
+			   std::vector<gdb::byte_vector> *blocks,
+			   std::vector<bool> *failed)
+{
+  if (*reply++ != 'V')
+    return false;
+
+  while (*reply == ';')
+    {
+      const char *start = ++reply;
+
+      if (*reply == 'E')
+	{
+	  reply++;
+	  if (*reply != ';' && *reply != '\0')
+	    return false;
+	  blocks->emplace_back ();
+	  if (failed != NULL)
+	    failed->push_back (true);
+	  continue;
+	}
+
+      while (isxdigit (*reply))
+	reply++;
+      if ((reply - start) % 2 != 0)
+	return false;
+
+      gdb::byte_vector block ((reply - start) / 2);
+
+      hex2bin (start, block.data (), block.size ());
+      blocks->push_back (std::move (block));
+      if (failed != NULL)
+	failed->push_back (false);
+    }
+
+  return *reply == '\0';
+}
+
+/* Return true if the qMemReadV packet may be used to read memory
+   now.  */
+
+bool
+remote_target::can_read_memory_vector ()
+{
+  if (packet_support (PACKET_qMemReadV) == PACKET_DISABLE
+      || !target_has_execution
+      || get_traceframe_number () != -1
+      || gdbarch_addressable_memory_unit_size (target_gdbarch ()) != 1)
+    return false;
+
+  set_remote_traceframe ();
+  set_general_thread (inferior_ptid);
+  return true;
+}
+
+/* Implementation of to_read_memory_vector.  Send as many blocks per
+   qMemReadV packet as fit in the request and the reply, splitting
+   the blocks that don't fit in one.  */
+
+bool
+remote_target::read_memory_vector (std::vector<memory_read_request> *requests)
+{
+  struct remote_state *rs = get_remote_state ();
+  /* The first block not asked for completely, and how much of it was
+     asked for.  */
+  size_t next = 0;
+  ULONGEST next_offset = 0;
+
+  if (!can_read_memory_vector ())
+    return false;
+
+  while (next < requests->size ())
+    {
+      /* The pieces of blocks asked for, as block index and length.  */
+      std::vector<std::pair<size_t, ULONGEST>> pieces;
+      /* Room left in the reply, after the leading 'V'.  */
+      long room = get_memory_read_packet_size () - 1;
+      char *p = rs->buf;
+      char *end = rs->buf + get_remote_packet_size () - 1;
+      size_t i = next;
+      ULONGEST offset = next_offset;
+
+      strcpy (p, "qMemReadV:");
+      p += strlen (p);
+
+      while (i < requests->size ()
+	     && end - p >= (long) (2 * 2 * sizeof (ULONGEST) + 2))
+	{
+	  memory_read_request &req = (*requests)[i];
+	  ULONGEST want = std::min (req.len - offset,
+				    (ULONGEST) std::max ((room - 1) / 2, 0L));
+
+	  if (want != 0)
+	    {
+	      if (!pieces.empty ())
+		*p++ = ';';
+	      p += hexnumstr (p, (ULONGEST) remote_address_masked (req.addr
+								    + offset));
+	      *p++ = ',';
+	      p += hexnumstr (p, want);
+	      pieces.emplace_back (i, want);
+	      room -= 1 + 2 * want;
+	      offset += want;
+	    }
+
+	  /* Ask for the rest of the block in the next packet.  */
+	  if (offset < req.len)
+	    break;
+
+	  i++;
+	  offset = 0;
+	}
+      *p = '\0';
+
+      if (pieces.empty ())
+	{
+	  /* Only empty blocks were left.  */
+	  if (i == requests->size ())
+	    break;
+	  return false;
+	}
+
+      putpkt (rs->buf);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+      if (packet_ok (rs->buf, &remote_protocol_packets[PACKET_qMemReadV])
+	  != PACKET_OK)
+	return false;
+
+      std::vector<gdb::byte_vector> blocks;
+      std::vector<bool> failed;
+
+      if (!parse_memory_vector_reply (rs->buf, &blocks, &failed)
+	  || blocks.size () > pieces.size ())
+	return false;
+
+      next = i;
+      next_offset = offset;
+      for (size_t k = 0; k < blocks.size (); k++)
+	{
+	  memory_read_request &req = (*requests)[pieces[k].first];
+	  ULONGEST want = pieces[k].second;
+	  ULONGEST got = std::min ((ULONGEST) blocks[k].size (), want);
+
+	  req.data.insert (req.data.end (), blocks[k].begin (),
+			   blocks[k].begin () + got);
+	  if (failed[k])
+	    req.failed = true;
+
+	  /* Don't ask for the rest of a block that ended early.  */
+	  if (got < want && pieces[k].first == next && next_offset != 0)
+	    {
+	      next++;
+	      next_offset = 0;
+	    }
+	}
+
+      /* The stub left out the blocks that didn't fit in its reply.  */
+      if (blocks.size () < pieces.size () && next_offset != 0)
+	{
+	  next++;
+	  next_offset = 0;
+	}
+    }
+
+  return true;
+}
+
+/* Implementation of to_read_memory_chain.  Let the stub follow the
+   pointers, asking for as many nodes per qMemReadV packet as fit in
+   the reply.  */
+
+bool
+remote_target::read_memory_chain (CORE_ADDR addr, ULONGEST len,
+				  ULONGEST next_offset, int max_count,
+				  std::vector<gdb::byte_vector> *nodes)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct gdbarch *gdbarch = target_gdbarch ();
+  int ptr_size = gdbarch_ptr_bit (gdbarch) / TARGET_CHAR_BIT;
+  long per_reply = (get_memory_read_packet_size () - 1) / (1 + 2 * len);
+  CORE_ADDR node = addr;
+
+  if ((ptr_size != 1 && ptr_size != 2 && ptr_size != 4 && ptr_size != 8)
+      || per_reply == 0
+      || !can_read_memory_vector ())
+    return false;
+
+  while (nodes->size () < (size_t) max_count)
+    {
+      long count = std::min ((long) (max_count - nodes->size ()), per_reply);
+      std::vector<gdb::byte_vector> blocks;
+
+      xsnprintf (rs->buf, get_remote_packet_size (),
+		 "qMemReadV:follow:%s,%x,%lx,%s:%s,%s",
+		 phex_nz (next_offset, sizeof (next_offset)), ptr_size, count,
+		 phex_nz (addr, sizeof (addr)),
+		 phex_nz (remote_address_masked (node), sizeof (node)),
+		 phex_nz (len, sizeof (len)));
+      putpkt (rs->buf);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+      if (packet_ok (rs->buf, &remote_protocol_packets[PACKET_qMemReadV])
+	  != PACKET_OK
+	  || !parse_memory_vector_reply (rs->buf, &blocks, NULL)
+	  || blocks.size () > (size_t) count)
+	return false;
+
+      for (gdb::byte_vector &block : blocks)
+	{
+	  if (block.size () > len)
+	    block.resize (len);
+	  nodes->push_back (std::move (block));
+	}
+
+      /* The stub stops at a null pointer, a pointer back to ADDR, or
+	 memory it can't read.  */
+      if (blocks.size () < (size_t) count || nodes->back ().size () < len)
+	break;
+
+      node = extract_unsigned_integer (nodes->back ().data () + next_offset,
+				       ptr_size, gdbarch_byte_order (gdbarch));
+      if (node == 0 || node == addr)
+	break;
+    }
+
+  return true;
+}
+
 int
 remote_target::search_memory (CORE_ADDR start_addr, ULONGEST search_space_len,
 			      const gdb_byte *pattern, ULONGEST pattern_len,
@@ -11291,6 +12239,112 @@ remote_target::packet_command (const char *args, int from_tty)
   puts_filtered ("\n");
 }
 
+/* Implement the "maint info remote-stats" command.  */
+
+static void
+maintenance_info_remote_stats (const char *args, int from_tty)
+{
+  remote_target *remote = get_current_remote_target ();
+  bool json = false, reset = false;
+
+  if (remote == nullptr)
+    error (_("command can only be used with remote target"));
+
+  gdb_argv argv (args);
+  for (int i = 0; i < argv.count (); i++)
+    {
+      const char *arg = argv[i];
+
+      if (strcmp (arg, "json") == 0)
+	json = true;
+      else if (strcmp (arg, "reset") == 0)
+	reset = true;
+      else
+	error (_("Unrecognized argument: %s"), arg);
+    }
+
+  remote_state *rs = remote->get_remote_state ();
+
+  if (json)
+    puts_filtered (rsp_stats_to_json (rs->stats).c_str ());
+  else if (rs->stats.empty ())
+    current_uiout->message (_("No packets exchanged.\n"));
+  else
+    {
+      struct ui_out *uiout = current_uiout;
+
+      /* Show the packet types that cost the most first.  */
+      std::vector<const rsp_stats::value_type *> rows;
+      for (const auto &entry : rs->stats)
+	rows.push_back (&entry);
+      std::stable_sort (rows.begin (), rows.end (),
+			[] (const rsp_stats::value_type *a,
+			    const rsp_stats::value_type *b)
+			{
+			  return (a->second.total_latency
+				  > b->second.total_latency);
+			});
+
+      std::string buckets;
+      for (const char *name : rsp_latency_bucket_names)
+	{
+	  if (!buckets.empty ())
+	    buckets += '/';
+	  buckets += name;
+	}
+
+      ui_out_emit_table table_emitter (uiout, 9, rows.size (),
+				       "remote-stats");
+      uiout->table_header (24, ui_left, "type", "Packet");
+      uiout->table_header (8, ui_right, "count", "Count");
+      uiout->table_header (10, ui_right, "bytes-out", "Bytes out");
+      uiout->table_header (10, ui_right, "bytes-in", "Bytes in");
+      uiout->table_header (12, ui_right, "total-latency", "Total us");
+      uiout->table_header (9, ui_right, "average-latency", "Avg us");
+      uiout->table_header (9, ui_right, "max-latency", "Max us");
+      uiout->table_header (12, ui_right, "wait", "Wait us");
+      uiout->table_header (buckets.size (), ui_left, "latency-histogram",
+			   buckets.c_str ());
+      uiout->table_body ();
+
+      for (const rsp_stats::value_type *row : rows)
+	{
+	  const rsp_packet_stats &ps = row->second;
+	  LONGEST total = rsp_duration_us (ps.total_latency);
+	  std::string histogram;
+
+	  for (ULONGEST n : ps.latency_histogram)
+	    {
+	      if (!histogram.empty ())
+		histogram += '/';
+	      histogram += pulongest (n);
+	    }
+
+	  ui_out_emit_tuple tuple_emitter (uiout, NULL);
+	  uiout->field_string ("type", row->first.c_str ());
+	  uiout->field_string ("count", pulongest (ps.count));
+	  uiout->field_string ("bytes-out", pulongest (ps.bytes_out));
+	  uiout->field_string ("bytes-in", pulongest (ps.bytes_in));
+	  uiout->field_string ("total-latency", plongest (total));
+	  uiout->field_string ("average-latency",
+			       plongest (ps.replies != 0
+					 ? total / (LONGEST) ps.replies : 0));
+	  uiout->field_string ("max-latency",
+			       plongest (rsp_duration_us (ps.max_latency)));
+	  uiout->field_string ("wait",
+			       plongest (rsp_duration_us (ps.wait_time)));
+	  uiout->field_string ("latency-histogram", histogram.c_str ());
+	  uiout->text ("\n");
+	}
+    }
+
+  if (reset)
+    {
+      rs->stats.clear ();
+      rs->pending_requests.clear ();
+    }
+}
+
 #if 0
 /* --------- UNIT_TEST for THREAD oriented PACKETS ------------------- */
 
@@ -11880,7 +12934,7 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
 void
 readahead_cache::invalidate ()
 {
-  this->fd = -1;
+  this->blocks.clear ();
 }
 
 /* See declaration.h.  */
@@ -11888,8 +12942,10 @@ readahead_cache::invalidate ()
 void
 readahead_cache::invalidate_fd (int fd)
 {
-  if (this->fd == fd)
-    this->fd = -1;
+  this->blocks.remove_if ([=] (const block &b)
+    {
+      return b.fd == fd;
+    });
 }
 
 /* Set the filesystem remote_hostio functions that take FILENAME
@@ -12064,22 +13120,37 @@ int
 readahead_cache::pread (int fd, gdb_byte *read_buf, size_t len,
 			ULONGEST offset)
 {
-  if (this->fd == fd
-      && this->offset <= offset
-      && offset < this->offset + this->bufsize)
-    {
-      ULONGEST max = this->offset + this->bufsize;
+  for (auto it = this->blocks.begin (); it != this->blocks.end (); ++it)
+    if (it->fd == fd
+	&& it->offset <= offset
+	&& offset < it->offset + it->data.size ())
+      {
+	ULONGEST max = it->offset + it->data.size ();
 
-      if (offset + len > max)
-	len = max - offset;
+	if (offset + len > max)
+	  len = max - offset;
 
-      memcpy (read_buf, this->buf + offset - this->offset, len);
-      return len;
-    }
+	memcpy (read_buf, it->data.data () + offset - it->offset, len);
+
+	/* Keep the block most recently used first.  */
+	this->blocks.splice (this->blocks.begin (), this->blocks, it);
+	return len;
+      }
 
   return 0;
 }
 
+/* See declaration.h.  */
+
+void
+readahead_cache::add (int fd, ULONGEST offset, gdb::byte_vector &&data)
+{
+  if (this->blocks.size () >= READAHEAD_CACHE_BLOCKS)
+    this->blocks.pop_back ();
+
+  this->blocks.push_front ({fd, offset, std::move (data)});
+}
+
 /* Implementation of to_fileio_pread.  */
 
 int
@@ -12106,20 +13177,15 @@ remote_target::remote_hostio_pread (int fd, gdb_byte *read_buf, int len,
     fprintf_unfiltered (gdb_stdlog, "readahead cache miss %s\n",
 			pulongest (cache->miss_count));
 
-  cache->fd = fd;
-  cache->offset = offset;
-  cache->bufsize = get_remote_packet_size ();
-  cache->buf = (gdb_byte *) xrealloc (cache->buf, cache->bufsize);
+  gdb::byte_vector data (get_remote_packet_size ());
 
-  ret = remote_hostio_pread_vFile (cache->fd, cache->buf, cache->bufsize,
-				   cache->offset, remote_errno);
+  ret = remote_hostio_pread_vFile (fd, data.data (), data.size (),
+				   offset, remote_errno);
   if (ret <= 0)
-    {
-      cache->invalidate_fd (fd);
-      return ret;
-    }
+    return ret;
 
-  cache->bufsize = ret;
+  data.resize (ret);
+  cache->add (fd, offset, std::move (data));
   return cache->pread (fd, read_buf, len, offset);
 }
 
@@ -13963,6 +15029,14 @@ remote_target::load (const char *name, int from_tty)
   generic_load (name, from_tty);
 }
 
+/* Implementation of to_connection_string.  */
+
+const char *
+remote_target::connection_string ()
+{
+  return get_remote_state ()->connection_name.c_str ();
+}
+
 /* Accepts an integer PID; returns a string representing a file that
    can be opened on the remote side to get the symbols for the child
    process.  Returns NULL if the operation is not supported.  */
@@ -14367,6 +15441,16 @@ response packet.  GDB supplies the initial `$' character, and the\n\
 terminating `#' character and checksum."),
 	   &maintenancelist);
 
+  add_cmd ("remote-stats", class_maintenance, maintenance_info_remote_stats,
+	   _("\
+Show statistics about the packets exchanged with the remote target.\n\
+Usage: maintenance info remote-stats [json] [reset]\n\
+For each type of packet, show how many were sent, the bytes sent and\n\
+received, the round-trip latencies and the time spent waiting for\n\
+replies, most expensive first.  With \"json\", print them in JSON\n\
+instead.  With \"reset\", clear them afterwards."),
+	   &maintenanceinfolist);
+
   add_setshow_boolean_cmd ("remotebreak", no_class, &remote_break, _("\
 Set whether to send break if interrupted."), _("\
 Show whether to send break if interrupted."), _("\
@@ -14431,6 +15515,19 @@ further restriction and ``limit'' to enable that restriction."),
 	   _("Show the maximum number of bytes per memory-read packet."),
 	   &remote_show_cmdlist);
 
+  add_setshow_zuinteger_cmd ("memory-read-window", no_class,
+			     &remote_memory_read_window, _("\
+Set the number of memory read packets that may be outstanding at once."),
+			     _("\
+Show the number of memory read packets that may be outstanding at once."),
+			     _("\
+When reading a block of memory that does not fit in one packet, GDB\n\
+sends up to this many read requests before waiting for their replies.\n\
+This is only done when the remote connection does not use\n\
+acknowledgments.  A value of 0 or 1 sends one request at a time."),
+			     NULL, NULL,
+			     &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zinteger_cmd ("hardware-watchpoint-limit", no_class,
 			    &remote_hw_watchpoint_limit, _("\
 Set the maximum number of target hardware watchpoints."), _("\
@@ -14725,6 +15822,24 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_no_resumed],
 			 "N stop reply", "no-resumed-stop-reply", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_x],
+			 "x", "binary-upload", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_qMemReadV],
+			 "qMemReadV", "read-memory-vector", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_compression],
+			 "compression", "compression", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_thread_list_delta],
+			 "thread-list-delta", "thread-list-delta", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_qAllRegisters],
+			 "qAllRegisters", "all-registers", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_compact_libraries_svr4],
+			 "compact-libraries-svr4", "compact-libraries-svr4", 0);
+
   /* Assert that we've registered "set remote foo-packet" commands
      for all packet configs.  */
   {
@@ -186,6 +186,30 @@ svr4_same (struct so_list *gdb, struct so_list *inferior)
   return (svr4_same_1 (gdb->so_original_name, inferior->so_original_name));
 }
 
+/* Decode LM, the contents of the link map entry at LM_ADDR.  */
+
+static std::unique_ptr<lm_info_svr4>
+lm_info_decode (CORE_ADDR lm_addr, const gdb_byte *lm)
+{
+  struct link_map_offsets *lmo = svr4_fetch_link_map_offsets ();
+  struct type *ptr_type = builtin_type (target_gdbarch ())->builtin_data_ptr;
+  std::unique_ptr<lm_info_svr4> lm_info (new lm_info_svr4);
+
+  lm_info->lm_addr = lm_addr;
+
+  lm_info->l_addr_inferior = extract_typed_address (&lm[lmo->l_addr_offset],
+						    ptr_type);
+  lm_info->l_ld = extract_typed_address (&lm[lmo->l_ld_offset], ptr_type);
+  lm_info->l_next = extract_typed_address (&lm[lmo->l_next_offset],
+					   ptr_type);
+  lm_info->l_prev = extract_typed_address (&lm[lmo->l_prev_offset],
+					   ptr_type);
+  lm_info->l_name = extract_typed_address (&lm[lmo->l_name_offset],
+					   ptr_type);
+
+  return lm_info;
+}
+
 static std::unique_ptr<lm_info_svr4>
 lm_info_read (CORE_ADDR lm_addr)
 {
@@ -198,22 +222,7 @@ lm_info_read (CORE_ADDR lm_addr)
     warning (_("Error reading shared library list entry at %s"),
 	     paddress (target_gdbarch (), lm_addr));
   else
-    {
-      struct type *ptr_type = builtin_type (target_gdbarch ())->builtin_data_ptr;
-
-      lm_info.reset (new lm_info_svr4);
-      lm_info->lm_addr = lm_addr;
-
-      lm_info->l_addr_inferior = extract_typed_address (&lm[lmo->l_addr_offset],
-							ptr_type);
-      lm_info->l_ld = extract_typed_address (&lm[lmo->l_ld_offset], ptr_type);
-      lm_info->l_next = extract_typed_address (&lm[lmo->l_next_offset],
-					       ptr_type);
-      lm_info->l_prev = extract_typed_address (&lm[lmo->l_prev_offset],
-					       ptr_type);
-      lm_info->l_name = extract_typed_address (&lm[lmo->l_name_offset],
-					       ptr_type);
-    }
+    lm_info = lm_info_decode (lm_addr, lm.data ());
 
   return lm_info;
 }
@@ -1121,6 +1130,120 @@ svr4_copy_library_list (struct so_list *src)
   return dst;
 }
 
+/* Add the library NAME, whose link map entry at LM holds L_ADDR and
+   L_LD, at the tail of LIST, keeping the list in order.  */
+
+static void
+svr4_library_list_add (struct svr4_library_list *list, const char *name,
+		       CORE_ADDR lm, CORE_ADDR l_addr, CORE_ADDR l_ld)
+{
+  struct so_list *new_elem;
+
+  new_elem = XCNEW (struct so_list);
+  lm_info_svr4 *li = new lm_info_svr4;
+  new_elem->lm_info = li;
+  li->lm_addr = lm;
+  li->l_addr_inferior = l_addr;
+  li->l_ld = l_ld;
+
+  strncpy (new_elem->so_name, name, sizeof (new_elem->so_name) - 1);
+  new_elem->so_name[sizeof (new_elem->so_name) - 1] = 0;
+  strcpy (new_elem->so_original_name, new_elem->so_name);
+
+  *list->tailp = new_elem;
+  list->tailp = &new_elem->next;
+}
+
+/* The first line of the compact form of the library list that remote
+   stubs may send instead of XML.  Each following line describes the
+   main executable's link map entry ("m LM") or a library ("l LM L_ADDR
+   L_LD NAME"); the numbers are in hex, and backslashes and newlines in
+   NAME are escaped with a backslash.  */
+
+#define SVR4_COMPACT_HEADER "library-list-svr4-compact 1\n"
+
+/* Parse the compact form of the library list DOCUMENT into *LIST.
+   Return 1 if *LIST contains the library list, it may be empty, caller
+   is responsible for freeing all its entries.  Return 0 if DOCUMENT is
+   malformed.  */
+
+static int
+svr4_parse_libraries_compact (const char *document,
+			      struct svr4_library_list *list)
+{
+  struct cleanup *back_to = make_cleanup (svr4_free_library_list,
+					  &list->head);
+  const char *p = document + strlen (SVR4_COMPACT_HEADER);
+
+  memset (list, 0, sizeof (*list));
+  list->tailp = &list->head;
+
+  for (;;)
+    {
+      if (*p == '\0')
+	{
+	  /* Parsed successfully, keep the result.  */
+	  discard_cleanups (back_to);
+	  return 1;
+	}
+
+      char kind = *p++;
+
+      if (*p != ' ')
+	break;
+      p++;
+
+      if (kind == 'm')
+	list->main_lm = strtoulst (p, &p, 16);
+      else if (kind == 'l')
+	{
+	  CORE_ADDR lm, l_addr, l_ld;
+	  std::string name;
+
+	  lm = strtoulst (p, &p, 16);
+	  if (*p != ' ')
+	    break;
+	  p++;
+	  l_addr = strtoulst (p, &p, 16);
+	  if (*p != ' ')
+	    break;
+	  p++;
+	  l_ld = strtoulst (p, &p, 16);
+	  if (*p != ' ')
+	    break;
+	  p++;
+
+	  for (; *p != '\n' && *p != '\0'; p++)
+	    {
+	      if (*p == '\\' && p[1] == 'n')
+		{
+		  name += '\n';
+		  p++;
+		}
+	      else if (*p == '\\' && p[1] == '\\')
+		{
+		  name += '\\';
+		  p++;
+		}
+	      else
+		name += *p;
+	    }
+
+	  svr4_library_list_add (list, name.c_str (), lm, l_addr, l_ld);
+	}
+      else
+	break;
+
+      if (*p != '\n')
+	break;
+      p++;
+    }
+
+  warning (_("Malformed target library list"));
+  do_cleanups (back_to);
+  return 0;
+}
+
 #ifdef HAVE_LIBEXPAT
 
 #include "xml-support.h"
@@ -1143,21 +1266,8 @@ library_list_start_library (struct gdb_xml_parser *parser,
     = (ULONGEST *) xml_find_attribute (attributes, "l_addr")->value.get ();
   ULONGEST *l_ldp
     = (ULONGEST *) xml_find_attribute (attributes, "l_ld")->value.get ();
-  struct so_list *new_elem;
-
-  new_elem = XCNEW (struct so_list);
-  lm_info_svr4 *li = new lm_info_svr4;
-  new_elem->lm_info = li;
-  li->lm_addr = *lmp;
-  li->l_addr_inferior = *l_addrp;
-  li->l_ld = *l_ldp;
-
-  strncpy (new_elem->so_name, name, sizeof (new_elem->so_name) - 1);
-  new_elem->so_name[sizeof (new_elem->so_name) - 1] = 0;
-  strcpy (new_elem->so_original_name, new_elem->so_name);
 
-  *list->tailp = new_elem;
-  list->tailp = &new_elem->next;
+  svr4_library_list_add (list, name, *lmp, *l_addrp, *l_ldp);
 }
 
 /* Handle the start of a <library-list-svr4> element.  */
@@ -1244,6 +1354,8 @@ svr4_parse_libraries (const char *document, struct svr4_library_list *list)
   return 0;
 }
 
+#endif
+
 /* Attempt to get so_list from target via qXfer:libraries-svr4:read packet.
 
    Return 0 if packet not supported, *SO_LIST_RETURN is not modified in such
@@ -1267,19 +1379,16 @@ svr4_current_sos_via_xfer_libraries (struct svr4_library_list *list,
   if (!svr4_library_document)
     return 0;
 
-  return svr4_parse_libraries (svr4_library_document->data (), list);
-}
+  if (startswith (svr4_library_document->data (), SVR4_COMPACT_HEADER))
+    return svr4_parse_libraries_compact (svr4_library_document->data (),
+					 list);
 
+#ifdef HAVE_LIBEXPAT
+  return svr4_parse_libraries (svr4_library_document->data (), list);
 #else
-
-static int
-svr4_current_sos_via_xfer_libraries (struct svr4_library_list *list,
-				     const char *annex)
-{
   return 0;
-}
-
 #endif
+}
 
 /* If no shared library information is available from the dynamic
    linker, build a fallback list from other sources.  */
@@ -1316,21 +1425,110 @@ svr4_default_sos (void)
    entries stored to LINK_PTR_PTR are still valid although they may
    represent only part of the inferior library list.  */
 
+/* The number of link map entries that svr4_read_so_list reads
+   ahead.  */
+#define SVR4_SO_LIST_BATCH 256
+
+/* Read up to SVR4_SO_LIST_BATCH entries of the inferior libraries
+   chain starting at address LM into ENTRIES, and the start of their
+   names into NAMES.  A remote target that supports it reads each in a
+   single round trip, instead of several per library.  Entries that
+   can't be read whole are left out; svr4_read_so_list reads those one
+   at a time, which also reports the errors.  */
+
+static void
+svr4_read_so_list_batch (CORE_ADDR lm,
+			 std::vector<std::unique_ptr<lm_info_svr4>> *entries,
+			 std::vector<memory_read_request> *names)
+{
+  struct link_map_offsets *lmo = svr4_fetch_link_map_offsets ();
+  struct gdbarch *gdbarch = target_gdbarch ();
+  int ptr_size = gdbarch_ptr_bit (gdbarch) / TARGET_CHAR_BIT;
+  std::vector<gdb::byte_vector> nodes
+    = target_read_memory_chain (lm, lmo->link_map_size, lmo->l_next_offset,
+				SVR4_SO_LIST_BATCH);
+
+  entries->clear ();
+  names->clear ();
+  for (const gdb::byte_vector &node : nodes)
+    {
+      if (node.size () < lmo->link_map_size)
+	break;
+
+      std::unique_ptr<lm_info_svr4> li = lm_info_decode (lm, node.data ());
+
+      names->emplace_back (li->l_name, SO_NAME_MAX_PATH_SIZE - 1);
+      entries->push_back (std::move (li));
+
+      /* The target followed the raw pointer; stop if l_next means
+	 something else.  */
+      lm = extract_unsigned_integer (&node[lmo->l_next_offset], ptr_size,
+				     gdbarch_byte_order (gdbarch));
+      if (entries->back ()->l_next != lm)
+	break;
+    }
+
+  target_read_memory_vector (*names);
+}
+
+/* Set *BUFFER to the string at the start of NAME, read by
+   svr4_read_so_list_batch, and return true.  Return false if NAME
+   does not hold the whole string, up to the SO_NAME_MAX_PATH_SIZE - 1
+   bytes that target_read_string would read.  */
+
+static bool
+svr4_so_name_from_batch (const memory_read_request &name,
+			 gdb::unique_xmalloc_ptr<char> *buffer)
+{
+  const gdb_byte *data = name.data.data ();
+  const gdb_byte *nul
+    = (const gdb_byte *) memchr (data, 0, name.data.size ());
+  size_t len;
+
+  if (nul != NULL)
+    len = nul - data;
+  else if (name.data.size () == name.len)
+    len = name.len;
+  else
+    return false;
+
+  buffer->reset ((char *) xmalloc (len + 1));
+  memcpy (buffer->get (), data, len);
+  buffer->get ()[len] = '\0';
+  return true;
+}
+
 static int
 svr4_read_so_list (CORE_ADDR lm, CORE_ADDR prev_lm,
 		   struct so_list ***link_ptr_ptr, int ignore_first)
 {
   CORE_ADDR first_l_name = 0;
   CORE_ADDR next_lm;
+  std::vector<std::unique_ptr<lm_info_svr4>> entries;
+  std::vector<memory_read_request> names;
+  size_t index = 0;
 
-  for (; lm != 0; prev_lm = lm, lm = next_lm)
+  for (; lm != 0; prev_lm = lm, lm = next_lm, index++)
     {
       int errcode;
       gdb::unique_xmalloc_ptr<char> buffer;
 
       so_list_up newobj (XCNEW (struct so_list));
 
-      lm_info_svr4 *li = lm_info_read (lm).release ();
+      if (index == entries.size ())
+	{
+	  svr4_read_so_list_batch (lm, &entries, &names);
+	  index = 0;
+	}
+
+      lm_info_svr4 *li;
+      bool batched = (index < entries.size ()
+		      && entries[index]->lm_addr == lm);
+
+      if (batched)
+	li = entries[index].release ();
+      else
+	li = lm_info_read (lm).release ();
       newobj->lm_info = li;
       if (li == NULL)
 	return 0;
@@ -1360,8 +1558,11 @@ svr4_read_so_list (CORE_ADDR lm, CORE_ADDR prev_lm,
 	}
 
       /* Extract this shared object's name.  */
-      target_read_string (li->l_name, &buffer, SO_NAME_MAX_PATH_SIZE - 1,
-			  &errcode);
+      if (batched && svr4_so_name_from_batch (names[index], &buffer))
+	errcode = 0;
+      else
+	target_read_string (li->l_name, &buffer, SO_NAME_MAX_PATH_SIZE - 1,
+			    &errcode);
       if (errcode != 0)
 	{
 	  /* If this entry's l_name address matches that of the
@@ -2605,6 +2806,43 @@ struct pip_gdbif_task_info {
   int pgt_gdb_status;
 };
 
+/* Decode PGT, the contents of the PiP gdbif task entry at PGT_ADDR.  */
+
+static struct pip_gdbif_task_info *
+pip_gdbif_task_info_decode (CORE_ADDR pgt_addr, const gdb_byte *pgt)
+{
+  struct pip_gdbif_task_info *pgt_info;
+  struct type *ptr_type =
+    builtin_type (target_gdbarch ())->builtin_data_ptr;
+  enum bfd_endian byte_order = gdbarch_byte_order (target_gdbarch ());
+
+  pgt_info = (pip_gdbif_task_info *)xzalloc (sizeof (*pgt_info));
+  pgt_info->pgt_addr = pgt_addr;
+
+  /* XXX these offsets are for LP64 platform only. -- FIXED by AH 2020/03/19 */
+  pgt_info->pgt_next = extract_typed_address (&pgt[PIP_GDBIF_TASK_OFFSET_NEXT], ptr_type);
+  pgt_info->pgt_prev = extract_typed_address (&pgt[PIP_GDBIF_TASK_OFFSET_PREV], ptr_type);
+  pgt_info->pgt_root = extract_typed_address (&pgt[PIP_GDBIF_TASK_ROOT], ptr_type);
+  pgt_info->pgt_pathname = extract_typed_address (&pgt[PIP_GDBIF_TASK_PATHNAME], ptr_type);
+  pgt_info->pgt_realpathname = extract_typed_address (&pgt[PIP_GDBIF_TASK_REALPATHNAME], ptr_type);
+  pgt_info->pgt_argc = extract_signed_integer (&pgt[PIP_GDBIF_TASK_ARGC], 4, byte_order);
+  pgt_info->pgt_argv = extract_typed_address (&pgt[PIP_GDBIF_TASK_ARGV], ptr_type);
+  pgt_info->pgt_envv = extract_typed_address (&pgt[PIP_GDBIF_TASK_ENVV], ptr_type);
+  pgt_info->pgt_handle = extract_typed_address (&pgt[PIP_GDBIF_TASK_HANDLE], ptr_type);
+  pgt_info->pgt_load_address = extract_typed_address (&pgt[PIP_GDBIF_TASK_LOAD_ADDRESS], ptr_type);
+  pgt_info->pgt_pid = extract_signed_integer (&pgt[PIP_GDBIF_TASK_PID], 4, byte_order);
+  pgt_info->pgt_pipid = extract_signed_integer (&pgt[PIP_GDBIF_TASK_PIPID], 4, byte_order);
+  pgt_info->pgt_exit_code =
+    extract_signed_integer (&pgt[PIP_GDBIF_TASK_EXIT_CODE], 4, byte_order);
+  pgt_info->pgt_exec_mode =
+    extract_signed_integer (&pgt[PIP_GDBIF_TASK_EXEC_MODE], 4, byte_order);
+  pgt_info->pgt_status = extract_signed_integer (&pgt[PIP_GDBIF_TASK_STATUS], 4, byte_order);
+  pgt_info->pgt_gdb_status =
+    extract_signed_integer (&pgt[PIP_GDBIF_TASK_GDB_STATUS], 4, byte_order);
+
+  return pgt_info;
+}
+
 static struct pip_gdbif_task_info *
 pip_gdbif_task_info_read (CORE_ADDR pgt_addr)
 {
@@ -2625,35 +2863,7 @@ pip_gdbif_task_info_read (CORE_ADDR pgt_addr)
       pgt_info = NULL;
     }
   else
-    {
-      struct type *ptr_type =
-	builtin_type (target_gdbarch ())->builtin_data_ptr;
-      enum bfd_endian byte_order = gdbarch_byte_order (target_gdbarch ());
-
-      pgt_info = (pip_gdbif_task_info *)xzalloc (sizeof (*pgt_info));
-      pgt_info->pgt_addr = pgt_addr;
-
-      /* XXX these offsets are for LP64 platform only. -- FIXED by AH 2020/03/19 */
-      pgt_info->pgt_next = extract_typed_address (&pgt[PIP_GDBIF_TASK_OFFSET_NEXT], ptr_type);
-      pgt_info->pgt_prev = extract_typed_address (&pgt[PIP_GDBIF_TASK_OFFSET_PREV], ptr_type);
-      pgt_info->pgt_root = extract_typed_address (&pgt[PIP_GDBIF_TASK_ROOT], ptr_type);
-      pgt_info->pgt_pathname = extract_typed_address (&pgt[PIP_GDBIF_TASK_PATHNAME], ptr_type);
-      pgt_info->pgt_realpathname = extract_typed_address (&pgt[PIP_GDBIF_TASK_REALPATHNAME], ptr_type);
-      pgt_info->pgt_argc = extract_signed_integer (&pgt[PIP_GDBIF_TASK_ARGC], 4, byte_order);
-      pgt_info->pgt_argv = extract_typed_address (&pgt[PIP_GDBIF_TASK_ARGV], ptr_type);
-      pgt_info->pgt_envv = extract_typed_address (&pgt[PIP_GDBIF_TASK_ENVV], ptr_type);
-      pgt_info->pgt_handle = extract_typed_address (&pgt[PIP_GDBIF_TASK_HANDLE], ptr_type);
-      pgt_info->pgt_load_address = extract_typed_address (&pgt[PIP_GDBIF_TASK_LOAD_ADDRESS], ptr_type);
-      pgt_info->pgt_pid = extract_signed_integer (&pgt[PIP_GDBIF_TASK_PID], 4, byte_order);
-      pgt_info->pgt_pipid = extract_signed_integer (&pgt[PIP_GDBIF_TASK_PIPID], 4, byte_order);
-      pgt_info->pgt_exit_code =
-	extract_signed_integer (&pgt[PIP_GDBIF_TASK_EXIT_CODE], 4, byte_order);
-      pgt_info->pgt_exec_mode =
-	extract_signed_integer (&pgt[PIP_GDBIF_TASK_EXEC_MODE], 4, byte_order);
-      pgt_info->pgt_status = extract_signed_integer (&pgt[PIP_GDBIF_TASK_STATUS], 4, byte_order);
-      pgt_info->pgt_gdb_status =
-	extract_signed_integer (&pgt[PIP_GDBIF_TASK_GDB_STATUS], 4, byte_order);
-    }
+    pgt_info = pip_gdbif_task_info_decode (pgt_addr, pgt);
 
   do_cleanups (back_to);
 
@@ -2828,12 +3038,18 @@ unattached_pip_task_list_foreach (void (*doit)(int))
   do_cleanups (old_chain);
 }
 
+/* The number of PiP gdbif task entries that pip_scan_inferiors reads
+   ahead.  */
+#define PIP_SCAN_TASKS_BATCH 1024
+
 int
 pip_scan_inferiors (void)
 {
   struct pip_gdbif_root_info *pgr_info = pip_gdbif_root_read ();
   struct pip_gdbif_task_info *pgt_info;
   CORE_ADDR pgt_addr;
+  std::vector<struct inferior *> attached;
+  int root_pid = 0;
 
   if (pgr_info == NULL)
     return 0;
@@ -2841,14 +3057,31 @@ pip_scan_inferiors (void)
   unattached_pip_task_list_clear (NULL);
 
   pgt_addr = pgr_info->pgr_task_root_addr;
+
+  /* Read the task list ahead; a remote target that supports it
+     follows the links itself, in a single round trip.  */
+  std::vector<gdb::byte_vector> tasks
+    = target_read_memory_chain (pgt_addr, PIP_GDBIF_TASK_SIZE,
+				PIP_GDBIF_TASK_OFFSET_NEXT,
+				PIP_SCAN_TASKS_BATCH);
+  size_t index = 0;
+
   do {
-    pgt_info = pip_gdbif_task_info_read (pgt_addr);
+    if (index < tasks.size ()
+	&& tasks[index].size () == PIP_GDBIF_TASK_SIZE)
+      pgt_info = pip_gdbif_task_info_decode (pgt_addr, tasks[index].data ());
+    else
+      pgt_info = pip_gdbif_task_info_read (pgt_addr);
     if (pgt_info == NULL)
       break;
+    index++;
     if (svr4_debug)
       fprintf_unfiltered (gdb_stdlog, "PiP debug: pip_gdbif pid:%d pipid:%d\n",
 			  (int)pgt_info->pgt_pid, (int)pgt_info->pgt_pipid);
 
+    if (pgt_info->pgt_pipid == PIP_GDBIF_PIPID_ROOT)
+      root_pid = pgt_info->pgt_pid;
+
     if (pgt_info->pgt_pipid != PIP_GDBIF_PIPID_ANY)
       {
 	struct inferior *inf;
@@ -2864,6 +3097,7 @@ pip_scan_inferiors (void)
             if (inf->pid == pgt_info->pgt_pid)
 	      {
 		already_attached = 1;
+		attached.push_back (inf);
 
 		/* not initialized yet? */
 		if (inf->pipid == PIP_GDBIF_PIPID_ANY)
@@ -2897,6 +3131,13 @@ pip_scan_inferiors (void)
   } while (pgt_addr != pgr_info->pgr_task_root_addr &&
 	   pgt_addr != 0 /* fail safe */);
 
+  /* Only the root task has the PiP root structure; this is it if its
+     own entry was not found.  */
+  if (root_pid <= 0)
+    root_pid = inferior_ptid.pid ();
+  for (struct inferior *inf : attached)
+    inf->pip_root_pid = root_pid;
+
   xfree (pgr_info);
   return 1;
 }
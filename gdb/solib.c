@@ -47,6 +47,9 @@
 #include "gdb_bfd.h"
 #include "filestuff.h"
 #include "source.h"
+#include "build-id.h"
+#include "gdb/fileio.h"
+#include "common/byte-vector.h"
 
 /* Architecture-specific operations.  */
 
@@ -105,6 +108,19 @@ show_solib_search_path (struct ui_file *file, int from_tty,
 		    value);
 }
 
+/* If non-empty, the directory in which copies of the shared libraries
+   read from the target are kept, so that they need not be read from
+   it again.  */
+static char *solib_cache_directory = NULL;
+static void
+show_solib_cache_directory (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("The directory for copies of shared libraries "
+			    "read from the target is %s.\n"),
+		    value);
+}
+
 /* Same as HAVE_DOS_BASED_FILE_SYSTEM, but useable as an rvalue.  */
 #if (HAVE_DOS_BASED_FILE_SYSTEM)
 #  define DOS_BASED_FILE_SYSTEM 1
@@ -475,6 +491,274 @@ solib_bfd_fopen (const char *pathname, int fd)
   return abfd;
 }
 
+/* Return the name of the copy of the target file FILENAME, whose
+   build-id is BUILD_ID, in solib_cache_directory.  The copies are kept
+   in a subdirectory for each connection, as two targets may have
+   different files under the same name.  FILENAME comes from the
+   target, so empty and "." components are dropped, and an empty
+   string is returned if it has ".." components, which could otherwise
+   name a file outside of solib_cache_directory.  */
+
+static std::string
+solib_cache_filename (const char *filename,
+		      const struct bfd_build_id *build_id)
+{
+  std::string name = solib_cache_directory;
+  const char *connection = current_top_target ()->connection_string ();
+  const char *p = filename;
+
+  if (connection == NULL || *connection == '\0')
+    connection = target_shortname;
+
+  /* The connection may be a command line, for instance; keep only the
+     characters that are safe in a file name.  */
+  name += '/';
+  for (const char *c = connection; *c != '\0'; c++)
+    name += (isalnum ((unsigned char) *c) || *c == '.' || *c == '-'
+	     ? *c : '_');
+
+  while (*p != '\0')
+    {
+      const char *start = p;
+
+      while (*p != '\0' && !IS_DIR_SEPARATOR (*p))
+	p++;
+
+      size_t len = p - start;
+
+      if (len == 2 && start[0] == '.' && start[1] == '.')
+	return std::string ();
+      if (len != 0 && !(len == 1 && start[0] == '.'))
+	{
+	  name += '/';
+	  name.append (start, len);
+	}
+
+      while (IS_DIR_SEPARATOR (*p))
+	p++;
+    }
+
+  name += '.';
+  for (bfd_size_type i = 0; i < build_id->size; i++)
+    name += string_printf ("%02x", build_id->data[i]);
+
+  return name;
+}
+
+/* Copy the target file FILENAME to the local file CACHE_NAME, creating
+   the directories leading to it.  Return false, after warning, if
+   that fails.  An exception while reading the target file is passed
+   on, after removing the partial copy.  */
+
+static bool
+solib_cache_copy (const char *filename, const std::string &cache_name)
+{
+  for (size_t i = cache_name.find ('/', 1);
+       i != std::string::npos;
+       i = cache_name.find ('/', i + 1))
+    {
+      std::string dir = cache_name.substr (0, i);
+
+      if (mkdir (dir.c_str (), 0777) != 0 && errno != EEXIST)
+	{
+	  warning (_("Could not create directory \"%s\": %s"),
+		   dir.c_str (), safe_strerror (errno));
+	  return false;
+	}
+    }
+
+  int target_errno;
+  int fd = target_fileio_open (current_inferior (), filename,
+			       FILEIO_O_RDONLY, 0, &target_errno);
+  if (fd == -1)
+    return false;
+
+  /* Write to a temporary file first, so that an interrupted copy is
+     never mistaken for a complete one.  */
+  std::string temp_name = string_printf ("%s.%d", cache_name.c_str (),
+					 (int) getpid ());
+  gdb_file_up out = gdb_fopen_cloexec (temp_name.c_str (), "wb");
+  bool ok = out != NULL;
+
+  if (!ok)
+    warning (_("Could not create \"%s\": %s"),
+	     temp_name.c_str (), safe_strerror (errno));
+  else
+    {
+      gdb::byte_vector buf (64 * 1024);
+      ULONGEST offset = 0;
+
+      TRY
+	{
+	  for (;;)
+	    {
+	      int n = target_fileio_pread (fd, buf.data (), buf.size (),
+					   offset, &target_errno);
+
+	      if (n <= 0)
+		{
+		  ok = n == 0;
+		  break;
+		}
+	      if (fwrite (buf.data (), 1, n, out.get ()) != (size_t) n)
+		{
+		  ok = false;
+		  break;
+		}
+	      offset += n;
+	    }
+	}
+      CATCH (ex, RETURN_MASK_ALL)
+	{
+	  /* Don't leave the partial copy or the target file behind,
+	     e.g. if the user interrupted the copy.  */
+	  out.reset ();
+	  unlink (temp_name.c_str ());
+	  target_fileio_close (fd, &target_errno);
+	  throw_exception (ex);
+	}
+      END_CATCH
+
+      if (fclose (out.release ()) != 0)
+	ok = false;
+      if (ok && rename (temp_name.c_str (), cache_name.c_str ()) != 0)
+	ok = false;
+      if (!ok)
+	{
+	  warning (_("Could not copy \"%s\" to \"%s\""),
+		   filename, cache_name.c_str ());
+	  unlink (temp_name.c_str ());
+	}
+    }
+
+  target_fileio_close (fd, &target_errno);
+  return ok;
+}
+
+/* Open function for the BFDs returned by solib_cache_bfd_open, which
+   read the local file CACHE_NAME.  */
+
+static void *
+solib_cache_iovec_open (struct bfd *abfd, void *cache_name)
+{
+  int fd = gdb_open_cloexec ((const char *) cache_name, O_RDONLY | O_BINARY,
+			     0);
+
+  if (fd == -1)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return NULL;
+    }
+
+  int *stream = XNEW (int);
+
+  *stream = fd;
+  return stream;
+}
+
+/* Pread function for the BFDs returned by solib_cache_bfd_open.  */
+
+static file_ptr
+solib_cache_iovec_pread (struct bfd *abfd, void *stream, void *buf,
+			 file_ptr nbytes, file_ptr offset)
+{
+  int fd = *(int *) stream;
+  file_ptr pos = 0;
+
+  if (lseek (fd, offset, SEEK_SET) == -1)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return -1;
+    }
+
+  while (nbytes > pos)
+    {
+      ssize_t bytes = read (fd, (gdb_byte *) buf + pos, nbytes - pos);
+
+      if (bytes == 0)
+	break;
+      if (bytes == -1)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  bfd_set_error (bfd_error_system_call);
+	  return -1;
+	}
+      pos += bytes;
+    }
+
+  return pos;
+}
+
+/* Close function for the BFDs returned by solib_cache_bfd_open.  */
+
+static int
+solib_cache_iovec_close (struct bfd *abfd, void *stream)
+{
+  int fd = *(int *) stream;
+
+  xfree (stream);
+  close (fd);
+  return 0;
+}
+
+/* Stat function for the BFDs returned by solib_cache_bfd_open.  */
+
+static int
+solib_cache_iovec_fstat (struct bfd *abfd, void *stream, struct stat *sb)
+{
+  int result = fstat (*(int *) stream, sb);
+
+  if (result == -1)
+    bfd_set_error (bfd_error_system_call);
+  return result;
+}
+
+/* Return a BFD for the copy of ABFD, a shared library read from the
+   target, in solib_cache_directory, copying it there first if it is
+   not there yet.  The copy is looked up by the connection, file name
+   and build-id of ABFD, so that libraries are read from the target
+   only once even across sessions.  The BFD keeps the "target:" name of
+   ABFD, so that the library is shown, and its separate debug files
+   are looked for, as if it were read from the target.  Return NULL if
+   ABFD has no build-id or the copy cannot be used.  */
+
+static gdb_bfd_ref_ptr
+solib_cache_bfd_open (bfd *abfd)
+{
+  const struct bfd_build_id *build_id = build_id_bfd_shdr_get (abfd);
+
+  if (build_id == NULL)
+    return NULL;
+
+  const char *filename
+    = bfd_get_filename (abfd) + strlen (TARGET_SYSROOT_PREFIX);
+  std::string cache_name = solib_cache_filename (filename, build_id);
+  struct stat st;
+
+  if (cache_name.empty ())
+    return NULL;
+
+  if (stat (cache_name.c_str (), &st) != 0
+      && !solib_cache_copy (filename, cache_name))
+    return NULL;
+
+  gdb_bfd_ref_ptr cached
+    = gdb_bfd_openr_iovec (bfd_get_filename (abfd), gnutarget,
+			   solib_cache_iovec_open,
+			   (void *) cache_name.c_str (),
+			   solib_cache_iovec_pread,
+			   solib_cache_iovec_close,
+			   solib_cache_iovec_fstat);
+
+  if (cached == NULL
+      || !bfd_check_format (cached.get (), bfd_object)
+      || !build_id_verify (cached.get (), build_id->size, build_id->data))
+    return NULL;
+
+  return cached;
+}
+
 /* Find shared library PATHNAME and open a BFD for it.  */
 
 gdb_bfd_ref_ptr
@@ -512,6 +796,17 @@ solib_bfd_open (const char *pathname)
              bfd_get_arch_info (abfd.get ())->printable_name,
 	     b->printable_name);
 
+  /* Use the local copy of a library read from the target, if we keep
+     them.  */
+  if (solib_cache_directory != NULL && *solib_cache_directory != '\0'
+      && gdb_bfd_has_target_filename (abfd.get ()))
+    {
+      gdb_bfd_ref_ptr cached = solib_cache_bfd_open (abfd.get ());
+
+      if (cached != NULL)
+	return cached;
+    }
+
   return abfd;
 }
 
@@ -973,6 +1268,7 @@ solib_add (const char *pattern, int from_tty, int readsyms)
   {
     int any_matches = 0;
     int loaded_any_symbols = 0;
+    std::vector<struct objfile *> new_objfiles;
     symfile_add_flags add_flags = SYMFILE_DEFER_BP_RESET;
 
     if (from_tty)
@@ -1001,12 +1297,18 @@ solib_add (const char *pattern, int from_tty, int readsyms)
 				       gdb->so_name);
 		}
 	      else if (solib_read_symbols (gdb, add_flags))
-		loaded_any_symbols = 1;
+		{
+		  loaded_any_symbols = 1;
+		  if (gdb->objfile != NULL)
+		    new_objfiles.push_back (gdb->objfile);
+		}
 	    }
 	}
 
+    /* Only the breakpoints that can resolve to the new libraries need
+       to be re-set.  */
     if (loaded_any_symbols)
-      breakpoint_re_set ();
+      breakpoint_re_set_objfiles (new_objfiles);
 
     if (from_tty && pattern && ! any_matches)
       printf_unfiltered
@@ -1645,4 +1947,19 @@ PATH and LD_LIBRARY_PATH."),
 				     reload_shared_libraries,
 				     show_solib_search_path,
 				     &setlist, &showlist);
+
+  add_setshow_optional_filename_cmd ("solib-cache-directory", class_support,
+				     &solib_cache_directory, _("\
+Set the directory for copies of shared libraries read from the target."),
+				     _("\
+Show the directory for copies of shared libraries read from the target."),
+				     _("\
+When the system root starts with \"target:\", each shared library read\n\
+from the target is copied to this directory, under the connection to the\n\
+target, its name on the target and its build-id, and read from the copy\n\
+from then on, even by later debugging sessions.  If empty, shared libraries are read from the\n\
+target every time."),
+				     NULL,
+				     show_solib_cache_directory,
+				     &setlist, &showlist);
 }
@@ -53,6 +53,9 @@
 #include "extension.h"
 #include "observable.h"
 #include "common/def-vector.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
 
 /* The possible choices of "set print frame-arguments", and the value
    of this setting.  */
@@ -1826,10 +1829,240 @@ backtrace_command_1 (const char *count_exp, frame_filter_flags flags,
     }
 }
 
+/* Print the backtrace of the selected thread as backtrace_command_1
+   does, but print an error instead of throwing it, so that the
+   backtraces of the other threads still get printed.  */
+
+static void
+backtrace_thread_command_1 (const char *count_exp, frame_filter_flags flags,
+			    int no_filters, int from_tty)
+{
+  TRY
+    {
+      backtrace_command_1 (count_exp, flags, no_filters, from_tty);
+    }
+  CATCH (ex, RETURN_MASK_ERROR)
+    {
+      exception_print (gdb_stderr, ex);
+    }
+  END_CATCH
+}
+
+/* A thread whose stack was found by "backtrace unique".  The thread is
+   remembered by ptid, as the thread list may be pruned before the
+   stacks are printed.  */
+
+struct unique_stack_thread
+{
+  ptid_t ptid;
+  int inf_num;
+  int per_inf_num;
+};
+
+/* A distinct stack found by "backtrace unique".  */
+
+struct unique_stack
+{
+  /* The PC of each frame, innermost first.  */
+  std::vector<CORE_ADDR> pcs;
+
+  /* The threads with this stack, in ascending thread ID order.  The
+     first one was unwound completely and is the one printed.  */
+  std::vector<unique_stack_thread> threads;
+
+  /* If some of THREADS were only matched against PCS on their
+     innermost frames, the fewest frames any of them was compared on;
+     otherwise zero.  */
+  size_t prefix_frames = 0;
+};
+
+/* Return THREADS as a thread ID list, with runs of consecutive IDs
+   collapsed into ranges, in the syntax "thread apply" accepts.  */
+
+static std::string
+unique_stack_thread_ids (const std::vector<unique_stack_thread> &threads)
+{
+  bool qualified = show_inferior_qualified_tids ();
+  std::string ids;
+
+  for (size_t i = 0; i < threads.size (); )
+    {
+      size_t j = i;
+
+      while (j + 1 < threads.size ()
+	     && threads[j + 1].inf_num == threads[i].inf_num
+	     && threads[j + 1].per_inf_num == threads[j].per_inf_num + 1)
+	j++;
+
+      if (!ids.empty ())
+	ids += ", ";
+      if (qualified)
+	ids += string_printf ("%d.", threads[i].inf_num);
+      ids += string_printf ("%d", threads[i].per_inf_num);
+      if (j > i)
+	ids += string_printf ("-%d", threads[j].per_inf_num);
+
+      i = j + 1;
+    }
+
+  return ids;
+}
+
+/* Print each distinct stack of the live threads once, with the list of
+   threads it belongs to.
+
+   Stacks are compared by the PCs of their frames.  While unwinding a
+   thread, a running hash of the PCs seen so far is looked up among the
+   prefixes of the stacks already found; once BACKTRACE_UNIQUE_PREFIX
+   frames match the prefix of exactly one of them, the thread is
+   assumed to share that stack and is not unwound further, and the
+   stack's header says how many frames were compared.  Threads are
+   otherwise unwound completely and compared exactly.  */
+
+static void
+backtrace_unique_threads (const char *count_exp, frame_filter_flags flags,
+			  int no_filters, int from_tty)
+{
+  std::vector<unique_stack> stacks;
+
+  /* Map of complete stacks to their index in STACKS.  */
+  std::map<std::vector<CORE_ADDR>, int> stack_index;
+
+  /* Map of the hash of each prefix of the stacks in STACKS to the
+     index of the stack, or to -1 if more than one stack has it.  */
+  std::unordered_map<hashval_t, int> prefix_index;
+
+  scoped_restore_current_thread restore_thread;
+
+  iterate_over_live_threads_ordered (true, [&] (thread_info *thr)
+    {
+      std::vector<CORE_ADDR> pcs;
+      hashval_t hash = 0;
+      int found = -1;
+      size_t prefix_frames = 0;
+
+      TRY
+	{
+	  for (struct frame_info *fi = get_current_frame ();
+	       fi != NULL;
+	       fi = get_prev_frame (fi))
+	    {
+	      CORE_ADDR pc = 0;
+
+	      QUIT;
+
+	      get_frame_pc_if_available (fi, &pc);
+	      pcs.push_back (pc);
+	      hash = iterative_hash (&pc, sizeof (pc), hash);
+
+	      if (pcs.size () >= backtrace_unique_prefix)
+		{
+		  auto it = prefix_index.find (hash);
+
+		  /* Different prefixes may hash alike, so check the PCs
+		     themselves before trusting the match.  */
+		  if (it != prefix_index.end () && it->second >= 0)
+		    {
+		      const std::vector<CORE_ADDR> &seen
+			= stacks[it->second].pcs;
+
+		      if (seen.size () >= pcs.size ()
+			  && std::equal (pcs.begin (), pcs.end (),
+					 seen.begin ()))
+			{
+			  found = it->second;
+			  prefix_frames = pcs.size ();
+			  break;
+			}
+		    }
+		}
+	    }
+	}
+      CATCH (ex, RETURN_MASK_ERROR)
+	{
+	  /* Compare the frames unwound so far; printing the thread's
+	     backtrace shows the error.  */
+	}
+      END_CATCH
+
+      if (found < 0)
+	{
+	  auto it = stack_index.find (pcs);
+
+	  if (it != stack_index.end ())
+	    found = it->second;
+	  else
+	    {
+	      found = stacks.size ();
+	      stack_index.emplace (pcs, found);
+
+	      hash = 0;
+	      for (CORE_ADDR pc : pcs)
+		{
+		  hash = iterative_hash (&pc, sizeof (pc), hash);
+
+		  auto res = prefix_index.emplace (hash, found);
+		  if (!res.second && res.first->second != found)
+		    res.first->second = -1;
+		}
+
+	      stacks.emplace_back ();
+	      stacks.back ().pcs = std::move (pcs);
+	    }
+	}
+
+      unique_stack &stack = stacks[found];
+
+      stack.threads.push_back ({thr->ptid, thr->inf->num,
+				thr->per_inf_num});
+      if (prefix_frames != 0
+	  && (stack.prefix_frames == 0 || prefix_frames < stack.prefix_frames))
+	stack.prefix_frames = prefix_frames;
+    });
+
+  size_t nthreads = 0;
+
+  for (const unique_stack &stack : stacks)
+    {
+      const unique_stack_thread &first = stack.threads.front ();
+      thread_info *thr = find_thread_ptid (first.ptid);
+
+      nthreads += stack.threads.size ();
+
+      if (stack.threads.size () == 1)
+	printf_filtered (_("\nThread %s (%s):\n"),
+			 unique_stack_thread_ids (stack.threads).c_str (),
+			 target_pid_to_str (first.ptid));
+      else if (stack.prefix_frames != 0)
+	printf_filtered (_("\nThreads %s (%s threads, same innermost "
+			   "%s frames):\n"),
+			 unique_stack_thread_ids (stack.threads).c_str (),
+			 pulongest (stack.threads.size ()),
+			 pulongest (stack.prefix_frames));
+      else
+	printf_filtered (_("\nThreads %s (%s threads):\n"),
+			 unique_stack_thread_ids (stack.threads).c_str (),
+			 pulongest (stack.threads.size ()));
+
+      if (thr == NULL || thr->state == THREAD_EXITED)
+	{
+	  printf_filtered (_("(thread exited)\n"));
+	  continue;
+	}
+
+      switch_to_thread (thr);
+      backtrace_thread_command_1 (count_exp, flags, no_filters, from_tty);
+    }
+
+  printf_filtered (_("\n%s distinct stacks in %s threads.\n"),
+		   pulongest (stacks.size ()), pulongest (nthreads));
+}
+
 static void
 backtrace_command (const char *arg, int from_tty)
 {
   bool filters = true;
+  bool unique = false;
   frame_filter_flags flags = 0;
 
   if (arg)
@@ -1850,6 +2083,8 @@ backtrace_command (const char *arg, int from_tty)
 	    flags |= PRINT_LOCALS;
 	  else if (subset_compare (this_arg.c_str (), "hide"))
 	    flags |= PRINT_HIDE;
+	  else if (subset_compare (this_arg.c_str (), "unique"))
+	    unique = true;
 	  else
 	    {
 	      /* Not a recognized argument, so stop.  */
@@ -1862,7 +2097,12 @@ backtrace_command (const char *arg, int from_tty)
 	arg = NULL;
     }
 
-  backtrace_command_1 (arg, flags, !filters /* no frame-filters */, from_tty);
+  if (unique)
+    backtrace_unique_threads (arg, flags, !filters /* no frame-filters */,
+			      from_tty);
+  else
+    backtrace_command_1 (arg, flags, !filters /* no frame-filters */,
+			 from_tty);
 }
 
 /* Iterate over the local variables of a block B, calling CB with
@@ -2539,7 +2779,9 @@ Usage: backtrace [QUALIFIERS]... [COUNT]\n\
 With a negative argument, print outermost -COUNT frames.\n\
 Use of the 'full' qualifier also prints the values of the local variables.\n\
 Use of the 'no-filters' qualifier prohibits frame filters from executing\n\
-on this backtrace."));
+on this backtrace.\n\
+Use of the 'unique' qualifier prints each distinct stack of all threads\n\
+once, with the list of threads it belongs to."));
   add_com_alias ("bt", "backtrace", class_stack, 0);
 
   add_com_alias ("where", "backtrace", class_alias, 0);
@@ -120,6 +120,10 @@
   target_debug_do_print (host_address_to_string (X.data ()))
 #define target_debug_print_std_vector_static_tracepoint_marker(X)	\
   target_debug_do_print (host_address_to_string (X.data ()))
+#define target_debug_print_std_vector_memory_read_request_p(X)	\
+  target_debug_do_print (host_address_to_string (X))
+#define target_debug_print_std_vector_gdb_byte_vector_p(X)	\
+  target_debug_do_print (host_address_to_string (X))
 #define target_debug_print_const_struct_target_desc_p(X)	\
   target_debug_do_print (host_address_to_string (X))
 #define target_debug_print_struct_bp_location_p(X)	\
@@ -78,6 +78,7 @@ struct dummy_target : public target_ops
   char *pid_to_exec_file (int arg0) override;
   void log_command (const char *arg0) override;
   struct target_section_table *get_section_table () override;
+  const char *connection_string () override;
   thread_control_capabilities get_thread_control_capabilities () override;
   bool attach_no_wait () override;
   bool can_async_p () override;
@@ -93,6 +94,8 @@ struct dummy_target : public target_ops
   CORE_ADDR get_thread_local_address (ptid_t arg0, CORE_ADDR arg1, CORE_ADDR arg2) override;
   enum target_xfer_status xfer_partial (enum target_object arg0, const char *arg1, gdb_byte *arg2, const gdb_byte *arg3, ULONGEST arg4, ULONGEST arg5, ULONGEST *arg6) override;
   ULONGEST get_memory_xfer_limit () override;
+  bool read_memory_vector (std::vector<memory_read_request> *arg0) override;
+  bool read_memory_chain (CORE_ADDR arg0, ULONGEST arg1, ULONGEST arg2, int arg3, std::vector<gdb::byte_vector> *arg4) override;
   std::vector<mem_region> memory_map () override;
   void flash_erase (ULONGEST arg0, LONGEST arg1) override;
   void flash_done () override;
@@ -246,6 +249,7 @@ struct debug_target : public target_ops
   char *pid_to_exec_file (int arg0) override;
   void log_command (const char *arg0) override;
   struct target_section_table *get_section_table () override;
+  const char *connection_string () override;
   thread_control_capabilities get_thread_control_capabilities () override;
   bool attach_no_wait () override;
   bool can_async_p () override;
@@ -261,6 +265,8 @@ struct debug_target : public target_ops
   CORE_ADDR get_thread_local_address (ptid_t arg0, CORE_ADDR arg1, CORE_ADDR arg2) override;
   enum target_xfer_status xfer_partial (enum target_object arg0, const char *arg1, gdb_byte *arg2, const gdb_byte *arg3, ULONGEST arg4, ULONGEST arg5, ULONGEST *arg6) override;
   ULONGEST get_memory_xfer_limit () override;
+  bool read_memory_vector (std::vector<memory_read_request> *arg0) override;
+  bool read_memory_chain (CORE_ADDR arg0, ULONGEST arg1, ULONGEST arg2, int arg3, std::vector<gdb::byte_vector> *arg4) override;
   std::vector<mem_region> memory_map () override;
   void flash_erase (ULONGEST arg0, LONGEST arg1) override;
   void flash_done () override;
@@ -2043,6 +2049,31 @@ debug_target::get_section_table ()
   return result;
 }
 
+const char *
+target_ops::connection_string ()
+{
+  return this->beneath ()->connection_string ();
+}
+
+const char *
+dummy_target::connection_string ()
+{
+  return NULL;
+}
+
+const char *
+debug_target::connection_string ()
+{
+  const char * result;
+  fprintf_unfiltered (gdb_stdlog, "-> %s->connection_string (...)\n", this->beneath ()->shortname ());
+  result = this->beneath ()->connection_string ();
+  fprintf_unfiltered (gdb_stdlog, "<- %s->connection_string (", this->beneath ()->shortname ());
+  fputs_unfiltered (") = ", gdb_stdlog);
+  target_debug_print_const_char_p (result);
+  fputs_unfiltered ("\n", gdb_stdlog);
+  return result;
+}
+
 thread_control_capabilities
 target_ops::get_thread_control_capabilities ()
 {
@@ -2437,6 +2468,66 @@ debug_target::get_memory_xfer_limit ()
   return result;
 }
 
+bool
+target_ops::read_memory_vector (std::vector<memory_read_request> *arg0)
+{
+  return this->beneath ()->read_memory_vector (arg0);
+}
+
+bool
+dummy_target::read_memory_vector (std::vector<memory_read_request> *arg0)
+{
+  return false;
+}
+
+bool
+debug_target::read_memory_vector (std::vector<memory_read_request> *arg0)
+{
+  bool result;
+  fprintf_unfiltered (gdb_stdlog, "-> %s->read_memory_vector (...)\n", this->beneath ()->shortname ());
+  result = this->beneath ()->read_memory_vector (arg0);
+  fprintf_unfiltered (gdb_stdlog, "<- %s->read_memory_vector (", this->beneath ()->shortname ());
+  target_debug_print_std_vector_memory_read_request_p (arg0);
+  fputs_unfiltered (") = ", gdb_stdlog);
+  target_debug_print_bool (result);
+  fputs_unfiltered ("\n", gdb_stdlog);
+  return result;
+}
+
+bool
+target_ops::read_memory_chain (CORE_ADDR arg0, ULONGEST arg1, ULONGEST arg2, int arg3, std::vector<gdb::byte_vector> *arg4)
+{
+  return this->beneath ()->read_memory_chain (arg0, arg1, arg2, arg3, arg4);
+}
+
+bool
+dummy_target::read_memory_chain (CORE_ADDR arg0, ULONGEST arg1, ULONGEST arg2, int arg3, std::vector<gdb::byte_vector> *arg4)
+{
+  return false;
+}
+
+bool
+debug_target::read_memory_chain (CORE_ADDR arg0, ULONGEST arg1, ULONGEST arg2, int arg3, std::vector<gdb::byte_vector> *arg4)
+{
+  bool result;
+  fprintf_unfiltered (gdb_stdlog, "-> %s->read_memory_chain (...)\n", this->beneath ()->shortname ());
+  result = this->beneath ()->read_memory_chain (arg0, arg1, arg2, arg3, arg4);
+  fprintf_unfiltered (gdb_stdlog, "<- %s->read_memory_chain (", this->beneath ()->shortname ());
+  target_debug_print_CORE_ADDR (arg0);
+  fputs_unfiltered (", ", gdb_stdlog);
+  target_debug_print_ULONGEST (arg1);
+  fputs_unfiltered (", ", gdb_stdlog);
+  target_debug_print_ULONGEST (arg2);
+  fputs_unfiltered (", ", gdb_stdlog);
+  target_debug_print_int (arg3);
+  fputs_unfiltered (", ", gdb_stdlog);
+  target_debug_print_std_vector_gdb_byte_vector_p (arg4);
+  fputs_unfiltered (") = ", gdb_stdlog);
+  target_debug_print_bool (result);
+  fputs_unfiltered ("\n", gdb_stdlog);
+  return result;
+}
+
 std::vector<mem_region>
 target_ops::memory_map ()
 {
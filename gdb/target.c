@@ -48,6 +48,7 @@
 #include <algorithm>
 #include "byte-vector.h"
 #include "terminal.h"
+#include "observable.h"
 #include <algorithm>
 #include <unordered_map>
 
@@ -1213,6 +1214,8 @@ memory_xfer_partial (struct target_ops *ops, enum target_object object,
       breakpoint_xfer_memory (NULL, buf.data (), writebuf, memaddr, len);
       res = memory_xfer_partial_1 (ops, object, NULL, buf.data (), memaddr, len,
 				   xfered_len);
+      if (res == TARGET_XFER_OK)
+	gdb::observers::target_memory_written.notify (memaddr, *xfered_len);
     }
 
   return res;
@@ -1402,6 +1405,135 @@ target_read_code (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len)
     return -1;
 }
 
+/* Return true if LEN bytes at MEMADDR may be read with the target's
+   read_memory_vector or read_memory_chain method, which bypass
+   memory_xfer_partial: no overlay, trusted read-only section, memory
+   region attribute or data cache applies to them.  */
+
+static bool
+memory_vector_direct_p (CORE_ADDR memaddr, ULONGEST len)
+{
+  struct mem_region *region;
+
+  if (overlay_debugging || trust_readonly
+      || address_significant (target_gdbarch (), memaddr) != memaddr)
+    return false;
+
+  region = lookup_mem_region (memaddr);
+  if ((region->attrib.mode != MEM_RW && region->attrib.mode != MEM_RO)
+      || region->attrib.cache)
+    return false;
+
+  /* region->hi == 0 means there's no upper bound.  */
+  return region->hi == 0 || memaddr + len <= region->hi;
+}
+
+/* See target.h.  */
+
+void
+target_read_memory_vector (std::vector<memory_read_request> &requests)
+{
+  bool direct = true;
+
+  for (memory_read_request &req : requests)
+    {
+      req.data.clear ();
+      req.failed = false;
+      if (!memory_vector_direct_p (req.addr, req.len))
+	direct = false;
+    }
+
+  if (!direct || !current_top_target ()->read_memory_vector (&requests))
+    for (memory_read_request &req : requests)
+      {
+	req.data.clear ();
+	req.failed = false;
+      }
+
+  for (memory_read_request &req : requests)
+    {
+      ULONGEST done = req.data.size ();
+
+      if (done != 0 && !show_memory_breakpoints)
+	breakpoint_xfer_memory (req.data.data (), NULL, NULL, req.addr, done);
+
+      /* The target may have left out the end of a block that didn't
+	 fit in its reply.  Read the rest of it the slow way, which
+	 finds out exactly how much of it is readable.  */
+      if (done < req.len && !req.failed)
+	{
+	  LONGEST xfered;
+
+	  req.data.resize (req.len);
+	  xfered = target_read (current_top_target (), TARGET_OBJECT_MEMORY,
+				NULL, req.data.data () + done, req.addr + done,
+				req.len - done);
+	  req.data.resize (done + std::max (xfered, (LONGEST) 0));
+	}
+    }
+}
+
+/* See target.h.  */
+
+std::vector<gdb::byte_vector>
+target_read_memory_chain (CORE_ADDR addr, ULONGEST len,
+			  ULONGEST next_offset, int max_count)
+{
+  struct gdbarch *gdbarch = target_gdbarch ();
+  int ptr_size = gdbarch_ptr_bit (gdbarch) / TARGET_CHAR_BIT;
+  enum bfd_endian byte_order = gdbarch_byte_order (gdbarch);
+  std::vector<gdb::byte_vector> nodes;
+  CORE_ADDR node = addr;
+
+  gdb_assert (next_offset + ptr_size <= len);
+
+  if (memory_vector_direct_p (addr, len)
+      && current_top_target ()->read_memory_chain (addr, len, next_offset,
+						   max_count, &nodes))
+    {
+      /* Keep the nodes up to the first one that is short or that
+	 should have been read the slow way, and read the rest of the
+	 list from there.  */
+      for (size_t i = 0; i < nodes.size (); i++)
+	{
+	  if (nodes[i].size () < len || !memory_vector_direct_p (node, len))
+	    {
+	      nodes.resize (i);
+	      break;
+	    }
+
+	  if (!show_memory_breakpoints)
+	    breakpoint_xfer_memory (nodes[i].data (), NULL, NULL, node, len);
+	  node = extract_unsigned_integer (nodes[i].data () + next_offset,
+					   ptr_size, byte_order);
+	}
+    }
+  else
+    nodes.clear ();
+
+  while (nodes.size () < (size_t) max_count
+	 && (nodes.empty () || (node != 0 && node != addr)))
+    {
+      gdb::byte_vector buf (len);
+      LONGEST xfered = target_read (current_top_target (),
+				    TARGET_OBJECT_MEMORY, NULL,
+				    buf.data (), node, len);
+
+      if (xfered < (LONGEST) len)
+	{
+	  buf.resize (std::max (xfered, (LONGEST) 0));
+	  nodes.push_back (std::move (buf));
+	  break;
+	}
+
+      node = extract_unsigned_integer (buf.data () + next_offset,
+				       ptr_size, byte_order);
+      nodes.push_back (std::move (buf));
+    }
+
+  return nodes;
+}
+
 /* Write LEN bytes from MYADDR to target memory at address MEMADDR.
    Returns either 0 for success or -1 if any error occurs.  If an
    error occurs, no guarantee is made about how much data got written.
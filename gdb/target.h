@@ -43,6 +43,7 @@ struct inferior;
 #include "infrun.h" /* For enum exec_direction_kind.  */
 #include "breakpoint.h" /* For enum bptype.  */
 #include "common/scoped_restore.h"
+#include "common/byte-vector.h"
 
 /* This include file defines the interface between the main part
    of the debugger, and the part which is target-specific, or
@@ -182,7 +183,8 @@ enum target_object
   /* Extra signal info.  Usually the contents of `siginfo_t' on unix
      platforms.  */
   TARGET_OBJECT_SIGNAL_INFO,
-  /* The list of threads that are being debugged.  */
+  /* The list of threads that are being debugged.  The annex is NULL,
+     or "since=GENERATION" for the changes since an earlier list.  */
   TARGET_OBJECT_THREADS,
   /* Collected static trace data.  */
   TARGET_OBJECT_STATIC_TRACE_DATA,
@@ -295,6 +297,27 @@ struct memory_read_result
 extern std::vector<memory_read_result> read_memory_robust
     (struct target_ops *ops, const ULONGEST offset, const LONGEST len);
 
+/* Describes one block of memory to read with
+   target_read_memory_vector.  */
+
+struct memory_read_request
+{
+  memory_read_request (CORE_ADDR addr_, ULONGEST len_)
+    : addr (addr_), len (len_)
+  {}
+
+  /* Address of the first byte to read.  */
+  CORE_ADDR addr;
+  /* Number of bytes to read.  */
+  ULONGEST len;
+  /* The bytes read from ADDR on.  Shorter than LEN if the rest of the
+     block couldn't be read.  */
+  gdb::byte_vector data;
+  /* True if the target failed to read the rest of the block after
+     DATA, and no more of it is to be read.  */
+  bool failed = false;
+};
+
 /* Request that OPS transfer up to LEN addressable units from BUF to the
    target's OBJECT.  When writing to a memory object, the addressable unit
    size is architecture dependent and can be found using
@@ -671,6 +694,11 @@ struct target_ops
       TARGET_DEFAULT_IGNORE ();
     virtual struct target_section_table *get_section_table ()
       TARGET_DEFAULT_RETURN (NULL);
+    /* Return a string identifying the connection to the target, such
+       as the argument of "target remote", or NULL if the target has
+       no connection.  */
+    virtual const char *connection_string ()
+      TARGET_DEFAULT_RETURN (NULL);
     enum strata to_stratum;
 
     /* Provide default values for all "must have" methods.  */
@@ -772,6 +800,22 @@ struct target_ops
     virtual ULONGEST get_memory_xfer_limit ()
       TARGET_DEFAULT_RETURN (ULONGEST_MAX);
 
+    /* Read each block in REQUESTS, which are plain memory, in as few
+       requests to the target as possible.  Return false if the
+       target can't do better than reading the blocks one at a time.
+       See target_read_memory_vector.  */
+    virtual bool read_memory_vector (std::vector<memory_read_request> *requests)
+      TARGET_DEFAULT_RETURN (false);
+
+    /* Read the nodes of the linked list at ADDR into NODES, in as few
+       requests to the target as possible.  Return false if the
+       target can't do better than reading the nodes one at a time.
+       See target_read_memory_chain.  */
+    virtual bool read_memory_chain (CORE_ADDR addr, ULONGEST len,
+				    ULONGEST next_offset, int max_count,
+				    std::vector<gdb::byte_vector> *nodes)
+      TARGET_DEFAULT_RETURN (false);
+
     /* Returns the memory map for the target.  A return value of NULL
        means that no memory map is available.  If a memory address
        does not fall within any returned regions, it's assumed to be
@@ -1487,6 +1531,26 @@ extern int target_read_stack (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len);
 
 extern int target_read_code (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len);
 
+/* Read each block of memory in REQUESTS into its DATA, which is left
+   shorter than the block if only part of it could be read.  A target
+   that reads a block with one access may fail all of it, even though
+   its first bytes are readable.  Unlike
+   calling target_read_memory for each block, this reads all of them
+   in a single round trip to a remote target that supports it.  */
+
+extern void target_read_memory_vector
+  (std::vector<memory_read_request> &requests);
+
+/* Read the nodes of the linked list whose first node is at ADDR, each
+   LEN bytes long, with the target pointer at NEXT_OFFSET pointing to
+   the next one.  Stop after MAX_COUNT nodes, at a null pointer, or at
+   a pointer back to ADDR.  The last node returned is shorter than LEN
+   if only part of it could be read.  A remote target that supports it
+   follows the pointers itself, in a single round trip.  */
+
+extern std::vector<gdb::byte_vector> target_read_memory_chain
+  (CORE_ADDR addr, ULONGEST len, ULONGEST next_offset, int max_count);
+
 /* For target_write_memory see target/target.h.  */
 
 extern int target_write_raw_memory (CORE_ADDR memaddr, const gdb_byte *myaddr,
@@ -0,0 +1,56 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <assert.h>
+#include <dlfcn.h>
+#include <stddef.h>
+
+int
+func (int arg_main)
+{
+  return arg_main * 2;
+}
+
+void
+loaded (void)
+{
+}
+
+int
+main (void)
+{
+  void *handle1, *handle2;
+  int (*lib_func) (int);
+  int total = 0;
+
+  handle1 = dlopen (SHLIB1_NAME, RTLD_LAZY);
+  assert (handle1 != NULL);
+  loaded ();
+
+  handle2 = dlopen (SHLIB2_NAME, RTLD_LAZY);
+  assert (handle2 != NULL);
+  loaded ();
+
+  total += func (1);
+  total += func (3);
+
+  lib_func = (int (*) (int)) dlsym (handle1, "func");
+  assert (lib_func != NULL);
+  total += lib_func (0);
+
+  return total == 9 ? 0 : 1;
+}
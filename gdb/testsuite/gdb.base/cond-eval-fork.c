@@ -0,0 +1,50 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+volatile int total;
+
+void
+hit (int i)
+{
+  total++;	/* hit line */
+}
+
+int
+main (void)
+{
+  pid_t child;
+  int i;
+
+  for (i = 0; i < 10; i++)
+    hit (i);
+
+  child = fork ();
+
+  for (i = 10; i < 20; i++)
+    hit (i);
+
+  if (child > 0)
+    waitpid (child, NULL, 0);
+  else if (child == 0)
+    _exit (0);
+
+  return 0;	/* done line */
+}
@@ -0,0 +1,60 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+
+#define NTHREADS 4
+#define NCALLS 1000
+
+/* Calls of hit made by each thread.  Each thread only updates its own
+   counter, so that no call goes uncounted.  */
+volatile int counts[NTHREADS];
+
+void
+hit (int thread, int i)
+{
+  counts[thread]++;	/* hit line */
+}
+
+static void *
+worker (void *arg)
+{
+  int thread = *(int *) arg;
+  int i;
+
+  for (i = 0; i < NCALLS; i++)
+    hit (thread, i);
+  return NULL;
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+  int ids[NTHREADS];
+  int i;
+
+  for (i = 0; i < NTHREADS; i++)
+    {
+      ids[i] = i;
+      pthread_create (&threads[i], NULL, worker, &ids[i]);
+    }
+  for (i = 0; i < NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+
+  return 0;	/* done line */
+}
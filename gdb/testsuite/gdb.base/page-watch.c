@@ -0,0 +1,57 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <unistd.h>
+
+/* BUF is too large for the debug registers.  BEFORE and AFTER share
+   its pages.  */
+
+struct
+{
+  int before[16];
+  int buf[1000];
+  int after[16];
+} data __attribute__ ((aligned (4096)));
+
+int
+main (void)
+{
+  int fds[2];
+  int i, n;
+
+  if (pipe (fds) != 0)
+    return 1;
+
+  for (i = 0; i < 16; i++)
+    data.before[i] = i + 1;
+  for (i = 0; i < 16; i++)
+    data.after[i] = i + 1;
+
+  /* Ends right where BUF starts.  */
+  *(volatile long long *) &data.before[14] = -1;
+
+  data.buf[500] = 42;		/* buf write line */
+
+  /* Starts in BEFORE, ends in BUF.  */
+  *(volatile long long *) &data.before[15] = -1;	/* straddle line */
+
+  if (write (fds[1], "abcd", 4) != 4)
+    return 1;
+  n = read (fds[0], &data.buf[10], 4);	/* read line */
+
+  return n == 4 ? 0 : 1;	/* return line */
+}
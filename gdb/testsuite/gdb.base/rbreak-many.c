@@ -0,0 +1,49 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Forty functions for "rbreak" to set breakpoints on, rbreak_many_10
+   to rbreak_many_49, called in that order.  */
+
+#define FUNC(N) \
+  int rbreak_many_ ## N (void) { return N; }
+#define FUNCS(P) \
+  FUNC (P ## 0) FUNC (P ## 1) FUNC (P ## 2) FUNC (P ## 3) FUNC (P ## 4) \
+  FUNC (P ## 5) FUNC (P ## 6) FUNC (P ## 7) FUNC (P ## 8) FUNC (P ## 9)
+
+#define CALL(N) \
+  total += rbreak_many_ ## N ();
+#define CALLS(P) \
+  CALL (P ## 0) CALL (P ## 1) CALL (P ## 2) CALL (P ## 3) CALL (P ## 4) \
+  CALL (P ## 5) CALL (P ## 6) CALL (P ## 7) CALL (P ## 8) CALL (P ## 9)
+
+FUNCS (1)
+FUNCS (2)
+FUNCS (3)
+FUNCS (4)
+
+int
+main (void)
+{
+  int total = 0;
+
+  CALLS (1)
+  CALLS (2)
+  CALLS (3)
+  CALLS (4)
+
+  return total == 1180 ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+struct node
+{
+  struct node *next;
+  long value;
+};
+
+/* A list that ends with a null pointer.  */
+struct node list[4];
+
+/* A list that comes back to its first node.  */
+struct node ring[3];
+
+/* A list whose third node is not readable, and a list whose third
+   node is only partly readable.  */
+struct node broken[2];
+struct node partial[2];
+
+/* A readable page followed by an unreadable one.  */
+unsigned char *page;
+unsigned char *unmapped;
+long page_size;
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  int i;
+
+  page_size = sysconf (_SC_PAGESIZE);
+  page = (unsigned char *) mmap (NULL, 2 * page_size,
+				 PROT_READ | PROT_WRITE,
+				 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (page == MAP_FAILED)
+    return 1;
+  unmapped = page + page_size;
+  munmap (unmapped, page_size);
+  memset (page, 0x5a, page_size);
+
+  for (i = 0; i < 4; i++)
+    {
+      list[i].next = i < 3 ? &list[i + 1] : NULL;
+      list[i].value = 100 + i;
+    }
+
+  for (i = 0; i < 3; i++)
+    {
+      ring[i].next = &ring[(i + 1) % 3];
+      ring[i].value = 200 + i;
+    }
+
+  broken[0].next = &broken[1];
+  broken[1].next = (struct node *) unmapped;
+
+  /* Only the first half of the last node is readable.  */
+  partial[0].next = &partial[1];
+  partial[1].next = (struct node *) (unmapped - sizeof (struct node) / 2);
+
+  marker ();
+  return 0;
+}
@@ -0,0 +1,63 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <sys/mman.h>
+
+/* inc %eax; ret  */
+static const unsigned char code_inc[] = { 0xff, 0xc0, 0xc3 };
+
+/* movl $5, (%rdi); ret  */
+unsigned char code_store0[] = { 0xc7, 0x07, 0x05, 0x00, 0x00, 0x00, 0xc3 };
+
+/* movl $7, 4(%rdi); ret  */
+static const unsigned char code_store1[]
+  = { 0xc7, 0x47, 0x04, 0x07, 0x00, 0x00, 0x00, 0xc3 };
+
+typedef void (*code_fn) (int *);
+
+unsigned char *code;
+int vars[2];
+
+static void
+run_code (void)
+{
+  ((code_fn) code) (vars);
+}
+
+void
+gdb_writes_code (void)
+{
+}
+
+int
+main (void)
+{
+  code = (unsigned char *) mmap (NULL, 4096,
+				 PROT_READ | PROT_WRITE | PROT_EXEC,
+				 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (code == MAP_FAILED)
+    return 1;
+  memcpy (code, code_inc, sizeof (code_inc));
+
+  run_code ();	/* first run */
+  gdb_writes_code ();	/* gdb writes */
+  run_code ();	/* second run */
+  memcpy (code, code_store1, sizeof (code_store1));	/* program writes */
+  run_code ();	/* third run */
+  return 0;	/* end of main */
+}
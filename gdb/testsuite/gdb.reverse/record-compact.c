@@ -0,0 +1,60 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <signal.h>
+
+volatile int signals;
+unsigned long result;
+
+static void
+handler (int sig)
+{
+  signals++;	/* in handler */
+}
+
+/* Lots of arithmetic on a handful of values, so that most of the
+   recorded changes are register changes.  */
+
+unsigned long
+mix (unsigned long a, unsigned long b)
+{
+  unsigned long c = a ^ 0x5555, d = b + 0x3333, e = a * 7, f = b * 13;
+  int i;
+
+  for (i = 0; i < 64; i++)
+    {
+      a += b ^ c;
+      b = (b << 3) | (b >> 61);
+      c -= d + i;
+      d ^= e >> 2;
+      e += f * 3;
+      f = (f >> 5) + a;
+    }
+
+  return a ^ b ^ c ^ d ^ e ^ f;	/* mix return */
+}
+
+int
+main (void)
+{
+  signal (SIGUSR1, handler);
+  result = 0;	/* start recording */
+  result = mix (1, 2);	/* first mix */
+  raise (SIGUSR1);	/* raise signal */
+  result += mix (3, 4);	/* second mix */
+  return 0;	/* end of main */
+}
@@ -0,0 +1,74 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+
+/* Enough threads that GDBserver cannot send the registers of all of
+   them in one qAllRegisters reply.  */
+#define NTHREADS 240
+
+/* Main waits on STARTED until all the threads are running; they then
+   block on BLOCKED until the program exits.  */
+static pthread_barrier_t started;
+static pthread_mutex_t blocked = PTHREAD_MUTEX_INITIALIZER;
+
+/* Recurse DEPTH times before blocking, so that each thread stops in a
+   different frame.  */
+
+static int
+block (int depth)
+{
+  if (depth > 0)
+    return block (depth - 1) + 1;
+
+  pthread_barrier_wait (&started);
+  pthread_mutex_lock (&blocked);
+  pthread_mutex_unlock (&blocked);
+  return 0;
+}
+
+static void *
+thread_function (void *arg)
+{
+  block ((int) (long) arg);
+  return NULL;
+}
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+  int i;
+
+  pthread_mutex_lock (&blocked);
+  pthread_barrier_init (&started, NULL, NTHREADS + 1);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, thread_function, (void *) (long) i);
+  pthread_barrier_wait (&started);
+
+  marker ();
+
+  pthread_mutex_unlock (&blocked);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+  return 0;
+}
@@ -0,0 +1,69 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+struct node
+{
+  struct node *next;
+  long value;
+};
+
+/* A list that ends with a null pointer, a list that comes back to its
+   first node, and a list whose third node is not readable.  */
+struct node list[4];
+struct node ring[3];
+struct node broken[2];
+
+/* A page that is not readable.  */
+unsigned char *unmapped;
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  long page_size = sysconf (_SC_PAGESIZE);
+  int i;
+
+  unmapped = (unsigned char *) mmap (NULL, page_size, PROT_NONE,
+				     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (unmapped == MAP_FAILED)
+    return 1;
+
+  for (i = 0; i < 4; i++)
+    {
+      list[i].next = i < 3 ? &list[i + 1] : 0;
+      list[i].value = 100 + i;
+    }
+
+  for (i = 0; i < 3; i++)
+    {
+      ring[i].next = &ring[(i + 1) % 3];
+      ring[i].value = 200 + i;
+    }
+
+  broken[0].next = &broken[1];
+  broken[1].next = (struct node *) unmapped;
+
+  marker ();
+  return 0;
+}
@@ -0,0 +1,57 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define NPAGES 16
+
+/* NPAGES readable pages filled with a known pattern, followed by a
+   page that is not mapped at all.  A PROT_NONE page would not do, as
+   ptrace can read it anyway.  */
+unsigned char *block;
+unsigned char *boundary;
+long block_size;
+long page_size;
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  long i;
+
+  page_size = sysconf (_SC_PAGESIZE);
+  block_size = NPAGES * page_size;
+  block = (unsigned char *) mmap (NULL, block_size + page_size,
+				  PROT_READ | PROT_WRITE,
+				  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (block == MAP_FAILED)
+    return 1;
+  boundary = block + block_size;
+  if (munmap (boundary, page_size) != 0)
+    return 1;
+
+  for (i = 0; i < block_size; i++)
+    block[i] = (i * 7) % 251;
+
+  marker ();
+  return 0;
+}
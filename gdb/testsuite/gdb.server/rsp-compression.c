@@ -0,0 +1,52 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+
+#define SIZE 8192
+
+unsigned char src[SIZE];
+unsigned char dst[SIZE];
+
+void
+copied (void)
+{
+}
+
+int
+main (void)
+{
+  unsigned int seed = 1;
+  int i;
+
+  /* Mix runs, repeated patterns and noise, so that the compressor
+     emits both literals and back-references.  */
+  for (i = 0; i < SIZE; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      if ((i / 512) % 3 == 0)
+	src[i] = 0;
+      else if ((i / 512) % 3 == 1)
+	src[i] = "0123456789abcdef"[i % 16];
+      else
+	src[i] = seed >> 16;
+    }
+
+  copied ();	/* set breakpoint here */
+
+  return memcmp (src, dst, SIZE) != 0;
+}
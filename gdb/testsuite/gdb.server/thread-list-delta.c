@@ -0,0 +1,102 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+
+#define NTHREADS 4
+
+/* Main waits on STARTED until the threads it created are running.
+   Thread I then waits until main sets RELEASE[I].  */
+static pthread_barrier_t started;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int release[2 * NTHREADS];
+
+/* The LWP of each thread, and of the main thread.  */
+long lwps[2 * NTHREADS];
+long main_lwp;
+
+static void *
+thread_function (void *arg)
+{
+  int i = (int) (long) arg;
+
+  lwps[i] = syscall (SYS_gettid);
+  pthread_barrier_wait (&started);
+  pthread_mutex_lock (&mutex);
+  while (!release[i])
+    pthread_cond_wait (&cond, &mutex);
+  pthread_mutex_unlock (&mutex);
+  return NULL;
+}
+
+void
+first_list (void)
+{
+}
+
+void
+second_list (void)
+{
+}
+
+int
+main (void)
+{
+  pthread_t threads[2 * NTHREADS];
+  int i;
+
+  main_lwp = syscall (SYS_gettid);
+  pthread_barrier_init (&started, NULL, NTHREADS + 1);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, thread_function, (void *) (long) i);
+  pthread_barrier_wait (&started);
+
+  first_list ();
+
+  /* Let the first half of the threads exit, and start NTHREADS new
+     ones, so that threads both exited and were created between the
+     two lists.  */
+  pthread_mutex_lock (&mutex);
+  for (i = 0; i < NTHREADS / 2; i++)
+    release[i] = 1;
+  pthread_cond_broadcast (&cond);
+  pthread_mutex_unlock (&mutex);
+  for (i = 0; i < NTHREADS / 2; i++)
+    pthread_join (threads[i], NULL);
+
+  pthread_barrier_destroy (&started);
+  pthread_barrier_init (&started, NULL, NTHREADS + 1);
+  for (i = NTHREADS; i < 2 * NTHREADS; i++)
+    pthread_create (&threads[i], NULL, thread_function, (void *) (long) i);
+  pthread_barrier_wait (&started);
+
+  second_list ();
+
+  pthread_mutex_lock (&mutex);
+  for (i = 0; i < 2 * NTHREADS; i++)
+    release[i] = 1;
+  pthread_cond_broadcast (&cond);
+  pthread_mutex_unlock (&mutex);
+  for (i = NTHREADS / 2; i < 2 * NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2018 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <unistd.h>
+
+/* Number of threads of each kind.  */
+#define NTHREADS 3
+
+/* Main waits on STARTED until the threads are about to block on
+   BLOCKED, which it holds until the end.  */
+static pthread_barrier_t started;
+static pthread_mutex_t blocked = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+block (void)
+{
+  pthread_barrier_wait (&started);
+  pthread_mutex_lock (&blocked);
+  pthread_mutex_unlock (&blocked);
+}
+
+/* Recurse DEPTH times before blocking.  Threads that get here from
+   outer_a and from outer_b have the same innermost frames, and only
+   differ in the outermost ones.  */
+
+static int
+common (int depth)
+{
+  if (depth > 0)
+    return common (depth - 1) + 1;
+
+  block ();
+  return 0;
+}
+
+static void * __attribute__ ((noinline))
+outer_a (void *arg)
+{
+  common (10);
+  return NULL;
+}
+
+static void * __attribute__ ((noinline))
+outer_b (void *arg)
+{
+  common (10);
+  return NULL;
+}
+
+/* A stack shared with no other kind of thread.  */
+
+static void *
+shallow (void *arg)
+{
+  block ();
+  return NULL;
+}
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  pthread_t threads[3 * NTHREADS];
+  int i;
+
+  pthread_mutex_lock (&blocked);
+  pthread_barrier_init (&started, NULL, 3 * NTHREADS + 1);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, outer_a, NULL);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[NTHREADS + i], NULL, outer_b, NULL);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[2 * NTHREADS + i], NULL, shallow, NULL);
+  pthread_barrier_wait (&started);
+
+  /* Give the threads time to block.  */
+  sleep (1);
+
+  marker ();
+
+  pthread_mutex_unlock (&blocked);
+  for (i = 0; i < 3 * NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+  return 0;
+}
@@ -1594,60 +1594,72 @@ tp_array_compar (const thread_info *a, const thread_info *b)
 static void
 thread_apply_all_command (const char *cmd, int from_tty)
 {
-  tp_array_compar_ascending = false;
+  bool ascending = false;
+
   if (cmd != NULL
       && check_for_argument (&cmd, "-ascending", strlen ("-ascending")))
     {
       cmd = skip_spaces (cmd);
-      tp_array_compar_ascending = true;
+      ascending = true;
     }
 
   if (cmd == NULL || *cmd == '\000')
     error (_("Please specify a command following the thread ID list"));
 
+  iterate_over_live_threads_ordered (ascending, [&] (thread_info *thr)
+    {
+      printf_filtered (_("\nThread %s (%s):\n"),
+		       print_thread_id (thr),
+		       target_pid_to_str (inferior_ptid));
+
+      execute_command (cmd, from_tty);
+    });
+}
+
+/* See gdbthread.h.  */
+
+void
+iterate_over_live_threads_ordered
+  (bool ascending, gdb::function_view<void (thread_info *)> fn)
+{
   update_thread_list ();
 
   int tc = live_threads_count ();
-  if (tc != 0)
-    {
-      /* Save a copy of the thread list and increment each thread's
-	 refcount while executing the command in the context of each
-	 thread, in case the command is one that wipes threads.  E.g.,
-	 detach, kill, disconnect, etc., or even normally continuing
-	 over an inferior or thread exit.  */
-      std::vector<thread_info *> thr_list_cpy;
-      thr_list_cpy.reserve (tc);
+  if (tc == 0)
+    return;
 
-      {
-	thread_info *tp;
+  /* Save a copy of the thread list and increment each thread's
+     refcount while calling FN in the context of each thread, in case
+     FN wipes threads.  E.g., detach, kill, disconnect, etc., or even
+     normally continuing over an inferior or thread exit.  */
+  std::vector<thread_info *> thr_list_cpy;
+  thr_list_cpy.reserve (tc);
 
-	ALL_NON_EXITED_THREADS (tp)
-	  {
-	    thr_list_cpy.push_back (tp);
-	  }
+  {
+    thread_info *tp;
 
-	gdb_assert (thr_list_cpy.size () == tc);
+    ALL_NON_EXITED_THREADS (tp)
+      {
+	thr_list_cpy.push_back (tp);
       }
 
-      /* Increment the refcounts, and restore them back on scope
-	 exit.  */
-      scoped_inc_dec_ref inc_dec_ref (thr_list_cpy);
+    gdb_assert (thr_list_cpy.size () == tc);
+  }
 
-      std::sort (thr_list_cpy.begin (), thr_list_cpy.end (), tp_array_compar);
+  /* Increment the refcounts, and restore them back on scope exit.  */
+  scoped_inc_dec_ref inc_dec_ref (thr_list_cpy);
 
-      scoped_restore_current_thread restore_thread;
+  tp_array_compar_ascending = ascending;
+  std::sort (thr_list_cpy.begin (), thr_list_cpy.end (), tp_array_compar);
 
-      for (thread_info *thr : thr_list_cpy)
-	if (thread_alive (thr))
-	  {
-	    switch_to_thread (thr);
-	    printf_filtered (_("\nThread %s (%s):\n"),
-			     print_thread_id (thr),
-			     target_pid_to_str (inferior_ptid));
+  scoped_restore_current_thread restore_thread;
 
-	    execute_command (cmd, from_tty);
-	  }
-    }
+  for (thread_info *thr : thr_list_cpy)
+    if (thread_alive (thr))
+      {
+	switch_to_thread (thr);
+	fn (thr);
+      }
 }
 
 /* Implementation of the "thread apply" command.  */
@@ -19,6 +19,7 @@
 
 #include "defs.h"
 #include "inferior.h"
+#include "gdbthread.h"
 #include "elf/common.h"
 #include "gdb_proc_service.h"
 #include "nat/gdb_ptrace.h"
@@ -41,6 +42,15 @@
 #include "nat/x86-linux.h"
 #include "nat/x86-linux-dregs.h"
 #include "nat/linux-ptrace.h"
+#include "nat/linux-waitpid.h"
+#include "gdb_wait.h"
+#include <sys/syscall.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef ENABLE_PIP
+#include <pip_gdbif_enums.h>
+#endif
 
 /* linux_nat_target::low_new_fork implementation.  */
 
@@ -208,6 +218,363 @@ x86_linux_nat_target::read_description ()
 
   gdb_assert_not_reached ("failed to return tdesc");
 }
+
+#ifdef ENABLE_PIP
+/* PiP tasks are processes that run in one address space, but the
+   debug registers, and GDB's mirrors of them, are per process.  So
+   that a watchpoint set in one PiP task catches the accesses of all
+   of them, it is also inserted in the debug register state of the
+   other tasks (see pip_watchpoints_shared_p).  Tasks that show up
+   later get their copies when they are next resumed.  */
+
+struct x86_linux_pip_watch
+{
+  /* The process the watchpoint was set in.  */
+  int pid;
+
+  CORE_ADDR addr;
+  int len;
+  enum target_hw_bp_type type;
+
+  /* The processes that have a copy, and those that had no room for
+   one.  */
+  std::vector<int> copies;
+  std::vector<int> failed;
+};
+
+static std::vector<x86_linux_pip_watch> x86_linux_pip_watches;
+
+/* Insert (if INSERT) or remove watchpoint W in the debug register
+   state of process PID.  Return 0 on success.  */
+
+static int
+x86_linux_pip_update_watch (const x86_linux_pip_watch &w, int pid,
+			    bool insert)
+{
+  struct inferior *inf = find_inferior_pid (pid);
+  struct thread_info *thr;
+
+  thr = inf != NULL ? any_live_thread_of_inferior (inf) : NULL;
+  if (thr == NULL)
+    return -1;
+
+  scoped_restore_current_thread restore_thread;
+
+  switch_to_thread (thr);
+  if (insert)
+    return x86_insert_watchpoint (w.addr, w.len, w.type, NULL);
+  else
+    return x86_remove_watchpoint (w.addr, w.len, w.type, NULL);
+}
+
+/* Give the PiP task INF copies of the watchpoints of the other tasks
+   that it does not have yet.  */
+
+static void
+x86_linux_pip_sync_watches (struct inferior *inf)
+{
+  for (x86_linux_pip_watch &w : x86_linux_pip_watches)
+    {
+      struct inferior *owner = find_inferior_pid (w.pid);
+
+      if (w.pid == inf->pid || owner == NULL
+	  || !pip_watchpoints_shared_p (owner, inf)
+	  || std::find (w.copies.begin (), w.copies.end (), inf->pid)
+	     != w.copies.end ()
+	  || std::find (w.failed.begin (), w.failed.end (), inf->pid)
+	     != w.failed.end ())
+	continue;
+
+      if (x86_linux_pip_update_watch (w, inf->pid, true) == 0)
+	w.copies.push_back (inf->pid);
+      else
+	{
+	  warning (_("No debug register left in PiP task %d to watch "
+		     "%s for process %d."),
+		   inf->pipid, paddress (target_gdbarch (), w.addr), w.pid);
+	  w.failed.push_back (inf->pid);
+	}
+    }
+}
+
+/* Insert the watchpoint just set in the debug registers of the
+   current process in those of every other PiP task sharing its
+   watchpoints.  If one of them has no room left, undo everything and
+   return -1.  */
+
+static int
+x86_linux_pip_share_watch (CORE_ADDR addr, int len,
+			   enum target_hw_bp_type type)
+{
+  struct inferior *inf = find_inferior_ptid (inferior_ptid);
+  struct inferior *other;
+  x86_linux_pip_watch w;
+
+  if (inf == NULL || inf->pipid == PIP_GDBIF_PIPID_ANY)
+    return 0;
+
+  w.pid = inf->pid;
+  w.addr = addr;
+  w.len = len;
+  w.type = type;
+
+  ALL_NON_EXITED_INFERIORS (other)
+    if (other != inf && pip_watchpoints_shared_p (inf, other))
+      {
+	if (x86_linux_pip_update_watch (w, other->pid, true) != 0)
+	  {
+	    for (int pid : w.copies)
+	      x86_linux_pip_update_watch (w, pid, false);
+	    x86_remove_watchpoint (addr, len, type, NULL);
+	    return -1;
+	  }
+	w.copies.push_back (other->pid);
+      }
+
+  x86_linux_pip_watches.push_back (std::move (w));
+  return 0;
+}
+
+/* Remove the copies of the watchpoint being removed from the current
+   process.  */
+
+static void
+x86_linux_pip_unshare_watch (CORE_ADDR addr, int len,
+			     enum target_hw_bp_type type)
+{
+  int pid = inferior_ptid.pid ();
+
+  for (auto it = x86_linux_pip_watches.begin ();
+       it != x86_linux_pip_watches.end (); ++it)
+    if (it->pid == pid && it->addr == addr && it->len == len
+	&& it->type == type)
+      {
+	for (int copy : it->copies)
+	  if (find_inferior_pid (copy) != NULL)
+	    x86_linux_pip_update_watch (*it, copy, false);
+	x86_linux_pip_watches.erase (it);
+	return;
+      }
+}
+#endif
+
+/* Implement the "insert_watchpoint" target_ops method.  Use the
+   debug registers if they can take the watchpoint, and protect the
+   pages that hold the watched range otherwise.  */
+
+int
+x86_linux_nat_target::insert_watchpoint (CORE_ADDR addr, int len,
+					 enum target_hw_bp_type type,
+					 struct expression *cond)
+{
+  bool fits = x86_region_ok_for_hw_watchpoint (addr, len);
+  int ret = 1;
+
+  if (fits)
+    ret = x86_insert_watchpoint (addr, len, type, cond);
+
+#ifdef ENABLE_PIP
+  if (ret == 0)
+    ret = x86_linux_pip_share_watch (addr, len, type);
+#endif
+
+  /* The debug registers have no read watchpoints, and the caller
+     retries those as access watchpoints.  A range that fits in the
+     debug registers only goes to the pages when they are full and
+     page watchpoints are enabled; a wider one was only accepted by
+     region_ok_for_hw_watchpoint if they were.  */
+  if (ret == 0 || type == hw_read
+      || (fits && !linux_nat_can_use_page_watchpoints ()))
+    return ret;
+
+  return linux_nat_insert_page_watchpoint (addr, len, type);
+}
+
+/* Implement the "remove_watchpoint" target_ops method.  */
+
+int
+x86_linux_nat_target::remove_watchpoint (CORE_ADDR addr, int len,
+					 enum target_hw_bp_type type,
+					 struct expression *cond)
+{
+  int ret = linux_nat_remove_page_watchpoint (addr, len, type);
+
+  if (ret == 1)
+    {
+#ifdef ENABLE_PIP
+      x86_linux_pip_unshare_watch (addr, len, type);
+#endif
+      ret = x86_remove_watchpoint (addr, len, type, cond);
+    }
+  return ret;
+}
+
+/* linux_nat_target::low_forget_process implementation.  */
+
+void
+x86_linux_nat_target::low_forget_process (pid_t pid)
+{
+  x86_forget_process (pid);
+
+#ifdef ENABLE_PIP
+  /* The watchpoints of a process that is gone are never removed;
+     remove their copies from the other PiP tasks.  */
+  for (auto it = x86_linux_pip_watches.begin ();
+       it != x86_linux_pip_watches.end (); )
+    {
+      it->copies.erase (std::remove (it->copies.begin (), it->copies.end (),
+				     pid),
+			it->copies.end ());
+      it->failed.erase (std::remove (it->failed.begin (), it->failed.end (),
+				     pid),
+			it->failed.end ());
+      if (it->pid == pid)
+	{
+	  for (int copy : it->copies)
+	    if (find_inferior_pid (copy) != NULL)
+	      x86_linux_pip_update_watch (*it, copy, false);
+	  it = x86_linux_pip_watches.erase (it);
+	}
+      else
+	++it;
+    }
+#endif
+}
+
+/* linux_nat_target::low_prepare_to_resume implementation.  */
+
+void
+x86_linux_nat_target::low_prepare_to_resume (struct lwp_info *lwp)
+{
+#ifdef ENABLE_PIP
+  if (!x86_linux_pip_watches.empty ())
+    {
+      struct inferior *inf = find_inferior_pid (ptid_of_lwp (lwp).pid ());
+
+      if (inf != NULL && inf->pipid != PIP_GDBIF_PIPID_ANY)
+	x86_linux_pip_sync_watches (inf);
+    }
+#endif
+
+  x86_linux_prepare_to_resume (lwp);
+}
+
+/* The instructions low_inferior_mprotect plants to enter the kernel,
+   for 64-bit and 32-bit processes.  */
+static const gdb_byte x86_linux_syscall_insn[] = { 0x0f, 0x05 };
+static const gdb_byte x86_linux_int80_insn[] = { 0xcd, 0x80 };
+
+/* The mprotect system call numbers.  */
+#define X86_LINUX_NR_MPROTECT_64 10
+#define X86_LINUX_NR_MPROTECT_32 125
+#define X86_LINUX_X32_SYSCALL_BIT 0x40000000
+
+/* linux_nat_target::low_inferior_mprotect implementation.  Plant a
+   system call instruction at the PC of LWPID, single-step it with the
+   arguments of mprotect in the registers, and put the instruction and
+   registers back.  */
+
+int
+x86_linux_nat_target::low_inferior_mprotect (int lwpid, CORE_ADDR addr,
+					     ULONGEST len, int prot)
+{
+#if defined __x86_64__ || defined HAVE_PTRACE_GETREGS
+  struct user_regs_struct regs, saved_regs;
+  const gdb_byte *insn = x86_linux_int80_insn;
+  PTRACE_TYPE_RET word, saved_word;
+  PTRACE_TYPE_ARG3 pc;
+  sigset_t pending;
+  int status, ret = 0;
+
+  if (ptrace (PTRACE_GETREGS, lwpid, 0, &regs) < 0)
+    return -errno;
+  saved_regs = regs;
+
+#ifdef __x86_64__
+  pc = (PTRACE_TYPE_ARG3) regs.rip;
+  regs.orig_rax = -1;
+  if (regs.cs == AMD64_LINUX_USER64_CS)
+    {
+      insn = x86_linux_syscall_insn;
+      regs.rax = X86_LINUX_NR_MPROTECT_64;
+      if (regs.ds == AMD64_LINUX_X32_DS)
+	regs.rax |= X86_LINUX_X32_SYSCALL_BIT;
+      regs.rdi = addr;
+      regs.rsi = len;
+      regs.rdx = prot;
+    }
+  else
+    {
+      regs.rax = X86_LINUX_NR_MPROTECT_32;
+      regs.rbx = addr;
+      regs.rcx = len;
+      regs.rdx = prot;
+    }
+#else
+  pc = (PTRACE_TYPE_ARG3) regs.eip;
+  regs.orig_eax = -1;
+  regs.eax = X86_LINUX_NR_MPROTECT_32;
+  regs.ebx = addr;
+  regs.ecx = len;
+  regs.edx = prot;
+#endif
+
+  errno = 0;
+  saved_word = ptrace (PTRACE_PEEKTEXT, lwpid, pc, 0);
+  if (errno != 0)
+    return -errno;
+  word = saved_word;
+  memcpy (&word, insn, 2);
+
+  if (ptrace (PTRACE_POKETEXT, lwpid, pc, word) < 0
+      || ptrace (PTRACE_SETREGS, lwpid, 0, &regs) < 0)
+    ret = -errno;
+
+  /* Signals that arrive before the step is done are raised again
+     once the LWP is restored.  */
+  sigemptyset (&pending);
+  while (ret == 0)
+    {
+      if (ptrace (PTRACE_SINGLESTEP, lwpid, 0, 0) < 0
+	  || my_waitpid (lwpid, &status, __WALL) != lwpid)
+	ret = -errno;
+      else if (!WIFSTOPPED (status))
+	ret = -ESRCH;
+      else if (WSTOPSIG (status) == SIGTRAP)
+	break;
+      else
+	sigaddset (&pending, WSTOPSIG (status));
+    }
+
+  if (ret == 0)
+    {
+      if (ptrace (PTRACE_GETREGS, lwpid, 0, &regs) < 0)
+	ret = -errno;
+      else
+#ifdef __x86_64__
+	ret = (int) regs.rax;
+#else
+	ret = (int) regs.eax;
+#endif
+    }
+
+  /* Whatever happened, put the instruction back first, as the text
+     may be shared with other processes, then the registers, and keep
+     the first error.  */
+  if (ptrace (PTRACE_POKETEXT, lwpid, pc, saved_word) < 0 && ret >= 0)
+    ret = -errno;
+  if (ptrace (PTRACE_SETREGS, lwpid, 0, &saved_regs) < 0 && ret >= 0)
+    ret = -errno;
+
+  for (int sig = 1; sig < NSIG; sig++)
+    if (sigismember (&pending, sig))
+      syscall (__NR_tkill, lwpid, sig);
+
+  return ret;
+#else
+  return -ENOSYS;
+#endif
+}
 
 
 /* Enable branch tracing.  */
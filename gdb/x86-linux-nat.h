@@ -60,13 +60,29 @@ struct x86_linux_nat_target : public x86_nat_target<linux_nat_target>
   bool low_stopped_data_address (CORE_ADDR *addr_p) override
   { return x86_nat_target::stopped_data_address (addr_p); }
 
+  /* Watchpoints the debug registers cannot take may be implemented
+     by protecting the pages that hold them.  */
+  int region_ok_for_hw_watchpoint (CORE_ADDR addr, LONGEST len) override
+  {
+    return (linux_nat_can_use_page_watchpoints ()
+	    || x86_nat_target::region_ok_for_hw_watchpoint (addr, len));
+  }
+
+  int insert_watchpoint (CORE_ADDR addr, int len,
+			 enum target_hw_bp_type type,
+			 struct expression *cond) override;
+  int remove_watchpoint (CORE_ADDR addr, int len,
+			 enum target_hw_bp_type type,
+			 struct expression *cond) override;
+
+  int low_inferior_mprotect (int lwpid, CORE_ADDR addr, ULONGEST len,
+			     int prot) override;
+
   void low_new_fork (struct lwp_info *parent, pid_t child_pid) override;
 
-  void low_forget_process (pid_t pid) override
-  { x86_forget_process (pid); }
+  void low_forget_process (pid_t pid) override;
 
-  void low_prepare_to_resume (struct lwp_info *lwp) override
-  { x86_linux_prepare_to_resume (lwp); }
+  void low_prepare_to_resume (struct lwp_info *lwp) override;
 
   void low_new_thread (struct lwp_info *lwp) override
   { x86_linux_new_thread (lwp); }